@@ -0,0 +1,330 @@
+/*
+ * KeyframeTracks
+ * Track file writing, mapping and four-wide interpolation
+ */
+
+#include "KeyframeTracks.h"
+
+#include <Inventor/nodes/SoTransform.h>
+
+#include <cmath>
+#include <cstring>
+
+#include "Float4.h"
+#include "NotificationBatch.h"
+
+static const char keyframeMagic[8] = { 'C', 'O', 'I', 'N', 'K', 'E', 'Y', 'S' };
+
+// Map value in [min, min + range] to [0, 65535]
+static uint16_t quantizeUnsigned(float value, float min, float range)
+{
+    float unit = (value - min) / range;
+    unit = unit < 0.0f ? 0.0f : (unit > 1.0f ? 1.0f : unit);
+    return (uint16_t)(unit * 65535.0f + 0.5f);
+}
+
+// Map value in [-1, 1] to [-32767, 32767]
+static int16_t quantizeSigned(float value)
+{
+    value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    return (int16_t)floorf(value * 32767.0f + 0.5f);
+}
+
+KeyframeWriter::KeyframeWriter()
+    : fp(NULL), failed(false)
+{
+    memset(&header, 0, sizeof(header));
+}
+
+KeyframeWriter::~KeyframeWriter()
+{
+    close();
+}
+
+bool KeyframeWriter::open(const char* filename, int numTracks, float startTime, float keyInterval,
+                          bool quantize, const SbBox3f& translationBounds,
+                          const SbBox3f& scaleBounds)
+{
+    close();
+    if (numTracks <= 0 || keyInterval <= 0.0f ||
+        (quantize && (translationBounds.isEmpty() || scaleBounds.isEmpty()))) {
+        return false;
+    }
+    fp = fopen(filename, "wb");
+    if (!fp) {
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, keyframeMagic, sizeof(header.magic));
+    header.numTracks = (uint32_t)numTracks;
+    header.stride = (header.numTracks + 3) & ~3u;
+    header.quantized = quantize ? 1 : 0;
+    header.startTime = startTime;
+    header.keyInterval = keyInterval;
+    if (quantize) {
+        for (int i = 0; i < 3; i++) {
+            float translationRange = translationBounds.getMax()[i] - translationBounds.getMin()[i];
+            float scaleRange = scaleBounds.getMax()[i] - scaleBounds.getMin()[i];
+            header.translationMin[i] = translationBounds.getMin()[i];
+            header.translationRange[i] = translationRange > 0.0f ? translationRange : 1.0f;
+            header.scaleMin[i] = scaleBounds.getMin()[i];
+            header.scaleRange[i] = scaleRange > 0.0f ? scaleRange : 1.0f;
+        }
+    }
+    failed = fwrite(&header, sizeof(header), 1, fp) != 1;
+
+    // Padding tracks hold an identity transform, which interpolates cleanly
+    values.assign(KeyframeTracks::NUM_CHANNELS * header.stride, 0.0f);
+    for (uint32_t i = 0; i < header.stride; i++) {
+        values[KeyframeTracks::ROTATION_W * header.stride + i] = 1.0f;
+        for (int c = KeyframeTracks::SCALE_X; c <= KeyframeTracks::SCALE_Z; c++) {
+            values[c * header.stride + i] = 1.0f;
+        }
+    }
+    return !failed;
+}
+
+void KeyframeWriter::setValue(int track, const SbVec3f& translation, const SbRotation& rotation,
+                              const SbVec3f& scale)
+{
+    size_t stride = header.stride;
+    const float* q = rotation.getValue();
+    for (int i = 0; i < 3; i++) {
+        values[(KeyframeTracks::TRANSLATION_X + i) * stride + track] = translation[i];
+        values[(KeyframeTracks::SCALE_X + i) * stride + track] = scale[i];
+    }
+    for (int i = 0; i < 4; i++) {
+        values[(KeyframeTracks::ROTATION_X + i) * stride + track] = q[i];
+    }
+}
+
+bool KeyframeWriter::writeKey()
+{
+    if (!fp) {
+        return false;
+    }
+    size_t stride = header.stride;
+    if (!header.quantized) {
+        failed |= fwrite(&values[0], sizeof(float), values.size(), fp) != values.size();
+    } else {
+        std::vector<uint16_t> packed(values.size());
+        for (size_t i = 0; i < stride; i++) {
+            for (int c = 0; c < 3; c++) {
+                size_t t = (KeyframeTracks::TRANSLATION_X + c) * stride + i;
+                size_t s = (KeyframeTracks::SCALE_X + c) * stride + i;
+                packed[t] = quantizeUnsigned(values[t], header.translationMin[c],
+                                             header.translationRange[c]);
+                packed[s] = quantizeUnsigned(values[s], header.scaleMin[c], header.scaleRange[c]);
+            }
+            for (int c = 0; c < 4; c++) {
+                size_t r = (KeyframeTracks::ROTATION_X + c) * stride + i;
+                packed[r] = (uint16_t)quantizeSigned(values[r]);
+            }
+        }
+        failed |= fwrite(&packed[0], sizeof(uint16_t), packed.size(), fp) != packed.size();
+    }
+    header.numKeys++;
+    return !failed;
+}
+
+bool KeyframeWriter::close()
+{
+    if (!fp) {
+        return !failed;
+    }
+    // The key count is only known now
+    failed |= fseek(fp, 0, SEEK_SET) != 0;
+    failed |= fwrite(&header, sizeof(header), 1, fp) != 1;
+    failed |= fclose(fp) != 0;
+    fp = NULL;
+    return !failed;
+}
+
+KeyframeTracks::KeyframeTracks()
+    : header(NULL)
+{
+}
+
+KeyframeTracks::~KeyframeTracks()
+{
+    for (size_t i = 0; i < targets.size(); i++) {
+        targets[i]->unref();
+    }
+}
+
+bool KeyframeTracks::load(const char* filename)
+{
+    unload();
+    if (!file.open(filename)) {
+        return false;
+    }
+    const KeyframeFileHeader* h = (const KeyframeFileHeader*)file.getData();
+    size_t valueBytes = file.getSize() >= sizeof(*h) && h->quantized ? 2 : 4;
+    if (file.getSize() < sizeof(*h) || memcmp(h->magic, keyframeMagic, sizeof(h->magic)) != 0 ||
+        h->stride != ((h->numTracks + 3) & ~3u) || h->numKeys == 0 ||
+        file.getSize() != sizeof(*h) + (size_t)h->numKeys * NUM_CHANNELS * h->stride * valueBytes) {
+        file.close();
+        return false;
+    }
+    header = h;
+    results.assign(NUM_CHANNELS * header->stride, 0.0f);
+    return true;
+}
+
+void KeyframeTracks::unload()
+{
+    file.close();
+    header = NULL;
+    results.clear();
+}
+
+float KeyframeTracks::getDuration() const
+{
+    return header ? (header->numKeys - 1) * header->keyInterval : 0.0f;
+}
+
+size_t KeyframeTracks::getBytesPerKey() const
+{
+    return header ? NUM_CHANNELS * (header->quantized ? 2 : 4) : 0;
+}
+
+const void* KeyframeTracks::getBlock(int key) const
+{
+    size_t blockBytes = NUM_CHANNELS * header->stride * (header->quantized ? 2 : 4);
+    return (const char*)file.getData() + sizeof(*header) + key * blockBytes;
+}
+
+void KeyframeTracks::bind(int track, SoTransform* target)
+{
+    target->ref();
+    boundTracks.push_back(track);
+    targets.push_back(target);
+}
+
+void KeyframeTracks::evaluate(double seconds)
+{
+    if (!header) {
+        return;
+    }
+
+    // The same keys and fraction for all tracks
+    double position = (seconds - header->startTime) / header->keyInterval;
+    int last = (int)header->numKeys - 1;
+    position = position < 0.0 ? 0.0 : (position > last ? last : position);
+    int key = (int)position < last ? (int)position : (last > 0 ? last - 1 : 0);
+    int next = key < last ? key + 1 : key;
+    const float fraction = (float)(position - key);
+
+    // Dequantization, folded into the interpolation result
+    float scale[NUM_CHANNELS], offset[NUM_CHANNELS];
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        scale[c] = 1.0f;
+        offset[c] = 0.0f;
+    }
+    if (header->quantized) {
+        for (int i = 0; i < 3; i++) {
+            scale[TRANSLATION_X + i] = header->translationRange[i] / 65535.0f;
+            offset[TRANSLATION_X + i] = header->translationMin[i];
+            scale[SCALE_X + i] = header->scaleRange[i] / 65535.0f;
+            offset[SCALE_X + i] = header->scaleMin[i];
+        }
+        for (int i = 0; i < 4; i++) {
+            scale[ROTATION_X + i] = 1.0f / 32767.0f;
+        }
+    }
+
+    const char* a = (const char*)getBlock(key);
+    const char* b = (const char*)getBlock(next);
+    size_t stride = header->stride;
+    bool quantized = header->quantized != 0;
+    const Float4 t(fraction), half(0.5f);
+
+    for (size_t i = 0; i < stride; i += 4) {
+        Float4 values[2][NUM_CHANNELS];
+        for (int c = 0; c < NUM_CHANNELS; c++) {
+            size_t index = c * stride + i;
+            if (!quantized) {
+                values[0][c] = Float4::load((const float*)a + index);
+                values[1][c] = Float4::load((const float*)b + index);
+            } else if (c >= ROTATION_X && c <= ROTATION_W) {
+                values[0][c] = Float4::loadInt16((const int16_t*)a + index);
+                values[1][c] = Float4::loadInt16((const int16_t*)b + index);
+            } else {
+                values[0][c] = Float4::loadUint16((const uint16_t*)a + index);
+                values[1][c] = Float4::loadUint16((const uint16_t*)b + index);
+            }
+        }
+
+        // Translation and scale: lerp, then dequantize
+        for (int c = 0; c < NUM_CHANNELS; c++) {
+            if (c >= ROTATION_X && c <= ROTATION_W) {
+                continue;
+            }
+            Float4 v = values[0][c] + (values[1][c] - values[0][c]) * t;
+            (Float4(offset[c]) + v * Float4(scale[c])).store(&results[c * stride + i]);
+        }
+
+        // Rotation: slerp approximated by a normalized lerp with a corrected
+        // fraction (Zeux Kapoulkine's onlerp), within ~0.1 degree of the
+        // exact slerp even between keys 180 degrees apart
+        Float4 q0[4], q1[4];
+        Float4 dot(0.0f);
+        for (int k = 0; k < 4; k++) {
+            q0[k] = values[0][ROTATION_X + k] * Float4(scale[ROTATION_X + k]);
+            q1[k] = values[1][ROTATION_X + k] * Float4(scale[ROTATION_X + k]);
+            dot = dot + q0[k] * q1[k];
+        }
+        // Take the short way around
+        Float4 sign = sign4(dot);
+        Float4 d = dot * sign;
+        Float4 A = Float4(1.0904f) +
+                   d * (Float4(-3.2452f) + d * (Float4(3.55645f) - d * Float4(1.43519f)));
+        Float4 B = Float4(0.848013f) + d * (Float4(-1.06021f) + d * Float4(0.215638f));
+        Float4 k = A * (t - half) * (t - half) + B;
+        Float4 ot = t + t * (t - half) * (t - Float4(1.0f)) * k;
+        Float4 q[4];
+        Float4 length2(0.0f);
+        for (int c = 0; c < 4; c++) {
+            q[c] = q0[c] + (q1[c] * sign - q0[c]) * ot;
+            length2 = length2 + q[c] * q[c];
+        }
+        Float4 inverseLength = Float4(1.0f) / sqrt4(length2);
+        for (int c = 0; c < 4; c++) {
+            (q[c] * inverseLength).store(&results[(ROTATION_X + c) * stride + i]);
+        }
+    }
+}
+
+void KeyframeTracks::tick(double seconds)
+{
+    evaluate(seconds);
+    if (!header) {
+        return;
+    }
+    NotificationBatch batch;
+    SbVec3f translation, scale;
+    SbRotation rotation;
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (boundTracks[i] < 0 || boundTracks[i] >= (int)header->numTracks) {
+            continue;
+        }
+        getValue(boundTracks[i], translation, rotation, scale);
+        batch.edit(targets[i]->translation).setValue(translation);
+        batch.edit(targets[i]->rotation).setValue(rotation);
+        batch.edit(targets[i]->scaleFactor).setValue(scale);
+    }
+}
+
+void KeyframeTracks::getValue(int track, SbVec3f& translation, SbRotation& rotation,
+                              SbVec3f& scale) const
+{
+    size_t stride = header->stride;
+    const float* r = &results[0];
+    translation.setValue(r[TRANSLATION_X * stride + track], r[TRANSLATION_Y * stride + track],
+                         r[TRANSLATION_Z * stride + track]);
+    rotation.setValue(r[ROTATION_X * stride + track], r[ROTATION_Y * stride + track],
+                      r[ROTATION_Z * stride + track], r[ROTATION_W * stride + track]);
+    scale.setValue(r[SCALE_X * stride + track], r[SCALE_Y * stride + track],
+                   r[SCALE_Z * stride + track]);
+}
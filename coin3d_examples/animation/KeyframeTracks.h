@@ -0,0 +1,131 @@
+/*
+ * KeyframeTracks
+ * Recorded translation/rotation/scale tracks in a compact binary file,
+ * memory-mapped for playback and interpolated with SIMD
+ *
+ * All tracks of a file share uniformly spaced key times, as sampled from a
+ * simulation, so one time gives the same pair of keys and the same
+ * fraction for every track. The file is a header followed by one block per
+ * key; a block holds ten arrays over all tracks (translation x, y, z,
+ * rotation quaternion x, y, z, w, scale x, y, z), each padded to a multiple
+ * of four tracks. Values are float, or quantized to 16 bits: translation
+ * and scale relative to bounds stored in the header, rotation as signed
+ * quaternion components. Playback reads two consecutive blocks
+ * front to back straight from the mapping, lerps translation and scale
+ * and slerps rotation four tracks at a time.
+ *
+ * KeyframeWriter produces the file one key at a time, so recordings never
+ * have to fit in memory.
+ */
+
+#ifndef COIN3D_EXAMPLES_KEYFRAME_TRACKS_H
+#define COIN3D_EXAMPLES_KEYFRAME_TRACKS_H
+
+#include <Inventor/SbLinear.h>
+
+#include <cstdio>
+#include <stdint.h>
+#include <vector>
+
+#include "MappedFile.h"
+
+class SoTransform;
+
+// On-disk header, followed by the key blocks
+struct KeyframeFileHeader
+{
+    char magic[8];           // "COINKEYS"
+    uint32_t numTracks;
+    uint32_t numKeys;
+    uint32_t stride;         // numTracks rounded up to a multiple of four
+    uint32_t quantized;      // 0: float values, 1: 16 bit values
+    float startTime;         // time of key 0
+    float keyInterval;       // time between keys
+    float translationMin[3]; // quantization bounds
+    float translationRange[3];
+    float scaleMin[3];
+    float scaleRange[3];
+};
+
+class KeyframeWriter
+{
+public:
+    KeyframeWriter();
+    // Closes
+    ~KeyframeWriter();
+
+    // Quantized values are clamped to the bounds
+    bool open(const char* filename, int numTracks, float startTime, float keyInterval,
+              bool quantize, const SbBox3f& translationBounds = SbBox3f(),
+              const SbBox3f& scaleBounds = SbBox3f());
+    // Values of track at the next key
+    void setValue(int track, const SbVec3f& translation, const SbRotation& rotation,
+                  const SbVec3f& scale);
+    // Append the next key made of the values set since the last one
+    bool writeKey();
+    // Finish the header; false if any write failed
+    bool close();
+
+private:
+    FILE* fp;
+    KeyframeFileHeader header;
+    std::vector<float> values; // ten arrays of stride floats
+    bool failed;
+
+    KeyframeWriter(const KeyframeWriter&);
+    KeyframeWriter& operator=(const KeyframeWriter&);
+};
+
+class KeyframeTracks
+{
+public:
+    KeyframeTracks();
+    ~KeyframeTracks();
+
+    // Map a file written by KeyframeWriter
+    bool load(const char* filename);
+    void unload();
+
+    int getNumTracks() const { return header ? (int)header->numTracks : 0; }
+    int getNumKeys() const { return header ? (int)header->numKeys : 0; }
+    bool isQuantized() const { return header && header->quantized; }
+    float getDuration() const;
+    // Storage of one key of one track
+    size_t getBytesPerKey() const;
+    size_t getFileBytes() const { return file.getSize(); }
+
+    // Write track into target on every tick
+    void bind(int track, SoTransform* target);
+
+    // Interpolate all tracks at seconds, clamped to the recorded range
+    void evaluate(double seconds);
+    // Evaluate and write the bound targets in one NotificationBatch
+    void tick(double seconds);
+
+    // Results of the last evaluate()
+    void getValue(int track, SbVec3f& translation, SbRotation& rotation, SbVec3f& scale) const;
+
+private:
+    enum Channel
+    {
+        TRANSLATION_X, TRANSLATION_Y, TRANSLATION_Z,
+        ROTATION_X, ROTATION_Y, ROTATION_Z, ROTATION_W,
+        SCALE_X, SCALE_Y, SCALE_Z,
+        NUM_CHANNELS
+    };
+
+    friend class KeyframeWriter;
+
+    const void* getBlock(int key) const;
+
+    MappedFile file;
+    const KeyframeFileHeader* header;
+    std::vector<float> results; // ten arrays of stride floats
+    std::vector<int> boundTracks;
+    std::vector<SoTransform*> targets;
+
+    KeyframeTracks(const KeyframeTracks&);
+    KeyframeTracks& operator=(const KeyframeTracks&);
+};
+
+#endif // COIN3D_EXAMPLES_KEYFRAME_TRACKS_H
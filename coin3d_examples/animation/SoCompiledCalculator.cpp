@@ -0,0 +1,928 @@
+/*
+ * SoCompiledCalculator
+ * Expression compiler and evaluator
+ */
+
+#include "SoCompiledCalculator.h"
+
+#include <Inventor/errors/SoDebugError.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Register file layout; vectors take three consecutive floats
+enum
+{
+    INPUT_FLOATS = 0,    // a-h
+    INPUT_VECTORS = 8,   // A-H
+    TEMP_FLOATS = 32,    // ta-th
+    TEMP_VECTORS = 40,   // tA-tH
+    OUTPUT_FLOATS = 64,  // oa-od
+    OUTPUT_VECTORS = 68, // oA-oD
+    FIRST_FREE = 80      // constants and intermediate results
+};
+
+struct CalcOp;
+typedef void (*CalcFunc)(float* r, const CalcOp& op);
+
+struct CalcOp
+{
+    CalcFunc func;
+    int dst, a, b, c;
+    float (*math1)(float);
+    float (*math2)(float, float);
+};
+
+struct SoCompiledCalculator::Program
+{
+    std::vector<CalcOp> ops;
+    std::vector<float> registers; // constants preloaded
+    bool assigned[8];             // oa-od, oA-oD
+};
+
+// Operations
+
+static void opCopy(float* r, const CalcOp& op) { r[op.dst] = r[op.a]; }
+static void opAdd(float* r, const CalcOp& op) { r[op.dst] = r[op.a] + r[op.b]; }
+static void opSub(float* r, const CalcOp& op) { r[op.dst] = r[op.a] - r[op.b]; }
+static void opMul(float* r, const CalcOp& op) { r[op.dst] = r[op.a] * r[op.b]; }
+static void opDiv(float* r, const CalcOp& op) { r[op.dst] = r[op.a] / r[op.b]; }
+static void opMod(float* r, const CalcOp& op) { r[op.dst] = fmodf(r[op.a], r[op.b]); }
+static void opNeg(float* r, const CalcOp& op) { r[op.dst] = -r[op.a]; }
+static void opNot(float* r, const CalcOp& op) { r[op.dst] = r[op.a] == 0.0f ? 1.0f : 0.0f; }
+static void opAnd(float* r, const CalcOp& op) { r[op.dst] = (r[op.a] != 0.0f && r[op.b] != 0.0f) ? 1.0f : 0.0f; }
+static void opOr(float* r, const CalcOp& op) { r[op.dst] = (r[op.a] != 0.0f || r[op.b] != 0.0f) ? 1.0f : 0.0f; }
+static void opLess(float* r, const CalcOp& op) { r[op.dst] = r[op.a] < r[op.b] ? 1.0f : 0.0f; }
+static void opGreater(float* r, const CalcOp& op) { r[op.dst] = r[op.a] > r[op.b] ? 1.0f : 0.0f; }
+static void opLessEqual(float* r, const CalcOp& op) { r[op.dst] = r[op.a] <= r[op.b] ? 1.0f : 0.0f; }
+static void opGreaterEqual(float* r, const CalcOp& op) { r[op.dst] = r[op.a] >= r[op.b] ? 1.0f : 0.0f; }
+static void opEqual(float* r, const CalcOp& op) { r[op.dst] = r[op.a] == r[op.b] ? 1.0f : 0.0f; }
+static void opNotEqual(float* r, const CalcOp& op) { r[op.dst] = r[op.a] != r[op.b] ? 1.0f : 0.0f; }
+static void opSelect(float* r, const CalcOp& op) { r[op.dst] = r[op.a] != 0.0f ? r[op.b] : r[op.c]; }
+static void opMath1(float* r, const CalcOp& op) { r[op.dst] = op.math1(r[op.a]); }
+static void opMath2(float* r, const CalcOp& op) { r[op.dst] = op.math2(r[op.a], r[op.b]); }
+
+static void opCopy3(float* r, const CalcOp& op)
+{
+    r[op.dst] = r[op.a];
+    r[op.dst + 1] = r[op.a + 1];
+    r[op.dst + 2] = r[op.a + 2];
+}
+
+static void opBroadcast3(float* r, const CalcOp& op)
+{
+    r[op.dst] = r[op.dst + 1] = r[op.dst + 2] = r[op.a];
+}
+
+static void opMake3(float* r, const CalcOp& op)
+{
+    r[op.dst] = r[op.a];
+    r[op.dst + 1] = r[op.b];
+    r[op.dst + 2] = r[op.c];
+}
+
+static void opAdd3(float* r, const CalcOp& op)
+{
+    for (int i = 0; i < 3; i++) r[op.dst + i] = r[op.a + i] + r[op.b + i];
+}
+
+static void opSub3(float* r, const CalcOp& op)
+{
+    for (int i = 0; i < 3; i++) r[op.dst + i] = r[op.a + i] - r[op.b + i];
+}
+
+static void opScale3(float* r, const CalcOp& op)
+{
+    for (int i = 0; i < 3; i++) r[op.dst + i] = r[op.a + i] * r[op.b];
+}
+
+static void opDivide3(float* r, const CalcOp& op)
+{
+    for (int i = 0; i < 3; i++) r[op.dst + i] = r[op.a + i] / r[op.b];
+}
+
+static void opNeg3(float* r, const CalcOp& op)
+{
+    for (int i = 0; i < 3; i++) r[op.dst + i] = -r[op.a + i];
+}
+
+static void opSelect3(float* r, const CalcOp& op)
+{
+    int source = r[op.a] != 0.0f ? op.b : op.c;
+    for (int i = 0; i < 3; i++) r[op.dst + i] = r[source + i];
+}
+
+static void opDot(float* r, const CalcOp& op)
+{
+    r[op.dst] = r[op.a] * r[op.b] + r[op.a + 1] * r[op.b + 1] + r[op.a + 2] * r[op.b + 2];
+}
+
+static void opCross(float* r, const CalcOp& op)
+{
+    float x = r[op.a + 1] * r[op.b + 2] - r[op.a + 2] * r[op.b + 1];
+    float y = r[op.a + 2] * r[op.b] - r[op.a] * r[op.b + 2];
+    float z = r[op.a] * r[op.b + 1] - r[op.a + 1] * r[op.b];
+    r[op.dst] = x;
+    r[op.dst + 1] = y;
+    r[op.dst + 2] = z;
+}
+
+static void opLength(float* r, const CalcOp& op)
+{
+    r[op.dst] = sqrtf(r[op.a] * r[op.a] + r[op.a + 1] * r[op.a + 1] + r[op.a + 2] * r[op.a + 2]);
+}
+
+static void opNormalize(float* r, const CalcOp& op)
+{
+    float length = sqrtf(r[op.a] * r[op.a] + r[op.a + 1] * r[op.a + 1] + r[op.a + 2] * r[op.a + 2]);
+    float scale = length > 0.0f ? 1.0f / length : 0.0f;
+    for (int i = 0; i < 3; i++) r[op.dst + i] = r[op.a + i] * scale;
+}
+
+static void opIndex(float* r, const CalcOp& op)
+{
+    int index = (int)r[op.b];
+    r[op.dst] = r[op.a + (index < 0 ? 0 : (index > 2 ? 2 : index))];
+}
+
+// Math functions
+
+static float mathCos(float x) { return cosf(x); }
+static float mathSin(float x) { return sinf(x); }
+static float mathTan(float x) { return tanf(x); }
+static float mathAcos(float x) { return acosf(x); }
+static float mathAsin(float x) { return asinf(x); }
+static float mathAtan(float x) { return atanf(x); }
+static float mathCosh(float x) { return coshf(x); }
+static float mathSinh(float x) { return sinhf(x); }
+static float mathTanh(float x) { return tanhf(x); }
+static float mathSqrt(float x) { return sqrtf(x); }
+static float mathExp(float x) { return expf(x); }
+static float mathLog(float x) { return logf(x); }
+static float mathLog10(float x) { return log10f(x); }
+static float mathCeil(float x) { return ceilf(x); }
+static float mathFloor(float x) { return floorf(x); }
+static float mathAbs(float x) { return fabsf(x); }
+static float mathRand(float x) { return x * (float)rand() / (float)RAND_MAX; }
+static float mathAtan2(float y, float x) { return atan2f(y, x); }
+static float mathPow(float x, float y) { return powf(x, y); }
+static float mathFmod(float x, float y) { return fmodf(x, y); }
+
+struct MathFunction1
+{
+    const char* name;
+    float (*func)(float);
+};
+
+static const MathFunction1 mathFunctions1[] = {
+    { "cos", mathCos }, { "sin", mathSin }, { "tan", mathTan }, { "acos", mathAcos },
+    { "asin", mathAsin }, { "atan", mathAtan }, { "cosh", mathCosh }, { "sinh", mathSinh },
+    { "tanh", mathTanh }, { "sqrt", mathSqrt }, { "exp", mathExp }, { "log", mathLog },
+    { "log10", mathLog10 }, { "ceil", mathCeil }, { "floor", mathFloor }, { "fabs", mathAbs },
+    { "abs", mathAbs }, { "rand", mathRand }
+};
+
+struct MathFunction2
+{
+    const char* name;
+    float (*func)(float, float);
+};
+
+static const MathFunction2 mathFunctions2[] = {
+    { "atan2", mathAtan2 }, { "pow", mathPow }, { "fmod", mathFmod }
+};
+
+struct NamedConstant
+{
+    const char* name;
+    double value;
+};
+
+static const NamedConstant namedConstants[] = {
+    { "MAXFLOAT", FLT_MAX }, { "MINFLOAT", FLT_MIN },
+    { "M_E", 2.71828182845904523536 }, { "M_LOG2E", 1.44269504088896340736 },
+    { "M_LOG10E", 0.434294481903251827651 }, { "M_LN2", 0.693147180559945309417 },
+    { "M_LN10", 2.30258509299404568402 }, { "M_PI", 3.14159265358979323846 },
+    { "M_PI_2", 1.57079632679489661923 }, { "M_PI_4", 0.785398163397448309616 },
+    { "M_1_PI", 0.318309886183790671538 }, { "M_2_PI", 0.636619772367581343076 },
+    { "M_2_SQRTPI", 1.12837916709551257390 }, { "M_SQRT2", 1.41421356237309504880 },
+    { "M_SQRT1_2", 0.707106781186547524401 }
+};
+
+// Recursive descent compiler from expression text to CalcOps
+
+struct CalcValue
+{
+    int reg;
+    bool vector;
+};
+
+class ExpressionCompiler
+{
+public:
+    explicit ExpressionCompiler(const char* text)
+        : registers(FIRST_FREE, 0.0f), start(text), p(text)
+    {
+        for (int i = 0; i < 8; i++) {
+            assigned[i] = false;
+        }
+    }
+
+    bool compile()
+    {
+        for (;;) {
+            skipSpace();
+            if (*p == '\0') {
+                return true;
+            }
+            if (*p == ';') {
+                p++;
+                continue;
+            }
+            if (!parseStatement()) {
+                return false;
+            }
+            skipSpace();
+            if (*p != ';' && *p != '\0') {
+                return fail("expected ';'");
+            }
+        }
+    }
+
+    const std::string& getError() const { return error; }
+
+    std::vector<CalcOp> ops;
+    std::vector<float> registers;
+    bool assigned[8];
+
+private:
+    const char* start;
+    const char* p;
+    std::string error;
+
+    bool fail(const char* message)
+    {
+        char position[32];
+        snprintf(position, sizeof(position), " at column %d", (int)(p - start) + 1);
+        error = std::string(message) + position;
+        return false;
+    }
+
+    void skipSpace()
+    {
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+    }
+
+    // Consume token if it is next, but not as the prefix of a longer
+    // operator ("=" does not match "==")
+    bool accept(const char* token)
+    {
+        skipSpace();
+        size_t length = strlen(token);
+        if (strncmp(p, token, length) != 0) {
+            return false;
+        }
+        if (length == 1 && strchr("=<>!", token[0]) && p[1] == '=') {
+            return false;
+        }
+        p += length;
+        return true;
+    }
+
+    bool parseIdentifier(std::string& name)
+    {
+        skipSpace();
+        if (!isalpha((unsigned char)*p) && *p != '_') {
+            return false;
+        }
+        const char* begin = p;
+        while (isalnum((unsigned char)*p) || *p == '_') {
+            p++;
+        }
+        name.assign(begin, p);
+        return true;
+    }
+
+    int newRegister(int size)
+    {
+        int reg = (int)registers.size();
+        registers.resize(registers.size() + size, 0.0f);
+        return reg;
+    }
+
+    CalcValue constant(float value)
+    {
+        CalcValue result = { newRegister(1), false };
+        registers[result.reg] = value;
+        return result;
+    }
+
+    void emit(CalcFunc func, int dst, int a, int b = 0, int c = 0)
+    {
+        CalcOp op = { func, dst, a, b, c, NULL, NULL };
+        ops.push_back(op);
+    }
+
+    CalcValue emitResult(CalcFunc func, bool vector, int a, int b = 0, int c = 0)
+    {
+        CalcValue result = { newRegister(vector ? 3 : 1), vector };
+        emit(func, result.reg, a, b, c);
+        return result;
+    }
+
+    // Variables: inputs, temporaries and outputs; outputIndex is set for outputs
+    bool lookupVariable(const std::string& name, CalcValue& value, bool& writable, int& outputIndex)
+    {
+        outputIndex = -1;
+        writable = false;
+        if (name.size() == 1) {
+            char ch = name[0];
+            if (ch >= 'a' && ch <= 'h') {
+                value.reg = INPUT_FLOATS + (ch - 'a');
+                value.vector = false;
+                return true;
+            }
+            if (ch >= 'A' && ch <= 'H') {
+                value.reg = INPUT_VECTORS + 3 * (ch - 'A');
+                value.vector = true;
+                return true;
+            }
+            return false;
+        }
+        if (name.size() != 2) {
+            return false;
+        }
+        char kind = name[0], ch = name[1];
+        writable = true;
+        if (kind == 't' && ch >= 'a' && ch <= 'h') {
+            value.reg = TEMP_FLOATS + (ch - 'a');
+            value.vector = false;
+            return true;
+        }
+        if (kind == 't' && ch >= 'A' && ch <= 'H') {
+            value.reg = TEMP_VECTORS + 3 * (ch - 'A');
+            value.vector = true;
+            return true;
+        }
+        if (kind == 'o' && ch >= 'a' && ch <= 'd') {
+            value.reg = OUTPUT_FLOATS + (ch - 'a');
+            value.vector = false;
+            outputIndex = ch - 'a';
+            return true;
+        }
+        if (kind == 'o' && ch >= 'A' && ch <= 'D') {
+            value.reg = OUTPUT_VECTORS + 3 * (ch - 'A');
+            value.vector = true;
+            outputIndex = 4 + (ch - 'A');
+            return true;
+        }
+        writable = false;
+        return false;
+    }
+
+    bool parseStatement()
+    {
+        std::string name;
+        if (!parseIdentifier(name)) {
+            return fail("expected a variable");
+        }
+        CalcValue target;
+        bool writable;
+        int outputIndex;
+        if (!lookupVariable(name, target, writable, outputIndex) || !writable) {
+            return fail("cannot assign to this name");
+        }
+        if (accept("[")) {
+            skipSpace();
+            if (!target.vector || *p < '0' || *p > '2') {
+                return fail("expected vector component 0, 1 or 2");
+            }
+            target.reg += *p++ - '0';
+            target.vector = false;
+            if (!accept("]")) {
+                return fail("expected ']'");
+            }
+        }
+        if (!accept("=")) {
+            return fail("expected '='");
+        }
+        CalcValue value;
+        if (!parseExpression(value)) {
+            return false;
+        }
+        if (target.vector == value.vector) {
+            emit(value.vector ? opCopy3 : opCopy, target.reg, value.reg);
+        } else if (target.vector) {
+            emit(opBroadcast3, target.reg, value.reg);
+        } else {
+            return fail("cannot assign a vector to a float");
+        }
+        if (outputIndex >= 0) {
+            assigned[outputIndex] = true;
+        }
+        return true;
+    }
+
+    bool parseExpression(CalcValue& result)
+    {
+        CalcValue condition;
+        if (!parseOr(condition)) {
+            return false;
+        }
+        if (!accept("?")) {
+            result = condition;
+            return true;
+        }
+        CalcValue yes, no;
+        if (!parseExpression(yes)) {
+            return false;
+        }
+        if (!accept(":")) {
+            return fail("expected ':'");
+        }
+        if (!parseExpression(no)) {
+            return false;
+        }
+        if (condition.vector || yes.vector != no.vector) {
+            return fail("type mismatch in ?:");
+        }
+        result = emitResult(yes.vector ? opSelect3 : opSelect, yes.vector, condition.reg,
+                            yes.reg, no.reg);
+        return true;
+    }
+
+    // Float-only binary operators
+    bool floatBinary(CalcFunc func, const CalcValue& left, const CalcValue& right,
+                     CalcValue& result)
+    {
+        if (left.vector || right.vector) {
+            return fail("operator needs float operands");
+        }
+        result = emitResult(func, false, left.reg, right.reg);
+        return true;
+    }
+
+    bool parseOr(CalcValue& result)
+    {
+        if (!parseAnd(result)) {
+            return false;
+        }
+        while (accept("||")) {
+            CalcValue right;
+            if (!parseAnd(right) || !floatBinary(opOr, result, right, result)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseAnd(CalcValue& result)
+    {
+        if (!parseComparison(result)) {
+            return false;
+        }
+        while (accept("&&")) {
+            CalcValue right;
+            if (!parseComparison(right) || !floatBinary(opAnd, result, right, result)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseComparison(CalcValue& result)
+    {
+        if (!parseAdditive(result)) {
+            return false;
+        }
+        for (;;) {
+            CalcFunc func;
+            if (accept("==")) func = opEqual;
+            else if (accept("!=")) func = opNotEqual;
+            else if (accept("<=")) func = opLessEqual;
+            else if (accept(">=")) func = opGreaterEqual;
+            else if (accept("<")) func = opLess;
+            else if (accept(">")) func = opGreater;
+            else return true;
+            CalcValue right;
+            if (!parseAdditive(right) || !floatBinary(func, result, right, result)) {
+                return false;
+            }
+        }
+    }
+
+    bool parseAdditive(CalcValue& result)
+    {
+        if (!parseMultiplicative(result)) {
+            return false;
+        }
+        for (;;) {
+            bool add;
+            if (accept("+")) add = true;
+            else if (accept("-")) add = false;
+            else return true;
+            CalcValue right;
+            if (!parseMultiplicative(right)) {
+                return false;
+            }
+            if (result.vector != right.vector) {
+                return fail("cannot add a float and a vector");
+            }
+            result = result.vector
+                ? emitResult(add ? opAdd3 : opSub3, true, result.reg, right.reg)
+                : emitResult(add ? opAdd : opSub, false, result.reg, right.reg);
+        }
+    }
+
+    bool parseMultiplicative(CalcValue& result)
+    {
+        if (!parseUnary(result)) {
+            return false;
+        }
+        for (;;) {
+            char op;
+            if (accept("*")) op = '*';
+            else if (accept("/")) op = '/';
+            else if (accept("%")) op = '%';
+            else return true;
+            CalcValue right;
+            if (!parseUnary(right)) {
+                return false;
+            }
+            if (!result.vector && !right.vector) {
+                result = emitResult(op == '*' ? opMul : (op == '/' ? opDiv : opMod), false,
+                                    result.reg, right.reg);
+            } else if (op == '*' && result.vector != right.vector) {
+                const CalcValue& vector = result.vector ? result : right;
+                const CalcValue& scale = result.vector ? right : result;
+                result = emitResult(opScale3, true, vector.reg, scale.reg);
+            } else if (op == '/' && result.vector && !right.vector) {
+                result = emitResult(opDivide3, true, result.reg, right.reg);
+            } else {
+                return fail("unsupported vector operation");
+            }
+        }
+    }
+
+    bool parseUnary(CalcValue& result)
+    {
+        if (accept("-")) {
+            if (!parseUnary(result)) {
+                return false;
+            }
+            result = emitResult(result.vector ? opNeg3 : opNeg, result.vector, result.reg);
+            return true;
+        }
+        if (accept("+")) {
+            return parseUnary(result);
+        }
+        if (accept("!")) {
+            if (!parseUnary(result)) {
+                return false;
+            }
+            if (result.vector) {
+                return fail("'!' needs a float operand");
+            }
+            result = emitResult(opNot, false, result.reg);
+            return true;
+        }
+        return parsePostfix(result);
+    }
+
+    bool parsePostfix(CalcValue& result)
+    {
+        if (!parsePrimary(result)) {
+            return false;
+        }
+        while (accept("[")) {
+            CalcValue index;
+            if (!parseExpression(index)) {
+                return false;
+            }
+            if (!accept("]")) {
+                return fail("expected ']'");
+            }
+            if (!result.vector || index.vector) {
+                return fail("only vectors can be indexed, by a float");
+            }
+            result = emitResult(opIndex, false, result.reg, index.reg);
+        }
+        return true;
+    }
+
+    bool parseArguments(std::vector<CalcValue>& arguments)
+    {
+        if (accept(")")) {
+            return true;
+        }
+        do {
+            CalcValue argument;
+            if (!parseExpression(argument)) {
+                return false;
+            }
+            arguments.push_back(argument);
+        } while (accept(","));
+        if (!accept(")")) {
+            return fail("expected ')'");
+        }
+        return true;
+    }
+
+    bool parseCall(const std::string& name, CalcValue& result)
+    {
+        std::vector<CalcValue> args;
+        if (!parseArguments(args)) {
+            return false;
+        }
+        size_t numArgs = args.size();
+        bool vectorArgs = true, floatArgs = true;
+        for (size_t i = 0; i < numArgs; i++) {
+            vectorArgs = vectorArgs && args[i].vector;
+            floatArgs = floatArgs && !args[i].vector;
+        }
+
+        for (size_t i = 0; i < sizeof(mathFunctions1) / sizeof(mathFunctions1[0]); i++) {
+            if (name == mathFunctions1[i].name) {
+                if (numArgs != 1 || !floatArgs) {
+                    return fail("function needs one float argument");
+                }
+                result = emitResult(opMath1, false, args[0].reg);
+                ops.back().math1 = mathFunctions1[i].func;
+                return true;
+            }
+        }
+        for (size_t i = 0; i < sizeof(mathFunctions2) / sizeof(mathFunctions2[0]); i++) {
+            if (name == mathFunctions2[i].name) {
+                if (numArgs != 2 || !floatArgs) {
+                    return fail("function needs two float arguments");
+                }
+                result = emitResult(opMath2, false, args[0].reg, args[1].reg);
+                ops.back().math2 = mathFunctions2[i].func;
+                return true;
+            }
+        }
+        if (name == "vec3f") {
+            if (numArgs != 3 || !floatArgs) {
+                return fail("vec3f needs three float arguments");
+            }
+            result = emitResult(opMake3, true, args[0].reg, args[1].reg, args[2].reg);
+            return true;
+        }
+        if (name == "dot" || name == "cross") {
+            if (numArgs != 2 || !vectorArgs) {
+                return fail("function needs two vector arguments");
+            }
+            result = name == "dot" ? emitResult(opDot, false, args[0].reg, args[1].reg)
+                                   : emitResult(opCross, true, args[0].reg, args[1].reg);
+            return true;
+        }
+        if (name == "length" || name == "normalize") {
+            if (numArgs != 1 || !vectorArgs) {
+                return fail("function needs one vector argument");
+            }
+            result = name == "length" ? emitResult(opLength, false, args[0].reg)
+                                      : emitResult(opNormalize, true, args[0].reg);
+            return true;
+        }
+        return fail("unknown function");
+    }
+
+    bool parsePrimary(CalcValue& result)
+    {
+        skipSpace();
+        if (accept("(")) {
+            if (!parseExpression(result)) {
+                return false;
+            }
+            return accept(")") || fail("expected ')'");
+        }
+        if (isdigit((unsigned char)*p) || (*p == '.' && isdigit((unsigned char)p[1]))) {
+            char* end;
+            double value = strtod(p, &end);
+            p = end;
+            result = constant((float)value);
+            return true;
+        }
+
+        std::string name;
+        if (!parseIdentifier(name)) {
+            return fail("expected an expression");
+        }
+        if (accept("(")) {
+            return parseCall(name, result);
+        }
+        bool writable;
+        int outputIndex;
+        if (lookupVariable(name, result, writable, outputIndex)) {
+            return true;
+        }
+        for (size_t i = 0; i < sizeof(namedConstants) / sizeof(namedConstants[0]); i++) {
+            if (name == namedConstants[i].name) {
+                result = constant((float)namedConstants[i].value);
+                return true;
+            }
+        }
+        return fail("unknown name");
+    }
+};
+
+SO_ENGINE_SOURCE(SoCompiledCalculator);
+
+void SoCompiledCalculator::initClass()
+{
+    SO_ENGINE_INIT_CLASS(SoCompiledCalculator, SoEngine, "Engine");
+}
+
+SoCompiledCalculator::SoCompiledCalculator()
+    : program(NULL), needsCompile(TRUE)
+{
+    SO_ENGINE_CONSTRUCTOR(SoCompiledCalculator);
+
+    SO_ENGINE_ADD_INPUT(a, (0.0f));
+    SO_ENGINE_ADD_INPUT(b, (0.0f));
+    SO_ENGINE_ADD_INPUT(c, (0.0f));
+    SO_ENGINE_ADD_INPUT(d, (0.0f));
+    SO_ENGINE_ADD_INPUT(e, (0.0f));
+    SO_ENGINE_ADD_INPUT(f, (0.0f));
+    SO_ENGINE_ADD_INPUT(g, (0.0f));
+    SO_ENGINE_ADD_INPUT(h, (0.0f));
+    SO_ENGINE_ADD_INPUT(A, (0.0f, 0.0f, 0.0f));
+    SO_ENGINE_ADD_INPUT(B, (0.0f, 0.0f, 0.0f));
+    SO_ENGINE_ADD_INPUT(C, (0.0f, 0.0f, 0.0f));
+    SO_ENGINE_ADD_INPUT(D, (0.0f, 0.0f, 0.0f));
+    SO_ENGINE_ADD_INPUT(E, (0.0f, 0.0f, 0.0f));
+    SO_ENGINE_ADD_INPUT(F, (0.0f, 0.0f, 0.0f));
+    SO_ENGINE_ADD_INPUT(G, (0.0f, 0.0f, 0.0f));
+    SO_ENGINE_ADD_INPUT(H, (0.0f, 0.0f, 0.0f));
+    SO_ENGINE_ADD_INPUT(expression, (""));
+
+    SO_ENGINE_ADD_OUTPUT(oa, SoMFFloat);
+    SO_ENGINE_ADD_OUTPUT(ob, SoMFFloat);
+    SO_ENGINE_ADD_OUTPUT(oc, SoMFFloat);
+    SO_ENGINE_ADD_OUTPUT(od, SoMFFloat);
+    SO_ENGINE_ADD_OUTPUT(oA, SoMFVec3f);
+    SO_ENGINE_ADD_OUTPUT(oB, SoMFVec3f);
+    SO_ENGINE_ADD_OUTPUT(oC, SoMFVec3f);
+    SO_ENGINE_ADD_OUTPUT(oD, SoMFVec3f);
+}
+
+SoCompiledCalculator::~SoCompiledCalculator()
+{
+    delete program;
+}
+
+void SoCompiledCalculator::inputChanged(SoField* which)
+{
+    if (which == &expression) {
+        needsCompile = TRUE;
+    }
+}
+
+SbBool SoCompiledCalculator::isValid()
+{
+    if (needsCompile) {
+        compile();
+    }
+    return program != NULL;
+}
+
+void SoCompiledCalculator::compile()
+{
+    needsCompile = FALSE;
+    delete program;
+    program = NULL;
+    error.makeEmpty();
+
+    std::string text;
+    for (int i = 0; i < expression.getNum(); i++) {
+        text += expression[i].getString();
+        text += ";";
+    }
+
+    ExpressionCompiler compiler(text.c_str());
+    if (compiler.compile()) {
+        program = new Program;
+        program->ops.swap(compiler.ops);
+        program->registers.swap(compiler.registers);
+        for (int i = 0; i < 8; i++) {
+            program->assigned[i] = compiler.assigned[i];
+        }
+    } else {
+        error = compiler.getError().c_str();
+        SoDebugError::postWarning("SoCompiledCalculator::compile", "%s", error.getString());
+    }
+
+    // Outputs the expression never assigns must not overwrite their fields
+    SoEngineOutput* outputs[8] = { &oa, &ob, &oc, &od, &oA, &oB, &oC, &oD };
+    for (int i = 0; i < 8; i++) {
+        outputs[i]->enable(program && program->assigned[i]);
+    }
+}
+
+void SoCompiledCalculator::evaluate()
+{
+    if (needsCompile) {
+        compile();
+    }
+    if (!program) {
+        return;
+    }
+
+    // As with SoCalculator, shorter inputs repeat their last value
+    const SoMFFloat* floatInputs[8] = { &a, &b, &c, &d, &e, &f, &g, &h };
+    const SoMFVec3f* vectorInputs[8] = { &A, &B, &C, &D, &E, &F, &G, &H };
+    const float* floatValues[8];
+    const SbVec3f* vectorValues[8];
+    int floatNums[8], vectorNums[8];
+    int count = 1;
+    for (int i = 0; i < 8; i++) {
+        floatNums[i] = floatInputs[i]->getNum();
+        floatValues[i] = floatInputs[i]->getValues(0);
+        vectorNums[i] = vectorInputs[i]->getNum();
+        vectorValues[i] = vectorInputs[i]->getValues(0);
+        count = std::max(count, std::max(floatNums[i], vectorNums[i]));
+    }
+
+    std::vector<float> floatResults[4];
+    std::vector<SbVec3f> vectorResults[4];
+    for (int i = 0; i < 4; i++) {
+        if (program->assigned[i]) {
+            floatResults[i].resize(count);
+        }
+        if (program->assigned[4 + i]) {
+            vectorResults[i].resize(count);
+        }
+    }
+
+    float* r = &program->registers[0];
+    const CalcOp* ops = program->ops.empty() ? NULL : &program->ops[0];
+    size_t numOps = program->ops.size();
+    for (int index = 0; index < count; index++) {
+        for (int i = 0; i < 8; i++) {
+            r[INPUT_FLOATS + i] =
+                floatNums[i] ? floatValues[i][std::min(index, floatNums[i] - 1)] : 0.0f;
+            const float* v = vectorNums[i]
+                ? vectorValues[i][std::min(index, vectorNums[i] - 1)].getValue() : NULL;
+            for (int k = 0; k < 3; k++) {
+                r[INPUT_VECTORS + 3 * i + k] = v ? v[k] : 0.0f;
+            }
+        }
+        std::fill(r + TEMP_FLOATS, r + FIRST_FREE, 0.0f);
+
+        for (size_t i = 0; i < numOps; i++) {
+            ops[i].func(r, ops[i]);
+        }
+
+        for (int i = 0; i < 4; i++) {
+            if (program->assigned[i]) {
+                floatResults[i][index] = r[OUTPUT_FLOATS + i];
+            }
+            if (program->assigned[4 + i]) {
+                const float* v = r + OUTPUT_VECTORS + 3 * i;
+                vectorResults[i][index].setValue(v[0], v[1], v[2]);
+            }
+        }
+    }
+
+    if (program->assigned[0]) {
+        SO_ENGINE_OUTPUT(oa, SoMFFloat, setNum(count));
+        SO_ENGINE_OUTPUT(oa, SoMFFloat, setValues(0, count, &floatResults[0][0]));
+    }
+    if (program->assigned[1]) {
+        SO_ENGINE_OUTPUT(ob, SoMFFloat, setNum(count));
+        SO_ENGINE_OUTPUT(ob, SoMFFloat, setValues(0, count, &floatResults[1][0]));
+    }
+    if (program->assigned[2]) {
+        SO_ENGINE_OUTPUT(oc, SoMFFloat, setNum(count));
+        SO_ENGINE_OUTPUT(oc, SoMFFloat, setValues(0, count, &floatResults[2][0]));
+    }
+    if (program->assigned[3]) {
+        SO_ENGINE_OUTPUT(od, SoMFFloat, setNum(count));
+        SO_ENGINE_OUTPUT(od, SoMFFloat, setValues(0, count, &floatResults[3][0]));
+    }
+    if (program->assigned[4]) {
+        SO_ENGINE_OUTPUT(oA, SoMFVec3f, setNum(count));
+        SO_ENGINE_OUTPUT(oA, SoMFVec3f, setValues(0, count, &vectorResults[0][0]));
+    }
+    if (program->assigned[5]) {
+        SO_ENGINE_OUTPUT(oB, SoMFVec3f, setNum(count));
+        SO_ENGINE_OUTPUT(oB, SoMFVec3f, setValues(0, count, &vectorResults[1][0]));
+    }
+    if (program->assigned[6]) {
+        SO_ENGINE_OUTPUT(oC, SoMFVec3f, setNum(count));
+        SO_ENGINE_OUTPUT(oC, SoMFVec3f, setValues(0, count, &vectorResults[2][0]));
+    }
+    if (program->assigned[7]) {
+        SO_ENGINE_OUTPUT(oD, SoMFVec3f, setNum(count));
+        SO_ENGINE_OUTPUT(oD, SoMFVec3f, setValues(0, count, &vectorResults[3][0]));
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * SoCompiledCalculator
+ * Drop-in SoCalculator replacement that compiles its expression once
+ *
+ * Has the same inputs, outputs and expression language as SoCalculator.
+ * The expression is parsed, name-resolved and type-checked only when the
+ * expression field changes, into straight-line code: a flat list of
+ * operations, each a function pointer working on fixed slots of a float
+ * register file. Evaluating then runs these operations for every value
+ * index without any parsing, lookups or type dispatch.
+ *
+ * Supported: a-h, A-H inputs, ta-th, tA-tH temporaries, oa-od, oA-oD
+ * outputs; + - * / % and comparison, logical and ?: operators; v[i]
+ * indexing; cos sin tan acos asin atan atan2 cosh sinh tanh sqrt pow exp
+ * log log10 ceil floor fabs abs fmod rand, vec3f dot cross length
+ * normalize; M_PI and the other math.h constants. A float assigned to a
+ * vector output is replicated into all three components.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_COMPILED_CALCULATOR_H
+#define COIN3D_EXAMPLES_SO_COMPILED_CALCULATOR_H
+
+#include <Inventor/engines/SoSubEngine.h>
+#include <Inventor/fields/SoMFFloat.h>
+#include <Inventor/fields/SoMFVec3f.h>
+#include <Inventor/fields/SoMFString.h>
+#include <Inventor/SbString.h>
+
+class SoCompiledCalculator : public SoEngine
+{
+    SO_ENGINE_HEADER(SoCompiledCalculator);
+
+public:
+    static void initClass();
+    SoCompiledCalculator();
+
+    SoMFFloat a, b, c, d, e, f, g, h;
+    SoMFVec3f A, B, C, D, E, F, G, H;
+    SoMFString expression;
+
+    SoEngineOutput oa, ob, oc, od; // (SoMFFloat)
+    SoEngineOutput oA, oB, oC, oD; // (SoMFVec3f)
+
+    // False if the expression did not compile; getError() tells why
+    SbBool isValid();
+    const SbString& getError() { isValid(); return error; }
+
+protected:
+    virtual ~SoCompiledCalculator();
+
+private:
+    struct Program;
+
+    virtual void evaluate();
+    virtual void inputChanged(SoField* which);
+    void compile();
+
+    Program* program;
+    SbBool needsCompile;
+    SbString error;
+};
+
+#endif // COIN3D_EXAMPLES_SO_COMPILED_CALCULATOR_H
@@ -0,0 +1,256 @@
+/*
+ * TransformAnimator
+ * Structure-of-arrays channel evaluation and batched transform writes
+ */
+
+#include "TransformAnimator.h"
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/errors/SoDebugError.h>
+#include <Inventor/fields/SoSFTime.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/sensors/SoFieldSensor.h>
+
+#include <set>
+
+#include "Float4.h"
+
+static const float PI = 3.14159265358979f;
+
+// sin and cos of four angles. The angle is reduced to [-pi, pi], folded
+// into [-pi/2, pi/2] where sin is symmetric, and sin evaluated with its
+// Taylor series to x^11, exact to float precision on that interval.
+// cos(x) is sin(x + pi/2).
+static Float4 sin4(Float4 x)
+{
+    const Float4 pi(PI), minusPi(-PI);
+    x = x - Float4(2.0f * PI) * round4(x * Float4(0.5f / PI));
+    x = max4(min4(x, pi - x), minusPi - x);
+    Float4 x2 = x * x;
+    Float4 p = Float4(-1.0f / 39916800.0f);
+    p = p * x2 + Float4(1.0f / 362880.0f);
+    p = p * x2 + Float4(-1.0f / 5040.0f);
+    p = p * x2 + Float4(1.0f / 120.0f);
+    p = p * x2 + Float4(-1.0f / 6.0f);
+    p = p * x2 + Float4(1.0f);
+    return p * x;
+}
+
+static Float4 cos4(Float4 x)
+{
+    return sin4(x + Float4(0.5f * PI));
+}
+
+TransformAnimator::TransformAnimator()
+    : notificationRoot(NULL), realTimeSensor(NULL)
+{
+}
+
+TransformAnimator::~TransformAnimator()
+{
+    detachFromRealTime();
+    setNotificationRoot(NULL);
+    for (size_t i = 0; i < targets.size(); i++) {
+        targets[i]->unref();
+    }
+}
+
+int TransformAnimator::add(SoTransform* target)
+{
+    target->ref();
+    int index = (int)targets.size();
+    targets.push_back(target);
+
+    // Grow the arrays in steps of four; padding lanes evaluate to zero
+    size_t padded = (targets.size() + 3) & ~(size_t)3;
+    for (int i = 0; i < NUM_PARAMETERS; i++) {
+        parameters[i].resize(padded, 0.0f);
+    }
+    for (int i = 0; i < NUM_RESULTS; i++) {
+        results[i].resize(padded, 0.0f);
+    }
+
+    // Start from the current values with all motion off
+    SbVec3f translation = target->translation.getValue();
+    SbVec3f axis;
+    float angle;
+    target->rotation.getValue().getValue(axis, angle);
+    SbVec3f scale = target->scaleFactor.getValue();
+    setOrbit(index, translation, SbVec3f(0, 0, 0), SbVec3f(0, 0, 0), 0.0f);
+    setSpin(index, axis, 0.0f, angle);
+    parameters[SCALE_X][index] = scale[0];
+    parameters[SCALE_Y][index] = scale[1];
+    parameters[SCALE_Z][index] = scale[2];
+    setPulse(index, 1.0f, 0.0f, 0.0f);
+    return index;
+}
+
+void TransformAnimator::setOrbit(int index, const SbVec3f& center, const SbVec3f& cosAxis,
+                                 const SbVec3f& sinAxis, float frequency, float phase)
+{
+    for (int i = 0; i < 3; i++) {
+        parameters[CENTER_X + i][index] = center[i];
+        parameters[COS_X + i][index] = cosAxis[i];
+        parameters[SIN_X + i][index] = sinAxis[i];
+    }
+    parameters[ORBIT_FREQUENCY][index] = frequency;
+    parameters[ORBIT_PHASE][index] = phase;
+}
+
+void TransformAnimator::setSpin(int index, const SbVec3f& axis, float speed, float phase)
+{
+    SbVec3f unit = axis;
+    if (unit.normalize() == 0.0f) {
+        unit.setValue(0, 0, 1);
+    }
+    for (int i = 0; i < 3; i++) {
+        parameters[AXIS_X + i][index] = unit[i];
+    }
+    parameters[SPIN_SPEED][index] = speed;
+    parameters[SPIN_PHASE][index] = phase;
+}
+
+void TransformAnimator::setPulse(int index, float offset, float amplitude, float frequency)
+{
+    parameters[PULSE_OFFSET][index] = offset;
+    parameters[PULSE_AMPLITUDE][index] = amplitude;
+    parameters[PULSE_FREQUENCY][index] = frequency;
+}
+
+void TransformAnimator::setNotificationRoot(SoNode* root)
+{
+    if (root) {
+        root->ref();
+    }
+    if (notificationRoot) {
+        notificationRoot->unref();
+    }
+    notificationRoot = root;
+    if (notificationRoot) {
+        checkNotificationRoot();
+    }
+}
+
+void TransformAnimator::checkNotificationRoot() const
+{
+    std::set<const SoNode*> targetSet(targets.begin(), targets.end());
+    SoSearchAction search;
+    search.setType(SoTransform::getClassTypeId());
+    search.setInterest(SoSearchAction::ALL);
+    search.setSearchingAll(TRUE);
+    search.apply(notificationRoot);
+    const SoPathList& paths = search.getPaths();
+
+    // The root itself is notified; everything below it up to the target is not
+    for (int i = 0; i < paths.getLength(); i++) {
+        const SoPath* path = paths[i];
+        if (targetSet.find(path->getTail()) == targetSet.end()) {
+            continue;
+        }
+        for (int j = 1; j < path->getLength() - 1; j++) {
+            SoNode* node = path->getNode(j);
+            if (!node->isOfType(SoSeparator::getClassTypeId())) {
+                continue;
+            }
+            SoSeparator* separator = (SoSeparator*)node;
+            if (separator->renderCaching.getValue() != SoSeparator::OFF ||
+                separator->boundingBoxCaching.getValue() != SoSeparator::OFF ||
+                separator->pickCulling.getValue() != SoSeparator::OFF) {
+                SoDebugError::postWarning("TransformAnimator::setNotificationRoot",
+                                          "separator below the notification root caches; "
+                                          "it will not see the animated transforms");
+                return;
+            }
+        }
+    }
+}
+
+void TransformAnimator::tick(double seconds)
+{
+    evaluate((float)seconds);
+    write();
+}
+
+void TransformAnimator::evaluate(float time)
+{
+    const Float4 t(time), half(0.5f), zero(0.0f);
+    const std::vector<float>* p = parameters;
+    std::vector<float>* r = results;
+    size_t padded = p[CENTER_X].size();
+
+    for (size_t i = 0; i < padded; i += 4) {
+        // Translation
+        Float4 angle = Float4::load(&p[ORBIT_FREQUENCY][i]) * t + Float4::load(&p[ORBIT_PHASE][i]);
+        Float4 s = sin4(angle);
+        Float4 c = cos4(angle);
+        for (int k = 0; k < 3; k++) {
+            Float4 v = Float4::load(&p[CENTER_X + k][i]) + Float4::load(&p[COS_X + k][i]) * c +
+                       Float4::load(&p[SIN_X + k][i]) * s;
+            v.store(&r[TRANSLATION_X + k][i]);
+        }
+
+        // Rotation as a quaternion of the half angle
+        angle = (Float4::load(&p[SPIN_SPEED][i]) * t + Float4::load(&p[SPIN_PHASE][i])) * half;
+        s = sin4(angle);
+        for (int k = 0; k < 3; k++) {
+            (Float4::load(&p[AXIS_X + k][i]) * s).store(&r[QUATERNION_X + k][i]);
+        }
+        cos4(angle).store(&r[QUATERNION_W][i]);
+
+        // Scale
+        s = sin4(Float4::load(&p[PULSE_FREQUENCY][i]) * t);
+        Float4 factor = Float4::load(&p[PULSE_OFFSET][i]) +
+                        Float4::load(&p[PULSE_AMPLITUDE][i]) * max4(s, zero - s);
+        for (int k = 0; k < 3; k++) {
+            (Float4::load(&p[SCALE_X + k][i]) * factor).store(&r[SCALE_FACTOR_X + k][i]);
+        }
+    }
+}
+
+void TransformAnimator::write()
+{
+    const std::vector<float>* r = results;
+    for (size_t i = 0; i < targets.size(); i++) {
+        SoTransform* target = targets[i];
+        SbBool wasEnabled = target->enableNotify(FALSE);
+        target->translation.setValue(r[TRANSLATION_X][i], r[TRANSLATION_Y][i], r[TRANSLATION_Z][i]);
+        target->rotation.setValue(r[QUATERNION_X][i], r[QUATERNION_Y][i], r[QUATERNION_Z][i],
+                                  r[QUATERNION_W][i]);
+        target->scaleFactor.setValue(r[SCALE_FACTOR_X][i], r[SCALE_FACTOR_Y][i],
+                                     r[SCALE_FACTOR_Z][i]);
+        target->enableNotify(wasEnabled);
+        if (!notificationRoot) {
+            target->touch();
+        }
+    }
+    if (notificationRoot && !targets.empty()) {
+        notificationRoot->touch();
+    }
+}
+
+void TransformAnimator::attachToRealTime()
+{
+    SoSFTime* realTime = (SoSFTime*)SoDB::getGlobalField("realTime");
+    startTime = realTime->getValue();
+    if (!realTimeSensor) {
+        realTimeSensor = new SoFieldSensor(realTimeChangedCB, this);
+        realTimeSensor->attach(realTime);
+    }
+}
+
+void TransformAnimator::detachFromRealTime()
+{
+    delete realTimeSensor;
+    realTimeSensor = NULL;
+}
+
+void TransformAnimator::realTimeChangedCB(void* data, SoSensor* sensor)
+{
+    TransformAnimator* animator = (TransformAnimator*)data;
+    SoSFTime* realTime = (SoSFTime*)((SoFieldSensor*)sensor)->getAttachedField();
+    animator->tick((realTime->getValue() - animator->startTime).getValue());
+}
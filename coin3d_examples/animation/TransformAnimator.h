@@ -0,0 +1,116 @@
+/*
+ * TransformAnimator
+ * One animation system driving thousands of SoTransforms per tick
+ *
+ * Replaces a chain of SoElapsedTime -> SoCalculator -> SoTransform per
+ * object. The animated parameters of all targets are kept in
+ * structure-of-arrays form, one float array per parameter, and every tick
+ * evaluates them four targets at a time with SIMD. The results are then
+ * written into the target transforms with notification disabled, followed
+ * by a single notification: one touch() of the notification root if one is
+ * set, otherwise one touch() per target instead of one notification per
+ * field.
+ *
+ * Each target has three channels, all evaluated every tick:
+ *   translation = center + cosAxis * cos(w t + p) + sinAxis * sin(w t + p)
+ *   rotation    = axis, speed * t + phase
+ *   scaleFactor = scale * (offset + amplitude * |sin(w t)|)
+ * add() initializes them so that the target keeps its current values.
+ *
+ * A notification root only notifies itself and the nodes above it, so
+ * nothing between the root and the targets sees the silent field writes:
+ *   - separators there must not cache: set renderCaching and
+ *     boundingBoxCaching to OFF, and pickCulling too, since it relies on
+ *     the bounding box cache
+ *   - sensors attached to those nodes or to the targets do not trigger;
+ *     attach them to the root or above it
+ * setNotificationRoot() warns about caching separators below the root in
+ * front of the targets added so far.
+ */
+
+#ifndef COIN3D_EXAMPLES_TRANSFORM_ANIMATOR_H
+#define COIN3D_EXAMPLES_TRANSFORM_ANIMATOR_H
+
+#include <Inventor/SbLinear.h>
+#include <Inventor/SbTime.h>
+
+#include <vector>
+
+class SoNode;
+class SoTransform;
+class SoSensor;
+class SoFieldSensor;
+
+class TransformAnimator
+{
+public:
+    TransformAnimator();
+    ~TransformAnimator();
+
+    // Animate target; returns its index for the set functions
+    int add(SoTransform* target);
+    int getNumTargets() const { return (int)targets.size(); }
+    SoTransform* getTarget(int index) const { return targets[index]; }
+
+    // Translation on an ellipse (or line, with one axis zero) around center
+    void setOrbit(int index, const SbVec3f& center, const SbVec3f& cosAxis,
+                  const SbVec3f& sinAxis, float frequency, float phase = 0.0f);
+    // Rotation around axis at speed radians per second
+    void setSpin(int index, const SbVec3f& axis, float speed, float phase = 0.0f);
+    // Uniform pulsing of the target's scale
+    void setPulse(int index, float offset, float amplitude, float frequency);
+
+    // Node touched once per tick instead of every target, or NULL; see
+    // above for what must not sit between it and the targets
+    void setNotificationRoot(SoNode* root);
+    SoNode* getNotificationRoot() const { return notificationRoot; }
+
+    // Evaluate all channels at time seconds and write the targets
+    void tick(double seconds);
+
+    // Tick whenever the realTime global field changes, with the time
+    // counted from this call
+    void attachToRealTime();
+    void detachFromRealTime();
+
+private:
+    // Parameter arrays, each padded to a multiple of four targets
+    enum Parameter
+    {
+        CENTER_X, CENTER_Y, CENTER_Z,
+        COS_X, COS_Y, COS_Z,
+        SIN_X, SIN_Y, SIN_Z,
+        ORBIT_FREQUENCY, ORBIT_PHASE,
+        AXIS_X, AXIS_Y, AXIS_Z,
+        SPIN_SPEED, SPIN_PHASE,
+        SCALE_X, SCALE_Y, SCALE_Z,
+        PULSE_OFFSET, PULSE_AMPLITUDE, PULSE_FREQUENCY,
+        NUM_PARAMETERS
+    };
+
+    // Result arrays, same layout
+    enum Result
+    {
+        TRANSLATION_X, TRANSLATION_Y, TRANSLATION_Z,
+        QUATERNION_X, QUATERNION_Y, QUATERNION_Z, QUATERNION_W,
+        SCALE_FACTOR_X, SCALE_FACTOR_Y, SCALE_FACTOR_Z,
+        NUM_RESULTS
+    };
+
+    void evaluate(float time);
+    void write();
+    void checkNotificationRoot() const;
+    static void realTimeChangedCB(void* data, SoSensor* sensor);
+
+    std::vector<SoTransform*> targets;
+    std::vector<float> parameters[NUM_PARAMETERS];
+    std::vector<float> results[NUM_RESULTS];
+    SoNode* notificationRoot;
+    SoFieldSensor* realTimeSensor;
+    SbTime startTime;
+
+    TransformAnimator(const TransformAnimator&);
+    TransformAnimator& operator=(const TransformAnimator&);
+};
+
+#endif // COIN3D_EXAMPLES_TRANSFORM_ANIMATOR_H
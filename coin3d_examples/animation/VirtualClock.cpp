@@ -0,0 +1,68 @@
+/*
+ * VirtualClock
+ * realTime stepping and frame state capture
+ */
+
+#include "VirtualClock.h"
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/fields/SoSFTime.h>
+#include <Inventor/sensors/SoSensorManager.h>
+
+#include <cstdlib>
+
+VirtualClock::VirtualClock(double frameTime, double startTime)
+    : frameTime(frameTime), startTime(startTime), frame(0)
+{
+    realTime = (SoSFTime*)SoDB::getGlobalField("realTime");
+    SoDB::enableRealTimeSensor(FALSE);
+    update();
+}
+
+VirtualClock::~VirtualClock()
+{
+    realTime->setValue(SbTime::getTimeOfDay());
+    SoDB::enableRealTimeSensor(TRUE);
+}
+
+void VirtualClock::step()
+{
+    frame++;
+    update();
+}
+
+void VirtualClock::setFrame(int frame)
+{
+    this->frame = frame;
+    update();
+}
+
+SbTime VirtualClock::getTime() const
+{
+    // Multiplied rather than accumulated, so late frames do not drift
+    return SbTime(startTime + frame * frameTime);
+}
+
+void VirtualClock::update()
+{
+    realTime->setValue(getTime());
+    // Sensors on realTime and on what it changed see the new frame now
+    SoDB::getSensorManager()->processDelayQueue(FALSE);
+}
+
+std::string captureState(SoNode* root)
+{
+    SoOutput output;
+    output.setBuffer(malloc(4096), 4096, realloc);
+    SoWriteAction writer(&output);
+    writer.apply(root);
+
+    void* buffer;
+    size_t size;
+    output.getBuffer(buffer, size);
+    std::string state((const char*)buffer, size);
+    free(buffer);
+    return state;
+}
@@ -0,0 +1,61 @@
+/*
+ * VirtualClock
+ * Deterministic stand-in for wall-clock time in headless playback
+ *
+ * SoElapsedTime, SoTimeCounter, SoOneShot and anything else listening to
+ * the realTime global field normally see the time of day, updated by a
+ * timer from the window system's main loop. A VirtualClock turns that
+ * update off and sets realTime itself: each step() advances it by exactly
+ * one frame time and processes the delay queue, so the engine network
+ * computes frame n for time start + n * dt no matter how fast the loop
+ * runs. Engines evaluate lazily when their outputs are read, e.g. by the
+ * next traversal or by captureState().
+ *
+ * Create the clock before the scene, so engines that latch realTime when
+ * created (SoElapsedTime) start from the virtual start time. Timer and
+ * alarm sensors still use the time of day and are not driven.
+ */
+
+#ifndef COIN3D_EXAMPLES_VIRTUAL_CLOCK_H
+#define COIN3D_EXAMPLES_VIRTUAL_CLOCK_H
+
+#include <Inventor/SbTime.h>
+
+#include <string>
+
+class SoNode;
+class SoSFTime;
+
+class VirtualClock
+{
+public:
+    explicit VirtualClock(double frameTime = 1.0 / 60.0, double startTime = 0.0);
+    // Hands realTime back to the system clock
+    ~VirtualClock();
+
+    // Advance by one frame time
+    void step();
+    // Jump to frame, counted from the start time
+    void setFrame(int frame);
+
+    int getFrame() const { return frame; }
+    double getFrameTime() const { return frameTime; }
+    SbTime getTime() const;
+
+private:
+    void update();
+
+    SoSFTime* realTime;
+    double frameTime;
+    double startTime;
+    int frame;
+
+    VirtualClock(const VirtualClock&);
+    VirtualClock& operator=(const VirtualClock&);
+};
+
+// ASCII Inventor dump of root, with the current values of all fields
+// including engine outputs; equal strings mean equal frame state
+std::string captureState(SoNode* root);
+
+#endif // COIN3D_EXAMPLES_VIRTUAL_CLOCK_H
@@ -0,0 +1,240 @@
+/*
+ * Bulk Animation Benchmark
+ * CPU time per frame of animating many objects with the animation
+ * example's motions: connected SoCalculator engines per object against
+ * one TransformAnimator, with one notification per target or per frame
+ *
+ * A frame advances the time and reads back every transform, which is what
+ * a render traversal does first. Both sides see the same time: the engines
+ * read it from a global field instead of an SoElapsedTime.
+ *
+ * Usage: animation_bulk_benchmark [frames] [objects ...]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/engines/SoCalculator.h>
+#include <Inventor/engines/SoCompose.h>
+#include <Inventor/fields/SoSFFloat.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoCube.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "TransformAnimator.h"
+#include "BenchmarkUtils.h"
+
+// The four motions of the animation example, assigned round robin
+enum Motion { ROTATING, OSCILLATING, SCALING, COMBINED, NUM_MOTIONS };
+
+// Position of object i in a square grid of count
+static SbVec3f gridPosition(int i, int count)
+{
+    int side = (int)ceil(sqrt((double)count));
+    return SbVec3f((float)(i % side) * 5.0f, (float)(i / side) * 5.0f, 0);
+}
+
+// Separator that neither caches nor culls, as the animator requires below
+// its notification root
+static SoSeparator* createUncachedSeparator()
+{
+    SoSeparator* sep = new SoSeparator;
+    sep->renderCaching = SoSeparator::OFF;
+    sep->boundingBoxCaching = SoSeparator::OFF;
+    sep->pickCulling = SoSeparator::OFF;
+    return sep;
+}
+
+// Grid of count Separator { Transform Cube } objects
+static SoSeparator* createObjects(int count, std::vector<SoTransform*>& transforms)
+{
+    SoSeparator* root = createUncachedSeparator();
+    transforms.resize(count);
+    for (int i = 0; i < count; i++) {
+        SoSeparator* object = createUncachedSeparator();
+        transforms[i] = new SoTransform;
+        transforms[i]->translation = gridPosition(i, count);
+        object->addChild(transforms[i]);
+        object->addChild(new SoCube);
+        root->addChild(object);
+    }
+    return root;
+}
+
+// Engine chains like the example's, fed from the time field
+static void connectEngines(const std::vector<SoTransform*>& transforms, SoSFFloat* time)
+{
+    int count = (int)transforms.size();
+    for (int i = 0; i < count; i++) {
+        SoTransform* transform = transforms[i];
+        SoCalculator* calc = new SoCalculator;
+        calc->a.connectFrom(time);
+        calc->A = gridPosition(i, count);
+        SoComposeRotation* rotation = NULL;
+        switch (i % NUM_MOTIONS) {
+        case ROTATING:
+            calc->expression = "oa = a * 2.0";
+            rotation = new SoComposeRotation;
+            rotation->axis = SbVec3f(0, 1, 0);
+            break;
+        case OSCILLATING:
+            calc->expression = "oA = A + vec3f(0, sin(a * 3.0) * 2.0, 0)";
+            transform->translation.connectFrom(&calc->oA);
+            break;
+        case SCALING:
+            calc->expression = "ta = abs(sin(a * 2.0)) * 0.5 + 0.5; oA = vec3f(ta, ta, ta)";
+            transform->scaleFactor.connectFrom(&calc->oA);
+            break;
+        case COMBINED:
+            calc->expression = "oA = A + vec3f(cos(a) * 2.0, sin(a) * 2.0, 0); oa = a * 3.0";
+            transform->translation.connectFrom(&calc->oA);
+            rotation = new SoComposeRotation;
+            rotation->axis = SbVec3f(0, 0, 1);
+            break;
+        }
+        if (rotation) {
+            rotation->angle.connectFrom(&calc->oa);
+            transform->rotation.connectFrom(&rotation->rotation);
+        }
+    }
+}
+
+// The same motions as animator channels
+static void addChannels(const std::vector<SoTransform*>& transforms, TransformAnimator& animator)
+{
+    int count = (int)transforms.size();
+    for (int i = 0; i < count; i++) {
+        int index = animator.add(transforms[i]);
+        SbVec3f center = gridPosition(i, count);
+        switch (i % NUM_MOTIONS) {
+        case ROTATING:
+            animator.setSpin(index, SbVec3f(0, 1, 0), 2.0f);
+            break;
+        case OSCILLATING:
+            animator.setOrbit(index, center, SbVec3f(0, 0, 0), SbVec3f(0, 2, 0), 3.0f);
+            break;
+        case SCALING:
+            animator.setPulse(index, 0.5f, 0.5f, 2.0f);
+            break;
+        case COMBINED:
+            animator.setOrbit(index, center, SbVec3f(2, 0, 0), SbVec3f(0, 2, 0), 1.0f);
+            animator.setSpin(index, SbVec3f(0, 0, 1), 3.0f);
+            break;
+        }
+    }
+}
+
+// Read back all transforms, evaluating connected engines
+static float readTransforms(const std::vector<SoTransform*>& transforms)
+{
+    float sum = 0.0f;
+    for (size_t i = 0; i < transforms.size(); i++) {
+        sum += transforms[i]->translation.getValue()[1];
+        sum += transforms[i]->rotation.getValue().getValue()[3];
+        sum += transforms[i]->scaleFactor.getValue()[0];
+    }
+    return sum;
+}
+
+// Largest difference between the transforms of two scenes
+static float maxDifference(const std::vector<SoTransform*>& a, const std::vector<SoTransform*>& b)
+{
+    float diff = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        diff = std::max(diff, (a[i]->translation.getValue() - b[i]->translation.getValue()).length());
+        diff = std::max(diff, (a[i]->scaleFactor.getValue() - b[i]->scaleFactor.getValue()).length());
+        // q and -q are the same rotation
+        SbVec4f qa(a[i]->rotation.getValue().getValue());
+        SbVec4f qb(b[i]->rotation.getValue().getValue());
+        diff = std::max(diff, std::min((qa - qb).length(), (qa + qb).length()));
+    }
+    return diff;
+}
+
+struct FrameResult
+{
+    double enginesMs;
+    double perTargetMs;
+    double perFrameMs;
+    float maxDiff;
+};
+
+static FrameResult runFrames(int count, int frames)
+{
+    FrameResult result;
+    volatile float sink = 0.0f;
+
+    // Connected engines
+    SoSFFloat* time =
+        (SoSFFloat*)SoDB::createGlobalField("animationTime", SoSFFloat::getClassTypeId());
+    std::vector<SoTransform*> engineTransforms;
+    SoSeparator* engineRoot = createObjects(count, engineTransforms);
+    engineRoot->ref();
+    connectEngines(engineTransforms, time);
+    BenchTimer timer;
+    for (int frame = 0; frame < frames; frame++) {
+        time->setValue(frame / 60.0f);
+        sink = sink + readTransforms(engineTransforms);
+    }
+    result.enginesMs = timer.milliseconds() / frames;
+
+    // Animator, one touch per target and one per frame
+    std::vector<SoTransform*> transforms;
+    SoSeparator* root = createObjects(count, transforms);
+    root->ref();
+    {
+        TransformAnimator animator;
+        addChannels(transforms, animator);
+        timer.restart();
+        for (int frame = 0; frame < frames; frame++) {
+            animator.tick(frame / 60.0);
+            sink = sink + readTransforms(transforms);
+        }
+        result.perTargetMs = timer.milliseconds() / frames;
+
+        animator.setNotificationRoot(root);
+        timer.restart();
+        for (int frame = 0; frame < frames; frame++) {
+            animator.tick(frame / 60.0);
+            sink = sink + readTransforms(transforms);
+        }
+        result.perFrameMs = timer.milliseconds() / frames;
+    }
+    result.maxDiff = maxDifference(engineTransforms, transforms);
+
+    root->unref();
+    engineRoot->unref();
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int frames = argc > 1 ? atoi(argv[1]) : 100;
+    std::vector<int> counts;
+    for (int i = 2; i < argc; i++) {
+        counts.push_back(atoi(argv[i]));
+    }
+    if (counts.empty()) {
+        counts.push_back(1000);
+        counts.push_back(10000);
+        counts.push_back(100000);
+    }
+
+    printf("%d frames\n", frames);
+    printf("%10s %12s %14s %14s %8s %10s\n", "objects", "engines ms", "per target ms",
+           "per frame ms", "speedup", "max diff");
+    for (size_t i = 0; i < counts.size(); i++) {
+        FrameResult r = runFrames(counts[i], frames);
+        printf("%10d %12.3f %14.3f %14.3f %7.1fx %10g\n", counts[i], r.enginesMs,
+               r.perTargetMs, r.perFrameMs,
+               r.perFrameMs > 0.0 ? r.enginesMs / r.perFrameMs : 0.0, r.maxDiff);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Calculator Benchmark
+ * SoCalculator against SoCompiledCalculator on the animation example's
+ * expressions: evaluation cost per value with one engine over many
+ * values, and per tick with many single-valued engines
+ *
+ * Usage: animation_calculator_benchmark [values] [engines] [ticks]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/engines/SoCalculator.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "SoCompiledCalculator.h"
+#include "BenchmarkUtils.h"
+
+// The expressions of the animation example
+static const char* expressions[] = {
+    "oA = vec3f(0, 1, 0); oB = a * 2.0",
+    "oA = vec3f(0, sin(a * 3.0) * 2.0, 0)",
+    "ta = abs(sin(a * 2.0)) * 0.5 + 0.5; oA = vec3f(ta, ta, ta)",
+    "oA = vec3f(cos(a) * 2.0, sin(a) * 2.0, 0)",
+    "oA = vec3f(0, 0, 1); oB = a * 3.0",
+};
+
+// One engine evaluating count values per tick; returns seconds per tick
+// and leaves the last results in results
+template <class Engine>
+static double timeBulk(const char* expression, int count, int ticks, std::vector<SbVec3f>& results)
+{
+    Engine* engine = new Engine;
+    engine->ref();
+    engine->expression = expression;
+    SoCoordinate3* sink = new SoCoordinate3;
+    sink->ref();
+    sink->point.connectFrom(&engine->oA);
+
+    std::vector<float> values(count);
+    BenchTimer timer;
+    for (int tick = 0; tick < ticks; tick++) {
+        for (int i = 0; i < count; i++) {
+            values[i] = tick * 0.016f + i * 0.001f;
+        }
+        engine->a.setValues(0, count, &values[0]);
+        // Reading the connected field runs the engine
+        sink->point.getValues(0);
+    }
+    double seconds = timer.seconds() / ticks;
+
+    results.assign(sink->point.getValues(0), sink->point.getValues(0) + sink->point.getNum());
+    sink->unref();
+    engine->unref();
+    return seconds;
+}
+
+// numEngines single-valued engines, all updated every tick; returns
+// seconds per tick
+template <class Engine>
+static double timeEngines(const char* expression, int numEngines, int ticks)
+{
+    std::vector<Engine*> engines(numEngines);
+    std::vector<SoCoordinate3*> sinks(numEngines);
+    for (int i = 0; i < numEngines; i++) {
+        engines[i] = new Engine;
+        engines[i]->ref();
+        engines[i]->expression = expression;
+        sinks[i] = new SoCoordinate3;
+        sinks[i]->ref();
+        sinks[i]->point.connectFrom(&engines[i]->oA);
+    }
+
+    BenchTimer timer;
+    for (int tick = 0; tick < ticks; tick++) {
+        for (int i = 0; i < numEngines; i++) {
+            engines[i]->a.setValue(tick * 0.016f + i * 0.001f);
+            sinks[i]->point.getValues(0);
+        }
+    }
+    double seconds = timer.seconds() / ticks;
+
+    for (int i = 0; i < numEngines; i++) {
+        sinks[i]->unref();
+        engines[i]->unref();
+    }
+    return seconds;
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoCompiledCalculator::initClass();
+
+    int count = argc > 1 ? atoi(argv[1]) : 100000;
+    int numEngines = argc > 2 ? atoi(argv[2]) : 1000;
+    int ticks = argc > 3 ? atoi(argv[3]) : 20;
+
+    printf("%d values per engine / %d engines, %d ticks\n", count, numEngines, ticks);
+    printf("%-58s %10s %10s %8s %12s %12s %8s %10s\n", "expression", "calc ns", "compiled",
+           "speedup", "calc ms/tick", "compiled", "speedup", "max diff");
+    for (size_t e = 0; e < sizeof(expressions) / sizeof(expressions[0]); e++) {
+        std::vector<SbVec3f> expected, actual;
+        double calcBulk = timeBulk<SoCalculator>(expressions[e], count, ticks, expected);
+        double compiledBulk = timeBulk<SoCompiledCalculator>(expressions[e], count, ticks, actual);
+        double calcTick = timeEngines<SoCalculator>(expressions[e], numEngines, ticks);
+        double compiledTick = timeEngines<SoCompiledCalculator>(expressions[e], numEngines, ticks);
+
+        float diff = expected.size() == actual.size() ? 0.0f : -1.0f;
+        for (size_t i = 0; diff >= 0.0f && i < expected.size(); i++) {
+            diff = std::max(diff, (expected[i] - actual[i]).length());
+        }
+
+        printf("%-58s %10.1f %10.1f %7.1fx %12.3f %12.3f %7.1fx %10g\n", expressions[e],
+               calcBulk * 1e9 / count, compiledBulk * 1e9 / count,
+               compiledBulk > 0.0 ? calcBulk / compiledBulk : 0.0, calcTick * 1000.0,
+               compiledTick * 1000.0, compiledTick > 0.0 ? calcTick / compiledTick : 0.0,
+               diff);
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Playback Benchmark
+ * Headless playback of the animation example on a VirtualClock at a fixed
+ * frame time, as fast as the CPU allows: frames per second when each
+ * frame is only traversed, when its node state is captured, and when it
+ * is rendered offscreen to an image file; plus a check that two runs
+ * capture identical state for every frame
+ *
+ * Images are written as <image dir>/frame<n>.rgb and need an offscreen
+ * OpenGL context; without an image dir that mode is skipped.
+ *
+ * Usage: animation_playback_benchmark [frames] [fps] [image dir]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "VirtualClock.h"
+#include "ExampleScenes.h"
+#include "BenchmarkUtils.h"
+
+enum Mode { TRAVERSE, CAPTURE, RENDER };
+
+// Play frames of a fresh example scene; returns frames per second. In
+// CAPTURE mode the state hash of every frame is appended to hashes.
+static double play(Mode mode, int frames, double fps, const char* imageDir,
+                   std::vector<size_t>& hashes)
+{
+    // The clock comes first, so the scene's SoElapsedTime starts at zero
+    VirtualClock clock(1.0 / fps);
+    SoSeparator* root = new SoSeparator;
+    root->ref();
+    SoPerspectiveCamera* camera = new SoPerspectiveCamera;
+    root->addChild(camera);
+    root->addChild(new SoDirectionalLight);
+    root->addChild(createAnimationScene());
+
+    SbViewportRegion viewport(320, 240);
+    camera->viewAll(root, viewport, 2.0f);
+    SoGetBoundingBoxAction bboxAction(viewport);
+    SoOffscreenRenderer renderer(viewport);
+    std::hash<std::string> hashState;
+
+    BenchTimer timer;
+    for (int frame = 0; frame < frames; frame++) {
+        clock.step();
+        if (mode == TRAVERSE) {
+            bboxAction.apply(root);
+        } else if (mode == CAPTURE) {
+            hashes.push_back(hashState(captureState(root)));
+        } else {
+            if (!renderer.render(root)) {
+                fprintf(stderr, "Offscreen rendering is not available\n");
+                root->unref();
+                return 0.0;
+            }
+            char filename[1024];
+            snprintf(filename, sizeof(filename), "%s/frame%05d.rgb", imageDir, frame);
+            FILE* fp = fopen(filename, "wb");
+            if (!fp || !renderer.writeToRGB(fp)) {
+                fprintf(stderr, "Failed to write %s\n", filename);
+            }
+            if (fp) {
+                fclose(fp);
+            }
+        }
+    }
+    double seconds = timer.seconds();
+
+    root->unref();
+    return seconds > 0.0 ? frames / seconds : 0.0;
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int frames = argc > 1 ? atoi(argv[1]) : 1000;
+    double fps = argc > 2 ? atof(argv[2]) : 60.0;
+    const char* imageDir = argc > 3 ? argv[3] : NULL;
+
+    std::vector<size_t> first, second, unused;
+    double traverseFps = play(TRAVERSE, frames, fps, NULL, unused);
+    double captureFps = play(CAPTURE, frames, fps, NULL, first);
+    play(CAPTURE, frames, fps, NULL, second);
+    double renderFps = imageDir ? play(RENDER, frames, fps, imageDir, unused) : 0.0;
+
+    printf("%d frames at %g fps virtual time (%.1f s)\n", frames, fps, frames / fps);
+    printf("%-10s %14s %14s\n", "mode", "frames/sec", "x real time");
+    printf("%-10s %14.0f %14.1f\n", "traverse", traverseFps, traverseFps / fps);
+    printf("%-10s %14.0f %14.1f\n", "capture", captureFps, captureFps / fps);
+    if (imageDir) {
+        printf("%-10s %14.0f %14.1f\n", "render", renderFps, renderFps / fps);
+    }
+    bool deterministic = first == second;
+    printf("frame state of two runs %s\n", deterministic ? "identical" : "DIFFERS");
+    return deterministic ? 0 : 1;
+}
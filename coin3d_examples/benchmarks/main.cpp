@@ -0,0 +1,279 @@
+/*
+ * Coin3D Benchmarks
+ * Headless measurements of every example scene, replicated from 1x up to
+ * 10000x in a grid: scene build, SoGetBoundingBoxAction, SoRayPickAction,
+ * SoWriteAction and SoDB::readAll through an in-memory buffer, and
+ * SoOffscreenRenderer (the first frame, which creates the context and the
+ * caches, and a second one). Only SoDB::init is used, so it runs on
+ * machines without a display as long as offscreen contexts are available;
+ * rendering can be skipped where they are not.
+ *
+ * Results are written as JSON to stdout or to the output file, progress
+ * to stderr.
+ *
+ * Usage: coin3d_benchmarks [max scale] [--no-render] [--output results.json]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "ExampleScenes.h"
+#include "SceneIO.h"
+#include "BenchmarkUtils.h"
+
+static SoNode* buildBasicShapes() { return createBasicShapesScene(); }
+static SoNode* buildSceneGraph() { return createSceneGraphScene(); }
+static SoNode* buildTransformations() { return createTransformationsScene(); }
+static SoNode* buildMaterials() { return createMaterialsScene(); }
+static SoNode* buildLighting() { return createLightingScene(); }
+static SoNode* buildCameras() { return createCamerasScene(); }
+static SoNode* buildText() { return createTextScene(); }
+static SoNode* buildEvents() { return createEventsScene(); }
+static SoNode* buildFileIO() { return createSampleScene(); }
+static SoNode* buildAnimation() { return createAnimationScene(); }
+
+struct SceneEntry
+{
+    const char* name;
+    SoNode* (*build)();
+};
+
+static const SceneEntry scenes[] = {
+    { "basic_shapes", buildBasicShapes },
+    { "scene_graph", buildSceneGraph },
+    { "transformations", buildTransformations },
+    { "materials", buildMaterials },
+    { "lighting", buildLighting },
+    { "cameras", buildCameras },
+    { "text", buildText },
+    { "events", buildEvents },
+    { "file_io", buildFileIO },
+    { "animation", buildAnimation },
+};
+
+struct SceneResult
+{
+    const char* scene;
+    int scale;
+    double buildMs;
+    double bboxMs;
+    double pickMs;
+    bool picked;
+    double writeMs;
+    size_t writtenBytes;
+    double readMs;
+    bool readOk;
+    double renderFirstMs; // < 0 if not rendered
+    double renderMs;
+};
+
+// Build scene and drop a camera it brings along, so the copies are all
+// seen through the camera of the benchmark
+static SoNode* buildWithoutCamera(const SceneEntry& entry)
+{
+    SoNode* node = entry.build();
+    if (node->isOfType(SoGroup::getClassTypeId())) {
+        SoGroup* group = (SoGroup*)node;
+        if (group->getNumChildren() > 0 &&
+            group->getChild(0)->isOfType(SoCamera::getClassTypeId())) {
+            group->removeChild(0);
+        }
+    }
+    return node;
+}
+
+// Grid cell size that keeps copies of the scene apart
+static float cellSpacing(const SceneEntry& entry, const SbViewportRegion& viewport)
+{
+    SoNode* node = buildWithoutCamera(entry);
+    node->ref();
+    SoGetBoundingBoxAction bboxAction(viewport);
+    bboxAction.apply(node);
+    SbBox3f box = bboxAction.getBoundingBox();
+    node->unref();
+    if (box.isEmpty()) {
+        return 1.0f;
+    }
+    SbVec3f size = box.getMax() - box.getMin();
+    return std::max(size[0], size[1]) * 1.25f + 1.0f;
+}
+
+static SceneResult measure(const SceneEntry& entry, int scale, float spacing,
+                           const SbViewportRegion& viewport, bool render)
+{
+    SceneResult result;
+    memset(&result, 0, sizeof(result));
+    result.scene = entry.name;
+    result.scale = scale;
+
+    // scale copies in a square grid, below a camera and a light
+    BenchTimer timer;
+    SoSeparator* root = new SoSeparator;
+    root->ref();
+    SoPerspectiveCamera* camera = new SoPerspectiveCamera;
+    root->addChild(camera);
+    root->addChild(new SoDirectionalLight);
+    int side = (int)ceil(sqrt((double)scale));
+    for (int i = 0; i < scale; i++) {
+        SoSeparator* cell = new SoSeparator;
+        SoTranslation* translation = new SoTranslation;
+        translation->translation.setValue((i % side) * spacing, (i / side) * spacing, 0.0f);
+        cell->addChild(translation);
+        cell->addChild(buildWithoutCamera(entry));
+        root->addChild(cell);
+    }
+    result.buildMs = timer.milliseconds();
+
+    timer.restart();
+    SoGetBoundingBoxAction bboxAction(viewport);
+    bboxAction.apply(root);
+    result.bboxMs = timer.milliseconds();
+
+    camera->viewAll(root, viewport);
+
+    SbVec2s size = viewport.getViewportSizePixels();
+    timer.restart();
+    SoRayPickAction pickAction(viewport);
+    pickAction.setPoint(SbVec2s(size[0] / 2, size[1] / 2));
+    pickAction.apply(root);
+    result.pickMs = timer.milliseconds();
+    result.picked = pickAction.getPickedPoint() != NULL;
+
+    // Write to a growing memory buffer and read it back, so the numbers
+    // do not depend on the disk
+    timer.restart();
+    size_t initialSize = 1 << 20;
+    SoOutput out;
+    out.setBuffer(malloc(initialSize), initialSize, realloc);
+    SoWriteAction writeAction(&out);
+    writeAction.apply(root);
+    void* buffer = NULL;
+    size_t bufferSize = 0;
+    out.getBuffer(buffer, bufferSize);
+    result.writeMs = timer.milliseconds();
+    result.writtenBytes = bufferSize;
+
+    timer.restart();
+    SoInput in;
+    in.setBuffer(buffer, bufferSize);
+    SoSeparator* readRoot = SoDB::readAll(&in);
+    result.readMs = timer.milliseconds();
+    result.readOk = readRoot != NULL;
+    if (readRoot) {
+        readRoot->ref();
+        readRoot->unref();
+    }
+    free(buffer);
+
+    result.renderFirstMs = result.renderMs = -1.0;
+    if (render) {
+        SoOffscreenRenderer renderer(viewport);
+        timer.restart();
+        if (renderer.render(root)) {
+            result.renderFirstMs = timer.milliseconds();
+            timer.restart();
+            renderer.render(root);
+            result.renderMs = timer.milliseconds();
+        }
+    }
+
+    root->unref();
+    return result;
+}
+
+static void printMs(FILE* fp, const char* key, double ms)
+{
+    if (ms >= 0.0) {
+        fprintf(fp, "\"%s\": %.3f", key, ms);
+    } else {
+        fprintf(fp, "\"%s\": null", key);
+    }
+}
+
+static void writeJson(FILE* fp, const std::vector<SceneResult>& results,
+                      const SbViewportRegion& viewport, bool render)
+{
+    SbVec2s size = viewport.getViewportSizePixels();
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"viewport\": [%d, %d],\n", size[0], size[1]);
+    fprintf(fp, "  \"render\": %s,\n", render ? "true" : "false");
+    fprintf(fp, "  \"peak_resident_bytes\": %lu,\n", (unsigned long)peakResidentBytes());
+    fprintf(fp, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const SceneResult& r = results[i];
+        fprintf(fp, "    {\"scene\": \"%s\", \"scale\": %d, ", r.scene, r.scale);
+        printMs(fp, "build_ms", r.buildMs);
+        fprintf(fp, ", ");
+        printMs(fp, "bbox_ms", r.bboxMs);
+        fprintf(fp, ", ");
+        printMs(fp, "pick_ms", r.pickMs);
+        fprintf(fp, ", \"pick_hit\": %s, ", r.picked ? "true" : "false");
+        printMs(fp, "write_ms", r.writeMs);
+        fprintf(fp, ", \"written_bytes\": %lu, ", (unsigned long)r.writtenBytes);
+        printMs(fp, "read_ms", r.readOk ? r.readMs : -1.0);
+        fprintf(fp, ", ");
+        printMs(fp, "render_first_ms", r.renderFirstMs);
+        fprintf(fp, ", ");
+        printMs(fp, "render_ms", r.renderMs);
+        fprintf(fp, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int maxScale = 10000;
+    bool render = true;
+    const char* outputFile = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-render") == 0) {
+            render = false;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else {
+            maxScale = atoi(argv[i]);
+        }
+    }
+
+    SbViewportRegion viewport(1024, 768);
+    std::vector<SceneResult> results;
+    for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++) {
+        float spacing = cellSpacing(scenes[s], viewport);
+        for (int scale = 1; scale <= maxScale; scale *= 10) {
+            fprintf(stderr, "%s x%d\n", scenes[s].name, scale);
+            results.push_back(measure(scenes[s], scale, spacing, viewport, render));
+        }
+    }
+
+    FILE* fp = outputFile ? fopen(outputFile, "w") : stdout;
+    if (!fp) {
+        fprintf(stderr, "Failed to open %s\n", outputFile);
+        return 1;
+    }
+    writeJson(fp, results, viewport, render);
+    if (fp != stdout) {
+        fclose(fp);
+    }
+    return 0;
+}
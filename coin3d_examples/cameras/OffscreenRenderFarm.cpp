@@ -0,0 +1,416 @@
+/*
+ * OffscreenRenderFarm
+ * Parallel offscreen rendering of camera poses with PNG/PPM encoding
+ */
+
+#include "OffscreenRenderFarm.h"
+#include "BenchmarkUtils.h"
+
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/C/basic.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_OSMESA
+#include <GL/osmesa.h>
+#endif
+
+#ifndef COIN_THREADSAFE
+// Without thread support in Coin only one traversal may run at a time
+static std::mutex renderMutex;
+#endif
+
+#ifdef HAVE_ZLIB
+static void appendUint32(std::vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+static void appendChunk(std::vector<unsigned char>& out, const char* type,
+                        const unsigned char* data, size_t size)
+{
+    appendUint32(out, (uint32_t)size);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    uLong crc = crc32(0L, &out[start], (uInt)(size + 4));
+    appendUint32(out, (uint32_t)crc);
+}
+#endif
+
+// Encode bottom-up RGB rows as a PNG file (each row Sub filtered, one
+// IDAT chunk), or as a binary PPM without zlib. scratch is reused between
+// calls of one worker.
+static void encodeImage(const std::vector<unsigned char>& rgb, int width, int height, int level,
+                        std::vector<unsigned char>& scratch, std::vector<unsigned char>& image)
+{
+    size_t rowBytes = (size_t)width * 3;
+    image.clear();
+#ifdef HAVE_ZLIB
+    // Filter type 1 stores each byte as the difference to the same channel
+    // of the pixel on its left, which makes flat shaded areas compress well
+    std::vector<unsigned char> filtered(height * (rowBytes + 1));
+    for (int y = 0; y < height; y++) {
+        const unsigned char* row = &rgb[(height - 1 - y) * rowBytes];
+        unsigned char* out = &filtered[y * (rowBytes + 1)];
+        out[0] = 1;
+        memcpy(out + 1, row, 3);
+        for (size_t x = 3; x < rowBytes; x++) {
+            out[1 + x] = (unsigned char)(row[x] - row[x - 3]);
+        }
+    }
+    uLongf packedSize = compressBound((uLong)filtered.size());
+    scratch.resize(packedSize);
+    if (compress2(&scratch[0], &packedSize, &filtered[0], (uLong)filtered.size(), level) != Z_OK) {
+        return;
+    }
+
+    static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    image.insert(image.end(), signature, signature + 8);
+    std::vector<unsigned char> header;
+    appendUint32(header, (uint32_t)width);
+    appendUint32(header, (uint32_t)height);
+    header.push_back(8); // bits per channel
+    header.push_back(2); // RGB
+    header.push_back(0); // deflate
+    header.push_back(0); // adaptive filtering
+    header.push_back(0); // not interlaced
+    appendChunk(image, "IHDR", &header[0], header.size());
+    appendChunk(image, "IDAT", &scratch[0], packedSize);
+    appendChunk(image, "IEND", NULL, 0);
+#else
+    (void)level;
+    (void)scratch;
+    char header[32];
+    int headerSize = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+    image.insert(image.end(), header, header + headerSize);
+    for (int y = height - 1; y >= 0; y--) {
+        const unsigned char* row = &rgb[y * rowBytes];
+        image.insert(image.end(), row, row + rowBytes);
+    }
+#endif
+}
+
+// Place camera at pose, with near and far planes enclosing box, and turn
+// the headlight along its view direction
+static void applyPose(SoPerspectiveCamera* camera, SoDirectionalLight* headlight,
+                      const CameraPose& pose, const SbBox3f& box)
+{
+    SbVec3f direction;
+    pose.orientation.multVec(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+    headlight->direction = direction;
+    camera->position = pose.position;
+    camera->orientation = pose.orientation;
+    camera->heightAngle = pose.heightAngle;
+    if (box.isEmpty()) {
+        return;
+    }
+    SbVec3f direction;
+    pose.orientation.multVec(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+    float radius = (box.getMax() - box.getMin()).length() * 0.5f;
+    float distance = (box.getCenter() - pose.position).dot(direction);
+    float farDistance = std::max(distance + radius, 1e-3f);
+    camera->nearDistance = std::max(distance - radius, farDistance * 1e-3f);
+    camera->farDistance = farDistance;
+    camera->focalDistance = std::max(distance, 1e-3f);
+}
+
+OffscreenRenderFarm::OffscreenRenderFarm(const SbViewportRegion& viewport, unsigned numThreads)
+    : viewport(viewport), compressionLevel(6), headlightOn(true)
+{
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0) {
+            numThreads = 1;
+        }
+    }
+    workers.resize(numThreads);
+    for (unsigned t = 0; t < numThreads; t++) {
+        Worker& worker = workers[t];
+        worker.renderer = new SoOffscreenRenderer(viewport);
+        worker.renderer->setComponents(SoOffscreenRenderer::RGB);
+        worker.root = new SoSeparator;
+        worker.root->ref();
+        worker.camera = new SoPerspectiveCamera;
+        worker.root->addChild(worker.camera);
+        worker.headlight = new SoDirectionalLight;
+        worker.root->addChild(worker.headlight);
+    }
+}
+
+OffscreenRenderFarm::~OffscreenRenderFarm()
+{
+    for (size_t t = 0; t < workers.size(); t++) {
+        delete workers[t].renderer;
+        workers[t].root->unref();
+    }
+}
+
+bool OffscreenRenderFarm::isCompressionAvailable()
+{
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* OffscreenRenderFarm::getImageExtension()
+{
+    return isCompressionAvailable() ? "png" : "ppm";
+}
+
+void OffscreenRenderFarm::setBackgroundColor(const SbColor& color)
+{
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].renderer->setBackgroundColor(color);
+    }
+}
+
+void OffscreenRenderFarm::setHeadlight(bool on)
+{
+    headlightOn = on;
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].headlight->on = on;
+    }
+}
+
+// Whether every pixel of the RGB image has the same color
+static bool isUniform(const std::vector<unsigned char>& rgb)
+{
+    for (size_t i = 3; i < rgb.size(); i++) {
+        if (rgb[i] != rgb[i % 3]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void OffscreenRenderFarm::runWorkers(SoNode* scene, size_t count,
+                                     const std::function<void(Worker&)>& work)
+{
+    // Attach the scene on this thread, so the worker threads never change
+    // the auditors of shared nodes
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].root->addChild(scene);
+    }
+
+    // Worker 0 runs on the calling thread
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < workers.size() && t < count; t++) {
+        threads.push_back(std::thread(work, std::ref(workers[t])));
+    }
+    work(workers[0]);
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].root->removeChild(scene);
+    }
+}
+
+unsigned OffscreenRenderFarm::warmUp(SoNode* scene)
+{
+    SoGetBoundingBoxAction bboxAction(viewport);
+    bboxAction.apply(scene);
+    SbBox3f box = bboxAction.getBoundingBox();
+    std::vector<CameraPose> poses = orbitPoses(scene, viewport, 1);
+
+    std::atomic<unsigned> rendered(0);
+    runWorkers(scene, workers.size(), [&](Worker& worker) {
+#ifndef COIN_THREADSAFE
+        std::lock_guard<std::mutex> lock(renderMutex);
+#endif
+        applyPose(worker.camera, worker.headlight, poses[0], box);
+        if (worker.renderer->render(worker.root)) {
+            rendered++;
+        }
+    });
+    return rendered;
+}
+
+RenderFarmStats OffscreenRenderFarm::render(SoNode* scene, const std::vector<CameraPose>& poses,
+                                            const ImageSink& sink)
+{
+    BenchTimer wallTimer;
+    RenderFarmStats stats;
+    stats.threads = (unsigned)workers.size();
+
+    SoGetBoundingBoxAction bboxAction(viewport);
+    bboxAction.apply(scene);
+    SbBox3f box = bboxAction.getBoundingBox();
+
+    SbVec2s size = viewport.getViewportSizePixels();
+    int width = size[0], height = size[1];
+    std::atomic<size_t> next(0);
+    std::mutex statsMutex;
+    auto work = [&](Worker& worker) {
+        RenderFarmStats local;
+        std::vector<unsigned char> rgb((size_t)width * height * 3), scratch, image;
+        for (size_t i = next++; i < poses.size(); i = next++) {
+            BenchTimer timer;
+            bool rendered;
+            {
+#ifndef COIN_THREADSAFE
+                std::lock_guard<std::mutex> lock(renderMutex);
+#endif
+                applyPose(worker.camera, worker.headlight, poses[i], box);
+                rendered = worker.renderer->render(worker.root) != FALSE;
+                if (rendered) {
+                    memcpy(&rgb[0], worker.renderer->getBuffer(), rgb.size());
+                }
+            }
+            local.renderSeconds += timer.seconds();
+            if (!rendered) {
+                local.failed++;
+                continue;
+            }
+
+            timer.restart();
+            encodeImage(rgb, width, height, compressionLevel, scratch, image);
+            local.encodeSeconds += timer.seconds();
+            local.images++;
+            if (isUniform(rgb)) {
+                local.uniform++;
+            }
+            local.rawBytes += rgb.size();
+            local.encodedBytes += image.size();
+            sink(i, image);
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.images += local.images;
+        stats.failed += local.failed;
+        stats.uniform += local.uniform;
+        stats.rawBytes += local.rawBytes;
+        stats.encodedBytes += local.encodedBytes;
+        stats.renderSeconds += local.renderSeconds;
+        stats.encodeSeconds += local.encodeSeconds;
+    };
+
+    runWorkers(scene, poses.size(), work);
+    stats.seconds = wallTimer.seconds();
+    return stats;
+}
+
+std::vector<CameraPose> OffscreenRenderFarm::orbitPoses(SoNode* scene,
+                                                        const SbViewportRegion& viewport,
+                                                        int count)
+{
+    SoGetBoundingBoxAction bboxAction(viewport);
+    bboxAction.apply(scene);
+    SbBox3f box = bboxAction.getBoundingBox();
+    SbVec3f center(0.0f, 0.0f, 0.0f);
+    float radius = 1.0f;
+    if (!box.isEmpty()) {
+        center = box.getCenter();
+        radius = std::max((box.getMax() - box.getMin()).length() * 0.5f, 1e-3f);
+    }
+
+    // Distance at which the bounding sphere fills the narrower view angle
+    CameraPose pose;
+    float halfAngle = pose.heightAngle * 0.5f;
+    float aspect = viewport.getViewportAspectRatio();
+    if (aspect < 1.0f) {
+        halfAngle = atanf(tanf(halfAngle) * aspect);
+    }
+    float distance = radius / sinf(halfAngle);
+
+    // Fibonacci sphere: even coverage for any count
+    std::vector<CameraPose> poses(count > 0 ? count : 0, pose);
+    const float goldenAngle = 2.39996323f;
+    SbVec3f worldUp(0.0f, 1.0f, 0.0f);
+    for (int i = 0; i < count; i++) {
+        float y = 1.0f - 2.0f * (i + 0.5f) / count;
+        float r = sqrtf(std::max(1.0f - y * y, 0.0f));
+        SbVec3f offset(r * cosf(i * goldenAngle), y, r * sinf(i * goldenAngle));
+        poses[i].position = center + offset * distance;
+
+        // Look at the center, then roll the camera's up vector towards +y
+        SbVec3f direction = -offset;
+        SbRotation look(SbVec3f(0.0f, 0.0f, -1.0f), direction);
+        SbVec3f cameraUp;
+        look.multVec(SbVec3f(0.0f, 1.0f, 0.0f), cameraUp);
+        SbVec3f wantedUp = worldUp - direction * worldUp.dot(direction);
+        if (wantedUp.length() > 1e-4f) {
+            wantedUp.normalize();
+            look *= SbRotation(cameraUp, wantedUp);
+        }
+        poses[i].orientation = look;
+    }
+    return poses;
+}
+
+#ifdef HAVE_OSMESA
+// OSMesa context with the client memory it renders into
+struct OSMesaOffscreenContext
+{
+    OSMesaContext context;
+    std::vector<unsigned char> buffer;
+    unsigned int width;
+    unsigned int height;
+};
+
+class OSMesaContextManager : public SoDB::ContextManager
+{
+public:
+    virtual void* createOffscreenContext(unsigned int width, unsigned int height)
+    {
+        OSMesaContext context = OSMesaCreateContextExt(OSMESA_RGBA, 24, 0, 0, NULL);
+        if (!context) {
+            return NULL;
+        }
+        OSMesaOffscreenContext* offscreen = new OSMesaOffscreenContext;
+        offscreen->context = context;
+        offscreen->buffer.resize((size_t)width * height * 4);
+        offscreen->width = width;
+        offscreen->height = height;
+        return offscreen;
+    }
+
+    virtual SbBool makeContextCurrent(void* context)
+    {
+        OSMesaOffscreenContext* offscreen = (OSMesaOffscreenContext*)context;
+        return OSMesaMakeCurrent(offscreen->context, &offscreen->buffer[0], GL_UNSIGNED_BYTE,
+                                 offscreen->width, offscreen->height) ? TRUE : FALSE;
+    }
+
+    virtual void restorePreviousContext(void*)
+    {
+        // Contexts are only made current around a render, so there is
+        // nothing to restore but no context at all
+        OSMesaMakeCurrent(NULL, NULL, GL_UNSIGNED_BYTE, 0, 0);
+    }
+
+    virtual void destroyContext(void* context)
+    {
+        OSMesaOffscreenContext* offscreen = (OSMesaOffscreenContext*)context;
+        OSMesaDestroyContext(offscreen->context);
+        delete offscreen;
+    }
+};
+
+SoDB::ContextManager* OffscreenRenderFarm::createOSMesaContextManager()
+{
+    return new OSMesaContextManager;
+}
+#endif
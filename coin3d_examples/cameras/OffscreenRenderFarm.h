@@ -0,0 +1,136 @@
+/*
+ * OffscreenRenderFarm
+ * Batch rendering of one scene from many camera poses on a pool of
+ * SoOffscreenRenderer contexts, with the images compressed on the worker
+ * threads and streamed to a sink as they finish
+ *
+ * Every worker owns an offscreen renderer (its GL context, created on the
+ * first image and reused for all later ones) and a private root holding its
+ * own perspective camera and headlight in front of the shared scene, so the
+ * scene itself is never modified while rendering. Poses are handed out one
+ * at a time. The headlight shines along the view direction, like a
+ * viewer's; turn it off for scenes that bring their own lights.
+ *
+ * On servers without a GPU, Coin's offscreen contexts come from the
+ * software GL the system provides (Mesa llvmpipe behind GLX, e.g. under
+ * Xvfb). When built with OSMesa (HAVE_OSMESA), createOSMesaContextManager()
+ * returns a context manager for SoDB::init() that needs no display at all.
+ *
+ * Concurrent traversal of the scene needs a Coin built with thread
+ * support (COIN_THREADSAFE); otherwise rendering is serialized and only
+ * readback and compression run in parallel.
+ */
+
+#ifndef COIN3D_EXAMPLES_OFFSCREEN_RENDER_FARM_H
+#define COIN3D_EXAMPLES_OFFSCREEN_RENDER_FARM_H
+
+#include <Inventor/SbLinear.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoDB.h>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+class SoNode;
+class SoDirectionalLight;
+class SoOffscreenRenderer;
+class SoPerspectiveCamera;
+class SoSeparator;
+
+struct CameraPose
+{
+    SbVec3f position;
+    SbRotation orientation;
+    float heightAngle;
+
+    CameraPose() : heightAngle(0.785398f) {}
+};
+
+// Statistics of one OffscreenRenderFarm::render() call
+struct RenderFarmStats
+{
+    size_t images;        // images handed to the sink
+    size_t failed;        // poses the renderer could not render
+    size_t uniform;       // images with every pixel the same color
+    size_t rawBytes;      // uncompressed RGB size of the images
+    size_t encodedBytes;  // size of the compressed images
+    unsigned threads;     // worker threads used
+    double renderSeconds; // summed over workers: render and readback
+    double encodeSeconds; // summed over workers: compression
+    double seconds;       // wall-clock time of the whole call
+
+    RenderFarmStats()
+        : images(0), failed(0), uniform(0), rawBytes(0), encodedBytes(0), threads(0),
+          renderSeconds(0.0), encodeSeconds(0.0), seconds(0.0) {}
+
+    double imagesPerSecond() const { return seconds > 0.0 ? images / seconds : 0.0; }
+};
+
+class OffscreenRenderFarm
+{
+public:
+    // Called on the worker threads, possibly concurrently, with the index
+    // of the pose and the encoded image file (PNG, or PPM without zlib)
+    typedef std::function<void(size_t pose, const std::vector<unsigned char>& image)> ImageSink;
+
+    // numThreads == 0 uses all hardware threads
+    OffscreenRenderFarm(const SbViewportRegion& viewport, unsigned numThreads = 0);
+    ~OffscreenRenderFarm();
+
+    // 0 stores the image data uncompressed, 1-9 is the zlib level
+    void setCompressionLevel(int level) { compressionLevel = level; }
+    static bool isCompressionAvailable();
+    // File extension of the images produced: "png" or "ppm"
+    static const char* getImageExtension();
+
+    void setBackgroundColor(const SbColor& color);
+    // Light along the view direction of every pose, on by default
+    void setHeadlight(bool on);
+    bool isHeadlightOn() const { return headlightOn; }
+
+    // Render scene once on every worker, each on the thread it uses in
+    // render(), so all GL contexts exist before anything is timed. Returns
+    // the number of workers that rendered.
+    unsigned warmUp(SoNode* scene);
+
+    // Render scene, which must not contain a camera of its own, once per
+    // pose. Near and far planes are fitted to the scene's bounding box.
+    RenderFarmStats render(SoNode* scene, const std::vector<CameraPose>& poses,
+                           const ImageSink& sink);
+
+    // count poses looking at the center of scene's bounding box from
+    // points spread evenly over a sphere, at a distance that fits the
+    // whole box into the view
+    static std::vector<CameraPose> orbitPoses(SoNode* scene, const SbViewportRegion& viewport,
+                                              int count);
+
+#ifdef HAVE_OSMESA
+    // A context manager for SoDB::init() creating OSMesa contexts. Owned
+    // by the caller; must outlive every offscreen renderer.
+    static SoDB::ContextManager* createOSMesaContextManager();
+#endif
+
+private:
+    struct Worker
+    {
+        SoOffscreenRenderer* renderer;
+        SoSeparator* root;
+        SoPerspectiveCamera* camera;
+        SoDirectionalLight* headlight;
+    };
+
+    // Run work once per worker, worker 0 on the calling thread and the
+    // others on threads of their own, with scene attached to every root
+    void runWorkers(SoNode* scene, size_t count, const std::function<void(Worker&)>& work);
+
+    SbViewportRegion viewport;
+    std::vector<Worker> workers;
+    int compressionLevel;
+    bool headlightOn;
+
+    OffscreenRenderFarm(const OffscreenRenderFarm&);
+    OffscreenRenderFarm& operator=(const OffscreenRenderFarm&);
+};
+
+#endif // COIN3D_EXAMPLES_OFFSCREEN_RENDER_FARM_H
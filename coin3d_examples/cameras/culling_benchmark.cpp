@@ -0,0 +1,187 @@
+/*
+ * Culling Benchmark
+ * The cameras example grid scaled up to 1000 x 1000 spheres, seen from a
+ * camera flying low over it along a scripted path. Per frame, a plain
+ * separator traverses every object; SoCullingSeparator traverses only the
+ * objects inside the view volume, and with lod also lowers the complexity
+ * of distant ones. Reports the fraction of objects culled along the path,
+ * callback traversal time, triangles per frame (SoGetPrimitiveCountAction)
+ * and optionally offscreen render time.
+ *
+ * Usage: cameras_culling_benchmark [objects per side] [frames] [--render]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShape.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ExampleScenes.h"
+#include "SoCullingSeparator.h"
+#include "BenchmarkUtils.h"
+
+struct PathResult
+{
+    double traverseMs;  // SoCallbackAction per frame
+    double triangles;   // per frame
+    double renderMs;    // per frame, < 0 if not rendered
+    double culledMin, culledAvg, culledMax; // fraction of objects culled
+};
+
+// Camera at frame of frames: flying diagonally across the grid at a
+// fixed height, weaving left and right and looking ahead and down
+static void placeCamera(SoPerspectiveCamera* camera, int frame, int frames, float extent)
+{
+    float t = frames > 1 ? (float)frame / (frames - 1) : 0.0f;
+    float along = (-0.8f + 1.6f * t) * extent;
+    float heading = (float)(M_PI / 4 + M_PI / 3 * sin(2.0 * M_PI * t));
+    float pitch = (float)(35.0 * M_PI / 180.0);
+    SbVec3f position(along, along, 15.0f);
+    SbVec3f direction(cosf(heading) * cosf(pitch), sinf(heading) * cosf(pitch), -sinf(pitch));
+    camera->position = position;
+    camera->pointAt(position + direction, SbVec3f(0.0f, 0.0f, 1.0f));
+}
+
+static SoCallbackAction::Response countShapeCB(void* data, SoCallbackAction*, const SoNode*)
+{
+    (*(int*)data)++;
+    return SoCallbackAction::CONTINUE;
+}
+
+static PathResult flyPath(SoSeparator* root, SoPerspectiveCamera* camera,
+                          SoCullingSeparator* culling, int frames, float extent,
+                          const SbViewportRegion& viewport, bool render)
+{
+    PathResult result;
+    result.traverseMs = result.triangles = 0.0;
+    result.culledMin = 1.0;
+    result.culledAvg = result.culledMax = 0.0;
+
+    SoOffscreenRenderer* renderer = render ? new SoOffscreenRenderer(viewport) : NULL;
+    double renderMs = 0.0;
+    bool rendered = render;
+    for (int frame = 0; frame < frames; frame++) {
+        placeCamera(camera, frame, frames, extent);
+
+        int shapes = 0;
+        BenchTimer timer;
+        SoCallbackAction callbackAction(viewport);
+        callbackAction.addPreCallback(SoShape::getClassTypeId(), countShapeCB, &shapes);
+        callbackAction.apply(root);
+        result.traverseMs += timer.milliseconds();
+
+        if (culling) {
+            const SoCullingSeparator::Stats& stats = culling->getLastStats();
+            double culled = stats.candidates > 0
+                                ? 1.0 - (double)stats.visible / stats.candidates
+                                : 0.0;
+            result.culledMin = std::min(result.culledMin, culled);
+            result.culledMax = std::max(result.culledMax, culled);
+            result.culledAvg += culled / frames;
+        }
+
+        SoGetPrimitiveCountAction countAction(viewport);
+        countAction.apply(root);
+        result.triangles += (double)countAction.getTriangleCount() / frames;
+
+        if (renderer && rendered) {
+            timer.restart();
+            rendered = renderer->render(root) != FALSE;
+            renderMs += timer.milliseconds();
+        }
+    }
+    if (!culling) {
+        result.culledMin = 0.0;
+    }
+    result.traverseMs /= frames;
+    result.renderMs = rendered ? renderMs / frames : -1.0;
+    delete renderer;
+    return result;
+}
+
+static void printRow(const char* name, const PathResult& r)
+{
+    printf("%-12s %12.2f %14.0f %8.1f %8.1f %8.1f ", name, r.traverseMs, r.triangles,
+           r.culledMin * 100.0, r.culledAvg * 100.0, r.culledMax * 100.0);
+    if (r.renderMs >= 0.0) {
+        printf("%10.2f\n", r.renderMs);
+    } else {
+        printf("%10s\n", "n/a");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoCullingSeparator::initClass();
+
+    int objectsPerSide = argc > 1 ? atoi(argv[1]) : 1000; // 1M spheres
+    int frames = argc > 2 ? atoi(argv[2]) : 30;
+    bool render = argc > 3 && strcmp(argv[3], "--render") == 0;
+    if (frames < 1) frames = 1;
+
+    SbViewportRegion viewport(1024, 768);
+    SoSeparator* plain = createCamerasScene(objectsPerSide);
+    plain->ref();
+    SoPerspectiveCamera* camera = (SoPerspectiveCamera*)plain->getChild(0);
+    camera->nearDistance = 0.5f;
+    camera->farDistance = 500.0f;
+    float extent = (float)(objectsPerSide - 1);
+
+    // Same camera and objects, with the objects below a culling separator
+    SoSeparator* culledRoot = new SoSeparator;
+    culledRoot->ref();
+    SoCullingSeparator* culling = new SoCullingSeparator;
+    culledRoot->addChild(camera);
+    culledRoot->addChild(culling);
+    for (int i = 1; i < plain->getNumChildren(); i++) {
+        culling->addChild(plain->getChild(i));
+    }
+
+    // The first culled traversal builds the box hierarchy
+    placeCamera(camera, 0, frames, extent);
+    BenchTimer timer;
+    SoCallbackAction buildAction(viewport);
+    buildAction.apply(culledRoot);
+    double buildMs = timer.milliseconds();
+
+    PathResult plainResult = flyPath(plain, camera, NULL, frames, extent, viewport, render);
+    culling->lod = FALSE;
+    PathResult culledResult = flyPath(culledRoot, camera, culling, frames, extent, viewport,
+                                      render);
+    culling->lod = TRUE;
+    PathResult lodResult = flyPath(culledRoot, camera, culling, frames, extent, viewport,
+                                   render);
+
+    printf("%d spheres, %d frames, hierarchy built in %.1f ms\n",
+           objectsPerSide * objectsPerSide, frames, buildMs);
+    printf("%-12s %12s %14s %8s %8s %8s %10s\n", "traversal", "traverse ms", "triangles",
+           "min %", "culled %", "max %", "render ms");
+    printRow("plain", plainResult);
+    printRow("culled", culledResult);
+    printRow("culled+lod", lodResult);
+
+    // Complexity levels chosen in the last frame
+    const SoCullingSeparator::Stats& stats = culling->getLastStats();
+    printf("\nlast frame: %d of %d objects visible, %d box tests, per level:", stats.visible,
+           stats.candidates, stats.boxTests);
+    for (size_t level = 0; level < stats.levels.size(); level++) {
+        printf(" %d", stats.levels[level]);
+    }
+    printf("\n");
+
+    culledRoot->unref();
+    plain->unref();
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Flatten Benchmark
+ * Traversal cost of the cameras example grid scaled up to ~100k objects,
+ * before and after SceneFlattener merged it into a few face sets
+ *
+ * Usage: cameras_flatten_benchmark [objects per side] [complexity] [--render]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ExampleScenes.h"
+#include "SceneFlattener.h"
+#include "BenchmarkUtils.h"
+
+struct TraversalTimes
+{
+    double bboxMs;         // first SoGetBoundingBoxAction (no caches yet)
+    double callbackMs;     // plain SoCallbackAction traversal, average
+    double pickMs;         // SoRayPickAction through the viewport center
+    double renderMs;       // SoOffscreenRenderer, < 0 if not available
+    SoPickedPoint* picked; // copy of the picked point, or NULL
+};
+
+static TraversalTimes measure(SoSeparator* root, const SbViewportRegion& viewport, bool render)
+{
+    TraversalTimes times;
+
+    BenchTimer timer;
+    SoGetBoundingBoxAction bboxAction(viewport);
+    bboxAction.apply(root);
+    times.bboxMs = timer.milliseconds();
+
+    const int repeats = 5;
+    timer.restart();
+    for (int i = 0; i < repeats; i++) {
+        SoCallbackAction callbackAction;
+        callbackAction.apply(root);
+    }
+    times.callbackMs = timer.milliseconds() / repeats;
+
+    SbVec2s size = viewport.getViewportSizePixels();
+    timer.restart();
+    SoRayPickAction pickAction(viewport);
+    pickAction.setPoint(SbVec2s(size[0] / 2, size[1] / 2));
+    pickAction.apply(root);
+    times.pickMs = timer.milliseconds();
+    SoPickedPoint* picked = pickAction.getPickedPoint();
+    times.picked = picked ? picked->copy() : NULL;
+
+    times.renderMs = -1.0;
+    if (render) {
+        SoOffscreenRenderer renderer(viewport);
+        timer.restart();
+        if (renderer.render(root)) {
+            times.renderMs = timer.milliseconds();
+        }
+    }
+    return times;
+}
+
+static void printRow(const char* name, const TraversalTimes& t)
+{
+    printf("%-10s %10.2f %12.2f %10.2f ", name, t.bboxMs, t.callbackMs, t.pickMs);
+    if (t.renderMs >= 0.0) {
+        printf("%10.2f\n", t.renderMs);
+    } else {
+        printf("%10s\n", "n/a");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int objectsPerSide = argc > 1 ? atoi(argv[1]) : 317; // 317^2 ~ 100k
+    float complexity = argc > 2 ? (float)atof(argv[2]) : 0.1f;
+    bool render = argc > 3 && strcmp(argv[3], "--render") == 0;
+
+    SbViewportRegion viewport(1024, 768);
+
+    BenchTimer timer;
+    SoSeparator* root = createCamerasScene(objectsPerSide);
+    root->ref();
+    double buildMs = timer.milliseconds();
+
+    // Frame the whole grid with the scene's own camera
+    SoPerspectiveCamera* camera = (SoPerspectiveCamera*)root->getChild(0);
+    camera->viewAll(root, viewport);
+
+    TraversalTimes before = measure(root, viewport, render);
+
+    timer.restart();
+    SceneFlattener flattener;
+    flattener.setComplexity(complexity);
+    SoSeparator* flat = flattener.flatten(root);
+    double flattenMs = timer.milliseconds();
+
+    TraversalTimes after = measure(flat, viewport, render);
+
+    printf("%d objects (build %.1f ms), flattened in %.1f ms at complexity %.2f\n",
+           objectsPerSide * objectsPerSide, buildMs, flattenMs, complexity);
+    printf("  %d source shapes -> %d merged face sets, %lu triangles, %d kept subgraphs\n",
+           flattener.getNumSourceShapes(), flattener.getNumMergedSets(),
+           (unsigned long)flattener.getNumTriangles(), flattener.getNumKeptSubgraphs());
+    printf("%-10s %10s %12s %10s %10s\n", "graph", "bbox ms", "traverse ms", "pick ms", "render ms");
+    printRow("original", before);
+    printRow("flattened", after);
+
+    // A pick on the flattened graph must map back to the same sphere
+    if (before.picked && after.picked) {
+        SoPath* source = flattener.getSourcePath(after.picked);
+        bool same = source && source->getTail() == before.picked->getPath()->getTail();
+        printf("pick mapping back to original node: %s\n", same ? "ok" : "MISMATCH");
+    }
+    delete before.picked;
+    delete after.picked;
+
+    root->unref();
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Instancing Benchmark
+ * Build time, memory and traversal time of the cameras example grid scaled
+ * up to ~1M spheres, as one SoInstancedShape compared with the
+ * Separator{Transform, Material, Sphere} node-per-object pattern
+ *
+ * Usage: cameras_instancing_benchmark [objects per side] [--render]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ExampleScenes.h"
+#include "SoInstancedShape.h"
+#include "BenchmarkUtils.h"
+
+struct PatternResult
+{
+    double buildMs;
+    size_t memoryBytes; // growth of the resident size over the build
+    double bboxMs;
+    double callbackMs;
+    double pickMs;
+    double renderMs;    // < 0 if not available
+    bool picked;
+};
+
+static PatternResult measure(bool instanced, int objectsPerSide, const SbViewportRegion& viewport,
+                             bool render)
+{
+    PatternResult result;
+
+    size_t residentBefore = currentResidentBytes();
+    BenchTimer timer;
+    SoSeparator* root = instanced ? createInstancedCamerasScene(objectsPerSide)
+                                  : createCamerasScene(objectsPerSide);
+    root->ref();
+    result.buildMs = timer.milliseconds();
+    size_t residentAfter = currentResidentBytes();
+    result.memoryBytes = residentAfter > residentBefore ? residentAfter - residentBefore : 0;
+
+    SoPerspectiveCamera* camera = (SoPerspectiveCamera*)root->getChild(0);
+    camera->viewAll(root, viewport);
+
+    timer.restart();
+    SoGetBoundingBoxAction bboxAction(viewport);
+    bboxAction.apply(root);
+    result.bboxMs = timer.milliseconds();
+
+    timer.restart();
+    SoCallbackAction callbackAction;
+    callbackAction.apply(root);
+    result.callbackMs = timer.milliseconds();
+
+    SbVec2s size = viewport.getViewportSizePixels();
+    timer.restart();
+    SoRayPickAction pickAction(viewport);
+    pickAction.setPoint(SbVec2s(size[0] / 2, size[1] / 2));
+    pickAction.apply(root);
+    result.pickMs = timer.milliseconds();
+    result.picked = pickAction.getPickedPoint() != NULL;
+
+    result.renderMs = -1.0;
+    if (render) {
+        SoOffscreenRenderer renderer(viewport);
+        timer.restart();
+        if (renderer.render(root)) {
+            result.renderMs = timer.milliseconds();
+        }
+    }
+
+    root->unref();
+    return result;
+}
+
+static void printRow(const char* name, const PatternResult& r, int count)
+{
+    printf("%-10s %10.1f %12s %10.1f %10.1f %12.1f %8.2f %5s ", name, r.buildMs,
+           formatBytes((double)r.memoryBytes).c_str(), (double)r.memoryBytes / count,
+           r.bboxMs, r.callbackMs, r.pickMs, r.picked ? "yes" : "no");
+    if (r.renderMs >= 0.0) {
+        printf("%10.1f\n", r.renderMs);
+    } else {
+        printf("%10s\n", "n/a");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoInstancedShape::initClass();
+
+    int objectsPerSide = argc > 1 ? atoi(argv[1]) : 1000; // 1M spheres
+    bool render = argc > 2 && strcmp(argv[2], "--render") == 0;
+    int count = objectsPerSide * objectsPerSide;
+
+    SbViewportRegion viewport(1024, 768);
+
+    PatternResult instanced = measure(true, objectsPerSide, viewport, render);
+    PatternResult nodes = measure(false, objectsPerSide, viewport, render);
+
+    printf("%d spheres\n", count);
+    printf("%-10s %10s %12s %10s %10s %12s %8s %5s %10s\n", "pattern", "build ms", "memory",
+           "B/object", "bbox ms", "traverse ms", "pick ms", "hit", "render ms");
+    printRow("nodes", nodes, count);
+    printRow("instanced", instanced, count);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Render Farm Benchmark
+ * Renders the cameras example grid from many viewpoints around it with
+ * OffscreenRenderFarm using 1 to N worker threads and reports images per
+ * second, the split between rendering and compression and the speedup
+ * over one thread. Each row first renders one image per worker, so
+ * context creation is not part of the timings. The scene has no light of
+ * its own and is lit by the farm's headlight; a run in which every image
+ * comes out a single color fails.
+ *
+ * With an output directory, the images of every row are written there
+ * (and overwritten by the next row).
+ *
+ * Usage: cameras_render_farm_benchmark [viewpoints] [image size] [output dir]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ExampleScenes.h"
+#include "OffscreenRenderFarm.h"
+#include "BenchmarkUtils.h"
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+#ifdef HAVE_OSMESA
+    SoDB::ContextManager* contextManager = OffscreenRenderFarm::createOSMesaContextManager();
+    SoDB::init(contextManager);
+#else
+    SoDB::init();
+#endif
+
+    int viewpoints = argc > 1 ? atoi(argv[1]) : 256;
+    int imageSize = argc > 2 ? atoi(argv[2]) : 256;
+    const char* outputDir = argc > 3 ? argv[3] : NULL;
+
+    // The farm brings its own cameras, so the example's camera is removed
+    SoSeparator* scene = createCamerasScene(20);
+    scene->ref();
+    scene->removeChild(0);
+
+    SbViewportRegion viewport((short)imageSize, (short)imageSize);
+    std::vector<CameraPose> poses = OffscreenRenderFarm::orbitPoses(scene, viewport, viewpoints);
+    const char* extension = OffscreenRenderFarm::getImageExtension();
+    OffscreenRenderFarm::ImageSink sink = [&](size_t pose,
+                                              const std::vector<unsigned char>& image) {
+        if (!outputDir) {
+            return;
+        }
+        char filename[64];
+        snprintf(filename, sizeof(filename), "/view_%04u.%s", (unsigned)pose, extension);
+        std::string path = std::string(outputDir) + filename;
+        FILE* fp = fopen(path.c_str(), "wb");
+        if (fp) {
+            fwrite(&image[0], 1, image.size(), fp);
+            fclose(fp);
+        }
+    };
+
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+
+    printf("%d viewpoints, %dx%d %s images, 400 spheres\n", viewpoints, imageSize, imageSize,
+           extension);
+    printf("%8s %10s %10s %12s %12s %10s %8s %8s\n", "threads", "time ms", "images/s",
+           "render ms", "encode ms", "image", "ratio", "speedup");
+
+    double baseline = 0.0;
+    std::vector<unsigned> counts = threadCounts(maxThreads);
+    for (size_t c = 0; c < counts.size(); c++) {
+        unsigned threads = counts[c];
+        OffscreenRenderFarm farm(viewport, threads);
+        unsigned ready = farm.warmUp(scene);
+        if (ready < threads) {
+            fprintf(stderr, "Only %u of %u workers could render\n", ready, threads);
+        }
+
+        RenderFarmStats stats = farm.render(scene, poses, sink);
+        if (stats.images == 0) {
+            fprintf(stderr, "No image could be rendered (%u failed)\n", (unsigned)stats.failed);
+            return 1;
+        }
+        if (stats.uniform == stats.images) {
+            fprintf(stderr, "All %u images are a single color\n", (unsigned)stats.images);
+            return 1;
+        }
+
+        double imagesPerSecond = stats.imagesPerSecond();
+        if (threads == 1) {
+            baseline = imagesPerSecond;
+        }
+        // Render and encode times are per image, summed over the workers
+        printf("%8u %10.1f %10.1f %12.2f %12.2f %10s %7.1fx %7.2fx\n", threads,
+               stats.seconds * 1000.0, imagesPerSecond,
+               stats.renderSeconds * 1000.0 / stats.images,
+               stats.encodeSeconds * 1000.0 / stats.images,
+               formatBytes((double)stats.encodedBytes / stats.images).c_str(),
+               (double)stats.rawBytes / stats.encodedBytes,
+               baseline > 0.0 ? imagesPerSecond / baseline : 0.0);
+    }
+
+    scene->unref();
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * Benchmark Utilities
+ * Small helpers shared by the headless benchmarks of the examples
+ * Includes: Wall-clock timer, Peak and current resident memory, Byte formatting,
+ * Thread count sweep
+ */
+
+#ifndef COIN3D_EXAMPLES_BENCHMARK_UTILS_H
+#define COIN3D_EXAMPLES_BENCHMARK_UTILS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Wall-clock stopwatch, started on construction
+class BenchTimer
+{
+public:
+    BenchTimer() : start(std::chrono::steady_clock::now()) {}
+
+    void restart() { start = std::chrono::steady_clock::now(); }
+
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double milliseconds() const { return seconds() * 1000.0; }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// Peak resident set size of this process in bytes (0 if not available)
+size_t peakResidentBytes();
+
+// Current resident set size of this process in bytes (0 if not available)
+size_t currentResidentBytes();
+
+// Human readable byte count, e.g. "12.3 MB"
+std::string formatBytes(double bytes);
+
+// Thread counts for a scaling sweep: 1, 2, 4, ... below maxThreads, then
+// maxThreads itself (e.g. 1, 2, 4, 6 for 6)
+std::vector<unsigned> threadCounts(unsigned maxThreads);
+
+#endif // COIN3D_EXAMPLES_BENCHMARK_UTILS_H
@@ -0,0 +1,154 @@
+/*
+ * DepthSorter
+ * Insertion sort repair of the previous order with a radix sort fallback
+ */
+
+#include "DepthSorter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+DepthSorter::DepthSorter()
+    : method(INCREMENTAL), jumpAngle(0.35f), shiftBudget(8.0f), lastDirection(0.0f, 0.0f, 0.0f),
+      failedAngle(-1.0f), lastFull(false), lastShifts(0), numFull(0), numIncremental(0)
+{
+}
+
+void DepthSorter::reset()
+{
+    order.clear();
+    lastDirection.setValue(0.0f, 0.0f, 0.0f);
+    failedAngle = -1.0f;
+}
+
+struct KeyLess
+{
+    const float* keys;
+    bool operator()(int a, int b) const { return keys[a] < keys[b]; }
+};
+
+const std::vector<int>& DepthSorter::sort(const float* keys, int count,
+                                         const SbVec3f& viewDirection)
+{
+    float angle = jumpAngle + 1.0f;
+    if (lastDirection.length() > 0.0f && viewDirection.length() > 0.0f) {
+        float cosine = lastDirection.dot(viewDirection) /
+                       (lastDirection.length() * viewDirection.length());
+        angle = acosf(std::min(std::max(cosine, -1.0f), 1.0f));
+    }
+    lastDirection = viewDirection;
+    lastShifts = 0;
+
+    // A repair is not tried after a jump, nor while the view keeps turning
+    // nearly as fast as when the last repair ran out of budget. A jump
+    // starts over, so the speed of a failure before it no longer counts.
+    if (angle > jumpAngle) {
+        failedAngle = -1.0f;
+    }
+    bool coherent = angle <= jumpAngle && (failedAngle < 0.0f || angle < 0.75f * failedAngle);
+    if (method == INCREMENTAL && coherent && (int)order.size() == count) {
+        if (insertionSort(keys)) {
+            failedAngle = -1.0f;
+            lastFull = false;
+            numIncremental++;
+            return order;
+        }
+        failedAngle = angle;
+    }
+
+    if ((int)order.size() != count) {
+        order.resize(count);
+        for (int i = 0; i < count; i++) {
+            order[i] = i;
+        }
+    }
+    if (method == FULL_SORT) {
+        KeyLess less = { keys };
+        std::sort(order.begin(), order.end(), less);
+    } else {
+        radixSort(keys);
+    }
+    lastFull = true;
+    numFull++;
+    return order;
+}
+
+// Repair order in place; false if the shift budget ran out, leaving order
+// a valid but unsorted permutation
+bool DepthSorter::insertionSort(const float* keys)
+{
+    int count = (int)order.size();
+    // Gather the keys once so the inner loop runs over contiguous memory
+    sortedKeys.resize(count);
+    for (int i = 0; i < count; i++) {
+        sortedKeys[i] = keys[order[i]];
+    }
+    size_t budget = (size_t)(shiftBudget * count);
+    size_t shifts = 0;
+    for (int i = 1; i < count; i++) {
+        float key = sortedKeys[i];
+        if (!(key < sortedKeys[i - 1])) {
+            continue;
+        }
+        int index = order[i];
+        int j = i;
+        do {
+            sortedKeys[j] = sortedKeys[j - 1];
+            order[j] = order[j - 1];
+            j--;
+        } while (j > 0 && key < sortedKeys[j - 1]);
+        sortedKeys[j] = key;
+        order[j] = index;
+        shifts += i - j;
+        if (shifts > budget) {
+            lastShifts = shifts;
+            return false;
+        }
+    }
+    lastShifts = shifts;
+    return true;
+}
+
+// Map a float to an unsigned integer with the same ordering
+static inline uint32_t sortableBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
+
+// Stable LSD radix sort of order by key, three passes of 11 bits
+void DepthSorter::radixSort(const float* keys)
+{
+    int count = (int)order.size();
+    radixKeys.resize(count);
+    radixKeysTemp.resize(count);
+    orderTemp.resize(count);
+    for (int i = 0; i < count; i++) {
+        radixKeys[i] = sortableBits(keys[order[i]]);
+    }
+
+    const int bits = 11;
+    const uint32_t mask = (1u << bits) - 1;
+    std::vector<int> offsets(1 << bits);
+    for (int shift = 0; shift < 32; shift += bits) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (int i = 0; i < count; i++) {
+            offsets[(radixKeys[i] >> shift) & mask]++;
+        }
+        int sum = 0;
+        for (size_t b = 0; b < offsets.size(); b++) {
+            int n = offsets[b];
+            offsets[b] = sum;
+            sum += n;
+        }
+        for (int i = 0; i < count; i++) {
+            int slot = offsets[(radixKeys[i] >> shift) & mask]++;
+            radixKeysTemp[slot] = radixKeys[i];
+            orderTemp[slot] = order[i];
+        }
+        radixKeys.swap(radixKeysTemp);
+        order.swap(orderTemp);
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * DepthSorter
+ * Back to front ordering of transparent objects that exploits frame to
+ * frame coherence
+ *
+ * Sorting every frame from scratch wastes most of its work: while the
+ * camera moves smoothly, only objects at similar depth change places. The
+ * INCREMENTAL method keeps the previous frame's order and repairs it with
+ * an insertion sort, which is linear when few objects moved. After a
+ * camera jump (view direction turned by more than the jump angle) or when
+ * the repair needs more than the shift budget, it falls back to a full LSD
+ * radix sort of the depth keys. How far objects move in the order grows
+ * with their density in depth, so a repair that ran out of budget is not
+ * tried again until the view turns clearly slower than it did then. That
+ * limit is lifted by the next successful repair or camera jump.
+ */
+
+#ifndef COIN3D_EXAMPLES_DEPTH_SORTER_H
+#define COIN3D_EXAMPLES_DEPTH_SORTER_H
+
+#include <Inventor/SbLinear.h>
+
+#include <stdint.h>
+#include <vector>
+
+class DepthSorter
+{
+public:
+    enum Method
+    {
+        FULL_SORT,    // std::sort every frame
+        RADIX_SORT,   // radix sort every frame
+        INCREMENTAL   // repair the previous order, radix sort on jumps
+    };
+
+    DepthSorter();
+
+    void setMethod(Method method) { this->method = method; }
+    Method getMethod() const { return method; }
+    // View direction change in radians above which INCREMENTAL sorts fully
+    void setJumpAngle(float radians) { jumpAngle = radians; }
+    // Element moves per object an insertion sort may make before giving up
+    void setShiftBudget(float movesPerObject) { shiftBudget = movesPerObject; }
+
+    // Order objects by ascending key, i.e. by eye space z back to front.
+    // viewDirection is the camera direction in the objects' coordinates.
+    const std::vector<int>& sort(const float* keys, int count, const SbVec3f& viewDirection);
+    const std::vector<int>& getOrder() const { return order; }
+    // Drop the previous order, the next sort is a full one
+    void reset();
+
+    // Whether the last sort() had to sort from scratch, and the number of
+    // element moves its insertion sort made
+    bool wasFullSort() const { return lastFull; }
+    size_t getLastShifts() const { return lastShifts; }
+    unsigned long getNumFullSorts() const { return numFull; }
+    unsigned long getNumIncrementalSorts() const { return numIncremental; }
+
+private:
+    bool insertionSort(const float* keys);
+    void radixSort(const float* keys);
+
+    Method method;
+    float jumpAngle;
+    float shiftBudget;
+
+    std::vector<int> order;
+    std::vector<float> sortedKeys;  // keys in the order being repaired
+    std::vector<uint32_t> radixKeys;
+    std::vector<uint32_t> radixKeysTemp;
+    std::vector<int> orderTemp;
+    SbVec3f lastDirection;
+    float failedAngle;  // view change of the last failed repair, < 0 if none
+    bool lastFull;
+    size_t lastShifts;
+    unsigned long numFull;
+    unsigned long numIncremental;
+};
+
+#endif // COIN3D_EXAMPLES_DEPTH_SORTER_H
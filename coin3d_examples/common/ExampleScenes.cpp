@@ -0,0 +1,686 @@
+/*
+ * Example Scenes
+ * Reusable scene builders shared by the examples and their benchmarks
+ */
+
+#include "ExampleScenes.h"
+#include "SoInstancedShape.h"
+
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoCone.h>
+#include <Inventor/nodes/SoCylinder.h>
+#include <Inventor/nodes/SoSwitch.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoPointLight.h>
+#include <Inventor/nodes/SoSpotLight.h>
+#include <Inventor/nodes/SoFont.h>
+#include <Inventor/nodes/SoText2.h>
+#include <Inventor/nodes/SoText3.h>
+#include <Inventor/nodes/SoSelection.h>
+#include <Inventor/engines/SoElapsedTime.h>
+#include <Inventor/engines/SoCalculator.h>
+
+#include <cmath>
+
+SoSeparator* createBasicShapesScene()
+{
+    // Create root node
+    SoSeparator* root = new SoSeparator;
+    
+    // Create a sphere
+    SoSeparator* sphereSep = new SoSeparator;
+    SoTransform* sphereTransform = new SoTransform;
+    sphereTransform->translation.setValue(-3, 0, 0);
+    SoMaterial* sphereMaterial = new SoMaterial;
+    sphereMaterial->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
+    SoSphere* sphere = new SoSphere;
+    sphere->radius = 1.0;
+    sphereSep->addChild(sphereTransform);
+    sphereSep->addChild(sphereMaterial);
+    sphereSep->addChild(sphere);
+    root->addChild(sphereSep);
+    
+    // Create a cube
+    SoSeparator* cubeSep = new SoSeparator;
+    SoTransform* cubeTransform = new SoTransform;
+    cubeTransform->translation.setValue(-1, 0, 0);
+    SoMaterial* cubeMaterial = new SoMaterial;
+    cubeMaterial->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
+    SoCube* cube = new SoCube;
+    cube->width = 1.5;
+    cube->height = 1.5;
+    cube->depth = 1.5;
+    cubeSep->addChild(cubeTransform);
+    cubeSep->addChild(cubeMaterial);
+    cubeSep->addChild(cube);
+    root->addChild(cubeSep);
+    
+    // Create a cone
+    SoSeparator* coneSep = new SoSeparator;
+    SoTransform* coneTransform = new SoTransform;
+    coneTransform->translation.setValue(1, 0, 0);
+    SoMaterial* coneMaterial = new SoMaterial;
+    coneMaterial->diffuseColor.setValue(0.0, 0.0, 1.0); // Blue
+    SoCone* cone = new SoCone;
+    cone->bottomRadius = 0.8;
+    cone->height = 2.0;
+    coneSep->addChild(coneTransform);
+    coneSep->addChild(coneMaterial);
+    coneSep->addChild(cone);
+    root->addChild(coneSep);
+    
+    // Create a cylinder
+    SoSeparator* cylinderSep = new SoSeparator;
+    SoTransform* cylinderTransform = new SoTransform;
+    cylinderTransform->translation.setValue(3, 0, 0);
+    SoMaterial* cylinderMaterial = new SoMaterial;
+    cylinderMaterial->diffuseColor.setValue(1.0, 1.0, 0.0); // Yellow
+    SoCylinder* cylinder = new SoCylinder;
+    cylinder->radius = 0.6;
+    cylinder->height = 2.0;
+    cylinderSep->addChild(cylinderTransform);
+    cylinderSep->addChild(cylinderMaterial);
+    cylinderSep->addChild(cylinder);
+    root->addChild(cylinderSep);
+    
+    return root;
+}
+
+SoSeparator* createSceneGraphScene()
+{
+    // Create root separator (top of scene graph)
+    SoSeparator* root = new SoSeparator;
+    
+    // Create first branch - parent node with children
+    SoSeparator* branch1 = new SoSeparator;
+    SoTransform* transform1 = new SoTransform;
+    transform1->translation.setValue(-2, 0, 0);
+    SoMaterial* material1 = new SoMaterial;
+    material1->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
+    SoSphere* sphere1 = new SoSphere;
+    sphere1->radius = 0.8;
+    branch1->addChild(transform1);
+    branch1->addChild(material1);
+    branch1->addChild(sphere1);
+    
+    // Create second branch - demonstrates grouping
+    SoSeparator* branch2 = new SoSeparator;
+    SoTransform* transform2 = new SoTransform;
+    transform2->translation.setValue(0, 0, 0);
+    SoMaterial* material2 = new SoMaterial;
+    material2->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
+    SoCube* cube = new SoCube;
+    cube->width = 1.2;
+    cube->height = 1.2;
+    cube->depth = 1.2;
+    branch2->addChild(transform2);
+    branch2->addChild(material2);
+    branch2->addChild(cube);
+    
+    // Create third branch with switch node (can toggle visibility)
+    SoSwitch* switchNode = new SoSwitch;
+    switchNode->whichChild.setValue(SO_SWITCH_ALL); // Show all children
+    SoSeparator* branch3 = new SoSeparator;
+    SoTransform* transform3 = new SoTransform;
+    transform3->translation.setValue(2, 0, 0);
+    SoMaterial* material3 = new SoMaterial;
+    material3->diffuseColor.setValue(0.0, 0.0, 1.0); // Blue
+    SoSphere* sphere2 = new SoSphere;
+    sphere2->radius = 0.8;
+    branch3->addChild(transform3);
+    branch3->addChild(material3);
+    branch3->addChild(sphere2);
+    switchNode->addChild(branch3);
+    
+    // Add all branches to root (building the scene graph)
+    root->addChild(branch1);
+    root->addChild(branch2);
+    root->addChild(switchNode);
+    
+    return root;
+}
+
+SoSeparator* createTransformationsScene()
+{
+    // Create root node
+    SoSeparator* root = new SoSeparator;
+    
+    // Original cube (no transformation)
+    SoSeparator* originalSep = new SoSeparator;
+    SoMaterial* originalMaterial = new SoMaterial;
+    originalMaterial->diffuseColor.setValue(0.5, 0.5, 0.5); // Gray
+    SoCube* originalCube = new SoCube;
+    originalCube->width = 1.0;
+    originalCube->height = 1.0;
+    originalCube->depth = 1.0;
+    originalSep->addChild(originalMaterial);
+    originalSep->addChild(originalCube);
+    root->addChild(originalSep);
+    
+    // Translation example
+    SoSeparator* translatedSep = new SoSeparator;
+    SoTransform* translationTransform = new SoTransform;
+    translationTransform->translation.setValue(2.5, 0, 0);
+    SoMaterial* translatedMaterial = new SoMaterial;
+    translatedMaterial->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
+    SoCube* translatedCube = new SoCube;
+    translatedCube->width = 1.0;
+    translatedCube->height = 1.0;
+    translatedCube->depth = 1.0;
+    translatedSep->addChild(translationTransform);
+    translatedSep->addChild(translatedMaterial);
+    translatedSep->addChild(translatedCube);
+    root->addChild(translatedSep);
+    
+    // Rotation example
+    SoSeparator* rotatedSep = new SoSeparator;
+    SoTransform* rotationTransform = new SoTransform;
+    rotationTransform->translation.setValue(0, 2.5, 0);
+    rotationTransform->rotation.setValue(SbVec3f(0, 0, 1), M_PI / 4); // 45 degrees around Z axis
+    SoMaterial* rotatedMaterial = new SoMaterial;
+    rotatedMaterial->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
+    SoCube* rotatedCube = new SoCube;
+    rotatedCube->width = 1.0;
+    rotatedCube->height = 1.0;
+    rotatedCube->depth = 1.0;
+    rotatedSep->addChild(rotationTransform);
+    rotatedSep->addChild(rotatedMaterial);
+    rotatedSep->addChild(rotatedCube);
+    root->addChild(rotatedSep);
+    
+    // Scale example
+    SoSeparator* scaledSep = new SoSeparator;
+    SoTransform* scaleTransform = new SoTransform;
+    scaleTransform->translation.setValue(-2.5, 0, 0);
+    scaleTransform->scaleFactor.setValue(0.5, 1.5, 1.0); // Non-uniform scale
+    SoMaterial* scaledMaterial = new SoMaterial;
+    scaledMaterial->diffuseColor.setValue(0.0, 0.0, 1.0); // Blue
+    SoCube* scaledCube = new SoCube;
+    scaledCube->width = 1.0;
+    scaledCube->height = 1.0;
+    scaledCube->depth = 1.0;
+    scaledSep->addChild(scaleTransform);
+    scaledSep->addChild(scaledMaterial);
+    scaledSep->addChild(scaledCube);
+    root->addChild(scaledSep);
+    
+    // Combined transformations example
+    SoSeparator* combinedSep = new SoSeparator;
+    SoTransform* combinedTransform = new SoTransform;
+    combinedTransform->translation.setValue(0, -2.5, 0);
+    combinedTransform->rotation.setValue(SbVec3f(1, 1, 0), M_PI / 6); // Rotation around (1,1,0)
+    combinedTransform->scaleFactor.setValue(1.2, 1.2, 1.2);
+    SoMaterial* combinedMaterial = new SoMaterial;
+    combinedMaterial->diffuseColor.setValue(1.0, 1.0, 0.0); // Yellow
+    SoCube* combinedCube = new SoCube;
+    combinedCube->width = 1.0;
+    combinedCube->height = 1.0;
+    combinedCube->depth = 1.0;
+    combinedSep->addChild(combinedTransform);
+    combinedSep->addChild(combinedMaterial);
+    combinedSep->addChild(combinedCube);
+    root->addChild(combinedSep);
+    
+    return root;
+}
+
+SoSeparator* createMaterialsScene()
+{
+    // Create root node
+    SoSeparator* root = new SoSeparator;
+    
+    // Add a light source for better material visualization
+    SoDirectionalLight* light = new SoDirectionalLight;
+    light->direction.setValue(0, 0, -1);
+    root->addChild(light);
+    
+    // Material with diffuse color only
+    SoSeparator* diffuseSep = new SoSeparator;
+    SoTransform* diffuseTransform = new SoTransform;
+    diffuseTransform->translation.setValue(-3, 1, 0);
+    SoMaterial* diffuseMaterial = new SoMaterial;
+    diffuseMaterial->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
+    SoSphere* diffuseSphere = new SoSphere;
+    diffuseSphere->radius = 0.7;
+    diffuseSep->addChild(diffuseTransform);
+    diffuseSep->addChild(diffuseMaterial);
+    diffuseSep->addChild(diffuseSphere);
+    root->addChild(diffuseSep);
+    
+    // Material with specular highlights
+    SoSeparator* specularSep = new SoSeparator;
+    SoTransform* specularTransform = new SoTransform;
+    specularTransform->translation.setValue(-1, 1, 0);
+    SoMaterial* specularMaterial = new SoMaterial;
+    specularMaterial->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
+    specularMaterial->specularColor.setValue(1.0, 1.0, 1.0); // White specular
+    specularMaterial->shininess = 0.9; // High shininess
+    SoSphere* specularSphere = new SoSphere;
+    specularSphere->radius = 0.7;
+    specularSep->addChild(specularTransform);
+    specularSep->addChild(specularMaterial);
+    specularSep->addChild(specularSphere);
+    root->addChild(specularSep);
+    
+    // Material with emissive color (self-illuminated)
+    SoSeparator* emissiveSep = new SoSeparator;
+    SoTransform* emissiveTransform = new SoTransform;
+    emissiveTransform->translation.setValue(1, 1, 0);
+    SoMaterial* emissiveMaterial = new SoMaterial;
+    emissiveMaterial->diffuseColor.setValue(0.0, 0.0, 1.0); // Blue
+    emissiveMaterial->emissiveColor.setValue(0.3, 0.3, 1.0); // Blue glow
+    SoSphere* emissiveSphere = new SoSphere;
+    emissiveSphere->radius = 0.7;
+    emissiveSep->addChild(emissiveTransform);
+    emissiveSep->addChild(emissiveMaterial);
+    emissiveSep->addChild(emissiveSphere);
+    root->addChild(emissiveSep);
+    
+    // Material with transparency
+    SoSeparator* transparentSep = new SoSeparator;
+    SoTransform* transparentTransform = new SoTransform;
+    transparentTransform->translation.setValue(3, 1, 0);
+    SoMaterial* transparentMaterial = new SoMaterial;
+    transparentMaterial->diffuseColor.setValue(1.0, 1.0, 0.0); // Yellow
+    transparentMaterial->transparency = 0.5; // 50% transparent
+    SoSphere* transparentSphere = new SoSphere;
+    transparentSphere->radius = 0.7;
+    transparentSep->addChild(transparentTransform);
+    transparentSep->addChild(transparentMaterial);
+    transparentSep->addChild(transparentSphere);
+    root->addChild(transparentSep);
+    
+    // Complex material (combining multiple properties)
+    SoSeparator* complexSep = new SoSeparator;
+    SoTransform* complexTransform = new SoTransform;
+    complexTransform->translation.setValue(0, -1, 0);
+    SoMaterial* complexMaterial = new SoMaterial;
+    complexMaterial->ambientColor.setValue(0.2, 0.0, 0.2); // Dark purple ambient
+    complexMaterial->diffuseColor.setValue(0.8, 0.0, 0.8); // Purple
+    complexMaterial->specularColor.setValue(1.0, 1.0, 1.0); // White specular
+    complexMaterial->emissiveColor.setValue(0.1, 0.0, 0.1); // Slight glow
+    complexMaterial->shininess = 0.7;
+    complexMaterial->transparency = 0.2;
+    SoSphere* complexSphere = new SoSphere;
+    complexSphere->radius = 0.7;
+    complexSep->addChild(complexTransform);
+    complexSep->addChild(complexMaterial);
+    complexSep->addChild(complexSphere);
+    root->addChild(complexSep);
+    
+    return root;
+}
+
+SoSeparator* createLightingScene()
+{
+    // Create root node
+    SoSeparator* root = new SoSeparator;
+    
+    // Directional Light Example
+    SoSeparator* directionalSep = new SoSeparator;
+    SoDirectionalLight* directionalLight = new SoDirectionalLight;
+    directionalLight->direction.setValue(0, -1, -1); // Light direction
+    directionalLight->color.setValue(1.0, 1.0, 1.0); // White light
+    directionalLight->intensity = 1.0;
+    SoTransform* directionalTransform = new SoTransform;
+    directionalTransform->translation.setValue(-3, 0, 0);
+    SoMaterial* directionalMaterial = new SoMaterial;
+    directionalMaterial->diffuseColor.setValue(0.8, 0.2, 0.2); // Red
+    SoSphere* directionalSphere = new SoSphere;
+    directionalSphere->radius = 0.8;
+    directionalSep->addChild(directionalLight);
+    directionalSep->addChild(directionalTransform);
+    directionalSep->addChild(directionalMaterial);
+    directionalSep->addChild(directionalSphere);
+    root->addChild(directionalSep);
+    
+    // Point Light Example
+    SoSeparator* pointSep = new SoSeparator;
+    SoPointLight* pointLight = new SoPointLight;
+    pointLight->location.setValue(0, 2, 0); // Light position
+    pointLight->color.setValue(0.0, 1.0, 0.0); // Green light
+    pointLight->intensity = 0.8;
+    SoTransform* pointTransform = new SoTransform;
+    pointTransform->translation.setValue(0, 0, 0);
+    SoMaterial* pointMaterial = new SoMaterial;
+    pointMaterial->diffuseColor.setValue(0.8, 0.8, 0.8); // Gray
+    SoSphere* pointSphere = new SoSphere;
+    pointSphere->radius = 0.8;
+    pointSep->addChild(pointLight);
+    pointSep->addChild(pointTransform);
+    pointSep->addChild(pointMaterial);
+    pointSep->addChild(pointSphere);
+    root->addChild(pointSep);
+    
+    // Spot Light Example
+    SoSeparator* spotSep = new SoSeparator;
+    SoSpotLight* spotLight = new SoSpotLight;
+    spotLight->location.setValue(3, 3, 3); // Light position
+    spotLight->direction.setValue(0, -1, -1); // Light direction
+    spotLight->color.setValue(1.0, 1.0, 0.0); // Yellow light
+    spotLight->intensity = 1.0;
+    spotLight->cutOffAngle = 0.5; // Spot angle
+    SoTransform* spotTransform = new SoTransform;
+    spotTransform->translation.setValue(3, 0, 0);
+    SoMaterial* spotMaterial = new SoMaterial;
+    spotMaterial->diffuseColor.setValue(0.2, 0.2, 0.8); // Blue
+    SoSphere* spotSphere = new SoSphere;
+    spotSphere->radius = 0.8;
+    spotSep->addChild(spotLight);
+    spotSep->addChild(spotTransform);
+    spotSep->addChild(spotMaterial);
+    spotSep->addChild(spotSphere);
+    root->addChild(spotSep);
+    
+    // Additional sphere to show lighting effects
+    SoSeparator* referenceSep = new SoSeparator;
+    SoTransform* referenceTransform = new SoTransform;
+    referenceTransform->translation.setValue(0, -2, 0);
+    SoMaterial* referenceMaterial = new SoMaterial;
+    referenceMaterial->diffuseColor.setValue(0.5, 0.5, 0.5); // Gray
+    referenceMaterial->specularColor.setValue(1.0, 1.0, 1.0); // White specular
+    referenceMaterial->shininess = 0.9;
+    SoSphere* referenceSphere = new SoSphere;
+    referenceSphere->radius = 1.0;
+    referenceSep->addChild(referenceTransform);
+    referenceSep->addChild(referenceMaterial);
+    referenceSep->addChild(referenceSphere);
+    root->addChild(referenceSep);
+    
+    return root;
+}
+
+SoSeparator* createTextScene()
+{
+    // Create root node
+    SoSeparator* root = new SoSeparator;
+    
+    // 2D Text Example
+    SoSeparator* text2dSep = new SoSeparator;
+    SoTransform* text2dTransform = new SoTransform;
+    text2dTransform->translation.setValue(0, 2, 0);
+    SoMaterial* text2dMaterial = new SoMaterial;
+    text2dMaterial->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
+    SoFont* text2dFont = new SoFont;
+    text2dFont->size = 1.0;
+    SoText2* text2d = new SoText2;
+    text2d->string.set1Value(0, "2D Text in Coin3D");
+    text2dSep->addChild(text2dTransform);
+    text2dSep->addChild(text2dMaterial);
+    text2dSep->addChild(text2dFont);
+    text2dSep->addChild(text2d);
+    root->addChild(text2dSep);
+    
+    // 3D Text Example
+    SoSeparator* text3dSep = new SoSeparator;
+    SoTransform* text3dTransform = new SoTransform;
+    text3dTransform->translation.setValue(0, 0, 0);
+    SoMaterial* text3dMaterial = new SoMaterial;
+    text3dMaterial->diffuseColor.setValue(0.0, 0.0, 1.0); // Blue
+    SoFont* text3dFont = new SoFont;
+    text3dFont->size = 0.8;
+    SoText3* text3d = new SoText3;
+    text3d->string.set1Value(0, "3D Text");
+    text3d->parts.setValue(SoText3::ALL);
+    text3dSep->addChild(text3dTransform);
+    text3dSep->addChild(text3dMaterial);
+    text3dSep->addChild(text3dFont);
+    text3dSep->addChild(text3d);
+    root->addChild(text3dSep);
+    
+    // Multiple lines of text
+    SoSeparator* multilineSep = new SoSeparator;
+    SoTransform* multilineTransform = new SoTransform;
+    multilineTransform->translation.setValue(0, -2, 0);
+    SoMaterial* multilineMaterial = new SoMaterial;
+    multilineMaterial->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
+    SoFont* multilineFont = new SoFont;
+    multilineFont->size = 0.5;
+    SoText2* multilineText = new SoText2;
+    multilineText->string.set1Value(0, "Line 1");
+    multilineText->string.set1Value(1, "Line 2");
+    multilineText->string.set1Value(2, "Line 3");
+    multilineSep->addChild(multilineTransform);
+    multilineSep->addChild(multilineMaterial);
+    multilineSep->addChild(multilineFont);
+    multilineSep->addChild(multilineText);
+    root->addChild(multilineSep);
+    
+    return root;
+}
+
+SoSelection* createEventsScene()
+{
+    // Create root node with selection capability
+    SoSelection* root = new SoSelection;
+    root->policy = SoSelection::SINGLE; // Allow single selection
+    
+    // Create interactive objects
+    SoSeparator* sphere1Sep = new SoSeparator;
+    SoTransform* sphere1Transform = new SoTransform;
+    sphere1Transform->translation.setValue(-2, 0, 0);
+    SoMaterial* sphere1Material = new SoMaterial;
+    sphere1Material->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
+    SoSphere* sphere1 = new SoSphere;
+    sphere1->radius = 0.8;
+    sphere1Sep->addChild(sphere1Transform);
+    sphere1Sep->addChild(sphere1Material);
+    sphere1Sep->addChild(sphere1);
+    root->addChild(sphere1Sep);
+    
+    SoSeparator* cubeSep = new SoSeparator;
+    SoTransform* cubeTransform = new SoTransform;
+    cubeTransform->translation.setValue(0, 0, 0);
+    SoMaterial* cubeMaterial = new SoMaterial;
+    cubeMaterial->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
+    SoCube* cube = new SoCube;
+    cube->width = 1.5;
+    cube->height = 1.5;
+    cube->depth = 1.5;
+    cubeSep->addChild(cubeTransform);
+    cubeSep->addChild(cubeMaterial);
+    cubeSep->addChild(cube);
+    root->addChild(cubeSep);
+    
+    SoSeparator* sphere2Sep = new SoSeparator;
+    SoTransform* sphere2Transform = new SoTransform;
+    sphere2Transform->translation.setValue(2, 0, 0);
+    SoMaterial* sphere2Material = new SoMaterial;
+    sphere2Material->diffuseColor.setValue(0.0, 0.0, 1.0); // Blue
+    SoSphere* sphere2 = new SoSphere;
+    sphere2->radius = 0.8;
+    sphere2Sep->addChild(sphere2Transform);
+    sphere2Sep->addChild(sphere2Material);
+    sphere2Sep->addChild(sphere2);
+    root->addChild(sphere2Sep);
+    
+    return root;
+}
+
+// Camera shared by the cameras example scenes
+static SoPerspectiveCamera* createCamerasCamera()
+{
+    SoPerspectiveCamera* camera = new SoPerspectiveCamera;
+    camera->position.setValue(0, 0, 10); // Camera position
+    camera->orientation.setValue(SbVec3f(0, 1, 0), 0); // Camera orientation
+    camera->heightAngle = M_PI / 4; // 45 degree field of view
+    camera->nearDistance = 1.0;
+    camera->farDistance = 100.0;
+    return camera;
+}
+
+SoSeparator* createCamerasScene(int objectsPerSide)
+{
+    SoSeparator* root = new SoSeparator;
+    
+    // Add a perspective camera to the scene graph
+    root->addChild(createCamerasCamera());
+    
+    // Create some objects to view
+    float half = (objectsPerSide - 1) / 2.0f;
+    float steps = objectsPerSide > 1 ? (float)(objectsPerSide - 1) : 1.0f;
+    for (int i = 0; i < objectsPerSide; i++) {
+        for (int j = 0; j < objectsPerSide; j++) {
+            SoSeparator* objSep = new SoSeparator;
+            SoTransform* transform = new SoTransform;
+            transform->translation.setValue((i - half) * 2.0, (j - half) * 2.0, 0);
+            
+            SoMaterial* material = new SoMaterial;
+            float r = i / steps;
+            float g = j / steps;
+            float b = 0.5;
+            material->diffuseColor.setValue(r, g, b);
+            
+            SoSphere* sphere = new SoSphere;
+            sphere->radius = 0.5;
+            
+            objSep->addChild(transform);
+            objSep->addChild(material);
+            objSep->addChild(sphere);
+            root->addChild(objSep);
+        }
+    }
+    
+    return root;
+}
+
+SoSeparator* createInstancedCamerasScene(int objectsPerSide)
+{
+    SoSeparator* root = new SoSeparator;
+    root->addChild(createCamerasCamera());
+    
+    SoSphere* sphere = new SoSphere;
+    sphere->radius = 0.5;
+    
+    SoInstancedShape* instances = new SoInstancedShape;
+    instances->shape = sphere;
+    
+    // Fill the packed arrays directly instead of one set1Value() per instance
+    int count = objectsPerSide * objectsPerSide;
+    instances->instanceMatrix.setNum(count);
+    instances->instanceColor.setNum(count);
+    SbMatrix* matrices = instances->instanceMatrix.startEditing();
+    uint32_t* colors = instances->instanceColor.startEditing();
+    
+    float half = (objectsPerSide - 1) / 2.0f;
+    float steps = objectsPerSide > 1 ? (float)(objectsPerSide - 1) : 1.0f;
+    for (int i = 0; i < objectsPerSide; i++) {
+        for (int j = 0; j < objectsPerSide; j++) {
+            int index = i * objectsPerSide + j;
+            matrices[index].setTranslate(SbVec3f((i - half) * 2.0f, (j - half) * 2.0f, 0));
+            
+            SbColor color(i / steps, j / steps, 0.5f);
+            colors[index] = color.getPackedValue();
+        }
+    }
+    
+    instances->instanceColor.finishEditing();
+    instances->instanceMatrix.finishEditing();
+    root->addChild(instances);
+    
+    return root;
+}
+
+SoSeparator* createAnimationScene()
+{
+    // Create root node
+    SoSeparator* root = new SoSeparator;
+    
+    // Create time source for animations
+    SoElapsedTime* timer = new SoElapsedTime;
+    
+    // Rotating sphere
+    SoSeparator* rotatingSep = new SoSeparator;
+    SoTransform* rotatingTransform = new SoTransform;
+    rotatingTransform->translation.setValue(-3, 0, 0);
+    
+    // Connect timer to rotation
+    SoCalculator* rotationCalc = new SoCalculator;
+    rotationCalc->a.connectFrom(&timer->timeOut);
+    rotationCalc->expression = "oA = vec3f(0, 1, 0); oB = a * 2.0"; // Rotate around Y axis
+    rotatingTransform->rotation.connectFrom(&rotationCalc->oA);
+    
+    SoMaterial* rotatingMaterial = new SoMaterial;
+    rotatingMaterial->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
+    SoSphere* rotatingSphere = new SoSphere;
+    rotatingSphere->radius = 0.8;
+    rotatingSep->addChild(rotatingTransform);
+    rotatingSep->addChild(rotatingMaterial);
+    rotatingSep->addChild(rotatingSphere);
+    root->addChild(rotatingSep);
+    
+    // Oscillating cube (moving up and down)
+    SoSeparator* oscillatingSep = new SoSeparator;
+    SoTransform* oscillatingTransform = new SoTransform;
+    
+    // Connect timer to translation
+    SoCalculator* translationCalc = new SoCalculator;
+    translationCalc->a.connectFrom(&timer->timeOut);
+    translationCalc->expression = "oA = vec3f(0, sin(a * 3.0) * 2.0, 0)";
+    oscillatingTransform->translation.connectFrom(&translationCalc->oA);
+    
+    SoMaterial* oscillatingMaterial = new SoMaterial;
+    oscillatingMaterial->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
+    SoCube* oscillatingCube = new SoCube;
+    oscillatingCube->width = 1.2;
+    oscillatingCube->height = 1.2;
+    oscillatingCube->depth = 1.2;
+    oscillatingSep->addChild(oscillatingTransform);
+    oscillatingSep->addChild(oscillatingMaterial);
+    oscillatingSep->addChild(oscillatingCube);
+    root->addChild(oscillatingSep);
+    
+    // Scaling sphere
+    SoSeparator* scalingSep = new SoSeparator;
+    SoTransform* scalingTransform = new SoTransform;
+    scalingTransform->translation.setValue(3, 0, 0);
+    
+    // Connect timer to scale
+    SoCalculator* scaleCalc = new SoCalculator;
+    scaleCalc->a.connectFrom(&timer->timeOut);
+    scaleCalc->expression = "ta = abs(sin(a * 2.0)) * 0.5 + 0.5; oA = vec3f(ta, ta, ta)";
+    scalingTransform->scaleFactor.connectFrom(&scaleCalc->oA);
+    
+    SoMaterial* scalingMaterial = new SoMaterial;
+    scalingMaterial->diffuseColor.setValue(0.0, 0.0, 1.0); // Blue
+    SoSphere* scalingSphere = new SoSphere;
+    scalingSphere->radius = 0.8;
+    scalingSep->addChild(scalingTransform);
+    scalingSep->addChild(scalingMaterial);
+    scalingSep->addChild(scalingSphere);
+    root->addChild(scalingSep);
+    
+    // Combined animation - rotation + translation
+    SoSeparator* combinedSep = new SoSeparator;
+    SoTransform* combinedTransform = new SoTransform;
+    
+    // Translation in circular pattern
+    SoCalculator* circularCalc = new SoCalculator;
+    circularCalc->a.connectFrom(&timer->timeOut);
+    circularCalc->expression = "oA = vec3f(cos(a) * 2.0, sin(a) * 2.0, 0)";
+    combinedTransform->translation.connectFrom(&circularCalc->oA);
+    
+    // Rotation
+    SoCalculator* combinedRotCalc = new SoCalculator;
+    combinedRotCalc->a.connectFrom(&timer->timeOut);
+    combinedRotCalc->expression = "oA = vec3f(0, 0, 1); oB = a * 3.0";
+    combinedTransform->rotation.connectFrom(&combinedRotCalc->oA);
+    
+    SoMaterial* combinedMaterial = new SoMaterial;
+    combinedMaterial->diffuseColor.setValue(1.0, 1.0, 0.0); // Yellow
+    SoCube* combinedCube = new SoCube;
+    combinedCube->width = 0.8;
+    combinedCube->height = 0.8;
+    combinedCube->depth = 0.8;
+    combinedSep->addChild(combinedTransform);
+    combinedSep->addChild(combinedMaterial);
+    combinedSep->addChild(combinedCube);
+    root->addChild(combinedSep);
+    
+    return root;
+}
@@ -0,0 +1,57 @@
+/*
+ * Example Scenes
+ * Reusable scene builders shared by the examples and their benchmarks
+ */
+
+#ifndef COIN3D_EXAMPLES_EXAMPLE_SCENES_H
+#define COIN3D_EXAMPLES_EXAMPLE_SCENES_H
+
+class SoSeparator;
+class SoSelection;
+
+// Scenes of the examples, one builder per example. The examples show
+// them in a viewer; coin3d_benchmarks measures them headless.
+
+// Basic shapes example: sphere, cube, cone and cylinder side by side
+SoSeparator* createBasicShapesScene();
+
+// Scene graph example: two separator branches and a third one below an
+// SoSwitch showing all of its children
+SoSeparator* createSceneGraphScene();
+
+// Transformations example: an untransformed cube and cubes translated,
+// rotated, scaled and transformed with all three combined
+SoSeparator* createTransformationsScene();
+
+// Materials example: a directional light and spheres with diffuse,
+// specular, emissive, transparent and combined materials
+SoSeparator* createMaterialsScene();
+
+// Lighting example: spheres lit by a directional, a point and a spot
+// light (each scoped to its own separator) and an unlit reference sphere
+SoSeparator* createLightingScene();
+
+// Text example: a line of SoText2, a line of SoText3 with all parts and
+// three lines of SoText2, each with its own font size and color
+SoSeparator* createTextScene();
+
+// Events example: an SoSelection (single selection policy) holding two
+// spheres and a cube. The example adds its callbacks to it.
+SoSelection* createEventsScene();
+
+// Cameras example scene: a perspective camera followed by a grid of
+// objectsPerSide x objectsPerSide Separator{Transform, Material, Sphere}
+// objects, spaced 2 units apart and centered on the origin. The example
+// itself uses a 5 x 5 grid.
+SoSeparator* createCamerasScene(int objectsPerSide = 5);
+
+// Same camera and grid, but all spheres are instances of a single
+// SoInstancedShape (SoInstancedShape::initClass() must have been called)
+SoSeparator* createInstancedCamerasScene(int objectsPerSide = 5);
+
+// Animation example scene: a rotating sphere, an oscillating cube, a
+// scaling sphere and a cube moving on a circle while rotating, each
+// driven by SoCalculator engines from one SoElapsedTime on realTime
+SoSeparator* createAnimationScene();
+
+#endif // COIN3D_EXAMPLES_EXAMPLE_SCENES_H
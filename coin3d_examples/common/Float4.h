@@ -0,0 +1,147 @@
+/*
+ * Float4
+ * Four-lane float vector for the SIMD kernels of the examples; SSE2 where
+ * available, plain arrays otherwise
+ */
+
+#ifndef COIN3D_EXAMPLES_FLOAT4_H
+#define COIN3D_EXAMPLES_FLOAT4_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLOAT4_SSE
+#endif
+
+#include <cmath>
+#include <stdint.h>
+
+struct Float4
+{
+#ifdef FLOAT4_SSE
+    __m128 v;
+
+    Float4() {}
+    Float4(__m128 v) : v(v) {}
+    explicit Float4(float s) : v(_mm_set1_ps(s)) {}
+
+    static Float4 load(const float* p) { return _mm_loadu_ps(p); }
+    // Four 16 bit integers, converted
+    static Float4 loadInt16(const int16_t* p)
+    {
+        __m128i v = _mm_loadl_epi64((const __m128i*)p);
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+    }
+    static Float4 loadUint16(const uint16_t* p)
+    {
+        __m128i v = _mm_loadl_epi64((const __m128i*)p);
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+    }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    friend Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+    friend Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+    friend Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+    friend Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+    friend Float4 min4(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+    friend Float4 max4(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+    // Nearest integer, ties to even
+    friend Float4 round4(Float4 a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)); }
+    friend Float4 sqrt4(Float4 a) { return _mm_sqrt_ps(a.v); }
+    // 1 or -1 with the sign of a
+    friend Float4 sign4(Float4 a)
+    {
+        return _mm_or_ps(_mm_and_ps(a.v, _mm_set1_ps(-0.0f)), _mm_set1_ps(1.0f));
+    }
+    // Bit i is set where lane i of a < b / a <= b
+    friend int lessMask(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+    friend int lessEqualMask(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmple_ps(a.v, b.v)); }
+#else
+    float v[4];
+
+    Float4() {}
+    explicit Float4(float s) { v[0] = v[1] = v[2] = v[3] = s; }
+
+    static Float4 load(const float* p)
+    {
+        Float4 r;
+        for (int i = 0; i < 4; i++) r.v[i] = p[i];
+        return r;
+    }
+    static Float4 loadInt16(const int16_t* p)
+    {
+        Float4 r;
+        for (int i = 0; i < 4; i++) r.v[i] = (float)p[i];
+        return r;
+    }
+    static Float4 loadUint16(const uint16_t* p)
+    {
+        Float4 r;
+        for (int i = 0; i < 4; i++) r.v[i] = (float)p[i];
+        return r;
+    }
+    void store(float* p) const
+    {
+        for (int i = 0; i < 4; i++) p[i] = v[i];
+    }
+
+    friend Float4 operator+(Float4 a, Float4 b)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] += b.v[i];
+        return a;
+    }
+    friend Float4 operator-(Float4 a, Float4 b)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] -= b.v[i];
+        return a;
+    }
+    friend Float4 operator*(Float4 a, Float4 b)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] *= b.v[i];
+        return a;
+    }
+    friend Float4 operator/(Float4 a, Float4 b)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] /= b.v[i];
+        return a;
+    }
+    friend Float4 min4(Float4 a, Float4 b)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+    friend Float4 max4(Float4 a, Float4 b)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+    friend Float4 round4(Float4 a)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] = std::nearbyint(a.v[i]);
+        return a;
+    }
+    friend Float4 sqrt4(Float4 a)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] = std::sqrt(a.v[i]);
+        return a;
+    }
+    friend Float4 sign4(Float4 a)
+    {
+        for (int i = 0; i < 4; i++) a.v[i] = std::copysign(1.0f, a.v[i]);
+        return a;
+    }
+    friend int lessMask(Float4 a, Float4 b)
+    {
+        int mask = 0;
+        for (int i = 0; i < 4; i++) mask |= (a.v[i] < b.v[i]) << i;
+        return mask;
+    }
+    friend int lessEqualMask(Float4 a, Float4 b)
+    {
+        int mask = 0;
+        for (int i = 0; i < 4; i++) mask |= (a.v[i] <= b.v[i]) << i;
+        return mask;
+    }
+#endif
+};
+
+#endif // COIN3D_EXAMPLES_FLOAT4_H
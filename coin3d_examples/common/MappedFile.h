@@ -0,0 +1,36 @@
+/*
+ * MappedFile
+ * Read-only memory mapping of a whole file
+ */
+
+#ifndef COIN3D_EXAMPLES_MAPPED_FILE_H
+#define COIN3D_EXAMPLES_MAPPED_FILE_H
+
+#include <cstddef>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const char* filename);
+    void close();
+
+    bool isOpen() const { return data != NULL; }
+    const void* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const void* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+#endif // COIN3D_EXAMPLES_MAPPED_FILE_H
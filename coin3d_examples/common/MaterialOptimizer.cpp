@@ -0,0 +1,147 @@
+/*
+ * Material Optimizer
+ * Value keyed material sharing and a callback action state change counter
+ */
+
+#include "MaterialOptimizer.h"
+
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/elements/SoLazyElement.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoShape.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+// All values of a material, each field prefixed by its ignore flag and
+// number of values
+static void appendColors(std::vector<float>& key, const SoMFColor& field)
+{
+    key.push_back(field.isIgnored() ? 1.0f : 0.0f);
+    key.push_back((float)field.getNum());
+    for (int i = 0; i < field.getNum(); i++) {
+        const float* rgb = field[i].getValue();
+        key.insert(key.end(), rgb, rgb + 3);
+    }
+}
+
+static void appendFloats(std::vector<float>& key, const SoMFFloat& field)
+{
+    key.push_back(field.isIgnored() ? 1.0f : 0.0f);
+    key.push_back((float)field.getNum());
+    key.insert(key.end(), field.getValues(0), field.getValues(0) + field.getNum());
+}
+
+static bool hasConnection(SoMaterial* material)
+{
+    return material->ambientColor.isConnected() || material->diffuseColor.isConnected() ||
+           material->specularColor.isConnected() || material->emissiveColor.isConnected() ||
+           material->shininess.isConnected() || material->transparency.isConnected();
+}
+
+MaterialDedupStats deduplicateMaterials(SoNode* root)
+{
+    MaterialDedupStats stats;
+
+    SoSearchAction search;
+    search.setType(SoMaterial::getClassTypeId());
+    search.setInterest(SoSearchAction::ALL);
+    search.setSearchingAll(TRUE);
+    search.apply(root);
+    const SoPathList& paths = search.getPaths();
+
+    std::map<std::vector<float>, SoMaterial*> shared;
+    std::set<SoMaterial*> seen;
+    for (int i = 0; i < paths.getLength(); i++) {
+        SoPath* path = paths[i];
+        SoMaterial* material = (SoMaterial*)path->getTail();
+        bool first = seen.insert(material).second;
+        if (first) {
+            stats.materials++;
+        }
+        if (material->getName().getLength() > 0 || hasConnection(material)) {
+            stats.skipped += first ? 1 : 0;
+            continue;
+        }
+
+        std::vector<float> key;
+        key.push_back(material->isOverride() ? 1.0f : 0.0f);
+        appendColors(key, material->ambientColor);
+        appendColors(key, material->diffuseColor);
+        appendColors(key, material->specularColor);
+        appendColors(key, material->emissiveColor);
+        appendFloats(key, material->shininess);
+        appendFloats(key, material->transparency);
+
+        std::map<std::vector<float>, SoMaterial*>::iterator it = shared.find(key);
+        if (it == shared.end()) {
+            shared[key] = material;
+            stats.unique++;
+            continue;
+        }
+        if (it->second == material || path->getLength() < 2) {
+            continue;
+        }
+        SoNode* parent = path->getNodeFromTail(1);
+        if (!parent->isOfType(SoGroup::getClassTypeId())) {
+            continue;
+        }
+        ((SoGroup*)parent)->replaceChild(path->getIndexFromTail(0), it->second);
+        stats.replaced++;
+    }
+    return stats;
+}
+
+struct StateChangeCounter
+{
+    StateChangeCounts counts;
+    uint32_t lastNodeId;
+    SbColor last[4];
+    float lastShininess;
+    float lastTransparency;
+};
+
+static SoCallbackAction::Response countShapeCB(void* data, SoCallbackAction* action,
+                                               const SoNode*)
+{
+    StateChangeCounter* counter = (StateChangeCounter*)data;
+    SbColor ambient, diffuse, specular, emission;
+    float shininess, transparency;
+    action->getMaterial(ambient, diffuse, specular, emission, shininess, transparency);
+    uint32_t nodeId = SoLazyElement::getDiffuseNodeId(action->getState());
+
+    bool first = counter->counts.shapes == 0;
+    if (first || nodeId != counter->lastNodeId) {
+        counter->counts.nodeSwitches++;
+    }
+    if (first || ambient != counter->last[0] || diffuse != counter->last[1] ||
+        specular != counter->last[2] || emission != counter->last[3] ||
+        shininess != counter->lastShininess || transparency != counter->lastTransparency) {
+        counter->counts.valueChanges++;
+    }
+    counter->counts.shapes++;
+    counter->lastNodeId = nodeId;
+    counter->last[0] = ambient;
+    counter->last[1] = diffuse;
+    counter->last[2] = specular;
+    counter->last[3] = emission;
+    counter->lastShininess = shininess;
+    counter->lastTransparency = transparency;
+    return SoCallbackAction::CONTINUE;
+}
+
+StateChangeCounts countStateChanges(SoNode* root)
+{
+    StateChangeCounter counter;
+    counter.lastNodeId = 0;
+    counter.lastShininess = counter.lastTransparency = 0.0f;
+    SoCallbackAction action;
+    action.addPreCallback(SoShape::getClassTypeId(), countShapeCB, &counter);
+    action.apply(root);
+    return counter.counts;
+}
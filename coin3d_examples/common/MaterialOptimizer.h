@@ -0,0 +1,48 @@
+/*
+ * Material Optimizer
+ * Deduplication of identical SoMaterial nodes and headless counting of the
+ * material state changes a render traversal causes
+ *
+ * Coin's GL lazy element tracks the diffuse color by the id of the node it
+ * came from, so two material nodes with the same values still cost a full
+ * state change when shapes alternate between them. Sharing one node per
+ * distinct value removes these; SoSortedSeparator then groups the shapes
+ * using the same node.
+ */
+
+#ifndef COIN3D_EXAMPLES_MATERIAL_OPTIMIZER_H
+#define COIN3D_EXAMPLES_MATERIAL_OPTIMIZER_H
+
+class SoNode;
+
+struct MaterialDedupStats
+{
+    int materials;  // SoMaterial nodes found, counting shared ones once
+    int unique;     // distinct values among them
+    int replaced;   // group children redirected to a shared instance
+    int skipped;    // left alone: named or with connected fields
+
+    MaterialDedupStats() : materials(0), unique(0), replaced(0), skipped(0) {}
+};
+
+// Replace every SoMaterial below root that equals an earlier one in all
+// field values and ignore flags by that earlier node. Materials with a
+// name or a connected field are kept, as something may refer to them.
+MaterialDedupStats deduplicateMaterials(SoNode* root);
+
+// State changes of one traversal, in rendering order (SoSortedSeparator
+// reorders its children for SoCallbackAction as for rendering)
+struct StateChangeCounts
+{
+    int shapes;          // shapes traversed
+    int nodeSwitches;    // shapes whose material came from another node
+                         // than the previous shape's: what GL is sent
+    int valueChanges;    // shapes whose material values differ from the
+                         // previous shape's: the lower bound
+
+    StateChangeCounts() : shapes(0), nodeSwitches(0), valueChanges(0) {}
+};
+
+StateChangeCounts countStateChanges(SoNode* root);
+
+#endif // COIN3D_EXAMPLES_MATERIAL_OPTIMIZER_H
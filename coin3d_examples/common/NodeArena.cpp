@@ -0,0 +1,104 @@
+/*
+ * NodeArena
+ * Block allocation and release of the node arena
+ */
+
+#include "NodeArena.h"
+
+#include <new>
+
+// Every allocation is preceded by a header naming its arena (NULL for heap
+// allocations); 16 bytes keep the object aligned like operator new does
+static const size_t headerSize = 16;
+
+static thread_local NodeArena* currentArena = NULL;
+static std::atomic<size_t> liveArenas(0);
+
+NodeArena::Scope::Scope(size_t blockSize)
+    : arena(new NodeArena(blockSize)), previous(currentArena)
+{
+    currentArena = arena;
+}
+
+NodeArena::Scope::~Scope()
+{
+    currentArena = previous;
+    // Drop the scope's reference; the arena goes away with its last node
+    arena->release();
+}
+
+NodeArena::NodeArena(size_t blockSize)
+    : cursor(NULL), end(NULL), blockSize(blockSize), bytesUsed(0), references(1)
+{
+    liveArenas++;
+}
+
+NodeArena::~NodeArena()
+{
+    for (size_t i = 0; i < blocks.size(); i++) {
+        ::operator delete(blocks[i]);
+    }
+    liveArenas--;
+}
+
+size_t NodeArena::getNumLiveArenas()
+{
+    return liveArenas;
+}
+
+void* NodeArena::allocateFromBlocks(size_t size)
+{
+    size = (size + headerSize - 1) / headerSize * headerSize;
+    if (size > blockSize / 4) {
+        // Large objects get a block of their own, the current one stays open
+        char* block = (char*)::operator new(size);
+        blocks.push_back(block);
+        bytesUsed += size;
+        return block;
+    }
+    if (cursor == NULL || (size_t)(end - cursor) < size) {
+        cursor = (char*)::operator new(blockSize);
+        end = cursor + blockSize;
+        blocks.push_back(cursor);
+    }
+    char* result = cursor;
+    cursor += size;
+    bytesUsed += size;
+    return result;
+}
+
+void NodeArena::release()
+{
+    if (--references == 0) {
+        delete this;
+    }
+}
+
+void* NodeArena::allocate(size_t size)
+{
+    NodeArena* arena = currentArena;
+    char* memory;
+    if (arena) {
+        memory = (char*)arena->allocateFromBlocks(headerSize + size);
+        arena->references++;
+    } else {
+        memory = (char*)::operator new(headerSize + size);
+    }
+    *(NodeArena**)memory = arena;
+    return memory + headerSize;
+}
+
+void NodeArena::deallocate(void* ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    char* memory = (char*)ptr - headerSize;
+    NodeArena* arena = *(NodeArena**)memory;
+    if (arena) {
+        // Individual nodes are never reused, only the arena as a whole
+        arena->release();
+    } else {
+        ::operator delete(memory);
+    }
+}
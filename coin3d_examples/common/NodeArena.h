@@ -0,0 +1,76 @@
+/*
+ * NodeArena
+ * Opt-in bump allocator for bulk scene graph construction
+ *
+ * Nodes created as Pooled<T> (e.g. new Pooled<SoSeparator>) while a
+ * NodeArena::Scope is active on the thread are carved out of large shared
+ * blocks instead of one heap allocation each, so procedurally generated
+ * graphs are built with little malloc traffic and end up contiguous in
+ * memory. Fields of these nodes are members and live in the same block.
+ * The arena outlives its scope and releases all blocks at once when the
+ * last of its nodes is destroyed, i.e. when the root's reference count
+ * drops to zero. Outside a scope Pooled<T> falls back to the heap.
+ */
+
+#ifndef COIN3D_EXAMPLES_NODE_ARENA_H
+#define COIN3D_EXAMPLES_NODE_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+class NodeArena
+{
+public:
+    // Makes a fresh arena current on this thread for its lifetime
+    class Scope
+    {
+    public:
+        explicit Scope(size_t blockSize = 1 << 20);
+        ~Scope();
+
+        NodeArena* getArena() const { return arena; }
+
+    private:
+        NodeArena* arena;
+        NodeArena* previous;
+    };
+
+    // Allocate from the current arena, or from the heap without one
+    static void* allocate(size_t size);
+    static void deallocate(void* ptr);
+
+    size_t getNumBlocks() const { return blocks.size(); }
+    size_t getBytesUsed() const { return bytesUsed; }
+
+    // Arenas that still own memory (open scopes or live nodes)
+    static size_t getNumLiveArenas();
+
+private:
+    explicit NodeArena(size_t blockSize);
+    ~NodeArena();
+
+    void* allocateFromBlocks(size_t size);
+    void release();
+
+    std::vector<char*> blocks;
+    char* cursor;
+    char* end;
+    size_t blockSize;
+    size_t bytesUsed;
+    // Live objects, plus one while the scope is open
+    std::atomic<size_t> references;
+};
+
+// Node type whose instances are allocated through NodeArena
+template <class T>
+class Pooled : public T
+{
+public:
+    using T::T;
+
+    static void* operator new(size_t size) { return NodeArena::allocate(size); }
+    static void operator delete(void* ptr) { NodeArena::deallocate(ptr); }
+};
+
+#endif // COIN3D_EXAMPLES_NODE_ARENA_H
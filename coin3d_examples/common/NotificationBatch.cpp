@@ -0,0 +1,137 @@
+/*
+ * NotificationBatch
+ * Held-back notifications and their coalescing along shared paths
+ */
+
+#include "NotificationBatch.h"
+
+#include <Inventor/lists/SoAuditorList.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/nodes/SoNode.h>
+
+#include <map>
+#include <set>
+
+unsigned long NotificationBatch::totalSaved = 0;
+const std::vector<NotificationBatch::Edit>* NotificationBatch::committing = NULL;
+
+// The only parent of node, or NULL if it has none or several
+static SoNode* singleParent(SoNode* node)
+{
+    const SoAuditorList& auditors = node->getAuditors();
+    SoNode* parent = NULL;
+    for (int i = 0; i < auditors.getLength(); i++) {
+        if (auditors.getType(i) == SoNotRec::PARENT) {
+            if (parent) {
+                return NULL;
+            }
+            parent = (SoNode*)auditors.getObject(i);
+        }
+    }
+    return parent;
+}
+
+NotificationBatch::NotificationBatch()
+    : numEdits(0), numNotifications(0), numReportedSaved(0)
+{
+}
+
+NotificationBatch::~NotificationBatch()
+{
+    commit();
+}
+
+void NotificationBatch::hold(SoFieldContainer* container, SoField* field)
+{
+    // Engines and other containers notify as usual
+    if (!container || !container->isOfType(SoNode::getClassTypeId())) {
+        numNotifications++;
+        return;
+    }
+    // A node that is already held, by this batch or an outer one, is
+    // left alone, so each node is recorded once
+    if (container->enableNotify(FALSE)) {
+        container->ref();
+        Edit edit = { (SoNode*)container, field };
+        pending.push_back(edit);
+    }
+}
+
+void NotificationBatch::commit()
+{
+    std::map<SoNode*, SoField*> fieldOf;
+    std::set<SoNode*> mergedNodes;
+    std::vector<SoNode*> level;
+    for (size_t i = 0; i < pending.size(); i++) {
+        pending[i].node->enableNotify(TRUE);
+        fieldOf[pending[i].node] = pending[i].field;
+        level.push_back(pending[i].node);
+    }
+    const std::vector<Edit>* outer = committing;
+    committing = &pending;
+
+    // Replace groups of pending siblings by their parent until no two
+    // pending nodes share one
+    for (bool merged = true; merged;) {
+        std::map<SoNode*, std::vector<SoNode*> > children;
+        for (size_t i = 0; i < level.size(); i++) {
+            SoNode* parent = singleParent(level[i]);
+            if (parent) {
+                children[parent].push_back(level[i]);
+            }
+        }
+
+        std::vector<SoNode*> next;
+        std::set<SoNode*> inNext;
+        merged = false;
+        for (size_t i = 0; i < level.size(); i++) {
+            SoNode* parent = singleParent(level[i]);
+            SoNode* node = level[i];
+            if (parent && children[parent].size() >= 2) {
+                node = parent;
+                mergedNodes.insert(parent);
+                merged = true;
+            }
+            if (inNext.insert(node).second) {
+                next.push_back(node);
+            }
+        }
+
+        // The children still invalidate their own caches, but stop at the
+        // parent, which notifies for them later
+        std::map<SoNode*, std::vector<SoNode*> >::iterator it;
+        for (it = children.begin(); it != children.end(); ++it) {
+            if (it->second.size() < 2) {
+                continue;
+            }
+            SbBool wasEnabled = it->first->enableNotify(FALSE);
+            for (size_t i = 0; i < it->second.size(); i++) {
+                it->second[i]->touch();
+            }
+            it->first->enableNotify(wasEnabled);
+        }
+        level.swap(next);
+    }
+
+    // Edited nodes notify through their field, merged ancestors as a whole
+    for (size_t i = 0; i < level.size(); i++) {
+        std::map<SoNode*, SoField*>::iterator it = fieldOf.find(level[i]);
+        if (it != fieldOf.end() && it->second && !mergedNodes.count(level[i])) {
+            it->second->touch();
+        } else {
+            level[i]->touch();
+        }
+    }
+    numNotifications += level.size();
+    committing = outer;
+
+    for (size_t i = 0; i < pending.size(); i++) {
+        pending[i].node->unref();
+    }
+    pending.clear();
+
+    if (getNumSaved() > numReportedSaved) {
+        totalSaved += getNumSaved() - numReportedSaved;
+        numReportedSaved = getNumSaved();
+    }
+}
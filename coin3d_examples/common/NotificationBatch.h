@@ -0,0 +1,100 @@
+/*
+ * NotificationBatch
+ * Scoped transaction that coalesces the notifications of bulk field edits
+ *
+ * Every setValue() normally sends a notification from the node up to the
+ * root, invalidating caches and scheduling sensors on the way. Inside a
+ * batch, fields are edited through edit(), which disables notification of
+ * the field's node until commit. Commit touches every edited node once,
+ * whatever the number of its edited fields, and merges the paths of edited
+ * siblings: when two or more pending nodes have the same single parent,
+ * they are touched with the parent's notification disabled, so each still
+ * invalidates its own caches, and the parent takes their place. This
+ * repeats upwards, so edits all over a subtree end in one notification
+ * from their closest common ancestor.
+ *
+ * A node that is not merged notifies through its first edited field, so
+ * sensors see that node and field as the trigger. Sensors above a merged
+ * path see the ancestor with no trigger field, as after a structural
+ * change; immediate sensors can ask getCommittingEdits() for the nodes and
+ * fields behind it instead of treating it as one. Notifications of
+ * connected fields are not held back. Batches nest; a node already held
+ * by an outer batch is left to it.
+ *
+ *   {
+ *       NotificationBatch batch;
+ *       batch.edit(transform->translation).setValue(x, y, z);
+ *       batch.edit(material->diffuseColor) = color;
+ *   } // commit
+ */
+
+#ifndef COIN3D_EXAMPLES_NOTIFICATION_BATCH_H
+#define COIN3D_EXAMPLES_NOTIFICATION_BATCH_H
+
+#include <Inventor/fields/SoField.h>
+
+#include <vector>
+
+class SoNode;
+
+class NotificationBatch
+{
+public:
+    NotificationBatch();
+    // Commits
+    ~NotificationBatch();
+
+    // Hold back notification of field's node and return field for editing
+    template <class Field>
+    Field& edit(Field& field)
+    {
+        hold(field.getContainer(), &field);
+        numEdits++;
+        return field;
+    }
+
+    // Hold back notification of node, for edits made directly on it
+    void suspend(SoFieldContainer* container) { hold(container, NULL); }
+
+    // Send the coalesced notifications; the batch can be reused after
+    void commit();
+
+    // Counters of this batch, since construction
+    unsigned long getNumEdits() const { return numEdits; }
+    unsigned long getNumNotifications() const { return numNotifications; }
+    unsigned long getNumSaved() const
+    {
+        return numEdits > numNotifications ? numEdits - numNotifications : 0;
+    }
+
+    // Notifications saved by all batches so far
+    static unsigned long getTotalSaved() { return totalSaved; }
+
+    // A node held by a batch and the field first edited on it, NULL if it
+    // was only suspended (its edit may be structural)
+    struct Edit
+    {
+        SoNode* node;
+        SoField* field;
+    };
+
+    // The edits of the batch whose commit is notifying right now, NULL
+    // outside of commits. Lets immediate sensors resolve a merged trigger.
+    static const std::vector<Edit>* getCommittingEdits() { return committing; }
+
+private:
+    void hold(SoFieldContainer* container, SoField* field);
+
+    std::vector<Edit> pending;
+    unsigned long numEdits;
+    unsigned long numNotifications;
+    unsigned long numReportedSaved;
+
+    static unsigned long totalSaved;
+    static const std::vector<Edit>* committing;
+
+    NotificationBatch(const NotificationBatch&);
+    NotificationBatch& operator=(const NotificationBatch&);
+};
+
+#endif // COIN3D_EXAMPLES_NOTIFICATION_BATCH_H
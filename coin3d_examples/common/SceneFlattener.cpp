@@ -0,0 +1,474 @@
+/*
+ * Scene Flattener
+ * Bakes static transforms and merges shapes into per-material face sets
+ */
+
+#include "SceneFlattener.h"
+
+#include <Inventor/SoPath.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/SbColor.h>
+#include <Inventor/details/SoFaceDetail.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/lists/SoFieldList.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoComplexity.h>
+#include <Inventor/nodes/SoDrawStyle.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoIndexedLineSet.h>
+#include <Inventor/nodes/SoLight.h>
+#include <Inventor/nodes/SoLightModel.h>
+#include <Inventor/nodes/SoLineSet.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoMaterialBinding.h>
+#include <Inventor/nodes/SoMatrixTransform.h>
+#include <Inventor/nodes/SoPointSet.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoShapeHints.h>
+#include <Inventor/nodes/SoText2.h>
+#include <Inventor/nodes/SoTexture2.h>
+#include <Inventor/nodes/SoTexture3.h>
+#include <Inventor/nodes/SoTextureCoordinate2.h>
+#include <Inventor/nodes/SoTextureCoordinate3.h>
+#include <Inventor/nodes/SoTextureCoordinateFunction.h>
+#include <Inventor/nodes/SoVertexProperty.h>
+#include <Inventor/nodes/SoVertexShape.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+bool SceneFlattener::MaterialKey::operator<(const MaterialKey& other) const
+{
+    if (segment != other.segment) {
+        return segment < other.segment;
+    }
+    return memcmp(values, other.values, sizeof(values)) < 0;
+}
+
+bool SceneFlattener::MaterialKey::operator==(const MaterialKey& other) const
+{
+    return segment == other.segment && memcmp(values, other.values, sizeof(values)) == 0;
+}
+
+bool SceneFlattener::VertexKey::operator==(const VertexKey& other) const
+{
+    return bucket == other.bucket && memcmp(values, other.values, sizeof(values)) == 0;
+}
+
+size_t SceneFlattener::VertexKeyHash::operator()(const VertexKey& key) const
+{
+    size_t hash = std::hash<const void*>()(key.bucket);
+    for (int i = 0; i < 6; i++) {
+        uint32_t bits;
+        memcpy(&bits, &key.values[i], sizeof(bits));
+        hash = hash * 31 + bits;
+    }
+    return hash;
+}
+
+SceneFlattener::SceneFlattener()
+    : complexity(0.2f), result(NULL), numKept(0), lastBucket(NULL), segment(0),
+      flipWinding(false)
+{
+}
+
+SceneFlattener::~SceneFlattener()
+{
+    clear();
+}
+
+void SceneFlattener::clear()
+{
+    if (result) {
+        result->unref();
+        result = NULL;
+    }
+    for (size_t i = 0; i < sources.size(); i++) {
+        sources[i]->unref();
+    }
+    sources.clear();
+    for (size_t i = 0; i < buckets.size(); i++) {
+        delete buckets[i];
+    }
+    buckets.clear();
+    bucketMap.clear();
+    for (size_t i = 0; i < keptChildren.size(); i++) {
+        if (keptChildren[i].material) {
+            keptChildren[i].material->unref();
+        }
+    }
+    keptChildren.clear();
+    keptSet.clear();
+    childSegment.clear();
+    lastBucket = NULL;
+    numKept = 0;
+}
+
+size_t SceneFlattener::getNumTriangles() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        count += buckets[i]->faceSources.size();
+    }
+    return count;
+}
+
+// Material bindings that interpolate colors over a face, which one color
+// per merged face cannot reproduce
+static bool isPerVertexBinding(int binding)
+{
+    return binding == SoMaterialBinding::PER_VERTEX ||
+           binding == SoMaterialBinding::PER_VERTEX_INDEXED;
+}
+
+// A subgraph is kept as is if baking it would change what it does: cameras
+// and lights affect everything after them, SoText2 is screen aligned, lines
+// and points produce no triangles, the merged face sets carry neither
+// texture coordinates, draw styles, shape hints, light models nor
+// per-vertex colors, and connected fields (engines, other fields) animate
+// their node.
+bool SceneFlattener::mustKeep(SoNode* node) const
+{
+    if (node->isOfType(SoCamera::getClassTypeId()) ||
+        node->isOfType(SoLight::getClassTypeId()) ||
+        node->isOfType(SoText2::getClassTypeId()) ||
+        node->isOfType(SoLineSet::getClassTypeId()) ||
+        node->isOfType(SoIndexedLineSet::getClassTypeId()) ||
+        node->isOfType(SoPointSet::getClassTypeId()) ||
+        node->isOfType(SoTexture2::getClassTypeId()) ||
+        node->isOfType(SoTexture3::getClassTypeId()) ||
+        node->isOfType(SoTextureCoordinate2::getClassTypeId()) ||
+        node->isOfType(SoTextureCoordinate3::getClassTypeId()) ||
+        node->isOfType(SoTextureCoordinateFunction::getClassTypeId()) ||
+        node->isOfType(SoDrawStyle::getClassTypeId()) ||
+        node->isOfType(SoShapeHints::getClassTypeId()) ||
+        node->isOfType(SoLightModel::getClassTypeId())) {
+        return true;
+    }
+    if (node->isOfType(SoMaterialBinding::getClassTypeId()) &&
+        isPerVertexBinding(((SoMaterialBinding*)node)->value.getValue())) {
+        return true;
+    }
+    if (node->isOfType(SoVertexShape::getClassTypeId())) {
+        SoNode* property = ((SoVertexShape*)node)->vertexProperty.getValue();
+        if (property && property->isOfType(SoVertexProperty::getClassTypeId())) {
+            SoVertexProperty* vertexProperty = (SoVertexProperty*)property;
+            if (vertexProperty->texCoord.getNum() > 0 ||
+                vertexProperty->texCoord3.getNum() > 0 ||
+                (vertexProperty->orderedRGBA.getNum() > 1 &&
+                 isPerVertexBinding(vertexProperty->materialBinding.getValue()))) {
+                return true;
+            }
+        }
+    }
+
+    SoFieldList fields;
+    int numFields = node->getFields(fields);
+    for (int i = 0; i < numFields; i++) {
+        if (fields[i]->isConnected()) {
+            return true;
+        }
+    }
+
+    SoChildList* children = node->getChildren();
+    if (children) {
+        for (int i = 0; i < children->getLength(); i++) {
+            if (mustKeep((*children)[i])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+SceneFlattener::Bucket* SceneFlattener::findBucket(const MaterialKey& key)
+{
+    // Consecutive faces nearly always share their state
+    if (lastBucket && lastBucket->key == key) {
+        return lastBucket;
+    }
+    std::map<MaterialKey, Bucket*>::iterator it = bucketMap.find(key);
+    if (it == bucketMap.end()) {
+        Bucket* bucket = new Bucket;
+        bucket->key = key;
+        bucket->faceSet = NULL;
+        it = bucketMap.insert(std::make_pair(key, bucket)).first;
+        buckets.push_back(bucket);
+    }
+    lastBucket = it->second;
+    return lastBucket;
+}
+
+int32_t SceneFlattener::addVertex(Bucket* bucket, const SoPrimitiveVertex* vertex)
+{
+    SbVec3f point, normal;
+    modelMatrix.multVecMatrix(vertex->getPoint(), point);
+    normalMatrix.multDirMatrix(vertex->getNormal(), normal);
+    normal.normalize();
+
+    VertexKey key;
+    key.bucket = bucket;
+    for (int i = 0; i < 3; i++) {
+        key.values[i] = point[i];
+        key.values[3 + i] = normal[i];
+    }
+    std::unordered_map<VertexKey, int32_t, VertexKeyHash>::iterator it = shapeVertices.find(key);
+    if (it != shapeVertices.end()) {
+        return it->second;
+    }
+
+    int32_t index = (int32_t)bucket->vertices.size();
+    bucket->vertices.push_back(point);
+    bucket->normals.push_back(normal);
+    shapeVertices.insert(std::make_pair(key, index));
+    return index;
+}
+
+SoCallbackAction::Response SceneFlattener::preNodeCB(void* data, SoCallbackAction* action,
+                                                     const SoNode* node)
+{
+    SceneFlattener* self = (SceneFlattener*)data;
+    // Kept subgraphs are direct children of the root: wrapper, root, child
+    const SoPath* path = action->getCurPath();
+    if (path->getLength() != 3 || !self->keptSet.count(node)) {
+        return SoCallbackAction::CONTINUE;
+    }
+
+    // Record the state the baked siblings in front leave for the child
+    KeptChild& kept = self->keptChildren[self->childSegment[path->getIndex(2)]];
+    kept.matrix = action->getModelMatrix();
+    SbColor ambient, diffuse, specular, emission;
+    float shininess, transparency;
+    action->getMaterial(ambient, diffuse, specular, emission, shininess, transparency);
+    SoMaterial* material = new SoMaterial;
+    material->ref();
+    if (ambient != material->ambientColor[0] || diffuse != material->diffuseColor[0] ||
+        specular != material->specularColor[0] || emission != material->emissiveColor[0] ||
+        shininess != material->shininess[0] || transparency != material->transparency[0]) {
+        material->ambientColor.setValue(ambient);
+        material->diffuseColor.setValue(diffuse);
+        material->specularColor.setValue(specular);
+        material->emissiveColor.setValue(emission);
+        material->shininess = shininess;
+        material->transparency = transparency;
+        if (kept.material) {
+            kept.material->unref();
+        }
+        kept.material = material;
+    } else {
+        material->unref();
+    }
+    return SoCallbackAction::PRUNE;
+}
+
+SoCallbackAction::Response SceneFlattener::preShapeCB(void* data, SoCallbackAction* action,
+                                                      const SoNode* node)
+{
+    SceneFlattener* self = (SceneFlattener*)data;
+
+    // Remember where the shape came from, without the complexity wrapper
+    SoPath* path = action->getCurPath()->copy(1);
+    path->ref();
+    self->sources.push_back(path);
+    // Faces go to the buckets of the run of top-level children they are in
+    self->segment = 0;
+    if (!self->childSegment.empty() && action->getCurPath()->getLength() > 2) {
+        self->segment = self->childSegment[action->getCurPath()->getIndex(2)];
+    }
+
+    self->modelMatrix = action->getModelMatrix();
+    self->normalMatrix = self->modelMatrix.inverse().transpose();
+    self->flipWinding = self->modelMatrix.det3() < 0.0f;
+    self->shapeVertices.clear();
+    return SoCallbackAction::CONTINUE;
+}
+
+void SceneFlattener::triangleCB(void* data, SoCallbackAction* action, const SoPrimitiveVertex* v1,
+                                const SoPrimitiveVertex* v2, const SoPrimitiveVertex* v3)
+{
+    SceneFlattener* self = (SceneFlattener*)data;
+
+    SbColor ambient, diffuse, specular, emission;
+    float shininess, transparency;
+    action->getMaterial(ambient, diffuse, specular, emission, shininess, transparency,
+                        v1->getMaterialIndex());
+
+    MaterialKey key;
+    key.segment = self->segment;
+    for (int i = 0; i < 3; i++) {
+        key.values[i] = ambient[i];
+        key.values[3 + i] = specular[i];
+        key.values[6 + i] = emission[i];
+    }
+    key.values[9] = shininess;
+    key.values[10] = transparency;
+    Bucket* bucket = self->findBucket(key);
+
+    // A mirroring transform turns the triangle inside out
+    if (self->flipWinding) {
+        std::swap(v2, v3);
+    }
+    bucket->coordIndex.push_back(self->addVertex(bucket, v1));
+    bucket->coordIndex.push_back(self->addVertex(bucket, v2));
+    bucket->coordIndex.push_back(self->addVertex(bucket, v3));
+    bucket->coordIndex.push_back(-1);
+    bucket->colors.push_back(diffuse.getPackedValue(transparency));
+    bucket->faceSources.push_back((int)self->sources.size() - 1);
+}
+
+// The kept child in its original place; separators and shapes get the
+// state of the baked siblings in front of them, anything else stays bare
+// so it keeps affecting what follows
+static void addKeptChild(SoSeparator* result, SoNode* node, const SbMatrix& matrix,
+                         SoMaterial* material)
+{
+    bool identity = matrix == SbMatrix::identity();
+    if ((identity && !material) || (!node->isOfType(SoSeparator::getClassTypeId()) &&
+                                     !node->isOfType(SoShape::getClassTypeId()))) {
+        result->addChild(node);
+        return;
+    }
+    SoSeparator* sep = new SoSeparator;
+    if (!identity) {
+        SoMatrixTransform* transform = new SoMatrixTransform;
+        transform->matrix = matrix;
+        sep->addChild(transform);
+    }
+    if (material) {
+        sep->addChild(material);
+    }
+    sep->addChild(node);
+    result->addChild(sep);
+}
+
+// One Separator{Material, IndexedFaceSet} per bucket, with the kept
+// children in between in their original order
+void SceneFlattener::buildResult()
+{
+    // Buckets were created in traversal order, so a segment's buckets are
+    // sorted after the ones of earlier segments
+    std::vector<Bucket*> ordered(buckets);
+    std::stable_sort(ordered.begin(), ordered.end(), [](const Bucket* a, const Bucket* b) {
+        return a->key.segment < b->key.segment;
+    });
+    size_t kept = 0;
+    for (size_t b = 0; b < ordered.size(); b++) {
+        Bucket* bucket = ordered[b];
+        for (; kept < keptChildren.size() && (int)kept < bucket->key.segment; kept++) {
+            addKeptChild(result, keptChildren[kept].node, keptChildren[kept].matrix,
+                         keptChildren[kept].material);
+        }
+        const float* v = bucket->key.values;
+
+        SoMaterial* material = new SoMaterial;
+        material->ambientColor.setValue(v[0], v[1], v[2]);
+        material->specularColor.setValue(v[3], v[4], v[5]);
+        material->emissiveColor.setValue(v[6], v[7], v[8]);
+        material->shininess = v[9];
+        material->transparency = v[10];
+
+        SoVertexProperty* vertexProperty = new SoVertexProperty;
+        vertexProperty->vertex.setValues(0, (int)bucket->vertices.size(), &bucket->vertices[0]);
+        vertexProperty->normal.setValues(0, (int)bucket->normals.size(), &bucket->normals[0]);
+        vertexProperty->normalBinding = SoVertexProperty::PER_VERTEX_INDEXED;
+        vertexProperty->orderedRGBA.setValues(0, (int)bucket->colors.size(), &bucket->colors[0]);
+        vertexProperty->materialBinding = SoVertexProperty::PER_FACE;
+
+        SoIndexedFaceSet* faceSet = new SoIndexedFaceSet;
+        faceSet->vertexProperty = vertexProperty;
+        faceSet->coordIndex.setValues(0, (int)bucket->coordIndex.size(), &bucket->coordIndex[0]);
+        bucket->faceSet = faceSet;
+
+        SoSeparator* sep = new SoSeparator;
+        sep->addChild(material);
+        sep->addChild(faceSet);
+        result->addChild(sep);
+
+        // The per-vertex data now lives in the fields
+        std::vector<SbVec3f>().swap(bucket->vertices);
+        std::vector<SbVec3f>().swap(bucket->normals);
+        std::vector<int32_t>().swap(bucket->coordIndex);
+        std::vector<uint32_t>().swap(bucket->colors);
+    }
+    for (; kept < keptChildren.size(); kept++) {
+        addKeptChild(result, keptChildren[kept].node, keptChildren[kept].matrix,
+                     keptChildren[kept].material);
+    }
+}
+
+SoSeparator* SceneFlattener::flatten(SoNode* root)
+{
+    clear();
+    root->ref();
+
+    // Subgraphs that must survive unchanged
+    SoChildList* children = root->getChildren();
+    if (children && root->isOfType(SoSeparator::getClassTypeId())) {
+        for (int i = 0; i < children->getLength(); i++) {
+            childSegment.push_back((int)keptChildren.size());
+            if (mustKeep((*children)[i])) {
+                KeptChild kept;
+                kept.node = (*children)[i];
+                kept.matrix = SbMatrix::identity();
+                kept.material = NULL;
+                keptChildren.push_back(kept);
+                keptSet.insert(kept.node);
+            }
+        }
+    }
+    numKept = (int)keptChildren.size();
+
+    // Tessellate with a fixed object space complexity
+    SoSeparator* wrapper = new SoSeparator;
+    wrapper->ref();
+    SoComplexity* complexityNode = new SoComplexity;
+    complexityNode->type = SoComplexity::OBJECT_SPACE;
+    complexityNode->value = complexity;
+    wrapper->addChild(complexityNode);
+    wrapper->addChild(root);
+
+    SoCallbackAction action;
+    action.addPreCallback(SoNode::getClassTypeId(), preNodeCB, this);
+    action.addPreCallback(SoShape::getClassTypeId(), preShapeCB, this);
+    action.addTriangleCallback(SoShape::getClassTypeId(), triangleCB, this);
+    action.apply(wrapper);
+
+    result = new SoSeparator;
+    result->ref();
+    buildResult();
+
+    wrapper->unref();
+    root->unrefNoDelete();
+    return result;
+}
+
+SoPath* SceneFlattener::getSourcePath(const SoIndexedFaceSet* faceSet, int faceIndex) const
+{
+    for (size_t i = 0; i < buckets.size(); i++) {
+        const Bucket* bucket = buckets[i];
+        if (bucket->faceSet == faceSet) {
+            if (faceIndex < 0 || faceIndex >= (int)bucket->faceSources.size()) {
+                return NULL;
+            }
+            return sources[bucket->faceSources[faceIndex]];
+        }
+    }
+    return NULL;
+}
+
+SoPath* SceneFlattener::getSourcePath(const SoPickedPoint* pickedPoint) const
+{
+    SoNode* tail = pickedPoint->getPath()->getTail();
+    if (!tail->isOfType(SoIndexedFaceSet::getClassTypeId())) {
+        return NULL;
+    }
+    const SoDetail* detail = pickedPoint->getDetail();
+    if (!detail || !detail->isOfType(SoFaceDetail::getClassTypeId())) {
+        return NULL;
+    }
+    return getSourcePath((const SoIndexedFaceSet*)tail, ((const SoFaceDetail*)detail)->getFaceIndex());
+}
@@ -0,0 +1,143 @@
+/*
+ * Scene Flattener
+ * Optimizer pass that collapses the Separator{Transform, Material, Shape}
+ * pattern used throughout the examples into a few merged face sets
+ *
+ * Static transforms are baked into the vertex data, primitives (spheres,
+ * cubes, cones, ...) are tessellated, and all triangles with compatible
+ * material state (everything except the diffuse color) end up in one
+ * SoIndexedFaceSet whose SoVertexProperty carries per-face colors. For
+ * every merged face the flattener remembers the path of the original shape,
+ * so picks on the flattened graph can be mapped back.
+ *
+ * Top-level children that cannot be baked are kept as they are: subgraphs
+ * containing cameras, lights, SoText2, line and point sets, textures and
+ * texture coordinates, draw styles, shape hints, light models, per-vertex
+ * materials or fields connected to engines. They stay in their original
+ * place among the merged face sets, which are split at every kept child.
+ * A kept separator or shape gets the transform and material the baked
+ * siblings in front of it left; other kept nodes (cameras, lights, draw
+ * styles, ...) are placed as they are, so they still affect what follows.
+ */
+
+#ifndef COIN3D_EXAMPLES_SCENE_FLATTENER_H
+#define COIN3D_EXAMPLES_SCENE_FLATTENER_H
+
+#include <Inventor/SbLinear.h>
+#include <Inventor/actions/SoCallbackAction.h>
+
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+class SoNode;
+class SoSeparator;
+class SoPath;
+class SoPickedPoint;
+class SoIndexedFaceSet;
+class SoMaterial;
+class SoPrimitiveVertex;
+
+class SceneFlattener
+{
+public:
+    SceneFlattener();
+    ~SceneFlattener();
+
+    // Tessellation level for primitives, as an object space SoComplexity value
+    void setComplexity(float value) { complexity = value; }
+
+    // Build the flattened version of root. The result is referenced by the
+    // flattener until the next flatten() call or its destruction.
+    SoSeparator* flatten(SoNode* root);
+    SoSeparator* getResult() const { return result; }
+
+    int getNumSourceShapes() const { return (int)sources.size(); }
+    int getNumMergedSets() const { return (int)buckets.size(); }
+    int getNumKeptSubgraphs() const { return numKept; }
+    size_t getNumTriangles() const;
+
+    // Path in the original graph of the shape that produced a face of the
+    // flattened graph, or NULL if the pick did not hit merged geometry
+    SoPath* getSourcePath(const SoPickedPoint* pickedPoint) const;
+    SoPath* getSourcePath(const SoIndexedFaceSet* faceSet, int faceIndex) const;
+
+private:
+    SceneFlattener(const SceneFlattener&);
+    SceneFlattener& operator=(const SceneFlattener&);
+
+    // Everything in SoMaterial except the diffuse color, which is stored
+    // per face, and the run of top-level children between kept ones
+    struct MaterialKey
+    {
+        int segment;
+        float values[11]; // ambient, specular, emissive, shininess, transparency
+        bool operator<(const MaterialKey& other) const;
+        bool operator==(const MaterialKey& other) const;
+    };
+
+    // A top-level child kept as is, with the state of the baked siblings
+    // in front of it
+    struct KeptChild
+    {
+        SoNode* node;
+        SbMatrix matrix;
+        SoMaterial* material; // referenced; NULL for the default material
+    };
+
+    struct Bucket
+    {
+        MaterialKey key;
+        std::vector<SbVec3f> vertices;
+        std::vector<SbVec3f> normals;
+        std::vector<int32_t> coordIndex;
+        std::vector<uint32_t> colors;   // per face, packed RGBA
+        std::vector<int> faceSources;   // per face, index into sources
+        SoIndexedFaceSet* faceSet;
+    };
+
+    // Vertex welding within the shape currently being tessellated
+    struct VertexKey
+    {
+        const Bucket* bucket;
+        float values[6];
+        bool operator==(const VertexKey& other) const;
+    };
+    struct VertexKeyHash
+    {
+        size_t operator()(const VertexKey& key) const;
+    };
+
+    void clear();
+    bool mustKeep(SoNode* node) const;
+    Bucket* findBucket(const MaterialKey& key);
+    int32_t addVertex(Bucket* bucket, const SoPrimitiveVertex* vertex);
+    void buildResult();
+
+    static SoCallbackAction::Response preNodeCB(void* data, SoCallbackAction* action, const SoNode* node);
+    static SoCallbackAction::Response preShapeCB(void* data, SoCallbackAction* action, const SoNode* node);
+    static void triangleCB(void* data, SoCallbackAction* action, const SoPrimitiveVertex* v1,
+                           const SoPrimitiveVertex* v2, const SoPrimitiveVertex* v3);
+
+    float complexity;
+    SoSeparator* result;
+    int numKept;
+    std::vector<KeptChild> keptChildren;
+    std::set<const SoNode*> keptSet;
+    std::vector<int> childSegment; // per top-level child, kept children before it
+    std::vector<SoPath*> sources;
+    std::map<MaterialKey, Bucket*> bucketMap;
+    std::vector<Bucket*> buckets;
+    Bucket* lastBucket;
+
+    // State of the shape being tessellated
+    int segment;
+    SbMatrix modelMatrix;
+    SbMatrix normalMatrix;
+    bool flipWinding;
+    std::unordered_map<VertexKey, int32_t, VertexKeyHash> shapeVertices;
+};
+
+#endif // COIN3D_EXAMPLES_SCENE_FLATTENER_H
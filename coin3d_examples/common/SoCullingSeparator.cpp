@@ -0,0 +1,392 @@
+/*
+ * SoCullingSeparator
+ * Hierarchical view volume culling and screen size complexity selection
+ */
+
+#include "SoCullingSeparator.h"
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/elements/SoComplexityElement.h>
+#include <Inventor/elements/SoComplexityTypeElement.h>
+#include <Inventor/elements/SoCoordinateElement.h>
+#include <Inventor/elements/SoFontNameElement.h>
+#include <Inventor/elements/SoFontSizeElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoUnitsElement.h>
+#include <Inventor/elements/SoViewVolumeElement.h>
+#include <Inventor/elements/SoViewportRegionElement.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/misc/SoState.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Children per hierarchy leaf
+static const int leafSize = 8;
+
+// Box test against the planes in mask: -1 outside one of them, otherwise
+// mask without the planes the box is entirely inside of
+static int testBox(const SbVec3f& min, const SbVec3f& max, const SbPlane* planes,
+                   unsigned int mask)
+{
+    for (int p = 0; p < 6; p++) {
+        if (!(mask & (1u << p))) {
+            continue;
+        }
+        const SbVec3f& normal = planes[p].getNormal();
+        float distance = planes[p].getDistanceFromOrigin();
+        // Corners farthest along and against the inward normal
+        SbVec3f outer(normal[0] >= 0.0f ? max[0] : min[0], normal[1] >= 0.0f ? max[1] : min[1],
+                      normal[2] >= 0.0f ? max[2] : min[2]);
+        if (normal.dot(outer) < distance) {
+            return -1;
+        }
+        SbVec3f inner(normal[0] >= 0.0f ? min[0] : max[0], normal[1] >= 0.0f ? min[1] : max[1],
+                      normal[2] >= 0.0f ? min[2] : max[2]);
+        if (normal.dot(inner) >= distance) {
+            mask &= ~(1u << p);
+        }
+    }
+    return (int)mask;
+}
+
+// Whether a camera has set the view volume: the element's default is
+// created with the state, at depth 0
+static bool hasCameraViewVolume(SoState* state)
+{
+    int stackIndex = SoViewVolumeElement::getClassStackIndex();
+    return state->isElementEnabled(stackIndex) &&
+           state->getConstElement(stackIndex)->getDepth() > 0;
+}
+
+SO_NODE_SOURCE(SoCullingSeparator);
+
+void SoCullingSeparator::initClass()
+{
+    SO_NODE_INIT_CLASS(SoCullingSeparator, SoSeparator, "Separator");
+}
+
+SoCullingSeparator::SoCullingSeparator()
+    : hierarchyValid(false), collectingBoxes(false)
+{
+    SO_NODE_CONSTRUCTOR(SoCullingSeparator);
+    SO_NODE_ADD_FIELD(culling, (TRUE));
+    SO_NODE_ADD_FIELD(lod, (TRUE));
+    SO_NODE_ADD_FIELD(minComplexity, (0.1f));
+    SO_NODE_ADD_FIELD(maxComplexity, (0.5f));
+    SO_NODE_ADD_FIELD(fullDetailSize, (256.0f));
+    SO_NODE_ADD_FIELD(levels, (4));
+    SO_NODE_ADD_FIELD(cullSize, (0.0f));
+
+    stats.children = stats.candidates = stats.visible = stats.boxTests = 0;
+}
+
+SoCullingSeparator::~SoCullingSeparator()
+{
+}
+
+void SoCullingSeparator::notify(SoNotList* list)
+{
+    // Fields of this node only change how the hierarchy is used
+    SoField* field = list->getLastField();
+    if (field == NULL || field->getContainer() != this) {
+        hierarchyValid = false;
+    }
+    SoSeparator::notify(list);
+}
+
+bool SoCullingSeparator::InheritedState::operator==(const InheritedState& other) const
+{
+    return coordinates == other.coordinates && fontName == other.fontName &&
+           fontSize == other.fontSize && units == other.units;
+}
+
+// The state above this node that boxes of its children depend on
+static void readInheritedState(SoState* state, uint32_t& coordinates, SbName& fontName,
+                               float& fontSize, int& units)
+{
+    coordinates = 0;
+    if (state->isElementEnabled(SoCoordinateElement::getClassStackIndex())) {
+        coordinates = SoCoordinateElement::getInstance(state)->getNodeId();
+    }
+    fontName = state->isElementEnabled(SoFontNameElement::getClassStackIndex())
+                   ? SoFontNameElement::get(state)
+                   : SbName("");
+    fontSize = state->isElementEnabled(SoFontSizeElement::getClassStackIndex())
+                   ? SoFontSizeElement::get(state)
+                   : 0.0f;
+    units = state->isElementEnabled(SoUnitsElement::getClassStackIndex())
+                ? (int)SoUnitsElement::get(state)
+                : 0;
+}
+
+void SoCullingSeparator::updateHierarchy(SoAction* action)
+{
+    InheritedState inherited;
+    readInheritedState(action->getState(), inherited.coordinates, inherited.fontName,
+                       inherited.fontSize, inherited.units);
+    if (hierarchyValid && inherited == boxState) {
+        return;
+    }
+    items.clear();
+    alwaysTraversed.clear();
+    nodes.clear();
+    // One traversal down the current path collects the boxes in the state
+    // the nodes above leave, see getBoundingBox()
+    SoPath* path = action->getCurPath()->copy();
+    path->ref();
+    collectingBoxes = true;
+    SoGetBoundingBoxAction bboxAction((SbViewportRegion()));
+    bboxAction.apply(path);
+    collectingBoxes = false;
+    path->unref();
+    if (!items.empty()) {
+        buildNode(0, (int)items.size());
+    }
+    boxState = inherited;
+    hierarchyValid = true;
+}
+
+void SoCullingSeparator::getBoundingBox(SoGetBoundingBoxAction* action)
+{
+    if (!collectingBoxes) {
+        SoSeparator::getBoundingBox(action);
+        return;
+    }
+    // Each separator child is boxed in the state its preceding siblings
+    // and the nodes above leave, so transforms, coordinates and fonts
+    // count. The boxes are in this node's coordinates.
+    SoState* state = action->getState();
+    state->push();
+    SoModelMatrixElement::makeIdentity(state, this);
+    for (int i = 0; i < children->getLength(); i++) {
+        if (!(*children)[i]->isOfType(SoSeparator::getClassTypeId())) {
+            children->traverse(action, i);
+            alwaysTraversed.push_back(i);
+            continue;
+        }
+        action->getXfBoundingBox().makeEmpty();
+        children->traverse(action, i);
+        Item item;
+        item.box = action->getXfBoundingBox().project();
+        item.child = i;
+        if (item.box.isEmpty()) {
+            alwaysTraversed.push_back(i);
+        } else {
+            items.push_back(item);
+        }
+    }
+    state->pop();
+}
+
+int SoCullingSeparator::buildNode(int first, int count)
+{
+    SbBox3f box, centers;
+    for (int k = first; k < first + count; k++) {
+        box.extendBy(items[k].box);
+        centers.extendBy(items[k].box.getCenter());
+    }
+    int index = (int)nodes.size();
+    BoxNode node;
+    node.min = box.getMin();
+    node.max = box.getMax();
+    node.first = first;
+    node.count = count;
+    node.left = node.right = -1;
+    nodes.push_back(node);
+
+    // Split at the median center along the longest extent of the centers
+    SbVec3f extent = centers.getMax() - centers.getMin();
+    int axis = 0;
+    if (extent[1] > extent[axis]) axis = 1;
+    if (extent[2] > extent[axis]) axis = 2;
+    if (count <= leafSize || extent[axis] <= 0.0f) {
+        return index;
+    }
+    int half = count / 2;
+    std::nth_element(items.begin() + first, items.begin() + first + half,
+                     items.begin() + first + count, [axis](const Item& a, const Item& b) {
+                         return a.box.getCenter()[axis] < b.box.getCenter()[axis];
+                     });
+    int left = buildNode(first, half);
+    int right = buildNode(first + half, count - half);
+    nodes[index].count = 0;
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+void SoCullingSeparator::cullNode(int node, const SbPlane* planes, unsigned int mask)
+{
+    stats.boxTests++;
+    const BoxNode& box = nodes[node];
+    int inside = testBox(box.min, box.max, planes, mask);
+    if (inside < 0) {
+        return;
+    }
+    mask = (unsigned int)inside;
+    if (box.count == 0) {
+        cullNode(box.left, planes, mask);
+        cullNode(box.right, planes, mask);
+        return;
+    }
+    for (int k = box.first; k < box.first + box.count; k++) {
+        if (mask != 0) {
+            stats.boxTests++;
+            if (testBox(items[k].box.getMin(), items[k].box.getMax(), planes, mask) < 0) {
+                continue;
+            }
+        }
+        visibleItems.push_back(k);
+    }
+}
+
+void SoCullingSeparator::traverseCulled(SoAction* action)
+{
+    updateHierarchy(action);
+    SoState* state = action->getState();
+    stats.children = children->getLength();
+    stats.candidates = (int)items.size();
+    stats.boxTests = 0;
+    if (!hasCameraViewVolume(state)) {
+        // Without a camera in front, the view volume is only the default
+        stats.visible = stats.candidates;
+        stats.levels.clear();
+        children->traverse(action);
+        return;
+    }
+    const SbViewVolume& viewVolume = SoViewVolumeElement::get(state);
+    const SbMatrix& model = SoModelMatrixElement::get(state);
+
+    // View volume planes in this node's coordinates, normals facing inwards
+    SbPlane planes[6];
+    viewVolume.getViewVolumePlanes(planes);
+    SbVec3f inside = viewVolume.getSightPoint(viewVolume.getNearDist() +
+                                              viewVolume.getDepth() * 0.5f);
+    SbMatrix toLocal = model.inverse();
+    for (int p = 0; p < 6; p++) {
+        if (planes[p].getDistance(inside) < 0.0f) {
+            planes[p] = SbPlane(-planes[p].getNormal(), -planes[p].getDistanceFromOrigin());
+        }
+        planes[p].transform(toLocal);
+    }
+
+    int levelCount = std::max((int)levels.getValue(), 1);
+    stats.levels.assign(levelCount, 0);
+    visibleItems.clear();
+    if (!nodes.empty()) {
+        cullNode(0, planes, 0x3f);
+    }
+
+    // Pixel size of each visible child's bounding sphere
+    bool useLod = lod.getValue();
+    float cullPixels = cullSize.getValue();
+    bool perspective = viewVolume.getProjectionType() == SbViewVolume::PERSPECTIVE;
+    float viewportHeight = SoViewportRegionElement::get(state).getViewportSizePixels()[1];
+    float pixelsPerUnit = viewportHeight / viewVolume.getHeight() *
+                          (perspective ? viewVolume.getNearDist() : 1.0f);
+    const SbVec3f& eye = viewVolume.getProjectionPoint();
+    const SbVec3f& sight = viewVolume.getProjectionDirection();
+    float scale = 0.0f;
+    for (int row = 0; row < 3; row++) {
+        SbVec3f axis(model[row][0], model[row][1], model[row][2]);
+        scale = std::max(scale, axis.length());
+    }
+
+    traversal.clear();
+    for (size_t v = 0; v < visibleItems.size(); v++) {
+        const Item& item = items[visibleItems[v]];
+        int level = levelCount - 1;
+        if (useLod || cullPixels > 0.0f) {
+            SbVec3f center;
+            model.multVecMatrix(item.box.getCenter(), center);
+            float diameter = (item.box.getMax() - item.box.getMin()).length() * scale;
+            float distance = perspective ? std::max((center - eye).dot(sight), 1e-6f) : 1.0f;
+            float pixels = diameter * pixelsPerUnit / distance;
+            if (pixels < cullPixels) {
+                continue;
+            }
+            if (useLod) {
+                level = std::min((int)(pixels / fullDetailSize.getValue() * levelCount),
+                                 levelCount - 1);
+            }
+        }
+        stats.levels[level]++;
+        traversal.push_back(std::make_pair(item.child, level));
+    }
+    stats.visible = (int)traversal.size();
+    for (size_t a = 0; a < alwaysTraversed.size(); a++) {
+        traversal.push_back(std::make_pair(alwaysTraversed[a], -1));
+    }
+    std::sort(traversal.begin(), traversal.end());
+
+    bool setComplexity =
+        useLod && state->isElementEnabled(SoComplexityElement::getClassStackIndex());
+    if (setComplexity) {
+        SoComplexityTypeElement::set(state, SoComplexityTypeElement::OBJECT_SPACE);
+    }
+    float low = minComplexity.getValue(), high = maxComplexity.getValue();
+    int currentLevel = -1;
+    for (size_t t = 0; t < traversal.size() && !action->hasTerminated(); t++) {
+        int level = traversal[t].second;
+        if (setComplexity && level >= 0 && level != currentLevel) {
+            float f = levelCount > 1 ? (float)level / (levelCount - 1) : 1.0f;
+            SoComplexityElement::set(state, low + (high - low) * f);
+            currentLevel = level;
+        }
+        children->traverse(action, traversal[t].first);
+        if (level < 0) {
+            // The child may have set a complexity of its own
+            currentLevel = -1;
+        }
+    }
+}
+
+void SoCullingSeparator::GLRenderBelowPath(SoGLRenderAction* action)
+{
+    if (!culling.getValue()) {
+        SoSeparator::GLRenderBelowPath(action);
+        return;
+    }
+    SoState* state = action->getState();
+    state->push();
+    traverseCulled(action);
+    state->pop();
+}
+
+void SoCullingSeparator::callback(SoCallbackAction* action)
+{
+    int numIndices;
+    const int* indices;
+    if (!culling.getValue() ||
+        action->getPathCode(numIndices, indices) != SoAction::NO_PATH) {
+        SoSeparator::callback(action);
+        return;
+    }
+    SoState* state = action->getState();
+    state->push();
+    traverseCulled(action);
+    state->pop();
+}
+
+void SoCullingSeparator::getPrimitiveCount(SoGetPrimitiveCountAction* action)
+{
+    int numIndices;
+    const int* indices;
+    if (!culling.getValue() ||
+        action->getPathCode(numIndices, indices) != SoAction::NO_PATH) {
+        SoSeparator::getPrimitiveCount(action);
+        return;
+    }
+    SoState* state = action->getState();
+    state->push();
+    traverseCulled(action);
+    state->pop();
+}
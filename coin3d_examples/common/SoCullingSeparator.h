@@ -0,0 +1,127 @@
+/*
+ * SoCullingSeparator
+ * Separator that culls its separator children against the view volume
+ * through a bounding box hierarchy and picks a complexity for each visible
+ * child from its projected size
+ *
+ * The bounding boxes of the separator children are computed on the first
+ * traversal, each in the state its preceding siblings and the nodes above
+ * leave, and arranged in a binary hierarchy, which is tested
+ * against the view volume top down: a subtree outside one plane is skipped
+ * as a whole, a subtree inside a plane is not tested against it again.
+ * Only visible children are traversed, in their original order. Any other
+ * child is always traversed, so property nodes in front of the separators
+ * keep working. The boxes are computed again after any change below the
+ * node, and when the coordinates, font or units inherited from above
+ * differ from those they were computed with; other inherited state must
+ * not change the size of the children.
+ *
+ * With lod on, each visible child is traversed with an object space
+ * SoComplexity value chosen from the pixel size of its bounding sphere,
+ * in a few discrete levels like SoLOD ranges: minComplexity for tiny
+ * objects up to maxComplexity from fullDetailSize pixels on. Children
+ * below cullSize pixels are culled as well. An SoComplexity inside a
+ * child still overrides the chosen value.
+ *
+ * Culling applies to render, callback and primitive count traversals
+ * outside of paths, with a camera in front of the node; without one every
+ * child is traversed. Cameras belong in front of the node: a change below
+ * it rebuilds the hierarchy. Like SoSortedSeparator, the node does no
+ * render caching of its own; its separator children still do.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_CULLING_SEPARATOR_H
+#define COIN3D_EXAMPLES_SO_CULLING_SEPARATOR_H
+
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoSFBool.h>
+#include <Inventor/fields/SoSFFloat.h>
+#include <Inventor/fields/SoSFInt32.h>
+#include <Inventor/SbLinear.h>
+#include <Inventor/SbName.h>
+
+#include <utility>
+#include <vector>
+
+class SoCullingSeparator : public SoSeparator
+{
+    SO_NODE_HEADER(SoCullingSeparator);
+
+public:
+    static void initClass();
+    SoCullingSeparator();
+
+    SoSFBool culling;         // FALSE traverses like a plain SoSeparator
+    SoSFBool lod;             // choose a complexity per visible child
+    SoSFFloat minComplexity;  // 0.1
+    SoSFFloat maxComplexity;  // 0.5, Coin's default complexity
+    SoSFFloat fullDetailSize; // pixels from which maxComplexity is used, 256
+    SoSFInt32 levels;         // distinct complexity values, 4
+    SoSFFloat cullSize;       // pixels below which children are culled, 0
+
+    virtual void GLRenderBelowPath(SoGLRenderAction* action);
+    virtual void callback(SoCallbackAction* action);
+    virtual void getPrimitiveCount(SoGetPrimitiveCountAction* action);
+    virtual void getBoundingBox(SoGetBoundingBoxAction* action);
+
+    // Result of the last culled traversal
+    struct Stats
+    {
+        int children;            // all children
+        int candidates;          // separator children in the hierarchy
+        int visible;             // candidates traversed
+        int boxTests;            // hierarchy boxes tested against planes
+        std::vector<int> levels; // visible children per complexity level
+    };
+    const Stats& getLastStats() const { return stats; }
+
+protected:
+    virtual ~SoCullingSeparator();
+    virtual void notify(SoNotList* list);
+
+private:
+    struct BoxNode
+    {
+        SbVec3f min, max;
+        int first, count; // range in items; count 0 for inner nodes
+        int left, right;  // child nodes of inner nodes
+    };
+
+    // A separator child with its box in this node's coordinates
+    struct Item
+    {
+        SbBox3f box;
+        int child;
+    };
+
+    // Inherited state the boxes were computed in
+    struct InheritedState
+    {
+        uint32_t coordinates; // node id of the SoCoordinateElement
+        SbName fontName;
+        float fontSize;
+        int units;
+        bool operator==(const InheritedState& other) const;
+    };
+
+    void updateHierarchy(SoAction* action);
+    int buildNode(int first, int count);
+    void cullNode(int node, const SbPlane* planes, unsigned int mask);
+    void traverseCulled(SoAction* action);
+
+    std::vector<Item> items;          // reordered so every leaf is a range
+    std::vector<int> alwaysTraversed; // children that are not separators
+    std::vector<BoxNode> nodes;       // nodes[0] is the root
+    bool hierarchyValid;
+    InheritedState boxState;
+    bool collectingBoxes; // getBoundingBox() fills items for updateHierarchy()
+
+    // Scratch of one traversal: items that passed the view volume test,
+    // then (child index, complexity level or -1) in traversal order
+    std::vector<int> visibleItems;
+    std::vector<std::pair<int, int> > traversal;
+    Stats stats;
+};
+
+#endif // COIN3D_EXAMPLES_SO_CULLING_SEPARATOR_H
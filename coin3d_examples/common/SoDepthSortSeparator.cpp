@@ -0,0 +1,170 @@
+/*
+ * SoDepthSortSeparator
+ * Back to front child traversal with coherent depth sorting
+ */
+
+#include "SoDepthSortSeparator.h"
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoViewingMatrixElement.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/misc/SoState.h>
+
+SO_NODE_SOURCE(SoDepthSortSeparator);
+
+void SoDepthSortSeparator::initClass()
+{
+    SO_NODE_INIT_CLASS(SoDepthSortSeparator, SoSeparator, "Separator");
+}
+
+SoDepthSortSeparator::SoDepthSortSeparator()
+    : centersValid(false), collectingCenters(false)
+{
+    SO_NODE_CONSTRUCTOR(SoDepthSortSeparator);
+    SO_NODE_ADD_FIELD(sortMethod, (INCREMENTAL));
+    SO_NODE_ADD_FIELD(jumpAngle, (0.35f));
+
+    SO_NODE_DEFINE_ENUM_VALUE(SortMethod, FULL_SORT);
+    SO_NODE_DEFINE_ENUM_VALUE(SortMethod, RADIX_SORT);
+    SO_NODE_DEFINE_ENUM_VALUE(SortMethod, INCREMENTAL);
+    SO_NODE_SET_SF_ENUM_TYPE(sortMethod, SortMethod);
+}
+
+SoDepthSortSeparator::~SoDepthSortSeparator()
+{
+}
+
+void SoDepthSortSeparator::notify(SoNotList* list)
+{
+    // Only the centers go stale; the previous order stays a good start
+    centersValid = false;
+    SoSeparator::notify(list);
+}
+
+void SoDepthSortSeparator::updateCenters()
+{
+    int count = children->getLength();
+    if (centersValid && (int)centerX.size() == count) {
+        return;
+    }
+    centerX.assign(count, 0.0f);
+    centerY.assign(count, 0.0f);
+    centerZ.assign(count, 0.0f);
+    runs.clear();
+    for (int i = 0; i < count; i++) {
+        if (!(*children)[i]->isOfType(SoSeparator::getClassTypeId())) {
+            continue;
+        }
+        if (runs.empty() || runs.back().second != i) {
+            runs.push_back(std::make_pair(i, i));
+        }
+        runs.back().second = i + 1;
+    }
+    // One traversal of this node collects the centers, see getBoundingBox()
+    collectingCenters = true;
+    SoGetBoundingBoxAction bboxAction((SbViewportRegion()));
+    bboxAction.apply(this);
+    collectingCenters = false;
+
+    // Sorters keep their previous order where the runs stayed the same
+    sorters.resize(runs.size());
+    centersValid = true;
+}
+
+void SoDepthSortSeparator::getBoundingBox(SoGetBoundingBoxAction* action)
+{
+    if (!collectingCenters) {
+        SoSeparator::getBoundingBox(action);
+        return;
+    }
+    // Each separator child is boxed in the state its preceding siblings
+    // leave, so transforms in front of a run move its centers. Applied to
+    // this node, the centers are in this node's coordinates.
+    SoState* state = action->getState();
+    state->push();
+    for (int i = 0; i < children->getLength(); i++) {
+        if (!(*children)[i]->isOfType(SoSeparator::getClassTypeId())) {
+            children->traverse(action, i);
+            continue;
+        }
+        action->getXfBoundingBox().makeEmpty();
+        children->traverse(action, i);
+        SbBox3f box = action->getXfBoundingBox().project();
+        if (!box.isEmpty()) {
+            SbVec3f center = box.getCenter();
+            centerX[i] = center[0];
+            centerY[i] = center[1];
+            centerZ[i] = center[2];
+        }
+    }
+    state->pop();
+}
+
+const std::vector<int>& SoDepthSortSeparator::sortBackToFront(const SbMatrix& modelView)
+{
+    updateCenters();
+    int count = (int)centerX.size();
+    keys.resize(count);
+    // Eye space z of each center; the farthest has the smallest
+    float mx = modelView[0][2], my = modelView[1][2], mz = modelView[2][2];
+    float offset = modelView[3][2];
+    for (int i = 0; i < count; i++) {
+        keys[i] = centerX[i] * mx + centerY[i] * my + centerZ[i] * mz + offset;
+    }
+
+    // Other children in place, each run of separators sorted within itself
+    traversal.clear();
+    int child = 0;
+    for (size_t r = 0; r < runs.size(); r++) {
+        int first = runs[r].first;
+        for (; child < first; child++) {
+            traversal.push_back(child);
+        }
+        DepthSorter& sorter = sorters[r];
+        sorter.setMethod((DepthSorter::Method)sortMethod.getValue());
+        sorter.setJumpAngle(jumpAngle.getValue());
+        const std::vector<int>& order =
+            sorter.sort(&keys[first], runs[r].second - first, SbVec3f(mx, my, mz));
+        for (size_t i = 0; i < order.size(); i++) {
+            traversal.push_back(first + order[i]);
+        }
+        child = runs[r].second;
+    }
+    for (; child < count; child++) {
+        traversal.push_back(child);
+    }
+    return traversal;
+}
+
+unsigned long SoDepthSortSeparator::getNumFullSorts() const
+{
+    unsigned long sorts = 0;
+    for (size_t r = 0; r < sorters.size(); r++) {
+        sorts += sorters[r].getNumFullSorts();
+    }
+    return sorts;
+}
+
+unsigned long SoDepthSortSeparator::getNumIncrementalSorts() const
+{
+    unsigned long sorts = 0;
+    for (size_t r = 0; r < sorters.size(); r++) {
+        sorts += sorters[r].getNumIncrementalSorts();
+    }
+    return sorts;
+}
+
+void SoDepthSortSeparator::GLRenderBelowPath(SoGLRenderAction* action)
+{
+    SoState* state = action->getState();
+    state->push();
+    SbMatrix modelView = SoModelMatrixElement::get(state) * SoViewingMatrixElement::get(state);
+    const std::vector<int>& order = sortBackToFront(modelView);
+    for (size_t i = 0; i < order.size() && !action->hasTerminated(); i++) {
+        children->traverse(action, order[i]);
+    }
+    state->pop();
+}
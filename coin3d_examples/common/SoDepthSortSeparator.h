@@ -0,0 +1,86 @@
+/*
+ * SoDepthSortSeparator
+ * Separator that renders its children back to front, keeping the order
+ * between frames and repairing it incrementally with a DepthSorter
+ *
+ * Meant for many transparent objects, each a separator child: the children
+ * are traversed by the eye space depth of their bounding box centers, so
+ * plain SoGLRenderAction::BLEND composites them correctly without Coin's
+ * SORTED_OBJECT_BLEND, which delays every transparent shape and sorts them
+ * all from scratch each frame. Opaque geometry belongs before this node.
+ *
+ * Only separator children are reordered, each run of consecutive ones
+ * among itself with its own DepthSorter. Other children (materials,
+ * transforms, ...) are traversed in place, so they still apply to the
+ * separators after them.
+ *
+ * Child centers are computed once and again after any change below the
+ * node, each in the state its preceding siblings leave. Like
+ * SoSortedSeparator, the node does no render caching or culling of its
+ * own.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_DEPTH_SORT_SEPARATOR_H
+#define COIN3D_EXAMPLES_SO_DEPTH_SORT_SEPARATOR_H
+
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoSFEnum.h>
+#include <Inventor/fields/SoSFFloat.h>
+#include <Inventor/SbLinear.h>
+
+#include <utility>
+#include <vector>
+
+#include "DepthSorter.h"
+
+class SoDepthSortSeparator : public SoSeparator
+{
+    SO_NODE_HEADER(SoDepthSortSeparator);
+
+public:
+    static void initClass();
+    SoDepthSortSeparator();
+
+    enum SortMethod
+    {
+        FULL_SORT = DepthSorter::FULL_SORT,
+        RADIX_SORT = DepthSorter::RADIX_SORT,
+        INCREMENTAL = DepthSorter::INCREMENTAL
+    };
+
+    SoSFEnum sortMethod;  // INCREMENTAL by default
+    SoSFFloat jumpAngle;  // view change in radians that forces a full sort
+
+    virtual void GLRenderBelowPath(SoGLRenderAction* action);
+    virtual void getBoundingBox(SoGetBoundingBoxAction* action);
+
+    // Child indices in traversal order for the given model * viewing
+    // matrix, separators back to front; this is what rendering runs each
+    // frame
+    const std::vector<int>& sortBackToFront(const SbMatrix& modelView);
+
+    // Sorts of all runs of separator children so far
+    unsigned long getNumFullSorts() const;
+    unsigned long getNumIncrementalSorts() const;
+
+protected:
+    virtual ~SoDepthSortSeparator();
+    virtual void notify(SoNotList* list);
+
+private:
+    void updateCenters();
+
+    // Bounding box centers of the children, one array per coordinate
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> keys;
+    bool centersValid;
+    bool collectingCenters;  // during updateCenters()
+    // Runs of consecutive separator children as [first, end) child
+    // indices, each with its sorter
+    std::vector<std::pair<int, int> > runs;
+    std::vector<DepthSorter> sorters;
+    std::vector<int> traversal;
+};
+
+#endif // COIN3D_EXAMPLES_SO_DEPTH_SORT_SEPARATOR_H
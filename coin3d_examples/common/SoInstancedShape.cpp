@@ -0,0 +1,263 @@
+/*
+ * SoInstancedShape
+ * One shared, pre-tessellated shape drawn for every packed instance
+ */
+
+#include "SoInstancedShape.h"
+
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/bundles/SoMaterialBundle.h>
+#include <Inventor/details/SoFaceDetail.h>
+#include <Inventor/elements/SoGLLazyElement.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/system/gl.h>
+
+SO_NODE_SOURCE(SoInstancedShape);
+
+void SoInstancedShape::initClass()
+{
+    SO_NODE_INIT_CLASS(SoInstancedShape, SoShape, "Shape");
+}
+
+SoInstancedShape::SoInstancedShape()
+    : tessellationValid(false), instancesBoxValid(false)
+{
+    SO_NODE_CONSTRUCTOR(SoInstancedShape);
+    SO_NODE_ADD_FIELD(shape, (NULL));
+    SO_NODE_ADD_FIELD(instanceMatrix, (SbMatrix::identity()));
+    SO_NODE_ADD_FIELD(instanceColor, (0xffffffff));
+    // No instances until they are set
+    instanceMatrix.setNum(0);
+    instanceColor.setNum(0);
+}
+
+SoInstancedShape::~SoInstancedShape()
+{
+}
+
+void SoInstancedShape::notify(SoNotList* list)
+{
+    // Changes inside the shared shape arrive through the shape field
+    if (list->getLastField() == &shape) {
+        tessellationValid = false;
+    }
+    instancesBoxValid = false;
+    SoShape::notify(list);
+}
+
+// Collects the triangles of the shared shape
+struct TessellationTarget
+{
+    std::vector<SbVec3f>* points;
+    std::vector<SbVec3f>* normals;
+};
+
+static void collectTriangleCB(void* data, SoCallbackAction* action, const SoPrimitiveVertex* v1,
+                              const SoPrimitiveVertex* v2, const SoPrimitiveVertex* v3)
+{
+    TessellationTarget* target = (TessellationTarget*)data;
+    const SbMatrix& m = action->getModelMatrix();
+    // Normals need the inverse transpose to stay perpendicular under
+    // non-uniform scaling
+    SbMatrix normalMatrix = m.inverse().transpose();
+    const SoPrimitiveVertex* vertices[3] = { v1, v2, v3 };
+    for (int i = 0; i < 3; i++) {
+        SbVec3f point, normal;
+        m.multVecMatrix(vertices[i]->getPoint(), point);
+        normalMatrix.multDirMatrix(vertices[i]->getNormal(), normal);
+        normal.normalize();
+        target->points->push_back(point);
+        target->normals->push_back(normal);
+    }
+}
+
+void SoInstancedShape::updateTessellation()
+{
+    if (tessellationValid) {
+        return;
+    }
+    points.clear();
+    normals.clear();
+    localBox.makeEmpty();
+
+    SoNode* node = shape.getValue();
+    if (node) {
+        TessellationTarget target = { &points, &normals };
+        SoCallbackAction action;
+        action.addTriangleCallback(SoShape::getClassTypeId(), collectTriangleCB, &target);
+        action.apply(node);
+    }
+    for (size_t i = 0; i < points.size(); i++) {
+        localBox.extendBy(points[i]);
+    }
+    tessellationValid = true;
+    instancesBoxValid = false;
+}
+
+int SoInstancedShape::getNumTriangles()
+{
+    updateTessellation();
+    return (int)points.size() / 3;
+}
+
+void SoInstancedShape::computeBBox(SoAction* action, SbBox3f& box, SbVec3f& center)
+{
+    updateTessellation();
+    if (!instancesBoxValid) {
+        instancesBox.makeEmpty();
+        if (!localBox.isEmpty()) {
+            const SbMatrix* matrices = instanceMatrix.getValues(0);
+            for (int i = 0; i < instanceMatrix.getNum(); i++) {
+                SbBox3f instanceBox = localBox;
+                instanceBox.transform(matrices[i]);
+                instancesBox.extendBy(instanceBox);
+            }
+        }
+        instancesBoxValid = true;
+    }
+    box = instancesBox;
+    if (!box.isEmpty()) {
+        center = box.getCenter();
+    }
+}
+
+void SoInstancedShape::GLRender(SoGLRenderAction* action)
+{
+    if (!shouldGLRender(action)) {
+        return;
+    }
+    updateTessellation();
+    int numInstances = instanceMatrix.getNum();
+    if (points.empty() || numInstances == 0) {
+        return;
+    }
+
+    SoState* state = action->getState();
+    SoMaterialBundle mb(action);
+    mb.sendFirst();
+
+    const SbMatrix* matrices = instanceMatrix.getValues(0);
+    const uint32_t* colors = instanceColor.getValues(0);
+    int numColors = instanceColor.getNum();
+
+    // Instance matrices may scale, so normals need renormalizing
+    glPushAttrib(GL_ENABLE_BIT);
+    glEnable(GL_NORMALIZE);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, points[0].getValue());
+    glNormalPointer(GL_FLOAT, 0, normals[0].getValue());
+
+    glMatrixMode(GL_MODELVIEW);
+    GLsizei count = (GLsizei)points.size();
+    for (int i = 0; i < numInstances; i++) {
+        if (numColors > 0) {
+            uint32_t rgba = colors[i < numColors ? i : numColors - 1];
+            glColor4ub((GLubyte)(rgba >> 24), (GLubyte)(rgba >> 16),
+                       (GLubyte)(rgba >> 8), (GLubyte)rgba);
+        }
+        glPushMatrix();
+        glMultMatrixf((const GLfloat*)matrices[i].getValue());
+        glDrawArrays(GL_TRIANGLES, 0, count);
+        glPopMatrix();
+    }
+
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glPopAttrib();
+
+    // The diffuse color in GL no longer matches what Coin thinks it is
+    if (numColors > 0) {
+        SoGLLazyElement::getInstance(state)->reset(state, SoLazyElement::DIFFUSE_MASK);
+    }
+}
+
+void SoInstancedShape::rayPick(SoRayPickAction* action)
+{
+    if (!shouldRayPick(action)) {
+        return;
+    }
+    updateTessellation();
+    action->setObjectSpace();
+
+    const SbMatrix* matrices = instanceMatrix.getValues(0);
+    for (int i = 0; i < instanceMatrix.getNum(); i++) {
+        // Cheap reject on the instance box before looking at triangles
+        SbBox3f instanceBox = localBox;
+        instanceBox.transform(matrices[i]);
+        if (!action->intersect(instanceBox, TRUE)) {
+            continue;
+        }
+
+        const SbMatrix& m = matrices[i];
+        SbMatrix normalMatrix = m.inverse().transpose();
+        for (size_t t = 0; t + 2 < points.size(); t += 3) {
+            SbVec3f v0, v1, v2;
+            m.multVecMatrix(points[t], v0);
+            m.multVecMatrix(points[t + 1], v1);
+            m.multVecMatrix(points[t + 2], v2);
+
+            SbVec3f point, barycentric;
+            SbBool front;
+            if (!action->intersect(v0, v1, v2, point, barycentric, front) ||
+                !action->isBetweenPlanes(point)) {
+                continue;
+            }
+            SoPickedPoint* pickedPoint = action->addIntersection(point);
+            if (!pickedPoint) {
+                continue;
+            }
+
+            SbVec3f normal = normals[t] * barycentric[0] + normals[t + 1] * barycentric[1] +
+                             normals[t + 2] * barycentric[2];
+            SbVec3f objectNormal;
+            normalMatrix.multDirMatrix(normal, objectNormal);
+            objectNormal.normalize();
+            pickedPoint->setObjectNormal(objectNormal);
+
+            SoFaceDetail* detail = new SoFaceDetail;
+            detail->setPartIndex(i);
+            detail->setFaceIndex((int)(t / 3));
+            pickedPoint->setDetail(detail, this);
+        }
+    }
+}
+
+void SoInstancedShape::generatePrimitives(SoAction* action)
+{
+    updateTessellation();
+    const SbMatrix* matrices = instanceMatrix.getValues(0);
+    const uint32_t* colors = instanceColor.getValues(0);
+    int numColors = instanceColor.getNum();
+
+    SoPrimitiveVertex vertex;
+    SoFaceDetail faceDetail;
+    vertex.setDetail(&faceDetail);
+
+    beginShape(action, TRIANGLES, &faceDetail);
+    for (int i = 0; i < instanceMatrix.getNum(); i++) {
+        const SbMatrix& m = matrices[i];
+        SbMatrix normalMatrix = m.inverse().transpose();
+        faceDetail.setPartIndex(i);
+        if (numColors > 0) {
+            vertex.setPackedColor(colors[i < numColors ? i : numColors - 1]);
+        }
+        for (size_t t = 0; t < points.size(); t++) {
+            if (t % 3 == 0) {
+                faceDetail.setFaceIndex((int)(t / 3));
+            }
+            SbVec3f point, normal;
+            m.multVecMatrix(points[t], point);
+            normalMatrix.multDirMatrix(normals[t], normal);
+            normal.normalize();
+            vertex.setPoint(point);
+            vertex.setNormal(normal);
+            shapeVertex(&vertex);
+        }
+    }
+    endShape();
+}
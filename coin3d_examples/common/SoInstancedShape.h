@@ -0,0 +1,64 @@
+/*
+ * SoInstancedShape
+ * Draws one shared shape many times from packed per-instance arrays
+ *
+ * Replaces the Separator{Transform, Material, Shape} per object pattern for
+ * large numbers of repeated parts (bolts, rivets, ...). Each instance costs
+ * one matrix and one packed color in the node's fields (68 bytes) instead
+ * of several node objects. The shared shape is tessellated once and drawn
+ * from vertex arrays for every instance, without any per-instance node
+ * traversal. Bounding box, ray pick and callback actions are supported;
+ * picked points carry an SoFaceDetail whose part index is the instance.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_INSTANCED_SHAPE_H
+#define COIN3D_EXAMPLES_SO_INSTANCED_SHAPE_H
+
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoSFNode.h>
+#include <Inventor/fields/SoMFMatrix.h>
+#include <Inventor/fields/SoMFUInt32.h>
+#include <Inventor/SbBox3f.h>
+
+#include <vector>
+
+class SoInstancedShape : public SoShape
+{
+    SO_NODE_HEADER(SoInstancedShape);
+
+public:
+    static void initClass();
+    SoInstancedShape();
+
+    SoSFNode shape;             // shared shape, e.g. an SoSphere
+    SoMFMatrix instanceMatrix;  // one object-to-parent matrix per instance
+    SoMFUInt32 instanceColor;   // packed RGBA per instance; empty = current material
+
+    virtual void GLRender(SoGLRenderAction* action);
+    virtual void rayPick(SoRayPickAction* action);
+
+    // Tessellation of the shared shape, in its own coordinates
+    int getNumTriangles();
+
+protected:
+    virtual ~SoInstancedShape();
+    virtual void notify(SoNotList* list);
+    virtual void computeBBox(SoAction* action, SbBox3f& box, SbVec3f& center);
+    virtual void generatePrimitives(SoAction* action);
+
+private:
+    void updateTessellation();
+
+    // Shared shape as a flat triangle list (3 vertices per triangle)
+    std::vector<SbVec3f> points;
+    std::vector<SbVec3f> normals;
+    SbBox3f localBox;
+    bool tessellationValid;
+
+    // Union of all instance boxes
+    SbBox3f instancesBox;
+    bool instancesBoxValid;
+};
+
+#endif // COIN3D_EXAMPLES_SO_INSTANCED_SHAPE_H
@@ -0,0 +1,194 @@
+/*
+ * SoSortedSeparator
+ * Material keyed traversal order for runs of separator children
+ */
+
+#include "SoSortedSeparator.h"
+
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoTexture2.h>
+#include <Inventor/nodes/SoTexture3.h>
+
+#include <algorithm>
+#include <map>
+
+SO_NODE_SOURCE(SoSortedSeparator);
+
+void SoSortedSeparator::initClass()
+{
+    SO_NODE_INIT_CLASS(SoSortedSeparator, SoSeparator, "Separator");
+}
+
+SoSortedSeparator::SoSortedSeparator()
+    : orderValid(false)
+{
+    SO_NODE_CONSTRUCTOR(SoSortedSeparator);
+    SO_NODE_ADD_FIELD(sortChildren, (TRUE));
+}
+
+SoSortedSeparator::~SoSortedSeparator()
+{
+}
+
+static bool isTexture(const SoNode* node)
+{
+    return node->isOfType(SoTexture2::getClassTypeId()) ||
+           node->isOfType(SoTexture3::getClassTypeId());
+}
+
+void SoSortedSeparator::notify(SoNotList* list)
+{
+    // Without a field, a child list changed (or a node was touched); of
+    // the field edits, only those of materials and textures count
+    SoField* field = list->getLastField();
+    if (field == NULL) {
+        orderValid = false;
+    } else {
+        SoFieldContainer* container = field->getContainer();
+        if (container && container->isOfType(SoNode::getClassTypeId()) &&
+            (container->isOfType(SoMaterial::getClassTypeId()) ||
+             isTexture((SoNode*)container))) {
+            orderValid = false;
+        }
+    }
+    SoSeparator::notify(list);
+}
+
+struct SortKey
+{
+    int texture;        // first appearance of the first texture below the child
+    int material;       // first appearance of the first SoMaterial below the child
+    int16_t shapeType;  // type key of the first shape below the child
+    int index;
+
+    bool operator<(const SortKey& other) const
+    {
+        if (texture != other.texture) {
+            return texture < other.texture;
+        }
+        if (material != other.material) {
+            return material < other.material;
+        }
+        return shapeType < other.shapeType;
+    }
+};
+
+// First texture, material and shape in traversal order below node
+struct KeyNodes
+{
+    const SoNode* texture;
+    const SoNode* material;
+    int16_t shapeType;
+    bool haveTexture, haveMaterial, haveShape;
+};
+
+static void findKey(const SoNode* node, KeyNodes& key)
+{
+    if (!key.haveTexture && isTexture(node)) {
+        key.texture = node;
+        key.haveTexture = true;
+    }
+    if (!key.haveMaterial && node->isOfType(SoMaterial::getClassTypeId())) {
+        key.material = node;
+        key.haveMaterial = true;
+    }
+    if (!key.haveShape && node->isOfType(SoShape::getClassTypeId())) {
+        key.shapeType = node->getTypeId().getKey();
+        key.haveShape = true;
+    }
+    SoChildList* children = node->getChildren();
+    for (int i = 0; children && i < children->getLength() &&
+                    !(key.haveTexture && key.haveMaterial && key.haveShape); i++) {
+        findKey((*children)[i], key);
+    }
+}
+
+// Number of node in order of first appearance; NULL counts like a node
+static int appearance(std::map<const SoNode*, int>& ids, const SoNode* node)
+{
+    std::map<const SoNode*, int>::iterator it = ids.find(node);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    int id = (int)ids.size();
+    ids[node] = id;
+    return id;
+}
+
+void SoSortedSeparator::updateOrder()
+{
+    if (orderValid && (int)order.size() == children->getLength()) {
+        return;
+    }
+    int count = children->getLength();
+    order.resize(count);
+    std::vector<SortKey> keys;
+    std::map<const SoNode*, int> textureIds, materialIds;
+    int i = 0;
+    while (i < count) {
+        if (!(*children)[i]->isOfType(SoSeparator::getClassTypeId())) {
+            order[i] = i;
+            i++;
+            continue;
+        }
+        // Sort the run of separators starting here
+        int start = i;
+        keys.clear();
+        textureIds.clear();
+        materialIds.clear();
+        for (; i < count && (*children)[i]->isOfType(SoSeparator::getClassTypeId()); i++) {
+            KeyNodes nodes = { NULL, NULL, 0, false, false, false };
+            findKey((*children)[i], nodes);
+            SortKey key = { appearance(textureIds, nodes.texture),
+                            appearance(materialIds, nodes.material), nodes.shapeType, i };
+            keys.push_back(key);
+        }
+        std::stable_sort(keys.begin(), keys.end());
+        for (size_t k = 0; k < keys.size(); k++) {
+            order[start + k] = keys[k].index;
+        }
+    }
+    orderValid = true;
+}
+
+void SoSortedSeparator::traverseSorted(SoAction* action)
+{
+    updateOrder();
+    for (size_t i = 0; i < order.size() && !action->hasTerminated(); i++) {
+        children->traverse(action, order[i]);
+    }
+}
+
+void SoSortedSeparator::GLRenderBelowPath(SoGLRenderAction* action)
+{
+    if (!sortChildren.getValue()) {
+        SoSeparator::GLRenderBelowPath(action);
+        return;
+    }
+    SoState* state = action->getState();
+    state->push();
+    traverseSorted(action);
+    state->pop();
+}
+
+void SoSortedSeparator::callback(SoCallbackAction* action)
+{
+    int numIndices;
+    const int* indices;
+    if (!sortChildren.getValue() ||
+        action->getPathCode(numIndices, indices) != SoAction::NO_PATH) {
+        SoSeparator::callback(action);
+        return;
+    }
+    SoState* state = action->getState();
+    state->push();
+    traverseSorted(action);
+    state->pop();
+}
@@ -0,0 +1,60 @@
+/*
+ * SoSortedSeparator
+ * Separator that renders its independent children grouped by material
+ *
+ * Consecutive children that are separators themselves cannot affect each
+ * other's state, so their order is free. Within every such run the node
+ * traverses the children sorted by the first texture node they contain,
+ * then by their first SoMaterial node and then by the type of their first
+ * shape, so shapes sharing a texture and material node are drawn back to
+ * back and the state is sent to GL once per group. Textures and materials
+ * are numbered in the order they first appear in the run, so the order
+ * does not depend on where the nodes happen to be allocated. Any other
+ * child keeps its place and bounds the runs around it. Works best after
+ * deduplicateMaterials() (MaterialOptimizer.h), which makes equal
+ * materials the same node.
+ *
+ * The order is recomputed after child lists change anywhere below the
+ * node and after edits of materials and textures, not after other field
+ * edits such as transforms or coordinates.
+ *
+ * Sorting applies to render and callback traversals outside of paths. The
+ * node does no render caching or culling of its own while sorting; its
+ * separator children still do.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_SORTED_SEPARATOR_H
+#define COIN3D_EXAMPLES_SO_SORTED_SEPARATOR_H
+
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoSFBool.h>
+
+#include <vector>
+
+class SoSortedSeparator : public SoSeparator
+{
+    SO_NODE_HEADER(SoSortedSeparator);
+
+public:
+    static void initClass();
+    SoSortedSeparator();
+
+    SoSFBool sortChildren;  // FALSE renders as a plain SoSeparator
+
+    virtual void GLRenderBelowPath(SoGLRenderAction* action);
+    virtual void callback(SoCallbackAction* action);
+
+protected:
+    virtual ~SoSortedSeparator();
+    virtual void notify(SoNotList* list);
+
+private:
+    void updateOrder();
+    void traverseSorted(SoAction* action);
+
+    std::vector<int> order;  // child indices in traversal order
+    bool orderValid;
+};
+
+#endif // COIN3D_EXAMPLES_SO_SORTED_SEPARATOR_H
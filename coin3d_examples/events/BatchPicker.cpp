@@ -0,0 +1,173 @@
+/*
+ * Batch Picker
+ * Single-traversal multi-ray picking with SIMD triangle tests
+ */
+
+#include "BatchPicker.h"
+#include "PickSimd.h"
+
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/nodes/SoShape.h>
+
+#include <cfloat>
+
+BatchPicker::BatchPicker(PickBVH* bvh)
+    : bvh(bvh), rays(NULL), hits(NULL), nextShapeRay(0), shapeIndex(-1),
+      numShapesTested(0), numTrianglesTested(0)
+{
+}
+
+void BatchPicker::pick(const SbLine* rays, int numRays, std::vector<RayHit>& hits)
+{
+    RayHit miss;
+    miss.shape = -1;
+    miss.distance = FLT_MAX;
+    miss.point.setValue(0, 0, 0);
+    miss.normal.setValue(0, 0, 0);
+    hits.assign(numRays, miss);
+    numShapesTested = 0;
+    numTrianglesTested = 0;
+    if (numRays == 0) {
+        return;
+    }
+
+    // Packet traversal of the hierarchy, also brings it up to date
+    bvh->findRayCandidates(rays, numRays, shapeRays);
+    if (shapeRays.empty()) {
+        return;
+    }
+
+    this->rays = rays;
+    this->hits = &hits[0];
+    nextShapeRay = 0;
+    shapeIndex = -1;
+
+    // The pre-callback sees the shapes in the order PickBVH collected them
+    SoCallbackAction action;
+    action.addPreCallback(SoShape::getClassTypeId(), preShapeCB, this);
+    action.addTriangleCallback(SoShape::getClassTypeId(), triangleCB, this);
+    action.apply(bvh->getRoot());
+
+    this->rays = NULL;
+    this->hits = NULL;
+}
+
+SoCallbackAction::Response BatchPicker::preShapeCB(void* data, SoCallbackAction* action,
+                                                   const SoNode*)
+{
+    BatchPicker* picker = (BatchPicker*)data;
+    int shape = ++picker->shapeIndex;
+
+    std::vector<std::pair<int, int> >& shapeRays = picker->shapeRays;
+    size_t& next = picker->nextShapeRay;
+    picker->activeRays.clear();
+    while (next < shapeRays.size() && shapeRays[next].first <= shape) {
+        if (shapeRays[next].first == shape) {
+            picker->activeRays.push_back(shapeRays[next].second);
+        }
+        next++;
+    }
+    if (picker->activeRays.empty()) {
+        // No ray reaches this shape's box, skip its triangles
+        return SoCallbackAction::PRUNE;
+    }
+
+    // Pad with copies of the last ray, their hits are discarded
+    size_t count = picker->activeRays.size();
+    size_t padded = (count + 3) & ~(size_t)3;
+    for (int c = 0; c < 6; c++) {
+        picker->activeData[c].resize(padded);
+    }
+    for (size_t i = 0; i < padded; i++) {
+        const SbLine& line = picker->rays[picker->activeRays[i < count ? i : count - 1]];
+        for (int axis = 0; axis < 3; axis++) {
+            picker->activeData[axis][i] = line.getPosition()[axis];
+            picker->activeData[3 + axis][i] = line.getDirection()[axis];
+        }
+    }
+
+    picker->modelMatrix = action->getModelMatrix();
+    picker->normalMatrix = picker->modelMatrix.inverse().transpose();
+    picker->numShapesTested++;
+    return SoCallbackAction::CONTINUE;
+}
+
+void BatchPicker::triangleCB(void* data, SoCallbackAction*, const SoPrimitiveVertex* v1,
+                             const SoPrimitiveVertex* v2, const SoPrimitiveVertex* v3)
+{
+    BatchPicker* picker = (BatchPicker*)data;
+    picker->numTrianglesTested++;
+
+    SbVec3f p0, p1, p2;
+    picker->modelMatrix.multVecMatrix(v1->getPoint(), p0);
+    picker->modelMatrix.multVecMatrix(v2->getPoint(), p1);
+    picker->modelMatrix.multVecMatrix(v3->getPoint(), p2);
+    SbVec3f e1 = p1 - p0;
+    SbVec3f e2 = p2 - p0;
+
+    // Moeller-Trumbore, one triangle against four rays per iteration
+    const Float4 zero(0.0f), one(1.0f), epsilon(1e-6f);
+    const Float4 e1x(e1[0]), e1y(e1[1]), e1z(e1[2]);
+    const Float4 e2x(e2[0]), e2y(e2[1]), e2z(e2[2]);
+    const Float4 p0x(p0[0]), p0y(p0[1]), p0z(p0[2]);
+
+    size_t count = picker->activeRays.size();
+    for (size_t first = 0; first < count; first += 4) {
+        Float4 ox = Float4::load(&picker->activeData[0][first]);
+        Float4 oy = Float4::load(&picker->activeData[1][first]);
+        Float4 oz = Float4::load(&picker->activeData[2][first]);
+        Float4 dx = Float4::load(&picker->activeData[3][first]);
+        Float4 dy = Float4::load(&picker->activeData[4][first]);
+        Float4 dz = Float4::load(&picker->activeData[5][first]);
+
+        // pvec = d x e2, det = e1 . pvec
+        Float4 px = dy * e2z - dz * e2y;
+        Float4 py = dz * e2x - dx * e2z;
+        Float4 pz = dx * e2y - dy * e2x;
+        Float4 det = e1x * px + e1y * py + e1z * pz;
+
+        float detValues[4], invValues[4];
+        det.store(detValues);
+        for (int lane = 0; lane < 4; lane++) {
+            invValues[lane] = detValues[lane] != 0.0f ? 1.0f / detValues[lane] : 0.0f;
+        }
+        Float4 invDet = Float4::load(invValues);
+        int mask = lessMask(epsilon, max4(det, zero - det));
+
+        // u = (o - p0) . pvec / det
+        Float4 tx = ox - p0x, ty = oy - p0y, tz = oz - p0z;
+        Float4 u = (tx * px + ty * py + tz * pz) * invDet;
+        // q = t x e1, v = d . q / det, t = e2 . q / det
+        Float4 qx = ty * e1z - tz * e1y;
+        Float4 qy = tz * e1x - tx * e1z;
+        Float4 qz = tx * e1y - ty * e1x;
+        Float4 v = (dx * qx + dy * qy + dz * qz) * invDet;
+        Float4 t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+        mask &= lessEqualMask(zero, u) & lessEqualMask(zero, v) & lessEqualMask(u + v, one) &
+                lessMask(epsilon, t);
+        if (!mask) {
+            continue;
+        }
+
+        float tValues[4], uValues[4], vValues[4];
+        t.store(tValues);
+        u.store(uValues);
+        v.store(vValues);
+        for (int lane = 0; lane < 4 && first + lane < count; lane++) {
+            RayHit& hit = picker->hits[picker->activeRays[first + lane]];
+            if (!(mask & (1 << lane)) || tValues[lane] >= hit.distance) {
+                continue;
+            }
+            const SbLine& line = picker->rays[picker->activeRays[first + lane]];
+            float bu = uValues[lane], bv = vValues[lane];
+            SbVec3f normal = v1->getNormal() * (1.0f - bu - bv) + v2->getNormal() * bu +
+                             v3->getNormal() * bv;
+            picker->normalMatrix.multDirMatrix(normal, hit.normal);
+            hit.normal.normalize();
+            hit.shape = picker->shapeIndex;
+            hit.distance = tValues[lane];
+            hit.point = line.getPosition() + line.getDirection() * tValues[lane];
+        }
+    }
+}
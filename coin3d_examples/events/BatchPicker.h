@@ -0,0 +1,73 @@
+/*
+ * Batch Picker
+ * Nearest hits for thousands of rays with a single scene traversal
+ *
+ * The rays are first run through the PickBVH as four-ray SIMD packets,
+ * which yields for every shape the rays that can hit its box. One
+ * SoCallbackAction traversal then prunes all shapes without rays and
+ * intersects the triangles of the others with their rays, again four rays
+ * at a time. Hits are on the tessellation SoCallbackAction produces, so
+ * analytic shapes (spheres, cones, ...) hit at their current complexity.
+ */
+
+#ifndef COIN3D_EXAMPLES_BATCH_PICKER_H
+#define COIN3D_EXAMPLES_BATCH_PICKER_H
+
+#include <Inventor/SbLinear.h>
+#include <Inventor/actions/SoCallbackAction.h>
+
+#include <utility>
+#include <vector>
+
+#include "PickBVH.h"
+
+class SoPrimitiveVertex;
+
+// Nearest hit of one ray; shape is an index for PickBVH::getShapePath(),
+// -1 if the ray hit nothing
+struct RayHit
+{
+    int shape;
+    float distance;
+    SbVec3f point;  // world space
+    SbVec3f normal; // world space, interpolated from the vertex normals
+};
+
+class BatchPicker
+{
+public:
+    explicit BatchPicker(PickBVH* bvh);
+
+    // hits[i] receives the nearest hit of rays[i]
+    void pick(const SbLine* rays, int numRays, std::vector<RayHit>& hits);
+
+    // Shapes and triangles intersected during the last pick
+    size_t getNumShapesTested() const { return numShapesTested; }
+    size_t getNumTrianglesTested() const { return numTrianglesTested; }
+
+private:
+    static SoCallbackAction::Response preShapeCB(void* data, SoCallbackAction* action,
+                                                 const SoNode* node);
+    static void triangleCB(void* data, SoCallbackAction* action, const SoPrimitiveVertex* v1,
+                           const SoPrimitiveVertex* v2, const SoPrimitiveVertex* v3);
+
+    PickBVH* bvh;
+
+    // State of the running pick
+    const SbLine* rays;
+    RayHit* hits;
+    std::vector<std::pair<int, int> > shapeRays;
+    size_t nextShapeRay;
+    int shapeIndex;
+
+    // Rays of the current shape, structure of arrays padded to 4
+    std::vector<int> activeRays;
+    std::vector<float> activeData[6];
+    SbMatrix modelMatrix;
+    SbMatrix normalMatrix;
+
+    size_t numShapesTested;
+    size_t numTrianglesTested;
+};
+
+#endif // COIN3D_EXAMPLES_BATCH_PICKER_H
@@ -0,0 +1,528 @@
+/*
+ * Pick BVH
+ * Hierarchy construction, refitting and candidate-pruned ray picking
+ */
+
+#include "PickBVH.h"
+#include "PickSimd.h"
+#include "NotificationBatch.h"
+#include "BenchmarkUtils.h"
+
+#include <Inventor/SoPath.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoGetMatrixAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/nodes/SoCamera.h>
+#include <Inventor/nodes/SoCoordinate3.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoSwitch.h>
+#include <Inventor/nodes/SoTransformation.h>
+#include <Inventor/nodes/SoVertexProperty.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <thread>
+
+// Shapes per leaf
+static const int leafSize = 4;
+
+// Ray / box slab test; tNear is the entry distance along the ray
+static bool intersectBox(const float* min, const float* max, const float* origin,
+                         const float* invDir, float& tNear)
+{
+    float t0 = 0.0f;
+    float t1 = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+        float ta = (min[axis] - origin[axis]) * invDir[axis];
+        float tb = (max[axis] - origin[axis]) * invDir[axis];
+        if (ta > tb) {
+            std::swap(ta, tb);
+        }
+        t0 = ta > t0 ? ta : t0;
+        t1 = tb < t1 ? tb : t1;
+        if (t0 > t1) {
+            return false;
+        }
+    }
+    tNear = t0;
+    return true;
+}
+
+PickBVH::PickBVH(SoNode* root)
+    : root(root), cameraPath(NULL), numThreads(0), nextNode(0), numNodes(0),
+      topologyDirty(true), refitAll(false), collectIndex(0), collectBoxesOnly(false),
+      numTested(0), buildSeconds(0.0), refitSeconds(0.0)
+{
+    root->ref();
+
+    // Immediate, so the trigger node and field of each change are known
+    sensor = new SoNodeSensor(rootChangedCB, this);
+    sensor->setPriority(0);
+    sensor->attach(root);
+}
+
+PickBVH::~PickBVH()
+{
+    sensor->detach();
+    delete sensor;
+    clear();
+    root->unref();
+}
+
+void PickBVH::clear()
+{
+    for (size_t i = 0; i < paths.size(); i++) {
+        paths[i]->unref();
+    }
+    paths.clear();
+    boxes.clear();
+    shapeDirty.clear();
+    dependents.clear();
+    groupTransforms.clear();
+    dirtyShapes.clear();
+    if (cameraPath) {
+        cameraPath->unref();
+        cameraPath = NULL;
+    }
+}
+
+void PickBVH::rootChangedCB(void* data, SoSensor* s)
+{
+    PickBVH* bvh = (PickBVH*)data;
+    SoNodeSensor* sensor = (SoNodeSensor*)s;
+    if (bvh->topologyDirty) {
+        return;
+    }
+
+    SoNode* node = sensor->getTriggerNode();
+    SoField* field = sensor->getTriggerField();
+    const std::vector<NotificationBatch::Edit>* edits = NotificationBatch::getCommittingEdits();
+    if (node && !field && edits) {
+        // Edits a NotificationBatch merged into one notification from their
+        // common ancestor
+        for (size_t i = 0; i < edits->size() && !bvh->topologyDirty; i++) {
+            bvh->nodeChanged((*edits)[i].node, (*edits)[i].field);
+        }
+        return;
+    }
+    bvh->nodeChanged(node, field);
+}
+
+void PickBVH::nodeChanged(SoNode* node, SoField* field)
+{
+    if (!node || !field || node->isOfType(SoSwitch::getClassTypeId())) {
+        // Children added, removed or switched
+        topologyDirty = true;
+        return;
+    }
+
+    std::unordered_map<SoNode*, std::vector<int> >::iterator it = dependents.find(node);
+    if (it != dependents.end()) {
+        for (size_t i = 0; i < it->second.size(); i++) {
+            markShapeDirty(it->second[i]);
+        }
+    } else if (node->isOfType(SoTransformation::getClassTypeId()) ||
+               node->isOfType(SoCoordinate3::getClassTypeId()) ||
+               node->isOfType(SoVertexProperty::getClassTypeId())) {
+        // Geometry state whose users were not tracked, e.g. a transform
+        // nested in a group before the shape's ancestor
+        refitAll = true;
+    }
+    // Anything else (materials, cameras, ...) does not move shapes
+}
+
+void PickBVH::markShapeDirty(int shape)
+{
+    if (!shapeDirty[shape]) {
+        shapeDirty[shape] = 1;
+        dirtyShapes.push_back(shape);
+    }
+}
+
+SoCallbackAction::Response PickBVH::collectShapeCB(void* data, SoCallbackAction* action,
+                                                   const SoNode* node)
+{
+    PickBVH* bvh = (PickBVH*)data;
+    SbBox3f box;
+    SbVec3f center;
+    ((SoShape*)node)->computeBBox(action, box, center);
+    if (!box.isEmpty()) {
+        box.transform(action->getModelMatrix());
+    }
+
+    if (bvh->collectBoxesOnly) {
+        // Same traversal order as when the shapes were collected
+        if (bvh->collectIndex < bvh->boxes.size()) {
+            bvh->boxes[bvh->collectIndex] = box;
+        }
+        bvh->collectIndex++;
+        return SoCallbackAction::CONTINUE;
+    }
+
+    int shape = (int)bvh->paths.size();
+    SoPath* path = action->getCurPath()->copy();
+    path->ref();
+    bvh->paths.push_back(path);
+    bvh->boxes.push_back(box);
+    bvh->shapeDirty.push_back(0);
+    bvh->addDependencies(action, shape);
+    return SoCallbackAction::CONTINUE;
+}
+
+void PickBVH::addDependencies(SoCallbackAction* action, int shape)
+{
+    // The shape depends on itself and on the transformations that precede
+    // it among the children of each of its ancestors
+    const SoFullPath* path = (const SoFullPath*)action->getCurPath();
+    for (int i = 1; i < path->getLength(); i++) {
+        SoNode* parent = path->getNode(i - 1);
+        std::unordered_map<SoNode*, std::vector<std::pair<int, SoNode*> > >::iterator it =
+            groupTransforms.find(parent);
+        if (it == groupTransforms.end()) {
+            // Scan each group once, not once per shape below it
+            std::vector<std::pair<int, SoNode*> > transforms;
+            SoChildList* children = parent->getChildren();
+            for (int c = 0; children && c < children->getLength(); c++) {
+                if ((*children)[c]->isOfType(SoTransformation::getClassTypeId())) {
+                    transforms.push_back(std::make_pair(c, (*children)[c]));
+                }
+            }
+            it = groupTransforms.insert(std::make_pair(parent, transforms)).first;
+        }
+        int index = path->getIndex(i);
+        for (size_t t = 0; t < it->second.size() && it->second[t].first < index; t++) {
+            dependents[it->second[t].second].push_back(shape);
+        }
+    }
+    dependents[path->getTail()].push_back(shape);
+}
+
+void PickBVH::collect(bool boxesOnly)
+{
+    collectBoxesOnly = boxesOnly;
+    collectIndex = 0;
+    SoCallbackAction action;
+    action.addPreCallback(SoShape::getClassTypeId(), collectShapeCB, this);
+    action.apply(root);
+}
+
+void PickBVH::setNodeBounds(Node& node, int begin, int end) const
+{
+    SbBox3f box;
+    for (int i = begin; i < end; i++) {
+        box.extendBy(boxes[order[i]]);
+    }
+    SbVec3f min, max;
+    box.getBounds(min, max);
+    for (int axis = 0; axis < 3; axis++) {
+        node.min[axis] = min[axis];
+        node.max[axis] = max[axis];
+    }
+}
+
+void PickBVH::buildRange(int index, int begin, int end, int depth, int spawnDepth)
+{
+    Node& node = nodes[index];
+    setNodeBounds(node, begin, end);
+    if (end - begin <= leafSize) {
+        node.first = begin;
+        node.count = end - begin;
+        return;
+    }
+
+    // Median split along the longest axis of the box centers
+    SbBox3f centerBox;
+    for (int i = begin; i < end; i++) {
+        centerBox.extendBy(centroids[order[i]]);
+    }
+    float dx, dy, dz;
+    centerBox.getSize(dx, dy, dz);
+    int axis = (dx >= dy && dx >= dz) ? 0 : (dy >= dz ? 1 : 2);
+    int mid = (begin + end) / 2;
+    const std::vector<SbVec3f>& centers = centroids;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                     [&centers, axis](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+
+    int children = nextNode.fetch_add(2);
+    node.first = children;
+    node.count = 0;
+    if (depth < spawnDepth) {
+        std::thread left([=]() { buildRange(children, begin, mid, depth + 1, spawnDepth); });
+        buildRange(children + 1, mid, end, depth + 1, spawnDepth);
+        left.join();
+    } else {
+        buildRange(children, begin, mid, depth + 1, spawnDepth);
+        buildRange(children + 1, mid, end, depth + 1, spawnDepth);
+    }
+}
+
+void PickBVH::rebuild()
+{
+    BenchTimer timer;
+    clear();
+    collect(false);
+
+    SoSearchAction search;
+    search.setType(SoCamera::getClassTypeId());
+    search.setInterest(SoSearchAction::FIRST);
+    search.apply(root);
+    if (search.getPath()) {
+        cameraPath = search.getPath()->copy();
+        cameraPath->ref();
+    }
+
+    int count = (int)boxes.size();
+    order.resize(count);
+    centroids.resize(count);
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+        centroids[i] = boxes[i].isEmpty() ? SbVec3f(0, 0, 0) : boxes[i].getCenter();
+    }
+
+    // Subtrees below the first levels are built on their own threads
+    unsigned threads = numThreads ? numThreads : std::thread::hardware_concurrency();
+    int spawnDepth = 0;
+    while ((1u << spawnDepth) < threads) {
+        spawnDepth++;
+    }
+
+    nodes.resize(count > 0 ? 2 * count : 1);
+    nextNode = 1;
+    if (count > 0) {
+        buildRange(0, 0, count, 0, spawnDepth);
+    } else {
+        nodes[0].first = 0;
+        nodes[0].count = 0;
+        setNodeBounds(nodes[0], 0, 0);
+    }
+    numNodes = nextNode;
+    centroids.clear();
+
+    topologyDirty = false;
+    refitAll = false;
+    buildSeconds = timer.seconds();
+}
+
+void PickBVH::refit()
+{
+    BenchTimer timer;
+    if (refitAll) {
+        collect(true);
+    } else {
+        SoGetBoundingBoxAction bboxAction(SbViewportRegion(640, 480));
+        for (size_t i = 0; i < dirtyShapes.size(); i++) {
+            bboxAction.apply(paths[dirtyShapes[i]]);
+            boxes[dirtyShapes[i]] = bboxAction.getBoundingBox();
+        }
+    }
+    for (size_t i = 0; i < dirtyShapes.size(); i++) {
+        shapeDirty[dirtyShapes[i]] = 0;
+    }
+    dirtyShapes.clear();
+    refitAll = false;
+
+    // Children always come after their parent, so one backward sweep
+    // updates the whole hierarchy
+    for (size_t i = numNodes; i-- > 0;) {
+        Node& node = nodes[i];
+        if (node.count > 0 || boxes.empty()) {
+            setNodeBounds(node, node.first, node.first + node.count);
+            continue;
+        }
+        const Node& a = nodes[node.first];
+        const Node& b = nodes[node.first + 1];
+        for (int axis = 0; axis < 3; axis++) {
+            node.min[axis] = std::min(a.min[axis], b.min[axis]);
+            node.max[axis] = std::max(a.max[axis], b.max[axis]);
+        }
+    }
+    refitSeconds = timer.seconds();
+}
+
+void PickBVH::update()
+{
+    if (topologyDirty) {
+        rebuild();
+    } else if (refitAll || !dirtyShapes.empty()) {
+        refit();
+    }
+}
+
+void PickBVH::findCandidates(const SbLine& line, std::vector<std::pair<float, int> >& candidates)
+{
+    update();
+    candidates.clear();
+    if (boxes.empty()) {
+        return;
+    }
+
+    const SbVec3f& position = line.getPosition();
+    const SbVec3f& direction = line.getDirection();
+    float origin[3], invDir[3];
+    for (int axis = 0; axis < 3; axis++) {
+        origin[axis] = position[axis];
+        invDir[axis] = direction[axis] != 0.0f ? 1.0f / direction[axis] : FLT_MAX;
+    }
+
+    std::vector<int> stack(1, 0);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        float t;
+        if (!intersectBox(node.min, node.max, origin, invDir, t)) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack.push_back(node.first);
+            stack.push_back(node.first + 1);
+            continue;
+        }
+        for (int i = node.first; i < node.first + node.count; i++) {
+            SbVec3f min, max;
+            boxes[order[i]].getBounds(min, max);
+            if (intersectBox(min.getValue(), max.getValue(), origin, invDir, t)) {
+                candidates.push_back(std::make_pair(t, order[i]));
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+}
+
+void PickBVH::findRayCandidates(const SbLine* lines, int numLines,
+                                std::vector<std::pair<int, int> >& shapeRays)
+{
+    update();
+    shapeRays.clear();
+    if (boxes.empty()) {
+        return;
+    }
+
+    std::vector<std::pair<int, int> > stack;
+    for (int first = 0; first < numLines; first += 4) {
+        // Unused lanes of the last packet repeat its first ray, masked off
+        int lanes = std::min(4, numLines - first);
+        float values[9][4];
+        for (int lane = 0; lane < 4; lane++) {
+            const SbLine& line = lines[first + (lane < lanes ? lane : 0)];
+            const SbVec3f& position = line.getPosition();
+            const SbVec3f& direction = line.getDirection();
+            for (int axis = 0; axis < 3; axis++) {
+                values[axis][lane] = position[axis];
+                values[3 + axis][lane] = direction[axis];
+                values[6 + axis][lane] =
+                    direction[axis] != 0.0f ? 1.0f / direction[axis] : FLT_MAX;
+            }
+        }
+        RayPacket4 packet;
+        for (int axis = 0; axis < 3; axis++) {
+            packet.origin[axis] = Float4::load(values[axis]);
+            packet.direction[axis] = Float4::load(values[3 + axis]);
+            packet.invDirection[axis] = Float4::load(values[6 + axis]);
+        }
+
+        stack.clear();
+        stack.push_back(std::make_pair(0, (1 << lanes) - 1));
+        while (!stack.empty()) {
+            const Node& node = nodes[stack.back().first];
+            int mask = stack.back().second & intersectBox4(packet, node.min, node.max);
+            stack.pop_back();
+            if (!mask) {
+                continue;
+            }
+            if (node.count == 0) {
+                stack.push_back(std::make_pair(node.first, mask));
+                stack.push_back(std::make_pair(node.first + 1, mask));
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; i++) {
+                const SbBox3f& box = boxes[order[i]];
+                if (box.isEmpty()) {
+                    continue;
+                }
+                int hits = mask & intersectBox4(packet, box.getMin().getValue(),
+                                                box.getMax().getValue());
+                for (int lane = 0; hits; lane++, hits >>= 1) {
+                    if (hits & 1) {
+                        shapeRays.push_back(std::make_pair(order[i], first + lane));
+                    }
+                }
+            }
+        }
+    }
+    std::sort(shapeRays.begin(), shapeRays.end());
+}
+
+SbLine PickBVH::cameraRay(const SbViewportRegion& viewport, const SbVec2s& pixel) const
+{
+    // The camera's view volume in world space, with the transformations
+    // above the camera and its viewport mapping applied
+    SoCamera* camera = (SoCamera*)cameraPath->getTail();
+    SoGetMatrixAction matrixAction(viewport);
+    matrixAction.apply(cameraPath);
+    SbViewportRegion cameraViewport;
+    SbViewVolume volume = camera->getViewVolume(viewport, cameraViewport,
+                                                matrixAction.getMatrix());
+
+    // The pixel normalized the way SoRayPickAction::setPoint() does it
+    SbVec2s origin = cameraViewport.getViewportOriginPixels();
+    SbVec2s size = cameraViewport.getViewportSizePixels();
+    SbVec2f normalized((float)(pixel[0] - origin[0]) / std::max((int)size[0], 1),
+                       (float)(pixel[1] - origin[1]) / std::max((int)size[1], 1));
+    SbLine line;
+    volume.projectPointToLine(normalized, line);
+    return line;
+}
+
+SoPickedPoint* PickBVH::pick(SoRayPickAction& action, const SbVec2s& pixel)
+{
+    update();
+    action.setPoint(pixel);
+    action.setPickAll(FALSE);
+    numTested = 0;
+    if (!cameraPath) {
+        // No camera to project with, so there is nothing to prune
+        action.apply(root);
+        numTested = paths.size();
+        SoPickedPoint* picked = action.getPickedPoint();
+        return picked ? picked->copy() : NULL;
+    }
+
+    SbLine line = cameraRay(action.getViewportRegion(), pixel);
+    std::vector<std::pair<float, int> > candidates;
+    findCandidates(line, candidates);
+
+    // Pick growing batches of candidates until the nearest hit lies in
+    // front of every remaining candidate box
+    SoPickedPoint* best = NULL;
+    float bestDistance = FLT_MAX;
+    size_t next = 0;
+    size_t batch = 8;
+    while (next < candidates.size() && candidates[next].first < bestDistance) {
+        SoPathList list;
+        size_t end = std::min(candidates.size(), next + batch);
+        for (; next < end; next++) {
+            list.append(paths[candidates[next].second]);
+        }
+        numTested += list.getLength();
+        batch *= 2;
+
+        action.apply(list, FALSE);
+        SoPickedPoint* picked = action.getPickedPoint();
+        if (picked) {
+            float distance = (picked->getPoint() - line.getPosition()).dot(line.getDirection());
+            if (distance < bestDistance) {
+                delete best;
+                best = picked->copy();
+                bestDistance = distance;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,142 @@
+/*
+ * Pick BVH
+ * Bounding volume hierarchy that prunes SoRayPickAction traversal
+ *
+ * The hierarchy is built over the world-space bounding boxes of all shapes
+ * under the root. A pick first intersects the ray with the hierarchy and
+ * then applies the SoRayPickAction to the paths of the candidate shapes
+ * only, nearest box first, so Coin skips every other subtree while still
+ * traversing the state-changing nodes (camera, transforms, materials) on
+ * the way. Picked points are identical to picking the whole graph.
+ *
+ * An immediate sensor on the root tracks edits. Transform and shape field
+ * changes mark the affected shapes, whose boxes are recomputed and the
+ * hierarchy refit before the next pick. Child list and switch edits
+ * rebuild it; the shape boxes are collected in one traversal and the
+ * hierarchy itself is built on several threads. Edits committed by a
+ * NotificationBatch are resolved one by one, even where the batch merged
+ * their notifications.
+ */
+
+#ifndef COIN3D_EXAMPLES_PICK_BVH_H
+#define COIN3D_EXAMPLES_PICK_BVH_H
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbLinear.h>
+#include <Inventor/actions/SoCallbackAction.h>
+
+#include <atomic>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class SbViewportRegion;
+class SoField;
+class SoNode;
+class SoPath;
+class SoPickedPoint;
+class SoRayPickAction;
+class SoSensor;
+class SoNodeSensor;
+
+class PickBVH
+{
+public:
+    explicit PickBVH(SoNode* root);
+    ~PickBVH();
+
+    // Threads used to build the hierarchy, 0 = hardware concurrency
+    void setNumThreads(unsigned threads) { numThreads = threads; }
+
+    // Pick through a pixel of the action's viewport with the first camera
+    // in the graph, like action.setPoint(pixel) and action.apply(root).
+    // Returns a copy of the nearest picked point for the caller to delete,
+    // or NULL if nothing was hit.
+    SoPickedPoint* pick(SoRayPickAction& action, const SbVec2s& pixel);
+
+    // Shapes whose world box the line hits, nearest box entry first
+    void findCandidates(const SbLine& line, std::vector<std::pair<float, int> >& candidates);
+
+    // (shape, ray) pairs for every ray whose line hits a shape box, sorted
+    // by shape; rays are traversed four at a time as SIMD packets
+    void findRayCandidates(const SbLine* lines, int numLines,
+                           std::vector<std::pair<int, int> >& shapeRays);
+
+    // Bring the hierarchy up to date with the scene graph now instead of
+    // on the next pick
+    void update();
+
+    SoNode* getRoot() const { return root; }
+    int getNumShapes() const { return (int)boxes.size(); }
+    const SoPath* getShapePath(int shape) const { return paths[shape]; }
+    const SbBox3f& getShapeBox(int shape) const { return boxes[shape]; }
+    size_t getNumNodes() const { return numNodes; }
+    // Shapes tested by the action during the last pick
+    size_t getNumTested() const { return numTested; }
+    double getBuildSeconds() const { return buildSeconds; }
+    double getRefitSeconds() const { return refitSeconds; }
+
+private:
+    PickBVH(const PickBVH&);
+    PickBVH& operator=(const PickBVH&);
+
+    // Inner nodes have count 0 and their children at first and first + 1;
+    // leaves cover order[first, first + count)
+    struct Node
+    {
+        float min[3];
+        float max[3];
+        int first;
+        int count;
+    };
+
+    static void rootChangedCB(void* data, SoSensor* sensor);
+    void nodeChanged(SoNode* node, SoField* field);
+    static SoCallbackAction::Response collectShapeCB(void* data, SoCallbackAction* action,
+                                                     const SoNode* node);
+
+    // World space ray through pixel of viewport from the camera
+    SbLine cameraRay(const SbViewportRegion& viewport, const SbVec2s& pixel) const;
+    void rebuild();
+    void refit();
+    void collect(bool boxesOnly);
+    void addDependencies(SoCallbackAction* action, int shape);
+    void buildRange(int node, int begin, int end, int depth, int spawnDepth);
+    void setNodeBounds(Node& node, int begin, int end) const;
+    void markShapeDirty(int shape);
+    void clear();
+
+    SoNode* root;
+    SoNodeSensor* sensor;
+    SoPath* cameraPath;
+    unsigned numThreads;
+
+    // Per shape, in traversal order
+    std::vector<SoPath*> paths;
+    std::vector<SbBox3f> boxes;
+    std::vector<char> shapeDirty;
+
+    // Transforms and shape nodes each shape's box depends on
+    std::unordered_map<SoNode*, std::vector<int> > dependents;
+    // Transformations among the children of a group, with their index
+    std::unordered_map<SoNode*, std::vector<std::pair<int, SoNode*> > > groupTransforms;
+
+    std::vector<Node> nodes;
+    std::vector<int> order;
+    std::vector<SbVec3f> centroids; // only during builds
+    std::atomic<int> nextNode;
+    size_t numNodes;
+
+    bool topologyDirty;
+    bool refitAll;
+    std::vector<int> dirtyShapes;
+    size_t collectIndex;
+    bool collectBoxesOnly;
+
+    size_t numTested;
+    double buildSeconds;
+    double refitSeconds;
+};
+
+#endif // COIN3D_EXAMPLES_PICK_BVH_H
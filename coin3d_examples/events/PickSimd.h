@@ -0,0 +1,33 @@
+/*
+ * Pick SIMD
+ * Ray packet kernels shared by PickBVH and BatchPicker
+ */
+
+#ifndef COIN3D_EXAMPLES_PICK_SIMD_H
+#define COIN3D_EXAMPLES_PICK_SIMD_H
+
+#include "Float4.h"
+
+// Four rays in structure-of-arrays layout
+struct RayPacket4
+{
+    Float4 origin[3];
+    Float4 direction[3];
+    Float4 invDirection[3];
+};
+
+// Lanes of the packet whose ray enters the box at a distance >= 0
+inline int intersectBox4(const RayPacket4& rays, const float* min, const float* max)
+{
+    Float4 tNear(0.0f);
+    Float4 tFar(3.0e38f);
+    for (int axis = 0; axis < 3; axis++) {
+        Float4 ta = (Float4(min[axis]) - rays.origin[axis]) * rays.invDirection[axis];
+        Float4 tb = (Float4(max[axis]) - rays.origin[axis]) * rays.invDirection[axis];
+        tNear = max4(tNear, min4(ta, tb));
+        tFar = min4(tFar, max4(ta, tb));
+    }
+    return lessEqualMask(tNear, tFar);
+}
+
+#endif // COIN3D_EXAMPLES_PICK_SIMD_H
@@ -0,0 +1,114 @@
+/*
+ * Batch Pick Benchmark
+ * Throughput in rays/sec of one SoRayPickAction per ray compared to
+ * BatchPicker, for a ray per pixel of a coarse grid over the cameras
+ * example scene
+ *
+ * Usage: events_batch_pick_benchmark [objects per side] [grid width] [grid height]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ExampleScenes.h"
+#include "PickBVH.h"
+#include "BatchPicker.h"
+#include "BenchmarkUtils.h"
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int objectsPerSide = argc > 1 ? atoi(argv[1]) : 100;
+    int gridWidth = argc > 2 ? atoi(argv[2]) : 64;
+    int gridHeight = argc > 3 ? atoi(argv[3]) : 48;
+
+    SbViewportRegion viewport(1024, 768);
+    SoSeparator* root = createCamerasScene(objectsPerSide);
+    root->ref();
+    SoPerspectiveCamera* camera = (SoPerspectiveCamera*)root->getChild(0);
+    camera->viewAll(root, viewport);
+
+    // One world-space ray through the center of every grid cell
+    SbViewVolume viewVolume = camera->getViewVolume(viewport.getViewportAspectRatio());
+    std::vector<SbLine> rays;
+    for (int y = 0; y < gridHeight; y++) {
+        for (int x = 0; x < gridWidth; x++) {
+            SbLine line;
+            viewVolume.projectPointToLine(
+                SbVec2f((x + 0.5f) / gridWidth, (y + 0.5f) / gridHeight), line);
+            rays.push_back(line);
+        }
+    }
+    int numRays = (int)rays.size();
+
+    // The reference is slow on big scenes, so it runs on every k-th ray only
+    int stride = numRays > 256 ? numRays / 256 : 1;
+    std::vector<const SoNode*> expected(numRays, (const SoNode*)NULL);
+    int numLinear = 0;
+    BenchTimer timer;
+    for (int i = 0; i < numRays; i += stride) {
+        SoRayPickAction action(viewport);
+        action.setRay(rays[i].getPosition(), rays[i].getDirection());
+        action.apply(root);
+        SoPickedPoint* picked = action.getPickedPoint();
+        if (picked) {
+            expected[i] = ((SoFullPath*)picked->getPath())->getTail();
+        }
+        numLinear++;
+    }
+    double linearSeconds = timer.seconds();
+
+    PickBVH bvh(root);
+    timer.restart();
+    bvh.update();
+    double buildSeconds = timer.seconds();
+
+    BatchPicker picker(&bvh);
+    std::vector<RayHit> hits;
+    timer.restart();
+    picker.pick(&rays[0], numRays, hits);
+    double batchSeconds = timer.seconds();
+
+    // The same shape must be hit; tessellated and analytic spheres may
+    // disagree at silhouettes
+    int numHits = 0, agree = 0, compared = 0;
+    for (int i = 0; i < numRays; i++) {
+        if (hits[i].shape >= 0) {
+            numHits++;
+        }
+        if (i % stride != 0) {
+            continue;
+        }
+        const SoNode* node = hits[i].shape >= 0
+            ? ((const SoFullPath*)bvh.getShapePath(hits[i].shape))->getTail() : NULL;
+        compared++;
+        if (node == expected[i]) {
+            agree++;
+        }
+    }
+
+    printf("%d shapes, %d x %d rays, %d hits; BVH build %.1f ms\n", bvh.getNumShapes(),
+           gridWidth, gridHeight, numHits, buildSeconds * 1000.0);
+    printf("%-22s %12.0f rays/s (%d rays in %.1f ms)\n", "SoRayPickAction/ray",
+           linearSeconds > 0.0 ? numLinear / linearSeconds : 0.0, numLinear,
+           linearSeconds * 1000.0);
+    printf("%-22s %12.0f rays/s (%d rays in %.1f ms, %lu shapes, %lu triangles)\n",
+           "BatchPicker", batchSeconds > 0.0 ? numRays / batchSeconds : 0.0, numRays,
+           batchSeconds * 1000.0, (unsigned long)picker.getNumShapesTested(),
+           (unsigned long)picker.getNumTrianglesTested());
+    printf("same shape as SoRayPickAction: %d / %d rays\n", agree, compared);
+
+    root->unref();
+    return 0;
+}
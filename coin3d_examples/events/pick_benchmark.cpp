@@ -0,0 +1,108 @@
+/*
+ * Pick Benchmark
+ * Ray pick latency against scene size, with a plain SoRayPickAction over
+ * the whole graph (linear) compared to PickBVH, on the cameras example grid
+ * scaled from 100 to ~500k spheres
+ *
+ * Usage: events_pick_benchmark [objects per side ...]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SoPickedPoint.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoTransform.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ExampleScenes.h"
+#include "PickBVH.h"
+#include "BenchmarkUtils.h"
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    std::vector<int> sides;
+    for (int i = 1; i < argc; i++) {
+        sides.push_back(atoi(argv[i]));
+    }
+    if (sides.empty()) {
+        sides.push_back(10);
+        sides.push_back(32);
+        sides.push_back(100);
+        sides.push_back(317);
+        sides.push_back(708); // ~500k
+    }
+
+    SbViewportRegion viewport(1024, 768);
+    const int numPicks = 20;
+
+    printf("%10s %10s %12s %10s %12s %10s %10s %8s %6s\n", "shapes", "build ms", "linear ms",
+           "bvh ms", "speedup", "tested", "refit ms", "nodes", "same");
+    for (size_t s = 0; s < sides.size(); s++) {
+        SoSeparator* root = createCamerasScene(sides[s]);
+        root->ref();
+        SoPerspectiveCamera* camera = (SoPerspectiveCamera*)root->getChild(0);
+        camera->viewAll(root, viewport);
+
+        // Pixels spread over the middle of the viewport, same for both modes
+        std::vector<SbVec2s> pixels;
+        srand(42);
+        for (int i = 0; i < numPicks; i++) {
+            pixels.push_back(SbVec2s((short)(256 + rand() % 512), (short)(192 + rand() % 384)));
+        }
+
+        PickBVH bvh(root);
+        bvh.update();
+        double buildMs = bvh.getBuildSeconds() * 1000.0;
+
+        double linearMs = 0.0, bvhMs = 0.0;
+        size_t tested = 0;
+        int same = 0;
+        for (int i = 0; i < numPicks; i++) {
+            BenchTimer timer;
+            SoRayPickAction linear(viewport);
+            linear.setPoint(pixels[i]);
+            linear.apply(root);
+            SoPickedPoint* expected = linear.getPickedPoint();
+            linearMs += timer.milliseconds();
+
+            timer.restart();
+            SoRayPickAction action(viewport);
+            SoPickedPoint* picked = bvh.pick(action, pixels[i]);
+            bvhMs += timer.milliseconds();
+            tested += bvh.getNumTested();
+
+            if (!expected && !picked) {
+                same++;
+            } else if (expected && picked &&
+                       ((SoFullPath*)expected->getPath())->getTail() ==
+                           ((SoFullPath*)picked->getPath())->getTail() &&
+                       expected->getPath()->getLength() == picked->getPath()->getLength() &&
+                       (expected->getPoint() - picked->getPoint()).length() < 1e-4f) {
+                same++;
+            }
+            delete picked;
+        }
+
+        // Move one sphere: only its box is recomputed and the tree refit
+        SoTransform* transform = (SoTransform*)((SoSeparator*)root->getChild(1))->getChild(0);
+        transform->translation.setValue(0.0f, 0.0f, 1.0f);
+        bvh.update();
+        double refitMs = bvh.getRefitSeconds() * 1000.0;
+
+        printf("%10d %10.1f %12.3f %10.3f %11.1fx %10.1f %10.3f %8lu %3d/%d\n",
+               bvh.getNumShapes(), buildMs, linearMs / numPicks, bvhMs / numPicks,
+               bvhMs > 0.0 ? linearMs / bvhMs : 0.0, (double)tested / numPicks, refitMs,
+               (unsigned long)bvh.getNumNodes(), same, numPicks);
+        root->unref();
+    }
+    return 0;
+}
@@ -0,0 +1,437 @@
+/*
+ * Scene Chunk Writer
+ * Incremental, streaming scene saves into a chunked container file
+ */
+
+#include "SceneChunkWriter.h"
+#include "SceneIO.h"
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/C/basic.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+static const uint32_t containerVersion = 1;
+static const uint32_t flagBinary = 1;
+static const uint32_t flagZlib = 2;
+static const size_t recordHeaderSize = 32; // "CHNK" id flags pad rawSize storedSize
+static const size_t footerSize = 12;       // indexOffset "SEND"
+
+#ifdef _WIN32
+#define seekFile _fseeki64
+#else
+#define seekFile fseeko
+#endif
+
+// Serialize one node (and everything below it) into memory
+static std::vector<char> serializeNode(SoNode* node, bool binary)
+{
+    SoOutput out;
+    size_t initialSize = 64 * 1024;
+    out.setBuffer(malloc(initialSize), initialSize, realloc);
+    out.setBinary(binary ? TRUE : FALSE);
+    SoWriteAction wa(&out);
+    wa.apply(node);
+
+    void* buffer = NULL;
+    size_t size = 0;
+    out.getBuffer(buffer, size);
+    std::vector<char> data((char*)buffer, (char*)buffer + size);
+    free(buffer);
+    return data;
+}
+
+static bool compressChunk(const std::vector<char>& raw, int level, std::vector<char>& packed)
+{
+#ifdef HAVE_ZLIB
+    uLongf size = compressBound((uLong)raw.size());
+    packed.resize(size);
+    if (compress2((Bytef*)packed.data(), &size, (const Bytef*)raw.data(),
+                  (uLong)raw.size(), level) != Z_OK) {
+        return false;
+    }
+    packed.resize(size);
+    return true;
+#else
+    (void)raw;
+    (void)level;
+    (void)packed;
+    return false;
+#endif
+}
+
+static bool writeBytes(FILE* fp, const void* data, size_t size, uint64_t& position)
+{
+    if (size > 0 && fwrite(data, 1, size, fp) != size) {
+        return false;
+    }
+    position += size;
+    return true;
+}
+
+template <class T>
+static bool writeValue(FILE* fp, T value, uint64_t& position)
+{
+    return writeBytes(fp, &value, sizeof(value), position);
+}
+
+template <class T>
+static T readValue(const char* data)
+{
+    T value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+bool SceneChunkWriter::isCompressionAvailable()
+{
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+SceneChunkWriter::SceneChunkWriter(SoSeparator* root, const char* filename)
+    : root(root), filename(filename), nextId(0), binary(false),
+      compressionLevel(0), hasSaved(false), fileSize(0), job(NULL), running(false)
+{
+    root->ref();
+}
+
+SceneChunkWriter::~SceneChunkWriter()
+{
+    wait();
+    for (size_t i = 0; i < chunks.size(); i++) {
+        chunks[i]->sensor->detach();
+        delete chunks[i]->sensor;
+        chunks[i]->node->unref();
+        delete chunks[i];
+    }
+    root->unref();
+}
+
+void SceneChunkWriter::chunkChangedCB(void* data, SoSensor* sensor)
+{
+    ((Chunk*)data)->dirty = true;
+}
+
+int SceneChunkWriter::getNumDirtyChunks() const
+{
+    int count = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (chunks[i]->dirty) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Bring the chunk table in line with the children of the root: new children
+// become new (dirty) chunks, removed children drop their chunk
+void SceneChunkWriter::syncChunks()
+{
+    std::multimap<SoNode*, Chunk*> existing;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        existing.insert(std::make_pair(chunks[i]->node, chunks[i]));
+    }
+
+    std::vector<Chunk*> synced;
+    for (int i = 0; i < root->getNumChildren(); i++) {
+        SoNode* node = root->getChild(i);
+        std::multimap<SoNode*, Chunk*>::iterator it = existing.find(node);
+        if (it != existing.end()) {
+            synced.push_back(it->second);
+            existing.erase(it);
+            continue;
+        }
+        Chunk* chunk = new Chunk;
+        chunk->node = node;
+        chunk->node->ref();
+        chunk->id = nextId++;
+        chunk->dirty = true;
+        // Immediate sensor, so the dirty flag is set as soon as the edit happens
+        chunk->sensor = new SoNodeSensor(chunkChangedCB, chunk);
+        chunk->sensor->setPriority(0);
+        chunk->sensor->attach(node);
+        synced.push_back(chunk);
+    }
+
+    for (std::multimap<SoNode*, Chunk*>::iterator it = existing.begin(); it != existing.end(); ++it) {
+        it->second->sensor->detach();
+        delete it->second->sensor;
+        it->second->node->unref();
+        delete it->second;
+    }
+    chunks = synced;
+}
+
+bool SceneChunkWriter::saveFull()
+{
+    return startSave(true);
+}
+
+bool SceneChunkWriter::saveIncremental()
+{
+    return startSave(false);
+}
+
+bool SceneChunkWriter::startSave(bool full)
+{
+    wait();
+    BenchTimer stallTimer;
+    saveTimer.restart();
+    syncChunks();
+
+    if (!hasSaved) {
+        full = true;
+    } else if (!full) {
+        // Compact once more than half of the file is superseded records
+        uint64_t liveBytes = 0;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            std::map<uint32_t, uint64_t>::const_iterator it = recordSizes.find(chunks[i]->id);
+            if (it != recordSizes.end()) {
+                liveBytes += it->second;
+            }
+        }
+        if (fileSize > 2 * liveBytes + 4096) {
+            full = true;
+        }
+    }
+
+    job = new Job;
+    job->full = full;
+    job->binary = binary;
+    job->level = compressionLevel;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        Chunk* chunk = chunks[i];
+        job->order.push_back(chunk->id);
+        if (!full && !chunk->dirty) {
+            continue;
+        }
+        job->ids.push_back(chunk->id);
+#ifdef COIN_THREADSAFE
+        // Snapshot: the background thread writes a private copy
+        SoNode* snapshot = chunk->node->copy();
+        snapshot->ref();
+        job->snapshots.push_back(snapshot);
+        job->serialized.push_back(std::vector<char>());
+#else
+        // SoWriteAction must stay on this thread without thread support in
+        // Coin; compression and file I/O still happen in the background
+        job->snapshots.push_back(NULL);
+        job->serialized.push_back(serializeNode(chunk->node, binary));
+#endif
+        chunk->dirty = false;
+    }
+
+    stats = SceneSaveStats();
+    stats.incremental = !full;
+    stats.chunksWritten = job->ids.size();
+    stats.chunksTotal = chunks.size();
+    stats.stallSeconds = stallTimer.seconds();
+    hasSaved = true;
+
+    running = true;
+    worker = std::thread(&SceneChunkWriter::runJob, this, job);
+    return true;
+}
+
+void SceneChunkWriter::runJob(Job* job)
+{
+    // A full save goes to a temporary file that is renamed into place, so
+    // a crash or write error never costs the previous scene. Offsets are
+    // kept aside until the save has succeeded.
+    std::string tempPath = filename + ".tmp";
+    FILE* fp = fopen(job->full ? tempPath.c_str() : filename.c_str(), job->full ? "wb" : "r+b");
+    bool ok = fp != NULL;
+    uint64_t start = job->full ? 0 : fileSize;
+    uint64_t position = start;
+    std::map<uint32_t, uint64_t> offsets, sizes;
+    if (!job->full) {
+        offsets = recordOffsets;
+        sizes = recordSizes;
+    }
+
+    if (ok && job->full) {
+        ok = writeBytes(fp, "SCNK", 4, position) &&
+             writeValue<uint32_t>(fp, containerVersion, position);
+    } else if (ok) {
+        // Append after the last footer, the old index stays as garbage
+        ok = seekFile(fp, (long long)fileSize, SEEK_SET) == 0;
+    }
+
+    // Chunk records
+    for (size_t i = 0; ok && i < job->ids.size(); i++) {
+        std::vector<char> raw;
+        if (job->snapshots[i]) {
+            raw = serializeNode(job->snapshots[i], job->binary);
+        } else {
+            raw.swap(job->serialized[i]);
+        }
+
+        uint32_t flags = job->binary ? flagBinary : 0;
+        std::vector<char> packed;
+        const std::vector<char>* data = &raw;
+        if (job->level > 0 && compressChunk(raw, job->level, packed)) {
+            flags |= flagZlib;
+            data = &packed;
+        }
+
+        uint64_t recordStart = position;
+        ok = writeBytes(fp, "CHNK", 4, position) &&
+             writeValue<uint32_t>(fp, job->ids[i], position) &&
+             writeValue<uint32_t>(fp, flags, position) &&
+             writeValue<uint32_t>(fp, 0, position) &&
+             writeValue<uint64_t>(fp, raw.size(), position) &&
+             writeValue<uint64_t>(fp, data->size(), position) &&
+             writeBytes(fp, data->data(), data->size(), position);
+        offsets[job->ids[i]] = recordStart;
+        sizes[job->ids[i]] = position - recordStart;
+    }
+
+    // Index of the current chunk order, then the footer pointing at it
+    uint64_t indexOffset = position;
+    if (ok) {
+        ok = writeBytes(fp, "INDX", 4, position) &&
+             writeValue<uint32_t>(fp, (uint32_t)job->order.size(), position);
+    }
+    for (size_t i = 0; ok && i < job->order.size(); i++) {
+        ok = writeValue<uint32_t>(fp, job->order[i], position) &&
+             writeValue<uint64_t>(fp, offsets[job->order[i]], position);
+    }
+    if (ok) {
+        ok = writeValue<uint64_t>(fp, indexOffset, position) &&
+             writeBytes(fp, "SEND", 4, position);
+    }
+    if (fp) {
+        ok = (fclose(fp) == 0) && ok;
+    }
+    if (job->full) {
+        if (ok) {
+            remove(filename.c_str()); // rename() does not replace on Windows
+            ok = rename(tempPath.c_str(), filename.c_str()) == 0;
+        }
+        if (!ok) {
+            remove(tempPath.c_str());
+        }
+    }
+
+    if (ok) {
+        recordOffsets.swap(offsets);
+        recordSizes.swap(sizes);
+        fileSize = position;
+    }
+    stats.ok = ok;
+    stats.bytesWritten = (size_t)(position - start);
+    stats.totalSeconds = saveTimer.seconds();
+    running = false;
+}
+
+SceneSaveStats SceneChunkWriter::wait()
+{
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (job) {
+        // Snapshots are released here, on the thread that created them
+        for (size_t i = 0; i < job->snapshots.size(); i++) {
+            if (job->snapshots[i]) {
+                job->snapshots[i]->unref();
+            }
+        }
+        delete job;
+        job = NULL;
+        // After a failed save the file cannot be trusted, start over
+        if (!stats.ok) {
+            hasSaved = false;
+        }
+    }
+    return stats;
+}
+
+// Function to read a scene written by SceneChunkWriter
+SoSeparator* readChunkedScene(const char* filename)
+{
+    MappedFile file;
+    if (!file.open(filename)) {
+        return NULL;
+    }
+    const char* data = (const char*)file.getData();
+    size_t size = file.getSize();
+    if (size < 8 + footerSize || memcmp(data, "SCNK", 4) != 0 ||
+        memcmp(data + size - 4, "SEND", 4) != 0) {
+        return NULL;
+    }
+
+    uint64_t indexOffset = readValue<uint64_t>(data + size - footerSize);
+    if (indexOffset + 8 > size || memcmp(data + indexOffset, "INDX", 4) != 0) {
+        return NULL;
+    }
+    uint32_t count = readValue<uint32_t>(data + indexOffset + 4);
+    if (indexOffset + 8 + (uint64_t)count * 12 > size) {
+        return NULL;
+    }
+
+    SoSeparator* root = new SoSeparator;
+    root->ref();
+    for (uint32_t i = 0; i < count; i++) {
+        const char* entry = data + indexOffset + 8 + i * 12;
+        uint64_t recordOffset = readValue<uint64_t>(entry + 4);
+        if (recordOffset + recordHeaderSize > size ||
+            memcmp(data + recordOffset, "CHNK", 4) != 0) {
+            root->unref();
+            return NULL;
+        }
+        const char* record = data + recordOffset;
+        uint32_t flags = readValue<uint32_t>(record + 8);
+        uint64_t rawSize = readValue<uint64_t>(record + 16);
+        uint64_t storedSize = readValue<uint64_t>(record + 24);
+        if (recordOffset + recordHeaderSize + storedSize > size) {
+            root->unref();
+            return NULL;
+        }
+
+        const char* payload = record + recordHeaderSize;
+        std::vector<char> inflated;
+        if (flags & flagZlib) {
+#ifdef HAVE_ZLIB
+            inflated.resize((size_t)rawSize);
+            uLongf length = (uLongf)rawSize;
+            if (uncompress((Bytef*)inflated.data(), &length, (const Bytef*)payload,
+                           (uLong)storedSize) != Z_OK || length != rawSize) {
+                root->unref();
+                return NULL;
+            }
+            payload = inflated.data();
+            storedSize = rawSize;
+#else
+            root->unref();
+            return NULL;
+#endif
+        }
+
+        // SoDB::read keeps the chunk's own root node, separator or not
+        SoInput in;
+        in.setBuffer(payload, (size_t)storedSize);
+        SoNode* node = NULL;
+        if (!SoDB::read(&in, node) || !node) {
+            root->unref();
+            return NULL;
+        }
+        root->addChild(node);
+    }
+    root->unrefNoDelete();
+    return root;
+}
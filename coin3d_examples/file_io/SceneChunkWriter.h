@@ -0,0 +1,133 @@
+/*
+ * Scene Chunk Writer
+ * Incremental, streaming scene saves for the File I/O example
+ *
+ * Every child of the root is one chunk of a log-structured container file.
+ * Node sensors mark chunks dirty when anything below them changes, and an
+ * incremental save appends only the dirty chunks plus a new index to the
+ * file. Chunks can be written as ASCII or binary Inventor and compressed
+ * with zlib. Saves run on a background thread against a snapshot (copy) of
+ * the dirty chunks, so the calling thread only pays for taking the snapshot.
+ *
+ * Container layout (native byte order):
+ *   "SCNK" version
+ *   chunk record: "CHNK" id flags rawSize storedSize data...
+ *   ...
+ *   index record: "INDX" count { id recordOffset }...
+ *   footer:       indexOffset "SEND"
+ * The last footer in the file is the valid one; older records and indices
+ * become garbage and are dropped by the next full save. A full save is
+ * written to <file>.tmp and renamed into place, so the previous scene
+ * survives a crash or write error.
+ */
+
+#ifndef COIN3D_EXAMPLES_SCENE_CHUNK_WRITER_H
+#define COIN3D_EXAMPLES_SCENE_CHUNK_WRITER_H
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+
+class SoNode;
+class SoSeparator;
+class SoSensor;
+class SoNodeSensor;
+
+// Result of one save
+struct SceneSaveStats
+{
+    bool ok;
+    bool incremental;      // false for a full rewrite
+    size_t chunksWritten;
+    size_t chunksTotal;
+    size_t bytesWritten;   // bytes appended to / written into the file
+    double stallSeconds;   // time the calling thread was blocked
+    double totalSeconds;   // time until the data was on disk
+
+    SceneSaveStats()
+        : ok(false), incremental(false), chunksWritten(0), chunksTotal(0),
+          bytesWritten(0), stallSeconds(0.0), totalSeconds(0.0) {}
+};
+
+class SceneChunkWriter
+{
+public:
+    SceneChunkWriter(SoSeparator* root, const char* filename);
+    ~SceneChunkWriter();
+
+    void setBinary(bool on) { binary = on; }
+    // 0 disables compression, 1-9 is the zlib level
+    void setCompressionLevel(int level) { compressionLevel = level; }
+    static bool isCompressionAvailable();
+
+    // Start a save of all chunks / of the dirty chunks only. An earlier save
+    // still in flight is waited for first. The first save is always full.
+    bool saveFull();
+    bool saveIncremental();
+
+    // Wait for the background save and return its stats
+    SceneSaveStats wait();
+    bool isSaving() const { return running; }
+
+    int getNumChunks() const { return (int)chunks.size(); }
+    int getNumDirtyChunks() const;
+
+private:
+    SceneChunkWriter(const SceneChunkWriter&);
+    SceneChunkWriter& operator=(const SceneChunkWriter&);
+
+    struct Chunk
+    {
+        SoNode* node;
+        uint32_t id;
+        bool dirty;
+        SoNodeSensor* sensor;
+    };
+
+    // Everything the background thread needs, owned by the job
+    struct Job
+    {
+        bool full;
+        bool binary;
+        int level;
+        std::vector<uint32_t> order;                // ids in child order
+        std::vector<uint32_t> ids;                  // ids of chunks to write
+        std::vector<SoNode*> snapshots;             // copies, or NULL if pre-serialized
+        std::vector<std::vector<char> > serialized; // chunks serialized up front
+    };
+
+    void syncChunks();
+    bool startSave(bool full);
+    void runJob(Job* job);
+    static void chunkChangedCB(void* data, SoSensor* sensor);
+
+    SoSeparator* root;
+    std::string filename;
+    std::vector<Chunk*> chunks;
+    uint32_t nextId;
+    bool binary;
+    int compressionLevel;
+    bool hasSaved;
+
+    // Written by the background thread, read only while it is idle
+    std::map<uint32_t, uint64_t> recordOffsets;
+    std::map<uint32_t, uint64_t> recordSizes;
+    uint64_t fileSize;
+
+    Job* job;
+    std::thread worker;
+    std::atomic<bool> running;
+    SceneSaveStats stats;
+    BenchTimer saveTimer;
+};
+
+// Function to read a scene written by SceneChunkWriter
+SoSeparator* readChunkedScene(const char* filename);
+
+#endif // COIN3D_EXAMPLES_SCENE_CHUNK_WRITER_H
@@ -0,0 +1,429 @@
+/*
+ * Scene I/O helpers for the File I/O example
+ * Implements buffered and memory-mapped scene loading
+ */
+
+#include "SceneIO.h"
+#include "SoDeferredFile.h"
+#include "BenchmarkUtils.h"
+
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/C/basic.h>
+#include <Inventor/errors/SoDebugError.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// Size of a file on disk, 0 if it cannot be queried
+static size_t fileSize(const char* filename)
+{
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(filename, &info) != 0) {
+        return 0;
+    }
+#else
+    struct stat info;
+    if (stat(filename, &info) != 0) {
+        return 0;
+    }
+#endif
+    return (size_t)info.st_size;
+}
+
+#ifndef COIN_THREADSAFE
+// Coin was built without thread support, so only one thread may be inside
+// the parser at a time. Mapping and hashing still run in parallel.
+static std::mutex parseMutex;
+#endif
+
+// Run body(i) for every i in [0, count) on numThreads threads, the calling
+// thread included. Work is handed out one index at a time.
+template <class Body>
+static void parallelFor(size_t count, unsigned numThreads, const Body& body)
+{
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < numThreads && t < count; t++) {
+        workers.push_back(std::thread([&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                body(i);
+            }
+        }));
+    }
+    for (size_t i = next++; i < count; i = next++) {
+        body(i);
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+}
+
+uint64_t hashBytes(const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Function to create a sample scene
+SoSeparator* createSampleScene()
+{
+    SoSeparator* root = new SoSeparator;
+    
+    // Create a sphere
+    SoSeparator* sphereSep = new SoSeparator;
+    SoTransform* sphereTransform = new SoTransform;
+    sphereTransform->translation.setValue(-2, 0, 0);
+    SoMaterial* sphereMaterial = new SoMaterial;
+    sphereMaterial->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
+    SoSphere* sphere = new SoSphere;
+    sphere->radius = 1.0;
+    sphereSep->addChild(sphereTransform);
+    sphereSep->addChild(sphereMaterial);
+    sphereSep->addChild(sphere);
+    root->addChild(sphereSep);
+    
+    // Create a cube
+    SoSeparator* cubeSep = new SoSeparator;
+    SoTransform* cubeTransform = new SoTransform;
+    cubeTransform->translation.setValue(2, 0, 0);
+    SoMaterial* cubeMaterial = new SoMaterial;
+    cubeMaterial->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
+    SoCube* cube = new SoCube;
+    cube->width = 1.5;
+    cube->height = 1.5;
+    cube->depth = 1.5;
+    cubeSep->addChild(cubeTransform);
+    cubeSep->addChild(cubeMaterial);
+    cubeSep->addChild(cube);
+    root->addChild(cubeSep);
+    
+    return root;
+}
+
+// Function to write scene to file
+void writeSceneToFile(SoSeparator* root, const char* filename)
+{
+    SoOutput out;
+    if (out.openFile(filename)) {
+        SoWriteAction wa(&out);
+        wa.apply(root);
+        out.closeFile();
+    }
+}
+
+// Function to read scene from file
+SoSeparator* readSceneFromFile(const char* filename, SceneLoadStats* stats)
+{
+    BenchTimer timer;
+    SoSeparator* root = NULL;
+    SoInput in;
+    if (in.openFile(filename)) {
+        root = SoDB::readAll(&in);
+        in.closeFile();
+    }
+    if (stats) {
+        stats->bytes = fileSize(filename);
+        stats->seconds = timer.seconds();
+        stats->mapped = false;
+    }
+    return root;
+}
+
+// Function to read scene from a memory-mapped file
+SoSeparator* readSceneFromFileMapped(const char* filename, SceneLoadStats* stats)
+{
+    BenchTimer timer;
+    MappedFile file;
+    if (!file.open(filename)) {
+        return NULL;
+    }
+
+    // gzip streams cannot be parsed in place, let SoInput inflate them
+    const unsigned char* bytes = (const unsigned char*)file.getData();
+    if (file.getSize() >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+        file.close();
+        return readSceneFromFile(filename, stats);
+    }
+
+    // SoInput reads straight out of the mapping and detects ASCII vs.
+    // binary Inventor from the file header
+    SoInput in;
+    in.setBuffer(file.getData(), file.getSize());
+    SoSeparator* root = SoDB::readAll(&in);
+
+    if (stats) {
+        stats->bytes = file.getSize();
+        stats->seconds = timer.seconds();
+        stats->mapped = true;
+    }
+    return root;
+}
+
+// Header line that starts every cache file: magic, source hash, source size
+static const char* cacheMagic = "#SceneCache";
+
+static std::string cacheHeader(uint64_t hash, size_t size)
+{
+    char header[64];
+    snprintf(header, sizeof(header), "%s %016llx %llu\n", cacheMagic,
+             (unsigned long long)hash, (unsigned long long)size);
+    return header;
+}
+
+// Write header + root in binary Inventor format. The data goes to a
+// temporary file first and is renamed into place, so a crash while writing
+// never leaves a truncated cache behind.
+static size_t writeSceneCache(SoSeparator* root, const std::string& cachePath,
+                              const std::string& header)
+{
+    SoOutput out;
+    size_t initialSize = 1024 * 1024;
+    out.setBuffer(malloc(initialSize), initialSize, realloc);
+    out.setBinary(TRUE);
+    SoWriteAction wa(&out);
+    wa.apply(root);
+
+    void* buffer = NULL;
+    size_t bufferSize = 0;
+    out.getBuffer(buffer, bufferSize);
+
+    std::string tempPath = cachePath + ".tmp";
+    size_t written = 0;
+    FILE* fp = fopen(tempPath.c_str(), "wb");
+    if (fp) {
+        bool ok = fwrite(header.data(), 1, header.size(), fp) == header.size() &&
+                  fwrite(buffer, 1, bufferSize, fp) == bufferSize;
+        ok = (fclose(fp) == 0) && ok;
+        if (ok) {
+            remove(cachePath.c_str()); // rename() does not replace on Windows
+            if (rename(tempPath.c_str(), cachePath.c_str()) == 0) {
+                written = header.size() + bufferSize;
+            }
+        }
+        if (!written) {
+            remove(tempPath.c_str());
+        }
+    }
+    free(buffer);
+    return written;
+}
+
+std::string sceneCachePath(const char* filename)
+{
+    return std::string(filename) + ".ivcache";
+}
+
+// Function to read scene from file through a binary cache
+SoSeparator* readSceneCached(const char* filename, SceneCacheStats* stats)
+{
+    SceneCacheStats local;
+    SceneCacheStats& st = stats ? *stats : local;
+    st = SceneCacheStats();
+
+    // Hash the source; this is a single pass over the mapped file and far
+    // cheaper than parsing it
+    BenchTimer timer;
+    std::string header;
+    {
+        MappedFile source;
+        if (!source.open(filename)) {
+            return NULL;
+        }
+        st.sourceBytes = source.getSize();
+        header = cacheHeader(hashBytes(source.getData(), source.getSize()), source.getSize());
+    }
+    st.hashSeconds = timer.seconds();
+
+    // Warm path: header matches, parse the binary scene that follows it
+    std::string cachePath = sceneCachePath(filename);
+    timer.restart();
+    {
+        MappedFile cache;
+        if (cache.open(cachePath.c_str()) && cache.getSize() > header.size() &&
+            memcmp(cache.getData(), header.data(), header.size()) == 0) {
+            SoInput in;
+            in.setBuffer((const char*)cache.getData() + header.size(),
+                         cache.getSize() - header.size());
+            SoSeparator* root = SoDB::readAll(&in);
+            if (root) {
+                st.hit = true;
+                st.cacheBytes = cache.getSize();
+                st.loadSeconds = timer.seconds();
+                return root;
+            }
+        }
+    }
+
+    // Cold path: parse the source text, then (re)write the cache
+    timer.restart();
+    SoSeparator* root = readSceneFromFileMapped(filename);
+    st.loadSeconds = timer.seconds();
+    if (!root) {
+        return NULL;
+    }
+
+    timer.restart();
+    root->ref();
+    st.cacheBytes = writeSceneCache(root, cachePath, header);
+    root->unrefNoDelete();
+    st.writeSeconds = timer.seconds();
+    return root;
+}
+
+// Function to split a scene into lazily loaded chunks
+SoSeparator* writeDeferredScene(SoSeparator* root, const char* dataFile)
+{
+    FILE* fp = fopen(dataFile, "wb");
+    if (!fp) {
+        return NULL;
+    }
+
+    SoSeparator* index = new SoSeparator;
+    SoGetBoundingBoxAction bboxAction(SbViewportRegion(640, 480));
+    size_t position = 0;
+    for (int i = 0; i < root->getNumChildren(); i++) {
+        SoNode* child = root->getChild(i);
+
+        // Each chunk gets its own header so it can be parsed on its own
+        SoOutput out;
+        size_t initialSize = 64 * 1024;
+        out.setBuffer(malloc(initialSize), initialSize, realloc);
+        SoWriteAction wa(&out);
+        wa.apply(child);
+        void* buffer = NULL;
+        size_t bufferSize = 0;
+        out.getBuffer(buffer, bufferSize);
+        // The proxy fields hold 32-bit byte ranges, which cannot address a
+        // data file beyond 4 GB
+        bool addressable = (uint64_t)position + bufferSize <= 0xffffffffu;
+        if (!addressable) {
+            SoDebugError::post("writeDeferredScene",
+                               "%s would exceed the 4 GB SoDeferredFile can address", dataFile);
+        }
+        bool ok = addressable && fwrite(buffer, 1, bufferSize, fp) == bufferSize;
+        free(buffer);
+        if (!ok) {
+            fclose(fp);
+            index->ref();
+            index->unref();
+            return NULL;
+        }
+
+        bboxAction.apply(child);
+        SbBox3f box = bboxAction.getBoundingBox();
+
+        SoDeferredFile* proxy = new SoDeferredFile;
+        proxy->name = dataFile;
+        proxy->offset = (uint32_t)position;
+        proxy->length = (uint32_t)bufferSize;
+        proxy->bboxMin = box.getMin();
+        proxy->bboxMax = box.getMax();
+        index->addChild(proxy);
+        position += bufferSize;
+    }
+
+    if (fclose(fp) != 0) {
+        index->ref();
+        index->unref();
+        return NULL;
+    }
+    return index;
+}
+
+// Function to load many scene files into one root
+SoSeparator* loadScenesParallel(const std::vector<std::string>& paths,
+                                unsigned numThreads, ParallelLoadStats* stats)
+{
+    BenchTimer timer;
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0) {
+            numThreads = 1;
+        }
+    }
+
+    // Pass 1: fingerprint every file (size + content hash)
+    std::vector<uint64_t> hashes(paths.size(), 0);
+    std::vector<size_t> sizes(paths.size(), 0);
+    parallelFor(paths.size(), numThreads, [&](size_t i) {
+        MappedFile file;
+        if (file.open(paths[i].c_str())) {
+            sizes[i] = file.getSize();
+            hashes[i] = hashBytes(file.getData(), file.getSize());
+        }
+    });
+
+    // Group files with identical contents, the first path of a group is
+    // the one that gets parsed
+    const size_t missing = (size_t)-1;
+    std::map<std::pair<uint64_t, size_t>, size_t> groups;
+    std::vector<size_t> groupOfPath(paths.size(), missing);
+    std::vector<size_t> representatives;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (sizes[i] == 0) {
+            continue;
+        }
+        std::pair<uint64_t, size_t> key(hashes[i], sizes[i]);
+        std::map<std::pair<uint64_t, size_t>, size_t>::iterator it = groups.find(key);
+        if (it == groups.end()) {
+            it = groups.insert(std::make_pair(key, representatives.size())).first;
+            representatives.push_back(i);
+        }
+        groupOfPath[i] = it->second;
+    }
+
+    // Pass 2: parse each distinct file once, every worker with its own SoInput
+    std::vector<SoSeparator*> parts(representatives.size(), (SoSeparator*)NULL);
+    parallelFor(representatives.size(), numThreads, [&](size_t k) {
+#ifndef COIN_THREADSAFE
+        std::lock_guard<std::mutex> lock(parseMutex);
+#endif
+        parts[k] = readSceneFromFileMapped(paths[representatives[k]].c_str());
+    });
+
+    // Attach on the calling thread, in path order. Duplicates share the
+    // same subgraph, which simply gets several references from the root.
+    SoSeparator* root = new SoSeparator;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (groupOfPath[i] != missing && parts[groupOfPath[i]]) {
+            root->addChild(parts[groupOfPath[i]]);
+        }
+    }
+
+    if (stats) {
+        stats->files = paths.size();
+        stats->uniqueFiles = representatives.size();
+        stats->bytes = 0;
+        for (size_t k = 0; k < representatives.size(); k++) {
+            stats->bytes += sizes[representatives[k]];
+        }
+        stats->threads = numThreads;
+        stats->seconds = timer.seconds();
+    }
+    return root;
+}
@@ -0,0 +1,107 @@
+/*
+ * Scene I/O helpers for the File I/O example
+ * Includes: Sample scene, Buffered read/write, Memory-mapped zero-copy read
+ */
+
+#ifndef COIN3D_EXAMPLES_SCENE_IO_H
+#define COIN3D_EXAMPLES_SCENE_IO_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+class SoSeparator;
+
+// Timing and size information collected while loading a scene
+struct SceneLoadStats
+{
+    size_t bytes;      // size of the file on disk
+    double seconds;    // wall-clock time spent opening and parsing
+    bool mapped;       // true if the file was parsed from a mapped region
+
+    SceneLoadStats() : bytes(0), seconds(0.0), mapped(false) {}
+
+    double bytesPerSecond() const { return seconds > 0.0 ? bytes / seconds : 0.0; }
+};
+
+// Statistics of a loadScenesParallel() call
+struct ParallelLoadStats
+{
+    size_t files;        // number of paths requested
+    size_t uniqueFiles;  // number of distinct file contents actually parsed
+    size_t bytes;        // bytes parsed (unique files only)
+    unsigned threads;    // worker threads used
+    double seconds;      // wall-clock time of the whole call
+
+    ParallelLoadStats() : files(0), uniqueFiles(0), bytes(0), threads(0), seconds(0.0) {}
+
+    double bytesPerSecond() const { return seconds > 0.0 ? bytes / seconds : 0.0; }
+};
+
+// Timing information of a readSceneCached() call. A cold load parses the
+// source text and writes the cache, a warm load only parses the cache.
+struct SceneCacheStats
+{
+    bool hit;             // true if a valid cache was used
+    size_t sourceBytes;   // size of the source file
+    size_t cacheBytes;    // size of the cache file
+    double hashSeconds;   // hashing the source file
+    double loadSeconds;   // parsing source text (cold) or binary cache (warm)
+    double writeSeconds;  // writing the cache (cold only)
+
+    SceneCacheStats()
+        : hit(false), sourceBytes(0), cacheBytes(0),
+          hashSeconds(0.0), loadSeconds(0.0), writeSeconds(0.0) {}
+
+    double totalSeconds() const { return hashSeconds + loadSeconds + writeSeconds; }
+};
+
+// Function to create a sample scene
+SoSeparator* createSampleScene();
+
+// Function to write scene to file
+void writeSceneToFile(SoSeparator* root, const char* filename);
+
+// Function to read scene from file (buffered stdio reads through SoInput)
+SoSeparator* readSceneFromFile(const char* filename, SceneLoadStats* stats = NULL);
+
+// Function to read scene from file by mapping it into memory and handing the
+// mapped region to SoInput::setBuffer, so no copy of the file is made.
+// ASCII and binary Inventor are detected from the header; gzip compressed
+// files are passed on to SoInput::openFile which inflates them while reading.
+SoSeparator* readSceneFromFileMapped(const char* filename, SceneLoadStats* stats = NULL);
+
+// 64-bit FNV-1a hash of a byte range, used to identify identical files
+uint64_t hashBytes(const void* data, size_t size);
+
+// Path of the binary cache kept next to a scene file
+std::string sceneCachePath(const char* filename);
+
+// Function to read scene from file through a binary cache. The cache holds
+// the content hash of the source followed by the scene in binary Inventor
+// format. If the hash still matches, the text parser is skipped entirely;
+// otherwise the source is parsed and the cache is (re)written.
+SoSeparator* readSceneCached(const char* filename, SceneCacheStats* stats = NULL);
+
+// Function to split a scene for lazy loading. Every child of root is written
+// as a self-contained Inventor chunk to dataFile, and an index scene with one
+// SoDeferredFile proxy per child (byte range + bounding box) is returned.
+// Children are expected to be separators, as in all example scenes.
+// SoDeferredFile::initClass() must have been called. Fails with an error
+// message if the data file would grow beyond the 4 GB the proxies' 32-bit
+// offsets can address.
+SoSeparator* writeDeferredScene(SoSeparator* root, const char* dataFile);
+
+// Function to load many scene files into one root. Files are hashed and
+// parsed on a pool of worker threads (each with its own SoInput); files
+// with identical content are parsed once and the resulting subgraph is
+// shared under the root. Subgraphs are attached on the calling thread in
+// the order of the paths. numThreads == 0 uses all hardware threads.
+SoSeparator* loadScenesParallel(const std::vector<std::string>& paths,
+                                unsigned numThreads = 0,
+                                ParallelLoadStats* stats = NULL);
+
+#endif // COIN3D_EXAMPLES_SCENE_IO_H
@@ -0,0 +1,303 @@
+/*
+ * SoDeferredFile
+ * Lazy subtree loading with bounding-box proxies and LRU eviction
+ */
+
+#include "SoDeferredFile.h"
+#include "SceneIO.h"
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoRayPickAction.h>
+#include <Inventor/actions/SoGetMatrixAction.h>
+#include <Inventor/actions/SoHandleEventAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/actions/SoGetPrimitiveCountAction.h>
+#include <Inventor/elements/SoCullElement.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+SO_NODE_SOURCE(SoDeferredFile);
+
+// Global state shared by all proxies
+static size_t memoryBudget = 0;
+static size_t residentTotal = 0;
+static unsigned long loadCount = 0;
+static unsigned long evictionCount = 0;
+static SoDeferredFile* lruHead = NULL;  // most recently used
+static SoDeferredFile* lruTail = NULL;  // least recently used
+
+void SoDeferredFile::initClass()
+{
+    SO_NODE_INIT_CLASS(SoDeferredFile, SoNode, "Node");
+    // Used to skip loading of subtrees outside the view volume
+    SO_ENABLE(SoGLRenderAction, SoCullElement);
+}
+
+SoDeferredFile::SoDeferredFile()
+    : residentBytes(0), traversalDepth(0), lruPrev(NULL), lruNext(NULL)
+{
+    SO_NODE_CONSTRUCTOR(SoDeferredFile);
+    SO_NODE_ADD_FIELD(name, (""));
+    SO_NODE_ADD_FIELD(offset, (0));
+    SO_NODE_ADD_FIELD(length, (0));
+    SO_NODE_ADD_FIELD(bboxMin, (0, 0, 0));
+    SO_NODE_ADD_FIELD(bboxMax, (0, 0, 0));
+    children = new SoChildList(this);
+}
+
+SoDeferredFile::~SoDeferredFile()
+{
+    unload();
+    delete children;
+}
+
+SoChildList* SoDeferredFile::getChildren() const
+{
+    return children;
+}
+
+SbBox3f SoDeferredFile::getProxyBoundingBox() const
+{
+    return SbBox3f(bboxMin.getValue(), bboxMax.getValue());
+}
+
+SbBool SoDeferredFile::isLoaded() const
+{
+    return children->getLength() > 0;
+}
+
+// Parse the byte range [offset, offset + length) of the file. The range is
+// a complete Inventor file on its own, header included.
+SbBool SoDeferredFile::load()
+{
+    if (isLoaded()) {
+        linkMostRecent();
+        return TRUE;
+    }
+
+    size_t start = offset.getValue();
+    size_t size = length.getValue();
+    MappedFile file;
+    if (size == 0 || !file.open(name.getValue().getString()) ||
+        start + size > file.getSize()) {
+        return FALSE;
+    }
+
+    SoInput in;
+    in.setBuffer((const char*)file.getData() + start, size);
+    SoSeparator* subtree = SoDB::readAll(&in);
+    if (!subtree) {
+        return FALSE;
+    }
+
+    // Loading changes what the proxy holds, not what the scene shows, so
+    // no notification: caches and sensors above are not invalidated
+    SbBool notifying = enableNotify(FALSE);
+    children->append(subtree);
+    enableNotify(notifying);
+    residentBytes = size;
+    residentTotal += size;
+    loadCount++;
+    linkMostRecent();
+    evictToBudget();
+    return TRUE;
+}
+
+void SoDeferredFile::unload()
+{
+    if (!isLoaded()) {
+        return;
+    }
+    unlink();
+    residentTotal -= residentBytes;
+    residentBytes = 0;
+    SbBool notifying = enableNotify(FALSE);
+    children->truncate(0);
+    enableNotify(notifying);
+}
+
+void SoDeferredFile::linkMostRecent()
+{
+    if (lruHead == this) {
+        return;
+    }
+    unlink();
+    lruNext = lruHead;
+    if (lruHead) {
+        lruHead->lruPrev = this;
+    }
+    lruHead = this;
+    if (!lruTail) {
+        lruTail = this;
+    }
+}
+
+void SoDeferredFile::unlink()
+{
+    if (lruPrev) {
+        lruPrev->lruNext = lruNext;
+    } else if (lruHead == this) {
+        lruHead = lruNext;
+    }
+    if (lruNext) {
+        lruNext->lruPrev = lruPrev;
+    } else if (lruTail == this) {
+        lruTail = lruPrev;
+    }
+    lruPrev = lruNext = NULL;
+}
+
+// Share of the budget eviction brings the resident bytes down to, so the
+// next few loads do not evict again right away
+static const double evictionLowWater = 0.75;
+
+// Once over budget, unload least recently used subtrees down to the low
+// water mark. Subtrees that are being traversed right now (an enclosing
+// proxy) are kept.
+void SoDeferredFile::evictToBudget()
+{
+    if (memoryBudget == 0 || residentTotal <= memoryBudget) {
+        return;
+    }
+    size_t target = (size_t)(memoryBudget * evictionLowWater);
+    SoDeferredFile* candidate = lruTail;
+    while (residentTotal > target && candidate) {
+        SoDeferredFile* prev = candidate->lruPrev;
+        if (candidate->traversalDepth == 0 && candidate != lruHead) {
+            candidate->unload();
+            evictionCount++;
+        }
+        candidate = prev;
+    }
+}
+
+void SoDeferredFile::traverseChildren(SoAction* action)
+{
+    if (!load()) {
+        return;
+    }
+    traversalDepth++;
+    int numIndices;
+    const int* indices;
+    if (action->getPathCode(numIndices, indices) == SoAction::IN_PATH) {
+        children->traverseInPath(action, numIndices, indices);
+    } else {
+        children->traverse(action);
+    }
+    traversalDepth--;
+}
+
+void SoDeferredFile::doAction(SoAction* action)
+{
+    if (isLoaded()) {
+        traverseChildren(action);
+    }
+}
+
+void SoDeferredFile::GLRender(SoGLRenderAction* action)
+{
+    // Subtrees outside the view volume are neither loaded nor rendered
+    if (!isLoaded() && SoCullElement::cullBox(action->getState(), getProxyBoundingBox())) {
+        return;
+    }
+    traverseChildren(action);
+}
+
+void SoDeferredFile::getBoundingBox(SoGetBoundingBoxAction* action)
+{
+    // Answered from the proxy box, a bounding box query never loads
+    if (isLoaded()) {
+        traverseChildren(action);
+        return;
+    }
+    SbBox3f box = getProxyBoundingBox();
+    if (!box.isEmpty()) {
+        action->extendBy(box);
+        action->setCenter(box.getCenter(), TRUE);
+    }
+}
+
+void SoDeferredFile::callback(SoCallbackAction* action)
+{
+    traverseChildren(action);
+}
+
+void SoDeferredFile::rayPick(SoRayPickAction* action)
+{
+    // Only load when the ray actually hits the proxy box
+    if (!isLoaded()) {
+        action->setObjectSpace();
+        if (!action->intersect(getProxyBoundingBox(), TRUE)) {
+            return;
+        }
+    }
+    traverseChildren(action);
+}
+
+void SoDeferredFile::getMatrix(SoGetMatrixAction* action)
+{
+    int numIndices;
+    const int* indices;
+    if (action->getPathCode(numIndices, indices) == SoAction::IN_PATH) {
+        traverseChildren(action);
+    }
+}
+
+void SoDeferredFile::handleEvent(SoHandleEventAction* action)
+{
+    doAction(action);
+}
+
+void SoDeferredFile::search(SoSearchAction* action)
+{
+    SoNode::search(action);
+    if (!action->isFound()) {
+        doAction(action);
+    }
+}
+
+void SoDeferredFile::getPrimitiveCount(SoGetPrimitiveCountAction* action)
+{
+    doAction(action);
+}
+
+void SoDeferredFile::notify(SoNotList* list)
+{
+    // A proxy that points somewhere else drops what it has loaded
+    SoField* field = list->getLastField();
+    if (field == &name || field == &offset || field == &length) {
+        unload();
+    }
+    SoNode::notify(list);
+}
+
+void SoDeferredFile::setMemoryBudget(size_t bytes)
+{
+    memoryBudget = bytes;
+    evictToBudget();
+}
+
+size_t SoDeferredFile::getMemoryBudget()
+{
+    return memoryBudget;
+}
+
+size_t SoDeferredFile::getResidentBytes()
+{
+    return residentTotal;
+}
+
+unsigned long SoDeferredFile::getLoadCount()
+{
+    return loadCount;
+}
+
+unsigned long SoDeferredFile::getEvictionCount()
+{
+    return evictionCount;
+}
@@ -0,0 +1,78 @@
+/*
+ * SoDeferredFile
+ * Proxy node for lazy, on-demand loading of a subtree, in the spirit of
+ * SoFile. The node only carries a precomputed bounding box and the byte
+ * range of the subtree in an Inventor file. The subtree is parsed the first
+ * time a render, pick or callback traversal actually needs it, and can be
+ * evicted again to stay within a global memory budget.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_DEFERRED_FILE_H
+#define COIN3D_EXAMPLES_SO_DEFERRED_FILE_H
+
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoSFString.h>
+#include <Inventor/fields/SoSFUInt32.h>
+#include <Inventor/fields/SoSFVec3f.h>
+#include <Inventor/SbBox3f.h>
+
+#include <cstddef>
+
+class SoChildList;
+
+class SoDeferredFile : public SoNode
+{
+    SO_NODE_HEADER(SoDeferredFile);
+
+public:
+    static void initClass();
+    SoDeferredFile();
+
+    SoSFString name;     // Inventor file holding the subtree
+    SoSFUInt32 offset;   // byte offset of the subtree in the file
+    SoSFUInt32 length;   // byte length of the subtree, including its header
+    SoSFVec3f bboxMin;   // precomputed bounding box of the subtree
+    SoSFVec3f bboxMax;
+
+    virtual void doAction(SoAction* action);
+    virtual void GLRender(SoGLRenderAction* action);
+    virtual void getBoundingBox(SoGetBoundingBoxAction* action);
+    virtual void callback(SoCallbackAction* action);
+    virtual void rayPick(SoRayPickAction* action);
+    virtual void getMatrix(SoGetMatrixAction* action);
+    virtual void handleEvent(SoHandleEventAction* action);
+    virtual void search(SoSearchAction* action);
+    virtual void getPrimitiveCount(SoGetPrimitiveCountAction* action);
+    virtual SoChildList* getChildren() const;
+
+    SbBool isLoaded() const;
+    SbBool load();
+    void unload();
+    SbBox3f getProxyBoundingBox() const;
+
+    // Budget for loaded subtrees, measured in source bytes. 0 means no limit.
+    // Exceeding it evicts down to three quarters of the budget.
+    static void setMemoryBudget(size_t bytes);
+    static size_t getMemoryBudget();
+    static size_t getResidentBytes();
+    static unsigned long getLoadCount();
+    static unsigned long getEvictionCount();
+
+protected:
+    virtual ~SoDeferredFile();
+    virtual void notify(SoNotList* list);
+
+private:
+    void traverseChildren(SoAction* action);
+    void linkMostRecent();
+    void unlink();
+    static void evictToBudget();
+
+    SoChildList* children;
+    size_t residentBytes;
+    int traversalDepth;       // > 0 while the subtree is being traversed
+    SoDeferredFile* lruPrev;  // loaded proxies, most recently used first
+    SoDeferredFile* lruNext;
+};
+
+#endif // COIN3D_EXAMPLES_SO_DEFERRED_FILE_H
@@ -0,0 +1,217 @@
+/*
+ * File I/O Benchmark
+ * Compares the buffered SoInput::openFile loader with the memory-mapped
+ * zero-copy loader on generated scenes of 10 MB, 100 MB and 1 GB, reports
+ * cold vs. warm load times of the binary scene cache, and the time to first
+ * bounding box and resident size of a lazily loaded (SoDeferredFile) scene
+ *
+ * Usage: file_io_benchmark [size in MB ...]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/SbViewportRegion.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "SceneIO.h"
+#include "SoDeferredFile.h"
+#include "BenchmarkUtils.h"
+
+// Number of sphere blocks grouped into one part separator
+static const unsigned long blocksPerPart = 1000;
+
+// Write an ASCII Inventor file of roughly targetBytes made of parts, each a
+// Separator of Separator { Transform Material Sphere } blocks
+static bool generateScene(const char* filename, size_t targetBytes)
+{
+    FILE* fp = fopen(filename, "w");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "#Inventor V2.1 ascii\n\nSeparator {\n");
+    size_t written = 0;
+    for (unsigned long i = 0; written < targetBytes || i % blocksPerPart != 0; i++) {
+        if (i % blocksPerPart == 0) {
+            written += (size_t)fprintf(fp, "%s  Separator {\n", i > 0 ? "  }\n" : "");
+        }
+        float x = (float)(i % 1000);
+        float y = (float)((i / 1000) % 1000);
+        float z = (float)(i / 1000000);
+        int n = fprintf(fp,
+                        "  Separator {\n"
+                        "    Transform { translation %g %g %g }\n"
+                        "    Material { diffuseColor %.3f %.3f 0.5 }\n"
+                        "    Sphere { radius 0.5 }\n"
+                        "  }\n",
+                        x, y, z, x / 1000.0f, y / 1000.0f);
+        if (n < 0) {
+            fclose(fp);
+            return false;
+        }
+        written += (size_t)n;
+    }
+    fprintf(fp, "  }\n}\n");
+    return fclose(fp) == 0;
+}
+
+// Lazy loading measurements for one scene size
+struct DeferredResult
+{
+    double fullLoadSeconds;
+    double firstBBoxSeconds;
+    size_t residentAfterBBox;
+    size_t residentAfterTraversal;
+    unsigned long loads;
+    unsigned long evictions;
+};
+
+// Load once with the given loader and return the stats
+static SceneLoadStats runLoad(bool mapped, const char* filename)
+{
+    SceneLoadStats stats;
+    SoSeparator* root = mapped ? readSceneFromFileMapped(filename, &stats)
+                               : readSceneFromFile(filename, &stats);
+    if (!root) {
+        fprintf(stderr, "Failed to read %s\n", filename);
+        exit(1);
+    }
+    root->ref();
+    root->unref();
+    return stats;
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoDeferredFile::initClass();
+
+    std::vector<int> sizesMB;
+    for (int i = 1; i < argc; i++) {
+        sizesMB.push_back(atoi(argv[i]));
+    }
+    if (sizesMB.empty()) {
+        sizesMB.push_back(10);
+        sizesMB.push_back(100);
+        sizesMB.push_back(1024);
+    }
+
+    std::vector<SceneCacheStats> coldWarm;
+    std::vector<DeferredResult> deferred;
+
+    printf("%10s %10s %12s %12s %12s %12s %8s\n", "size", "file",
+           "buffered ms", "buffered/s", "mapped ms", "mapped/s", "speedup");
+
+    for (size_t i = 0; i < sizesMB.size(); i++) {
+        char filename[256];
+        snprintf(filename, sizeof(filename), "/tmp/file_io_bench_%dMB.iv", sizesMB[i]);
+        if (!generateScene(filename, (size_t)sizesMB[i] * 1024 * 1024)) {
+            fprintf(stderr, "Failed to generate %s\n", filename);
+            return 1;
+        }
+
+        // Both loaders run twice in alternating order and the best time is
+        // kept, so neither one profits from a page cache warmed by the other
+        SceneLoadStats buffered, mapped;
+        for (int run = 0; run < 2; run++) {
+            SceneLoadStats b = runLoad(false, filename);
+            SceneLoadStats m = runLoad(true, filename);
+            if (run == 0 || b.seconds < buffered.seconds) buffered = b;
+            if (run == 0 || m.seconds < mapped.seconds) mapped = m;
+        }
+
+        printf("%8dMB %10s %12.1f %12s %12.1f %12s %7.2fx\n", sizesMB[i],
+               formatBytes((double)mapped.bytes).c_str(),
+               buffered.seconds * 1000.0, formatBytes(buffered.bytesPerSecond()).c_str(),
+               mapped.seconds * 1000.0, formatBytes(mapped.bytesPerSecond()).c_str(),
+               mapped.seconds > 0.0 ? buffered.seconds / mapped.seconds : 0.0);
+
+        // Cold load parses text and writes the cache, warm load reads it back
+        std::string cachePath = sceneCachePath(filename);
+        remove(cachePath.c_str());
+        SceneCacheStats cold, warm;
+        SoSeparator* coldRoot = readSceneCached(filename, &cold);
+        SoSeparator* warmRoot = readSceneCached(filename, &warm);
+        if (!coldRoot || !warmRoot || cold.hit || !warm.hit) {
+            fprintf(stderr, "Scene cache did not behave as expected for %s\n", filename);
+            return 1;
+        }
+        coldRoot->ref();
+        coldRoot->unref();
+        warmRoot->ref();
+        coldWarm.push_back(cold);
+        coldWarm.push_back(warm);
+
+        // Split into lazily loaded parts, then measure the time until the
+        // bounding box of the whole scene is known, and a full callback
+        // traversal under a budget of a quarter of the data size
+        std::string chunkPath = std::string(filename) + ".chunks";
+        std::string indexPath = std::string(filename) + ".index.iv";
+        SoSeparator* index = writeDeferredScene(warmRoot, chunkPath.c_str());
+        warmRoot->unref();
+        if (!index) {
+            fprintf(stderr, "Failed to write %s\n", chunkPath.c_str());
+            return 1;
+        }
+        index->ref();
+        writeSceneToFile(index, indexPath.c_str());
+        index->unref();
+
+        DeferredResult result;
+        result.fullLoadSeconds = mapped.seconds;
+        BenchTimer timer;
+        SoSeparator* lazyRoot = readSceneFromFileMapped(indexPath.c_str());
+        lazyRoot->ref();
+        SoGetBoundingBoxAction bboxAction(SbViewportRegion(640, 480));
+        bboxAction.apply(lazyRoot);
+        result.firstBBoxSeconds = timer.seconds();
+        result.residentAfterBBox = SoDeferredFile::getResidentBytes();
+
+        unsigned long loadsBefore = SoDeferredFile::getLoadCount();
+        unsigned long evictionsBefore = SoDeferredFile::getEvictionCount();
+        SoDeferredFile::setMemoryBudget((size_t)sizesMB[i] * 1024 * 1024 / 4);
+        SoCallbackAction callbackAction;
+        callbackAction.apply(lazyRoot);
+        result.loads = SoDeferredFile::getLoadCount() - loadsBefore;
+        result.evictions = SoDeferredFile::getEvictionCount() - evictionsBefore;
+        result.residentAfterTraversal = SoDeferredFile::getResidentBytes();
+        SoDeferredFile::setMemoryBudget(0);
+        lazyRoot->unref();
+        deferred.push_back(result);
+
+        remove(indexPath.c_str());
+        remove(chunkPath.c_str());
+        remove(cachePath.c_str());
+        remove(filename);
+    }
+
+    printf("\n%10s %10s %10s %10s %12s %12s %8s\n", "size", "cache", "hash ms",
+           "parse ms", "cold ms", "warm ms", "speedup");
+    for (size_t i = 0; i < sizesMB.size(); i++) {
+        const SceneCacheStats& cold = coldWarm[2 * i];
+        const SceneCacheStats& warm = coldWarm[2 * i + 1];
+        printf("%8dMB %10s %10.1f %10.1f %12.1f %12.1f %7.2fx\n", sizesMB[i],
+               formatBytes((double)warm.cacheBytes).c_str(),
+               warm.hashSeconds * 1000.0, cold.loadSeconds * 1000.0,
+               cold.totalSeconds() * 1000.0, warm.totalSeconds() * 1000.0,
+               warm.totalSeconds() > 0.0 ? cold.totalSeconds() / warm.totalSeconds() : 0.0);
+    }
+
+    printf("\n%10s %12s %14s %14s %8s %10s %14s\n", "size", "full load ms",
+           "first bbox ms", "resident bbox", "loads", "evictions", "resident end");
+    for (size_t i = 0; i < sizesMB.size(); i++) {
+        const DeferredResult& r = deferred[i];
+        printf("%8dMB %12.1f %14.1f %14s %8lu %10lu %14s\n", sizesMB[i],
+               r.fullLoadSeconds * 1000.0, r.firstBBoxSeconds * 1000.0,
+               formatBytes((double)r.residentAfterBBox).c_str(), r.loads, r.evictions,
+               formatBytes((double)r.residentAfterTraversal).c_str());
+    }
+
+    return 0;
+}
@@ -7,79 +7,20 @@
 #include <Inventor/Qt/SoQt.h>
 #include <Inventor/Qt/viewers/SoQtExaminerViewer.h>
 #include <Inventor/nodes/SoSeparator.h>
-#include <Inventor/nodes/SoSphere.h>
-#include <Inventor/nodes/SoCube.h>
-#include <Inventor/nodes/SoTransform.h>
-#include <Inventor/nodes/SoMaterial.h>
-#include <Inventor/actions/SoWriteAction.h>
-#include <Inventor/SoDB.h>
-#include <Inventor/SoInput.h>
-#include <Inventor/SoOutput.h>
 
-// Function to create a sample scene
-SoSeparator* createSampleScene()
-{
-    SoSeparator* root = new SoSeparator;
-    
-    // Create a sphere
-    SoSeparator* sphereSep = new SoSeparator;
-    SoTransform* sphereTransform = new SoTransform;
-    sphereTransform->translation.setValue(-2, 0, 0);
-    SoMaterial* sphereMaterial = new SoMaterial;
-    sphereMaterial->diffuseColor.setValue(1.0, 0.0, 0.0); // Red
-    SoSphere* sphere = new SoSphere;
-    sphere->radius = 1.0;
-    sphereSep->addChild(sphereTransform);
-    sphereSep->addChild(sphereMaterial);
-    sphereSep->addChild(sphere);
-    root->addChild(sphereSep);
-    
-    // Create a cube
-    SoSeparator* cubeSep = new SoSeparator;
-    SoTransform* cubeTransform = new SoTransform;
-    cubeTransform->translation.setValue(2, 0, 0);
-    SoMaterial* cubeMaterial = new SoMaterial;
-    cubeMaterial->diffuseColor.setValue(0.0, 1.0, 0.0); // Green
-    SoCube* cube = new SoCube;
-    cube->width = 1.5;
-    cube->height = 1.5;
-    cube->depth = 1.5;
-    cubeSep->addChild(cubeTransform);
-    cubeSep->addChild(cubeMaterial);
-    cubeSep->addChild(cube);
-    root->addChild(cubeSep);
-    
-    return root;
-}
-
-// Function to write scene to file
-void writeSceneToFile(SoSeparator* root, const char* filename)
-{
-    SoOutput out;
-    if (out.openFile(filename)) {
-        SoWriteAction wa(&out);
-        wa.apply(root);
-        out.closeFile();
-    }
-}
+#include <cstdio>
 
-// Function to read scene from file
-SoSeparator* readSceneFromFile(const char* filename)
-{
-    SoInput in;
-    if (in.openFile(filename)) {
-        SoSeparator* root = SoDB::readAll(&in);
-        in.closeFile();
-        return root;
-    }
-    return NULL;
-}
+#include "SceneIO.h"
+#include "SoDeferredFile.h"
 
 int main(int argc, char** argv)
 {
     // Initialize SoQt library
     QWidget* mainwin = SoQt::init(argc, argv, argv[0]);
     
+    // Register the lazy-loading proxy node so index files can be read
+    SoDeferredFile::initClass();
+    
     // Create a sample scene
     SoSeparator* sceneToWrite = createSampleScene();
     sceneToWrite->ref();
@@ -88,8 +29,16 @@ int main(int argc, char** argv)
     const char* filename = "/tmp/sample_scene.iv";
     writeSceneToFile(sceneToWrite, filename);
     
-    // Read scene from file
-    SoSeparator* root = readSceneFromFile(filename);
+    // Read scene from file; an unchanged file is loaded from its binary
+    // cache (/tmp/sample_scene.iv.ivcache) without running the text parser
+    SceneCacheStats stats;
+    SoSeparator* root = readSceneCached(filename, &stats);
+    if (root) {
+        printf("Loaded %s (%s): hash %.3f ms, load %.3f ms, cache write %.3f ms\n",
+               filename, stats.hit ? "warm, from cache" : "cold, parsed text",
+               stats.hashSeconds * 1000.0, stats.loadSeconds * 1000.0,
+               stats.writeSeconds * 1000.0);
+    }
     
     // If reading failed, use the original scene
     if (!root) {
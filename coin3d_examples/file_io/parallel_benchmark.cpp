@@ -0,0 +1,92 @@
+/*
+ * Parallel Loading Benchmark
+ * Loads an assembly of generated part files with loadScenesParallel()
+ * using 1 to N worker threads and reports the speedup over one thread
+ *
+ * Usage: file_io_parallel_benchmark [parts] [distinct parts] [spheres per part]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SceneIO.h"
+#include "BenchmarkUtils.h"
+
+// Write one ASCII part file; parts with the same variant are byte-identical
+static bool generatePart(const std::string& filename, int variant, int spheres)
+{
+    FILE* fp = fopen(filename.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "#Inventor V2.1 ascii\n\nSeparator {\n");
+    for (int i = 0; i < spheres; i++) {
+        fprintf(fp,
+                "  Separator {\n"
+                "    Transform { translation %d %d %d }\n"
+                "    Material { diffuseColor %.3f 0.5 0.5 }\n"
+                "    Sphere { radius 0.5 }\n"
+                "  }\n",
+                i % 10, i / 10, variant, (variant % 100) / 100.0f);
+    }
+    fprintf(fp, "}\n");
+    return fclose(fp) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int numParts = argc > 1 ? atoi(argv[1]) : 2000;
+    int numDistinct = argc > 2 ? atoi(argv[2]) : 1500;
+    int spheresPerPart = argc > 3 ? atoi(argv[3]) : 200;
+    if (numDistinct < 1) numDistinct = 1;
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "file_io_parts";
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < numParts; i++) {
+        std::string path = (dir / ("part_" + std::to_string(i) + ".iv")).string();
+        if (!generatePart(path, i % numDistinct, spheresPerPart)) {
+            fprintf(stderr, "Failed to generate %s\n", path.c_str());
+            return 1;
+        }
+        paths.push_back(path);
+    }
+
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+
+    printf("%d part files, %d distinct, %d spheres each\n", numParts, numDistinct, spheresPerPart);
+    printf("%8s %12s %12s %10s %8s\n", "threads", "time ms", "throughput", "children", "speedup");
+
+    double baseline = 0.0;
+    std::vector<unsigned> counts = threadCounts(maxThreads);
+    for (size_t c = 0; c < counts.size(); c++) {
+        unsigned threads = counts[c];
+        ParallelLoadStats stats;
+        SoSeparator* root = loadScenesParallel(paths, threads, &stats);
+        root->ref();
+        int children = root->getNumChildren();
+        root->unref();
+
+        if (threads == 1) {
+            baseline = stats.seconds;
+        }
+        printf("%8u %12.1f %10s/s %10d %7.2fx\n", threads, stats.seconds * 1000.0,
+               formatBytes(stats.bytesPerSecond()).c_str(), children,
+               stats.seconds > 0.0 ? baseline / stats.seconds : 0.0);
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
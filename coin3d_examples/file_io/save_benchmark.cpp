@@ -0,0 +1,162 @@
+/*
+ * Save Benchmark
+ * Compares full and incremental saves of SceneChunkWriter for ASCII and
+ * binary chunks, with and without zlib compression. Between the saves a
+ * small fraction of the parts is edited, as in an interactive session.
+ * After each incremental save the file is read back and the edited parts
+ * are compared with the scene.
+ *
+ * Usage: file_io_save_benchmark [parts] [spheres per part] [edited parts]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoMaterial.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "SceneChunkWriter.h"
+#include "BenchmarkUtils.h"
+
+// Function to create a scene of parts, each a separator of sphere objects
+static SoSeparator* createPartsScene(int numParts, int spheresPerPart)
+{
+    SoSeparator* root = new SoSeparator;
+    for (int p = 0; p < numParts; p++) {
+        SoSeparator* part = new SoSeparator;
+        for (int i = 0; i < spheresPerPart; i++) {
+            SoSeparator* objSep = new SoSeparator;
+            SoTransform* transform = new SoTransform;
+            transform->translation.setValue((float)(i % 10), (float)(i / 10), (float)p);
+            SoMaterial* material = new SoMaterial;
+            material->diffuseColor.setValue((p % 10) / 10.0f, 0.5f, 0.5f);
+            SoSphere* sphere = new SoSphere;
+            sphere->radius = 0.5;
+            objSep->addChild(transform);
+            objSep->addChild(material);
+            objSep->addChild(sphere);
+            part->addChild(objSep);
+        }
+        root->addChild(part);
+    }
+    return root;
+}
+
+// Change the material of the first object of every stride-th part
+static void editParts(SoSeparator* root, int numEdited, float value)
+{
+    int numParts = root->getNumChildren();
+    int stride = numEdited > 0 ? numParts / numEdited : numParts + 1;
+    for (int p = 0; stride > 0 && p < numParts; p += stride) {
+        SoSeparator* part = (SoSeparator*)root->getChild(p);
+        SoSeparator* objSep = (SoSeparator*)part->getChild(0);
+        SoMaterial* material = (SoMaterial*)objSep->getChild(1);
+        material->diffuseColor.setValue(value, 0.2f, 0.2f);
+    }
+}
+
+// Whether the edited objects of loaded, read back from a save, match
+// those of root in the fields editParts changes and their translations
+static bool checkEditedParts(SoSeparator* root, SoSeparator* loaded, int numEdited)
+{
+    int numParts = root->getNumChildren();
+    int stride = numEdited > 0 ? numParts / numEdited : numParts + 1;
+    for (int p = 0; stride > 0 && p < numParts; p += stride) {
+        SoSeparator* objSep = (SoSeparator*)((SoSeparator*)root->getChild(p))->getChild(0);
+        SoNode* part = loaded->getChild(p);
+        if (!part->isOfType(SoSeparator::getClassTypeId()) ||
+            ((SoSeparator*)part)->getNumChildren() == 0) {
+            return false;
+        }
+        SoNode* loadedObj = ((SoSeparator*)part)->getChild(0);
+        if (!loadedObj->isOfType(SoSeparator::getClassTypeId()) ||
+            ((SoSeparator*)loadedObj)->getNumChildren() < 2) {
+            return false;
+        }
+        SoNode* transform = ((SoSeparator*)loadedObj)->getChild(0);
+        SoNode* material = ((SoSeparator*)loadedObj)->getChild(1);
+        if (!transform->isOfType(SoTransform::getClassTypeId()) ||
+            !material->isOfType(SoMaterial::getClassTypeId())) {
+            return false;
+        }
+        SbVec3f translation = ((SoTransform*)objSep->getChild(0))->translation.getValue();
+        const SbColor& color = ((SoMaterial*)objSep->getChild(1))->diffuseColor[0];
+        if (!((SoTransform*)transform)->translation.getValue().equals(translation, 1e-6f) ||
+            !((SoMaterial*)material)->diffuseColor[0].equals(color, 1e-6f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printRow(const char* mode, const SceneSaveStats& stats)
+{
+    printf("%-22s %-12s %8lu/%-6lu %12s %10.2f %10.2f\n", mode,
+           stats.incremental ? "incremental" : "full",
+           (unsigned long)stats.chunksWritten, (unsigned long)stats.chunksTotal,
+           formatBytes((double)stats.bytesWritten).c_str(),
+           stats.stallSeconds * 1000.0, stats.totalSeconds * 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int numParts = argc > 1 ? atoi(argv[1]) : 1000;
+    int spheresPerPart = argc > 2 ? atoi(argv[2]) : 100;
+    int numEdited = argc > 3 ? atoi(argv[3]) : 10;
+
+    SoSeparator* root = createPartsScene(numParts, spheresPerPart);
+    root->ref();
+
+    printf("%d parts, %d spheres each, %d parts edited between saves\n",
+           numParts, spheresPerPart, numEdited);
+    printf("%-22s %-12s %15s %12s %10s %10s\n", "format", "save", "chunks",
+           "written", "stall ms", "total ms");
+
+    const char* filename = "/tmp/file_io_save_bench.scnk";
+    for (int binary = 0; binary <= 1; binary++) {
+        for (int compressed = 0; compressed <= 1; compressed++) {
+            if (compressed && !SceneChunkWriter::isCompressionAvailable()) {
+                continue;
+            }
+            std::string mode = binary ? "binary" : "ascii";
+            if (compressed) {
+                mode += " + zlib";
+            }
+
+            SceneChunkWriter writer(root, filename);
+            writer.setBinary(binary != 0);
+            writer.setCompressionLevel(compressed ? 6 : 0);
+
+            writer.saveFull();
+            printRow(mode.c_str(), writer.wait());
+
+            editParts(root, numEdited, binary * 0.5f + compressed * 0.25f);
+            writer.saveIncremental();
+            printRow(mode.c_str(), writer.wait());
+
+            SoSeparator* loaded = readChunkedScene(filename);
+            if (!loaded || loaded->getNumChildren() != root->getNumChildren()) {
+                fprintf(stderr, "Reading back %s failed\n", filename);
+                return 1;
+            }
+            loaded->ref();
+            bool matches = checkEditedParts(root, loaded, numEdited);
+            loaded->unref();
+            if (!matches) {
+                fprintf(stderr, "Edited parts read back from %s differ\n", filename);
+                return 1;
+            }
+        }
+    }
+
+    remove(filename);
+    root->unref();
+    return 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * LightClusters
+ * Light ranges from attenuation, view space cluster binning and per shape
+ * light lists
+ */
+
+#include "LightClusters.h"
+
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/elements/SoLightAttenuationElement.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/nodes/SoPointLight.h>
+#include <Inventor/nodes/SoSpotLight.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+LightClusterGrid::LightClusterGrid(int tilesX, int tilesY, int slices)
+    : tilesX(tilesX), tilesY(tilesY), slices(slices), nearDistance(1.0f), farDistance(10.0f),
+      logDepthRatio(1.0f), stamp(0)
+{
+}
+
+// Distance at which intensity falls to cutoff; < 0 if it never does
+static float attenuatedRange(float intensity, const SbVec3f& attenuation, float cutoff)
+{
+    float quadratic = attenuation[0], linear = attenuation[1], constant = attenuation[2];
+    float target = intensity / cutoff;
+    if (constant >= target) {
+        return 0.0f;
+    }
+    if (quadratic > 0.0f) {
+        return (-linear + sqrtf(linear * linear + 4.0f * quadratic * (target - constant))) /
+               (2.0f * quadratic);
+    }
+    if (linear > 0.0f) {
+        return (target - constant) / linear;
+    }
+    return -1.0f;
+}
+
+struct CollectData
+{
+    std::vector<ClusteredLight>* lights;
+    float cutoff;
+};
+
+static SoCallbackAction::Response collectLightCB(void* data, SoCallbackAction* action,
+                                                 const SoNode* node)
+{
+    CollectData* collect = (CollectData*)data;
+    SoLight* light = (SoLight*)node;
+    if (!light->on.getValue()) {
+        return SoCallbackAction::CONTINUE;
+    }
+    ClusteredLight entry;
+    entry.node = light;
+    entry.matrix = action->getModelMatrix();
+    entry.intensity = light->intensity.getValue();
+    // Coin's default, no distance attenuation
+    entry.attenuation.setValue(0.0f, 0.0f, 1.0f);
+    SoState* state = action->getState();
+    if (state->isElementEnabled(SoLightAttenuationElement::getClassStackIndex())) {
+        entry.attenuation = SoLightAttenuationElement::get(state);
+    }
+    entry.range = attenuatedRange(entry.intensity, entry.attenuation, collect->cutoff);
+    if (entry.range == 0.0f) {
+        return SoCallbackAction::CONTINUE;
+    }
+
+    entry.cosCutOff = -1.0f;
+    entry.direction.setValue(0.0f, 0.0f, -1.0f);
+    float cutOff = (float)M_PI;
+    if (light->isOfType(SoSpotLight::getClassTypeId())) {
+        SoSpotLight* spot = (SoSpotLight*)light;
+        entry.matrix.multVecMatrix(spot->location.getValue(), entry.position);
+        entry.matrix.multDirMatrix(spot->direction.getValue(), entry.direction);
+        entry.direction.normalize();
+        cutOff = spot->cutOffAngle.getValue();
+        entry.cosCutOff = cosf(cutOff);
+    } else {
+        entry.matrix.multVecMatrix(((SoPointLight*)light)->location.getValue(), entry.position);
+    }
+
+    // Bounding sphere: the range sphere, or the tighter one around a cone
+    // whose slant length is the range
+    entry.sphereCenter = entry.position;
+    entry.sphereRadius = entry.range;
+    if (entry.range > 0.0f && cutOff < (float)M_PI / 2.0f) {
+        if (cutOff > (float)M_PI / 4.0f) {
+            entry.sphereCenter += entry.direction * (cosf(cutOff) * entry.range);
+            entry.sphereRadius = sinf(cutOff) * entry.range;
+        } else {
+            float half = entry.range / (2.0f * cosf(cutOff));
+            entry.sphereCenter += entry.direction * half;
+            entry.sphereRadius = half;
+        }
+    }
+    collect->lights->push_back(entry);
+    return SoCallbackAction::CONTINUE;
+}
+
+void LightClusterGrid::collectLights(SoNode* root, float cutoffIntensity)
+{
+    lights.clear();
+    unboundedLights.clear();
+    if (root) {
+        CollectData data = { &lights, cutoffIntensity };
+        SoCallbackAction action;
+        action.addPreCallback(SoPointLight::getClassTypeId(), collectLightCB, &data);
+        action.addPreCallback(SoSpotLight::getClassTypeId(), collectLightCB, &data);
+        action.apply(root);
+    }
+    for (size_t i = 0; i < lights.size(); i++) {
+        if (lights[i].range < 0.0f) {
+            unboundedLights.push_back((int)i);
+        }
+    }
+    stamps.assign(lights.size(), 0);
+    stamp = 0;
+}
+
+int LightClusterGrid::sliceOf(float depth) const
+{
+    if (depth <= nearDistance) {
+        return 0;
+    }
+    int slice = (int)(logf(depth / nearDistance) / logDepthRatio * slices);
+    return std::min(slice, slices - 1);
+}
+
+// Clusters overlapped by an eye space box
+LightClusterGrid::ClusterRange LightClusterGrid::clusterRange(const SbBox3f& eyeBox) const
+{
+    ClusterRange range = { 0, -1, 0, -1, 0, -1 };
+    const SbVec3f& lo = eyeBox.getMin();
+    const SbVec3f& hi = eyeBox.getMax();
+    float depthNear = std::max(-hi[2], nearDistance);
+    float depthFar = std::min(-lo[2], farDistance);
+    if (eyeBox.isEmpty() || depthNear > depthFar) {
+        return range;
+    }
+
+    // The box clipped to the depth range projects inside the hull of its
+    // projected corners
+    float minX = 1.0f, maxX = -1.0f, minY = 1.0f, maxY = -1.0f;
+    for (int corner = 0; corner < 8; corner++) {
+        SbVec3f point(corner & 1 ? hi[0] : lo[0], corner & 2 ? hi[1] : lo[1],
+                      corner & 4 ? -depthFar : -depthNear);
+        SbVec3f ndc;
+        projection.multVecMatrix(point, ndc);
+        if (corner == 0) {
+            minX = maxX = ndc[0];
+            minY = maxY = ndc[1];
+        } else {
+            minX = std::min(minX, ndc[0]);
+            maxX = std::max(maxX, ndc[0]);
+            minY = std::min(minY, ndc[1]);
+            maxY = std::max(maxY, ndc[1]);
+        }
+    }
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) {
+        return range;
+    }
+    range.x0 = std::max((int)((minX + 1.0f) * 0.5f * tilesX), 0);
+    range.x1 = std::min((int)((maxX + 1.0f) * 0.5f * tilesX), tilesX - 1);
+    range.y0 = std::max((int)((minY + 1.0f) * 0.5f * tilesY), 0);
+    range.y1 = std::min((int)((maxY + 1.0f) * 0.5f * tilesY), tilesY - 1);
+    range.z0 = sliceOf(depthNear);
+    range.z1 = sliceOf(depthFar);
+    return range;
+}
+
+void LightClusterGrid::assign(const SbViewVolume& volume, const SbMatrix& localToEye)
+{
+    this->localToEye = localToEye;
+    SbMatrix viewing;
+    volume.getMatrices(viewing, projection);
+    nearDistance = std::max(volume.getNearDist(), 1e-4f);
+    farDistance = nearDistance + volume.getDepth();
+    logDepthRatio = logf(farDistance / nearDistance);
+
+    int numClusters = getNumClusters();
+    clusterOffsets.assign(numClusters + 1, 0);
+    lightRanges.resize(lights.size());
+
+    // Count the entries of every cluster, offset by one for the prefix sum
+    for (size_t i = 0; i < lights.size(); i++) {
+        static const ClusterRange empty = { 0, -1, 0, -1, 0, -1 };
+        ClusterRange& range = lightRanges[i];
+        range = empty;
+        const ClusteredLight& light = lights[i];
+        if (light.range < 0.0f) {
+            continue;
+        }
+        SbVec3f center;
+        localToEye.multVecMatrix(light.sphereCenter, center);
+        SbVec3f extent(light.sphereRadius, light.sphereRadius, light.sphereRadius);
+        range = clusterRange(SbBox3f(center - extent, center + extent));
+        for (int z = range.z0; z <= range.z1; z++) {
+            for (int y = range.y0; y <= range.y1; y++) {
+                for (int x = range.x0; x <= range.x1; x++) {
+                    clusterOffsets[(z * tilesY + y) * tilesX + x + 1]++;
+                }
+            }
+        }
+    }
+    for (int c = 0; c < numClusters; c++) {
+        clusterOffsets[c + 1] += clusterOffsets[c];
+    }
+
+    clusterLights.resize(clusterOffsets[numClusters]);
+    std::vector<int> fill(clusterOffsets.begin(), clusterOffsets.end() - 1);
+    for (size_t i = 0; i < lights.size(); i++) {
+        const ClusterRange& range = lightRanges[i];
+        for (int z = range.z0; z <= range.z1; z++) {
+            for (int y = range.y0; y <= range.y1; y++) {
+                for (int x = range.x0; x <= range.x1; x++) {
+                    clusterLights[fill[(z * tilesY + y) * tilesX + x]++] = (int)i;
+                }
+            }
+        }
+    }
+}
+
+float LightClusterGrid::intensityAt(int index, const SbVec3f& point) const
+{
+    const ClusteredLight& light = lights[index];
+    float distance = (point - light.position).length();
+    float attenuation = light.attenuation[2] + light.attenuation[1] * distance +
+                        light.attenuation[0] * distance * distance;
+    return light.intensity / std::max(attenuation, 1e-6f);
+}
+
+bool sphereTouchesBox(const SbVec3f& center, float radius, const SbBox3f& box)
+{
+    const SbVec3f& lo = box.getMin();
+    const SbVec3f& hi = box.getMax();
+    float distance2 = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        float d = center[axis] - std::min(std::max(center[axis], lo[axis]), hi[axis]);
+        distance2 += d * d;
+    }
+    return distance2 <= radius * radius;
+}
+
+int LightClusterGrid::gatherLights(const SbBox3f& box, std::vector<int>& result, int maxLights)
+{
+    result.assign(unboundedLights.begin(), unboundedLights.end());
+    if (!box.isEmpty() && !clusterOffsets.empty()) {
+        if (++stamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            stamp = 1;
+        }
+        SbBox3f eyeBox = box;
+        eyeBox.transform(localToEye);
+        ClusterRange range = clusterRange(eyeBox);
+        for (int z = range.z0; z <= range.z1; z++) {
+            for (int y = range.y0; y <= range.y1; y++) {
+                for (int x = range.x0; x <= range.x1; x++) {
+                    int cluster = (z * tilesY + y) * tilesX + x;
+                    for (int e = clusterOffsets[cluster]; e < clusterOffsets[cluster + 1]; e++) {
+                        int index = clusterLights[e];
+                        if (stamps[index] == stamp) {
+                            continue;
+                        }
+                        stamps[index] = stamp;
+                        const ClusteredLight& light = lights[index];
+                        if (sphereTouchesBox(light.sphereCenter, light.sphereRadius, box)) {
+                            result.push_back(index);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int count = (int)result.size();
+    if (maxLights > 0 && count > maxLights) {
+        SbVec3f center = box.isEmpty() ? SbVec3f(0.0f, 0.0f, 0.0f) : box.getCenter();
+        std::vector<std::pair<float, int> > ranked(count);
+        for (int i = 0; i < count; i++) {
+            ranked[i] = std::make_pair(-intensityAt(result[i], center), result[i]);
+        }
+        std::partial_sort(ranked.begin(), ranked.begin() + maxLights, ranked.end());
+        for (int i = 0; i < maxLights; i++) {
+            result[i] = ranked[i].second;
+        }
+        result.resize(maxLights);
+    }
+    return count;
+}
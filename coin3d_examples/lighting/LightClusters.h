@@ -0,0 +1,106 @@
+/*
+ * LightClusters
+ * CPU binning of point and spot lights into a view space cluster grid, so
+ * every shape only gets the lights that can reach it
+ *
+ * Coin lights have no range of their own; it follows from the light
+ * attenuation in effect at the light (SoEnvironment::attenuation) as the
+ * distance where intensity drops below a cutoff. Lights without any
+ * distance attenuation reach everything and are given to every shape.
+ * Each ranged light is bounded by a sphere (for spot lights the sphere
+ * around the cone of cutOffAngle along direction), which is entered into
+ * all clusters its eye space box overlaps. The grid divides the view
+ * volume into tiles on screen and exponentially spaced depth slices.
+ *
+ * All positions are in the coordinates of the light and shape graphs
+ * ("local"); assign() takes the local to eye transform.
+ */
+
+#ifndef COIN3D_EXAMPLES_LIGHT_CLUSTERS_H
+#define COIN3D_EXAMPLES_LIGHT_CLUSTERS_H
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbLinear.h>
+#include <Inventor/SbViewVolume.h>
+
+#include <stdint.h>
+#include <vector>
+
+class SoLight;
+class SoNode;
+
+struct ClusteredLight
+{
+    SoLight* node;
+    SbMatrix matrix;        // light to local coordinates
+    SbVec3f attenuation;    // squared, linear, constant as in SoEnvironment
+    SbVec3f position;       // local
+    SbVec3f direction;      // local, normalized; spot lights only
+    float cosCutOff;        // -1 for point lights
+    float intensity;
+    float range;            // < 0: not attenuated, reaches everything
+    SbVec3f sphereCenter;   // bounding sphere of the lit volume, local
+    float sphereRadius;
+};
+
+// Whether the sphere and box overlap
+bool sphereTouchesBox(const SbVec3f& center, float radius, const SbBox3f& box);
+
+class LightClusterGrid
+{
+public:
+    LightClusterGrid(int tilesX = 16, int tilesY = 9, int slices = 24);
+
+    // Collect the point and spot lights that are on below root, with
+    // their transforms. Lights dimmer than cutoffIntensity everywhere are
+    // left out.
+    void collectLights(SoNode* root, float cutoffIntensity);
+    int getNumLights() const { return (int)lights.size(); }
+    const ClusteredLight& getLight(int index) const { return lights[index]; }
+
+    // Bin the lights into the clusters of volume; localToEye is the model
+    // matrix of the local coordinates times the viewing matrix
+    void assign(const SbViewVolume& volume, const SbMatrix& localToEye);
+
+    // Indices of the lights whose clusters overlap box and whose bounding
+    // sphere touches it. With maxLights > 0 only the strongest at the box
+    // center are kept. Returns the count before capping.
+    int gatherLights(const SbBox3f& box, std::vector<int>& result, int maxLights = 0);
+
+    int getNumClusters() const { return tilesX * tilesY * slices; }
+    // Light to cluster entries of the last assign()
+    size_t getNumEntries() const { return clusterLights.size(); }
+
+    // Estimated intensity of light at point, ignoring the spot cone
+    float intensityAt(int light, const SbVec3f& point) const;
+
+private:
+    struct ClusterRange
+    {
+        int x0, x1, y0, y1, z0, z1;  // inclusive, x0 > x1 if empty
+    };
+
+    ClusterRange clusterRange(const SbBox3f& eyeBox) const;
+    int sliceOf(float depth) const;
+
+    int tilesX, tilesY, slices;
+    std::vector<ClusteredLight> lights;
+    std::vector<int> unboundedLights;
+
+    // View of the last assign()
+    SbMatrix localToEye;
+    SbMatrix projection;
+    float nearDistance, farDistance, logDepthRatio;
+
+    // Lights of cluster c are clusterLights[clusterOffsets[c] ..
+    // clusterOffsets[c + 1]]
+    std::vector<int> clusterOffsets;
+    std::vector<int> clusterLights;
+    std::vector<ClusterRange> lightRanges;
+
+    // Per light frame stamps to merge the lists of several clusters
+    std::vector<uint32_t> stamps;
+    uint32_t stamp;
+};
+
+#endif // COIN3D_EXAMPLES_LIGHT_CLUSTERS_H
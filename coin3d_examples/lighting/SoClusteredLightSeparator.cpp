@@ -0,0 +1,145 @@
+/*
+ * SoClusteredLightSeparator
+ * Per child light selection from the cluster grid
+ */
+
+#include "SoClusteredLightSeparator.h"
+
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/elements/SoGLLightIdElement.h>
+#include <Inventor/elements/SoLightAttenuationElement.h>
+#include <Inventor/elements/SoLightElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoViewVolumeElement.h>
+#include <Inventor/elements/SoViewingMatrixElement.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/nodes/SoLight.h>
+
+SO_NODE_SOURCE(SoClusteredLightSeparator);
+
+void SoClusteredLightSeparator::initClass()
+{
+    SO_NODE_INIT_CLASS(SoClusteredLightSeparator, SoSeparator, "Separator");
+}
+
+SoClusteredLightSeparator::SoClusteredLightSeparator()
+    : lightsValid(false), boxesValid(false)
+{
+    SO_NODE_CONSTRUCTOR(SoClusteredLightSeparator);
+    SO_NODE_ADD_FIELD(lights, (NULL));
+    SO_NODE_ADD_FIELD(cutoffIntensity, (0.02f));
+    SO_NODE_ADD_FIELD(maxLightsPerChild, (0));
+}
+
+SoClusteredLightSeparator::~SoClusteredLightSeparator()
+{
+}
+
+void SoClusteredLightSeparator::notify(SoNotList* list)
+{
+    // Changes inside the light graph arrive through the lights field
+    SoField* field = list->getLastField();
+    if (field == &lights || field == &cutoffIntensity) {
+        lightsValid = false;
+    } else if (field != &maxLightsPerChild) {
+        boxesValid = false;
+    }
+    SoSeparator::notify(list);
+}
+
+void SoClusteredLightSeparator::updateLights()
+{
+    if (!lightsValid) {
+        grid.collectLights(lights.getValue(), cutoffIntensity.getValue());
+        lightsValid = true;
+    }
+}
+
+void SoClusteredLightSeparator::updateBoxes()
+{
+    int count = children->getLength();
+    if (boxesValid && (int)boxes.size() == count) {
+        return;
+    }
+    boxes.resize(count);
+    SoGetBoundingBoxAction bboxAction((SbViewportRegion()));
+    for (int i = 0; i < count; i++) {
+        // Applied to the child alone, the box is in this node's coordinates
+        bboxAction.apply((*children)[i]);
+        boxes[i] = bboxAction.getBoundingBox();
+    }
+    boxesValid = true;
+}
+
+void SoClusteredLightSeparator::assignLights(const SbViewVolume& volume,
+                                             const SbMatrix& localToEye, int sourcesLeft)
+{
+    updateLights();
+    updateBoxes();
+    grid.assign(volume, localToEye);
+    int count = (int)boxes.size();
+    childLights.resize(count);
+    int limit = maxLightsPerChild.getValue();
+    if (sourcesLeft > 0 && (limit <= 0 || limit > sourcesLeft)) {
+        limit = sourcesLeft;
+    }
+    for (int i = 0; i < count; i++) {
+        grid.gatherLights(boxes[i], childLights[i], limit);
+    }
+}
+
+// Each light renders with its own transform and attenuation, as when
+// traversed in the light graph; leaves the model matrix at model
+void SoClusteredLightSeparator::renderLights(SoGLRenderAction* action,
+                                             const std::vector<int>& indices,
+                                             const SbMatrix& model)
+{
+    SoState* state = action->getState();
+    for (size_t l = 0; l < indices.size(); l++) {
+        const ClusteredLight& light = grid.getLight(indices[l]);
+        SoModelMatrixElement::set(state, this, light.matrix * model);
+        SoLightAttenuationElement::set(state, this, light.attenuation);
+        light.node->GLRender(action);
+    }
+    SoModelMatrixElement::set(state, this, model);
+}
+
+void SoClusteredLightSeparator::GLRenderBelowPath(SoGLRenderAction* action)
+{
+    SoState* state = action->getState();
+    // OpenGL light sources not taken by lights above this node
+    int sourcesLeft =
+        SoGLLightIdElement::getMaxGLSources() - SoLightElement::getLights(state).getLength();
+
+    state->push();
+    SbMatrix model = SoModelMatrixElement::get(state);
+    if (sourcesLeft <= 0) {
+        // Nothing left to choose from: all lights for all children, and
+        // OpenGL drops the ones without a source
+        updateLights();
+        std::vector<int> all(grid.getNumLights());
+        for (int l = 0; l < grid.getNumLights(); l++) {
+            all[l] = l;
+        }
+        renderLights(action, all, model);
+        for (int i = 0; i < children->getLength() && !action->hasTerminated(); i++) {
+            children->traverse(action, i);
+        }
+        state->pop();
+        return;
+    }
+
+    assignLights(SoViewVolumeElement::get(state), model * SoViewingMatrixElement::get(state),
+                 sourcesLeft);
+    for (int i = 0; i < children->getLength() && !action->hasTerminated(); i++) {
+        state->push();
+        renderLights(action, childLights[i], model);
+        children->traverse(action, i);
+        state->pop();
+    }
+    state->pop();
+}
@@ -0,0 +1,74 @@
+/*
+ * SoClusteredLightSeparator
+ * Separator that lights each of its children with only the nearby point
+ * and spot lights, chosen through a LightClusterGrid
+ *
+ * The local lights live in the subgraph of the lights field instead of in
+ * the scene, placed in this node's coordinates with transforms and with
+ * an SoEnvironment giving their attenuation. Every frame they are binned
+ * into the clusters of the current view; before each child is rendered,
+ * the lights whose clusters its bounding box overlaps and whose range
+ * reaches it are turned on, the strongest ones first if there are more
+ * than OpenGL provides. Lights set above this node, such as a directional
+ * sun, stay on for all children and count against that limit; if they
+ * leave no OpenGL light free, all local lights are rendered in front of
+ * the children as a plain separator would.
+ *
+ * Children should be separators; their bounding boxes are computed once
+ * and again after any change below the node. The node does no render
+ * caching or culling of its own.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_CLUSTERED_LIGHT_SEPARATOR_H
+#define COIN3D_EXAMPLES_SO_CLUSTERED_LIGHT_SEPARATOR_H
+
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoSFFloat.h>
+#include <Inventor/fields/SoSFInt32.h>
+#include <Inventor/fields/SoSFNode.h>
+#include <Inventor/SbBox3f.h>
+
+#include <vector>
+
+#include "LightClusters.h"
+
+class SoClusteredLightSeparator : public SoSeparator
+{
+    SO_NODE_HEADER(SoClusteredLightSeparator);
+
+public:
+    static void initClass();
+    SoClusteredLightSeparator();
+
+    SoSFNode lights;             // point and spot lights, in this node's coordinates
+    SoSFFloat cutoffIntensity;   // intensity below which a light is out of range
+    SoSFInt32 maxLightsPerChild; // 0: as many as OpenGL has left
+
+    virtual void GLRenderBelowPath(SoGLRenderAction* action);
+
+    // Light lists of all children for a view, as rendering computes them;
+    // sourcesLeft > 0 further limits the lights per child
+    void assignLights(const SbViewVolume& volume, const SbMatrix& localToEye,
+                      int sourcesLeft = 0);
+    const std::vector<int>& getChildLights(int child) const { return childLights[child]; }
+    const LightClusterGrid& getGrid() const { return grid; }
+
+protected:
+    virtual ~SoClusteredLightSeparator();
+    virtual void notify(SoNotList* list);
+
+private:
+    void updateLights();
+    void updateBoxes();
+    void renderLights(SoGLRenderAction* action, const std::vector<int>& indices,
+                      const SbMatrix& model);
+
+    LightClusterGrid grid;
+    bool lightsValid;
+    std::vector<SbBox3f> boxes;  // child bounding boxes
+    bool boxesValid;
+    std::vector<std::vector<int> > childLights;
+};
+
+#endif // COIN3D_EXAMPLES_SO_CLUSTERED_LIGHT_SEPARATOR_H
@@ -0,0 +1,258 @@
+/*
+ * Light Cluster Benchmark
+ * Clustered light assignment for a plant-like floor of shapes lit by many
+ * attenuated point and spot lights: time to collect the lights, bin them
+ * into the view's cluster grid and gather the light list of every shape,
+ * and the average number of lights per visible shape, against testing
+ * every light against every shape. The same frames are then rendered
+ * offscreen through SoClusteredLightSeparator and through a plain
+ * separator holding all lights, which OpenGL cuts down to its first few.
+ *
+ * Usage: lighting_cluster_benchmark [lights] [shapes per side] [frames]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoEnvironment.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoPointLight.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSpotLight.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "LightClusters.h"
+#include "SoClusteredLightSeparator.h"
+#include "BenchmarkUtils.h"
+
+static const float spacing = 4.0f;
+
+static float random01()
+{
+    return rand() / (float)RAND_MAX;
+}
+
+// Half point lights, half spot lights pointing down, above the floor
+static SoSeparator* createLights(int count, float extent)
+{
+    SoSeparator* lights = new SoSeparator;
+    SoEnvironment* environment = new SoEnvironment;
+    // Reaches about 16 units at the default cutoff intensity
+    environment->attenuation.setValue(0.2f, 0.0f, 1.0f);
+    lights->addChild(environment);
+    for (int i = 0; i < count; i++) {
+        SbVec3f location(random01() * extent, random01() * extent, 3.0f + 5.0f * random01());
+        if (i % 2) {
+            SoSpotLight* spot = new SoSpotLight;
+            spot->location = location;
+            spot->direction.setValue(random01() - 0.5f, random01() - 0.5f, -1.0f);
+            spot->cutOffAngle = 0.3f + 0.5f * random01();
+            lights->addChild(spot);
+        } else {
+            SoPointLight* point = new SoPointLight;
+            point->location = location;
+            lights->addChild(point);
+        }
+    }
+    return lights;
+}
+
+// Grid of boxes on the z = 0 floor
+static std::vector<SbBox3f> createShapeBoxes(int side)
+{
+    SoCube* cube = new SoCube;
+    cube->ref();
+    SoGetBoundingBoxAction bboxAction((SbViewportRegion()));
+    bboxAction.apply(cube);
+    SbBox3f cubeBox = bboxAction.getBoundingBox();
+    cube->unref();
+
+    std::vector<SbBox3f> boxes;
+    for (int y = 0; y < side; y++) {
+        for (int x = 0; x < side; x++) {
+            SbVec3f offset(x * spacing, y * spacing, 1.0f);
+            boxes.push_back(SbBox3f(cubeBox.getMin() + offset, cubeBox.getMax() + offset));
+        }
+    }
+    return boxes;
+}
+
+// The cubes of createShapeBoxes() as Separator { Translation, Cube }
+static void addShapes(SoGroup* parent, int side)
+{
+    SoCube* cube = new SoCube;
+    for (int y = 0; y < side; y++) {
+        for (int x = 0; x < side; x++) {
+            SoSeparator* shape = new SoSeparator;
+            SoTranslation* translation = new SoTranslation;
+            translation->translation.setValue(x * spacing, y * spacing, 1.0f);
+            shape->addChild(translation);
+            shape->addChild(cube);
+            parent->addChild(shape);
+        }
+    }
+}
+
+// Place camera for frame of frames, circling above the plant
+static void placeCamera(SoPerspectiveCamera* camera, int frame, int frames, float extent)
+{
+    float angle = 2.0f * (float)M_PI * frame / std::max(frames, 1);
+    SbVec3f center(0.5f * extent, 0.5f * extent, 0.0f);
+    camera->position = center + SbVec3f(cosf(angle), sinf(angle), 0.6f) * (0.6f * extent);
+    camera->pointAt(center, SbVec3f(0.0f, 0.0f, 1.0f));
+}
+
+// Milliseconds per offscreen frame of root, or < 0 without an offscreen context
+static double renderFrames(SoNode* root, SoPerspectiveCamera* camera, int frames, float extent,
+                           const SbViewportRegion& viewport)
+{
+    SoOffscreenRenderer renderer(viewport);
+    double ms = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        placeCamera(camera, frame, frames, extent);
+        BenchTimer timer;
+        if (!renderer.render(root)) {
+            return -1.0;
+        }
+        ms += timer.milliseconds();
+    }
+    return ms / std::max(frames, 1);
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoClusteredLightSeparator::initClass();
+
+    int numLights = argc > 1 ? atoi(argv[1]) : 1000;
+    int side = argc > 2 ? atoi(argv[2]) : 100;
+    int frames = argc > 3 ? atoi(argv[3]) : 20;
+    float extent = side * spacing;
+
+    srand(1);
+    SoSeparator* lightGraph = createLights(numLights, extent);
+    lightGraph->ref();
+    std::vector<SbBox3f> boxes = createShapeBoxes(side);
+
+    LightClusterGrid grid;
+    BenchTimer timer;
+    grid.collectLights(lightGraph, 0.02f);
+    double collectMs = timer.milliseconds();
+
+    // Camera circling above the plant, looking at its center
+    SoPerspectiveCamera* camera = new SoPerspectiveCamera;
+    camera->ref();
+    camera->nearDistance = 1.0f;
+    camera->farDistance = 3.0f * extent;
+    SbViewportRegion viewport(1280, 720);
+
+    double assignMs = 0.0, gatherMs = 0.0, bruteMs = 0.0;
+    double clusteredSum = 0.0, bruteSum = 0.0;
+    long visibleShapes = 0;
+    size_t entries = 0;
+    int maxLights = 0;
+    std::vector<int> shapeLights;
+    for (int frame = 0; frame < frames; frame++) {
+        placeCamera(camera, frame, frames, extent);
+        SbViewVolume volume = camera->getViewVolume(viewport.getViewportAspectRatio());
+        SbMatrix viewing, projection;
+        volume.getMatrices(viewing, projection);
+
+        timer.restart();
+        grid.assign(volume, viewing);
+        assignMs += timer.milliseconds();
+        entries += grid.getNumEntries();
+
+        std::vector<bool> visible(boxes.size());
+        for (size_t i = 0; i < boxes.size(); i++) {
+            visible[i] = volume.intersect(boxes[i]) != FALSE;
+        }
+
+        timer.restart();
+        for (size_t i = 0; i < boxes.size(); i++) {
+            int count = grid.gatherLights(boxes[i], shapeLights);
+            if (visible[i]) {
+                clusteredSum += count;
+                maxLights = std::max(maxLights, count);
+            }
+        }
+        gatherMs += timer.milliseconds();
+
+        // Reference: every light against every visible shape
+        timer.restart();
+        for (size_t i = 0; i < boxes.size(); i++) {
+            if (!visible[i]) {
+                continue;
+            }
+            visibleShapes++;
+            for (int l = 0; l < grid.getNumLights(); l++) {
+                const ClusteredLight& light = grid.getLight(l);
+                if (light.range < 0.0f ||
+                    sphereTouchesBox(light.sphereCenter, light.sphereRadius, boxes[i])) {
+                    bruteSum++;
+                }
+            }
+        }
+        bruteMs += timer.milliseconds();
+    }
+
+    printf("%d lights (%d collected), %d shapes, %d frames, %d clusters\n", numLights,
+           grid.getNumLights(), (int)boxes.size(), frames, grid.getNumClusters());
+    printf("collect lights:           %10.2f ms\n", collectMs);
+    printf("bin into clusters:        %10.3f ms/frame (%.0f light-cluster entries)\n",
+           assignMs / frames, (double)entries / frames);
+    printf("gather per shape lists:   %10.3f ms/frame\n", gatherMs / frames);
+    printf("all lights x all shapes:  %10.3f ms/frame (visible shapes only)\n", bruteMs / frames);
+    printf("visible shapes/frame:     %10.0f\n", (double)visibleShapes / frames);
+    printf("lights per visible shape: %10.2f clustered, %.2f exact, max %d; fixed function "
+           "evaluates all %d\n",
+           visibleShapes ? clusteredSum / visibleShapes : 0.0,
+           visibleShapes ? bruteSum / visibleShapes : 0.0, maxLights, grid.getNumLights());
+
+    // Rendering: the shapes under the clustering node, and under a plain
+    // separator after the whole light graph
+    SoSeparator* clusteredRoot = new SoSeparator;
+    clusteredRoot->ref();
+    clusteredRoot->addChild(camera);
+    SoClusteredLightSeparator* clustered = new SoClusteredLightSeparator;
+    clustered->lights = lightGraph;
+    addShapes(clustered, side);
+    clusteredRoot->addChild(clustered);
+
+    SoSeparator* plainRoot = new SoSeparator;
+    plainRoot->ref();
+    plainRoot->addChild(camera);
+    SoSeparator* plain = new SoSeparator;
+    for (int i = 0; i < lightGraph->getNumChildren(); i++) {
+        plain->addChild(lightGraph->getChild(i));
+    }
+    addShapes(plain, side);
+    plainRoot->addChild(plain);
+
+    double clusteredRenderMs = renderFrames(clusteredRoot, camera, frames, extent, viewport);
+    double plainRenderMs = renderFrames(plainRoot, camera, frames, extent, viewport);
+    if (clusteredRenderMs < 0.0 || plainRenderMs < 0.0) {
+        printf("render:                   %10s (no offscreen context)\n", "n/a");
+    } else {
+        printf("render, clustered lights: %10.2f ms/frame\n", clusteredRenderMs);
+        printf("render, plain separator:  %10.2f ms/frame (first OpenGL lights only)\n",
+               plainRenderMs);
+    }
+
+    plainRoot->unref();
+    clusteredRoot->unref();
+    camera->unref();
+    lightGraph->unref();
+    return 0;
+}
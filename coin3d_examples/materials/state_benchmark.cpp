@@ -0,0 +1,139 @@
+/*
+ * Material State Benchmark
+ * Material state changes per frame of a large scene where every object has
+ * its own SoMaterial but only a few distinct values occur: as built, after
+ * deduplicateMaterials(), and deduplicated under an SoSortedSeparator.
+ * State changes are counted headlessly with a callback traversal; frame
+ * times come from SoOffscreenRenderer, which runs on a software GL such
+ * as Mesa llvmpipe when started with LIBGL_ALWAYS_SOFTWARE=1.
+ *
+ * Usage: materials_state_benchmark [objects] [distinct materials] [frames]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoTransform.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "MaterialOptimizer.h"
+#include "SoSortedSeparator.h"
+#include "BenchmarkUtils.h"
+
+// Grid of objects, each Separator{Transform, Material, Sphere or Cube} with
+// a new material node holding one of distinct values, in random order
+static void addObjects(SoSeparator* root, int objects, int distinct)
+{
+    int side = (int)ceil(sqrt((double)objects));
+    srand(1);
+    for (int i = 0; i < objects; i++) {
+        SoSeparator* object = new SoSeparator;
+        SoTransform* transform = new SoTransform;
+        transform->translation.setValue((i % side) * 3.0f, (i / side) * 3.0f, 0.0f);
+        object->addChild(transform);
+
+        int value = rand() % distinct;
+        SoMaterial* material = new SoMaterial;
+        material->diffuseColor.setValue((value % 5) / 4.0f, (value / 5 % 5) / 4.0f,
+                                        (value / 25 % 5) / 4.0f);
+        material->shininess.setValue((value / 125 % 5) / 4.0f);
+        object->addChild(material);
+
+        if (rand() % 2) {
+            object->addChild(new SoSphere);
+        } else {
+            object->addChild(new SoCube);
+        }
+        root->addChild(object);
+    }
+}
+
+// Milliseconds per frame after one warm-up frame, < 0 if no GL context
+// could be created
+static double renderFrame(SoNode* root, const SbViewportRegion& viewport, int frames)
+{
+    SoOffscreenRenderer renderer(viewport);
+    if (frames <= 0 || !renderer.render(root)) {
+        return -1.0;
+    }
+    BenchTimer timer;
+    for (int i = 0; i < frames; i++) {
+        renderer.render(root);
+    }
+    return timer.milliseconds() / frames;
+}
+
+static void printRow(const char* name, SoNode* root, const SbViewportRegion& viewport, int frames)
+{
+    BenchTimer timer;
+    StateChangeCounts counts = countStateChanges(root);
+    double countMs = timer.milliseconds();
+    double frameMs = renderFrame(root, viewport, frames);
+    printf("%-16s %10d %14d %14d %10.1f ", name, counts.shapes, counts.nodeSwitches,
+           counts.valueChanges, countMs);
+    if (frameMs >= 0.0) {
+        printf("%10.1f\n", frameMs);
+    } else {
+        printf("%10s\n", "n/a");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoSortedSeparator::initClass();
+
+    int objects = argc > 1 ? atoi(argv[1]) : 20000;
+    int distinct = argc > 2 ? atoi(argv[2]) : 50;
+    int frames = argc > 3 ? atoi(argv[3]) : 10;
+    if (distinct < 1) {
+        distinct = 1;
+    }
+
+    SbViewportRegion viewport(1024, 768);
+
+    // Camera and light stay in front of the objects in either root
+    SoPerspectiveCamera* camera = new SoPerspectiveCamera;
+    SoDirectionalLight* light = new SoDirectionalLight;
+    SoSeparator* root = new SoSeparator;
+    root->ref();
+    root->addChild(camera);
+    root->addChild(light);
+    addObjects(root, objects, distinct);
+    camera->viewAll(root, viewport);
+
+    printf("%d objects, %d distinct materials, %d frames\n", objects, distinct, frames);
+    printf("%-16s %10s %14s %14s %10s %10s\n", "graph", "shapes", "node switches",
+           "value changes", "count ms", "frame ms");
+    printRow("original", root, viewport, frames);
+
+    BenchTimer timer;
+    MaterialDedupStats stats = deduplicateMaterials(root);
+    double dedupMs = timer.milliseconds();
+    printRow("deduplicated", root, viewport, frames);
+
+    // Same children under a sorting separator
+    SoSortedSeparator* sorted = new SoSortedSeparator;
+    sorted->ref();
+    for (int i = 0; i < root->getNumChildren(); i++) {
+        sorted->addChild(root->getChild(i));
+    }
+    printRow("dedup + sorted", sorted, viewport, frames);
+
+    printf("\ndeduplicateMaterials: %d materials, %d unique, %d replaced, %d skipped, %.1f ms\n",
+           stats.materials, stats.unique, stats.replaced, stats.skipped, dedupMs);
+
+    sorted->unref();
+    root->unref();
+    return 0;
+}
@@ -0,0 +1,215 @@
+/*
+ * Transparency Sort Benchmark
+ * Per-frame cost of ordering 50k transparent spheres back to front during
+ * a scripted camera orbit: sorting from scratch with std::sort (what
+ * SORTED_OBJECT_BLEND does each frame), with a radix sort, and repairing
+ * the previous frame's order incrementally (SoDepthSortSeparator). The
+ * orbit runs at several speeds and jumps by 90 degrees every 180 frames,
+ * which must fall back to a full sort. A small graph with a rotation
+ * between two runs of separators checks that the sort sees it.
+ *
+ * With --render, a few orbit frames are also drawn offscreen, once with
+ * SORTED_OBJECT_BLEND over a plain separator and once with BLEND over
+ * SoDepthSortSeparator.
+ *
+ * Usage: materials_transparency_benchmark [spheres] [frames] [--render]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoRotation.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "SoDepthSortSeparator.h"
+#include "BenchmarkUtils.h"
+
+// Random cloud of spheres, half at transparency 0.5 and half at 0.2 as in
+// the materials example
+static void addSpheres(SoGroup* group, int spheres, float extent)
+{
+    SoMaterial* materials[2];
+    for (int i = 0; i < 2; i++) {
+        materials[i] = new SoMaterial;
+        materials[i]->diffuseColor.setValue(1.0f, i ? 0.5f : 1.0f, 0.0f);
+        materials[i]->transparency = i ? 0.2f : 0.5f;
+    }
+    SoSphere* sphere = new SoSphere;
+    sphere->radius = 0.5f;
+    srand(1);
+    for (int i = 0; i < spheres; i++) {
+        SoSeparator* object = new SoSeparator;
+        SoTransform* transform = new SoTransform;
+        transform->translation.setValue((rand() / (float)RAND_MAX - 0.5f) * extent,
+                                        (rand() / (float)RAND_MAX - 0.5f) * extent,
+                                        (rand() / (float)RAND_MAX - 0.5f) * extent);
+        object->addChild(transform);
+        object->addChild(materials[i % 2]);
+        object->addChild(sphere);
+        group->addChild(object);
+    }
+}
+
+// Camera on a circle around the cloud at frame of an orbit turning by
+// degreesPerFrame, with a 90 degree jump every 180 frames
+static void placeCamera(SoPerspectiveCamera* camera, int frame, float degreesPerFrame,
+                        float radius)
+{
+    float degrees = frame * degreesPerFrame + (frame / 180) * 90.0f;
+    float angle = degrees * (float)M_PI / 180.0f;
+    camera->position.setValue(radius * sinf(angle), 0.3f * radius, radius * cosf(angle));
+    camera->pointAt(SbVec3f(0.0f, 0.0f, 0.0f));
+}
+
+static SoSeparator* createSphereAt(float z)
+{
+    SoSeparator* object = new SoSeparator;
+    SoTranslation* translation = new SoTranslation;
+    translation->translation.setValue(0.0f, 0.0f, z);
+    object->addChild(translation);
+    object->addChild(new SoSphere);
+    return object;
+}
+
+// Separator(z = 0), Rotation(180 degrees about y), Separator(z = -2),
+// Separator(z = 2), seen from +z: the rotation swaps the last two, so the
+// one at z = 2 is the farther one
+static bool checkTransformBetweenRuns()
+{
+    SoDepthSortSeparator* sorted = new SoDepthSortSeparator;
+    sorted->ref();
+    sorted->addChild(createSphereAt(0.0f));
+    SoRotation* rotation = new SoRotation;
+    rotation->rotation.setValue(SbVec3f(0.0f, 1.0f, 0.0f), (float)M_PI);
+    sorted->addChild(rotation);
+    sorted->addChild(createSphereAt(-2.0f));
+    sorted->addChild(createSphereAt(2.0f));
+
+    SbMatrix viewing;
+    viewing.setTranslate(SbVec3f(0.0f, 0.0f, -20.0f));
+    const std::vector<int>& order = sorted->sortBackToFront(viewing);
+    const int expected[] = { 0, 1, 3, 2 };
+    bool ok = order.size() == 4;
+    for (size_t i = 0; ok && i < order.size(); i++) {
+        ok = order[i] == expected[i];
+    }
+    sorted->unref();
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoDepthSortSeparator::initClass();
+
+    int spheres = argc > 1 ? atoi(argv[1]) : 50000;
+    int frames = argc > 2 ? atoi(argv[2]) : 720;
+    bool render = argc > 3 && strcmp(argv[3], "--render") == 0;
+
+    if (!checkTransformBetweenRuns()) {
+        fprintf(stderr, "Wrong order with a transform between two runs\n");
+        return 1;
+    }
+
+    // About 3 units per sphere along each axis of the cloud
+    float extent = 3.0f * (float)cbrt((double)spheres);
+    float radius = 1.5f * extent;
+    SbViewportRegion viewport(1024, 768);
+    float aspect = viewport.getViewportAspectRatio();
+
+    SoPerspectiveCamera* camera = new SoPerspectiveCamera;
+    camera->nearDistance = 1.0f;
+    camera->farDistance = 3.0f * radius;
+    SoDepthSortSeparator* sorted = new SoDepthSortSeparator;
+    addSpheres(sorted, spheres, extent);
+
+    SoSeparator* root = new SoSeparator;
+    root->ref();
+    root->addChild(camera);
+    root->addChild(new SoDirectionalLight);
+    root->addChild(sorted);
+
+    const char* methodNames[] = { "std::sort", "radix", "incremental" };
+    const float speeds[] = { 0.0f, 0.05f, 0.5f, 2.0f };
+
+    printf("%d spheres, %d frames per orbit, jump every 180 frames\n", spheres, frames);
+    printf("%-8s %-12s %10s %10s %8s %12s\n", "deg/frm", "method", "avg ms", "max ms", "full",
+           "incremental");
+    for (size_t s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++) {
+        for (int method = 0; method < 3; method++) {
+            sorted->sortMethod = method;
+            unsigned long fullBefore = sorted->getNumFullSorts();
+            unsigned long incrementalBefore = sorted->getNumIncrementalSorts();
+            double totalMs = 0.0, maxMs = 0.0;
+            for (int frame = 0; frame < frames; frame++) {
+                placeCamera(camera, frame, speeds[s], radius);
+                SbMatrix viewing, projection;
+                camera->getViewVolume(aspect).getMatrices(viewing, projection);
+                BenchTimer timer;
+                sorted->sortBackToFront(viewing);
+                double ms = timer.milliseconds();
+                totalMs += ms;
+                maxMs = std::max(maxMs, ms);
+            }
+            printf("%-8.2f %-12s %10.3f %10.3f %8lu %12lu\n", speeds[s], methodNames[method],
+                   totalMs / frames, maxMs, sorted->getNumFullSorts() - fullBefore,
+                   sorted->getNumIncrementalSorts() - incrementalBefore);
+        }
+    }
+
+    if (render) {
+        // Same camera and spheres under a plain separator
+        SoSeparator* plain = new SoSeparator;
+        SoSeparator* plainRoot = new SoSeparator;
+        plainRoot->ref();
+        plainRoot->addChild(camera);
+        plainRoot->addChild(root->getChild(1));
+        plainRoot->addChild(plain);
+        for (int i = 0; i < sorted->getNumChildren(); i++) {
+            plain->addChild(sorted->getChild(i));
+        }
+        sorted->sortMethod = SoDepthSortSeparator::INCREMENTAL;
+
+        const int renderFrames = 10;
+        SoOffscreenRenderer renderer(viewport);
+        for (int pass = 0; pass < 2; pass++) {
+            SoNode* scene = pass ? (SoNode*)root : (SoNode*)plainRoot;
+            renderer.getGLRenderAction()->setTransparencyType(
+                pass ? SoGLRenderAction::BLEND : SoGLRenderAction::SORTED_OBJECT_BLEND);
+            BenchTimer timer;
+            bool ok = true;
+            for (int frame = 0; frame < renderFrames && ok; frame++) {
+                placeCamera(camera, frame, 0.5f, radius);
+                ok = renderer.render(scene) != FALSE;
+            }
+            if (ok) {
+                printf("render %-34s %10.1f ms/frame\n",
+                       pass ? "BLEND + SoDepthSortSeparator" : "SORTED_OBJECT_BLEND",
+                       timer.milliseconds() / renderFrames);
+            } else {
+                printf("render: no offscreen GL context\n");
+                break;
+            }
+        }
+        plainRoot->unref();
+    }
+
+    root->unref();
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Notification Benchmark
+ * Per-field setValue() against a NotificationBatch when every object of a
+ * large scene gets new simulation results each frame (translation,
+ * diffuseColor and radius of Separator{Transform, Material, Sphere}
+ * branches), with an immediate sensor on the root counting the
+ * notifications that arrive there
+ *
+ * The bounding boxes of both scenes are compared at the end, which checks
+ * that the shapes' caches were invalidated by the batched edits.
+ *
+ * Usage: scene_graph_notification_benchmark [objects] [frames]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSphere.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "NotificationBatch.h"
+#include "BenchmarkUtils.h"
+
+struct Object
+{
+    SoTransform* transform;
+    SoMaterial* material;
+    SoSphere* sphere;
+};
+
+static void countCB(void* data, SoSensor*)
+{
+    (*(unsigned long*)data)++;
+}
+
+static SoSeparator* createObjects(int count, std::vector<Object>& objects)
+{
+    SoSeparator* root = new SoSeparator;
+    objects.resize(count);
+    for (int i = 0; i < count; i++) {
+        SoSeparator* branch = new SoSeparator;
+        objects[i].transform = new SoTransform;
+        objects[i].material = new SoMaterial;
+        objects[i].sphere = new SoSphere;
+        branch->addChild(objects[i].transform);
+        branch->addChild(objects[i].material);
+        branch->addChild(objects[i].sphere);
+        root->addChild(branch);
+    }
+    return root;
+}
+
+// Simulation result of object i in frame
+static SbVec3f position(int i, int frame)
+{
+    return SbVec3f((float)(i % 1000) * 3.0f, (float)(i / 1000) * 3.0f, frame * 0.1f);
+}
+
+static SbColor color(int i, int frame)
+{
+    return SbColor((float)((i + frame) % 256) / 255.0f, 0.5f, 0.5f);
+}
+
+static float radius(int i, int frame)
+{
+    return 0.5f + 0.1f * (float)((i + frame) % 10);
+}
+
+static SbBox3f boundingBox(SoNode* root)
+{
+    SoGetBoundingBoxAction action(SbViewportRegion(640, 480));
+    action.apply(root);
+    return action.getBoundingBox();
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int count = argc > 1 ? atoi(argv[1]) : 100000;
+    int frames = argc > 2 ? atoi(argv[2]) : 10;
+
+    std::vector<Object> plainObjects, batchObjects;
+    SoSeparator* plainRoot = createObjects(count, plainObjects);
+    SoSeparator* batchRoot = createObjects(count, batchObjects);
+    plainRoot->ref();
+    batchRoot->ref();
+    boundingBox(plainRoot);
+    boundingBox(batchRoot);
+
+    unsigned long plainNotifications = 0, batchNotifications = 0;
+    SoNodeSensor plainSensor(countCB, &plainNotifications);
+    SoNodeSensor batchSensor(countCB, &batchNotifications);
+    plainSensor.setPriority(0);
+    batchSensor.setPriority(0);
+    plainSensor.attach(plainRoot);
+    batchSensor.attach(batchRoot);
+
+    BenchTimer timer;
+    for (int frame = 0; frame < frames; frame++) {
+        for (int i = 0; i < count; i++) {
+            plainObjects[i].transform->translation.setValue(position(i, frame));
+            plainObjects[i].material->diffuseColor.setValue(color(i, frame));
+            plainObjects[i].sphere->radius.setValue(radius(i, frame));
+        }
+    }
+    double plainMs = timer.milliseconds() / frames;
+
+    unsigned long edits = 0, notifications = 0;
+    timer.restart();
+    for (int frame = 0; frame < frames; frame++) {
+        NotificationBatch batch;
+        for (int i = 0; i < count; i++) {
+            batch.edit(batchObjects[i].transform->translation).setValue(position(i, frame));
+            batch.edit(batchObjects[i].material->diffuseColor).setValue(color(i, frame));
+            batch.edit(batchObjects[i].sphere->radius).setValue(radius(i, frame));
+        }
+        batch.commit();
+        edits += batch.getNumEdits();
+        notifications += batch.getNumNotifications();
+    }
+    double batchMs = timer.milliseconds() / frames;
+
+    plainSensor.detach();
+    batchSensor.detach();
+    SbBox3f plainBox = boundingBox(plainRoot);
+    SbBox3f batchBox = boundingBox(batchRoot);
+
+    printf("%d objects, %d field edits per frame, %d frames\n", count, 3 * count, frames);
+    printf("%-10s %12s %18s %14s\n", "mode", "ms/frame", "root notifications", "saved");
+    printf("%-10s %12.2f %18lu %14s\n", "per field", plainMs, plainNotifications / frames, "-");
+    printf("%-10s %12.2f %18lu %14lu\n", "batch", batchMs, batchNotifications / frames,
+           (edits - notifications) / frames);
+    printf("speedup %.1fx, total saved %lu, bounding boxes %s\n",
+           batchMs > 0.0 ? plainMs / batchMs : 0.0, NotificationBatch::getTotalSaved(),
+           plainBox == batchBox ? "match" : "DIFFER");
+
+    batchRoot->unref();
+    plainRoot->unref();
+    return plainBox == batchBox ? 0 : 1;
+}
@@ -0,0 +1,335 @@
+/*
+ * GlyphCache
+ * Glyph tessellation capture, software rasterization and atlas packing
+ */
+
+#include "GlyphCache.h"
+
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/nodes/SoFont.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoText3.h>
+#include <Inventor/system/gl.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Samples per pixel along each axis when rasterizing
+static const int SUPERSAMPLE = 4;
+
+GlyphCache& GlyphCache::getInstance()
+{
+    // Never destroyed, so it cannot outlive Coin at exit
+    static GlyphCache* cache = new GlyphCache;
+    return *cache;
+}
+
+GlyphCache::GlyphCache()
+    : shelfX(0), shelfY(0), shelfHeight(0), captureRoot(NULL), captureFont(NULL),
+      captureText(NULL), meshBytes(0)
+{
+    resetStats();
+}
+
+size_t GlyphCache::KeyHash::operator()(const Key& key) const
+{
+    uint32_t sizeBits;
+    memcpy(&sizeBits, &key.size, sizeof(sizeBits));
+    size_t hash = (size_t)key.font;
+    hash = hash * 31 + sizeBits;
+    hash = hash * 31 + key.code;
+    return hash * 31 + (size_t)key.parts;
+}
+
+void GlyphCache::decodeUtf8(const char* text, std::vector<uint32_t>& codes)
+{
+    codes.clear();
+    const unsigned char* s = (const unsigned char*)text;
+    while (*s) {
+        uint32_t code = *s++;
+        int extra = 0;
+        if (code >= 0xf0) {
+            code &= 0x07;
+            extra = 3;
+        } else if (code >= 0xe0) {
+            code &= 0x0f;
+            extra = 2;
+        } else if (code >= 0xc0) {
+            code &= 0x1f;
+            extra = 1;
+        }
+        for (; extra > 0 && (*s & 0xc0) == 0x80; extra--) {
+            code = (code << 6) | (*s++ & 0x3f);
+        }
+        codes.push_back(code);
+    }
+}
+
+static void encodeUtf8(uint32_t code, char* out)
+{
+    if (code < 0x80) {
+        *out++ = (char)code;
+    } else if (code < 0x800) {
+        *out++ = (char)(0xc0 | (code >> 6));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+        *out++ = (char)(0xe0 | (code >> 12));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    } else {
+        *out++ = (char)(0xf0 | (code >> 18));
+        *out++ = (char)(0x80 | ((code >> 12) & 0x3f));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    }
+    *out = '\0';
+}
+
+const Glyph3D& GlyphCache::getGlyph3D(const SbName& font, float size, uint32_t code, int parts)
+{
+    Key key = { font.getString(), size, code, parts };
+    std::unordered_map<Key, size_t, KeyHash>::iterator it = index3D.find(key);
+    if (it != index3D.end()) {
+        stats.hits3D++;
+        return glyphs3D[it->second];
+    }
+    stats.misses3D++;
+    glyphs3D.push_back(Glyph3D());
+    Glyph3D& glyph = glyphs3D.back();
+    tessellate(font, size, code, parts, glyph);
+    meshBytes += (glyph.points.size() + glyph.normals.size()) * sizeof(SbVec3f);
+    index3D[key] = glyphs3D.size() - 1;
+    return glyph;
+}
+
+const Glyph2D& GlyphCache::getGlyph2D(const SbName& font, float size, uint32_t code)
+{
+    Key key = { font.getString(), size, code, 0 };
+    std::unordered_map<Key, size_t, KeyHash>::iterator it = index2D.find(key);
+    if (it != index2D.end()) {
+        stats.hits2D++;
+        return glyphs2D[it->second];
+    }
+    stats.misses2D++;
+    // The outline is only needed while rasterizing
+    Glyph3D outline;
+    tessellate(font, size, code, SoText3::FRONT, outline);
+    glyphs2D.push_back(Glyph2D());
+    Glyph2D& glyph = glyphs2D.back();
+    rasterize(outline, glyph);
+    index2D[key] = glyphs2D.size() - 1;
+    return glyph;
+}
+
+struct CaptureTarget
+{
+    std::vector<SbVec3f>* points;
+    std::vector<SbVec3f>* normals;
+};
+
+static void captureTriangleCB(void* data, SoCallbackAction* action, const SoPrimitiveVertex* v1,
+                              const SoPrimitiveVertex* v2, const SoPrimitiveVertex* v3)
+{
+    CaptureTarget* target = (CaptureTarget*)data;
+    const SbMatrix& m = action->getModelMatrix();
+    const SoPrimitiveVertex* vertices[3] = { v1, v2, v3 };
+    for (int i = 0; i < 3; i++) {
+        SbVec3f point, normal;
+        m.multVecMatrix(vertices[i]->getPoint(), point);
+        m.multDirMatrix(vertices[i]->getNormal(), normal);
+        normal.normalize();
+        target->points->push_back(point);
+        if (target->normals) {
+            target->normals->push_back(normal);
+        }
+    }
+}
+
+static float maxX(const std::vector<SbVec3f>& points)
+{
+    float x = 0.0f;
+    for (size_t i = 0; i < points.size(); i++) {
+        x = i == 0 ? points[i][0] : std::max(x, points[i][0]);
+    }
+    return x;
+}
+
+// Triangles of code as SoText3 generates them. The advance is how far a
+// following '|' moves: its right edge in "c|" minus that in "|".
+void GlyphCache::tessellate(const SbName& font, float size, uint32_t code, int parts,
+                            Glyph3D& glyph)
+{
+    if (!captureRoot) {
+        captureRoot = new SoSeparator;
+        captureRoot->ref();
+        captureFont = new SoFont;
+        captureText = new SoText3;
+        captureRoot->addChild(captureFont);
+        captureRoot->addChild(captureText);
+    }
+    captureFont->name = font;
+    captureFont->size = size;
+    captureText->parts = parts;
+
+    char text[8];
+    encodeUtf8(code, text);
+    captureText->string = text;
+    CaptureTarget target = { &glyph.points, &glyph.normals };
+    SoCallbackAction action;
+    action.addTriangleCallback(SoText3::getClassTypeId(), captureTriangleCB, &target);
+    action.apply(captureRoot);
+
+    std::vector<SbVec3f> probe;
+    CaptureTarget probeTarget = { &probe, NULL };
+    SoCallbackAction probeAction;
+    probeAction.addTriangleCallback(SoText3::getClassTypeId(), captureTriangleCB, &probeTarget);
+    captureText->parts = SoText3::FRONT;
+    captureText->string = "|";
+    probeAction.apply(captureRoot);
+    float bar = maxX(probe);
+    probe.clear();
+    strcat(text, "|");
+    captureText->string = text;
+    probeAction.apply(captureRoot);
+    glyph.advance = std::max(maxX(probe) - bar, 0.0f);
+
+    glyph.box.makeEmpty();
+    for (size_t i = 0; i < glyph.points.size(); i++) {
+        glyph.box.extendBy(glyph.points[i]);
+    }
+}
+
+// Coverage of the front face triangles, one unit per pixel
+void GlyphCache::rasterize(const Glyph3D& outline, Glyph2D& glyph)
+{
+    glyph.page = -1;
+    glyph.x = glyph.y = glyph.width = glyph.height = 0;
+    glyph.bearingX = glyph.bearingY = 0;
+    glyph.advance = outline.advance;
+    if (outline.box.isEmpty()) {
+        return;
+    }
+    int x0 = (int)floorf(outline.box.getMin()[0]);
+    int y0 = (int)floorf(outline.box.getMin()[1]);
+    int width = (int)ceilf(outline.box.getMax()[0]) - x0;
+    int height = (int)ceilf(outline.box.getMax()[1]) - y0;
+    if (width <= 0 || height <= 0 || !allocate(width, height, glyph)) {
+        return;
+    }
+    glyph.bearingX = (short)x0;
+    glyph.bearingY = (short)y0;
+
+    int sampleWidth = width * SUPERSAMPLE;
+    int sampleHeight = height * SUPERSAMPLE;
+    std::vector<unsigned char> samples(sampleWidth * sampleHeight, 0);
+    const std::vector<SbVec3f>& p = outline.points;
+    for (size_t t = 0; t + 2 < p.size(); t += 3) {
+        // Triangle in sample coordinates
+        float ax = (p[t][0] - x0) * SUPERSAMPLE, ay = (p[t][1] - y0) * SUPERSAMPLE;
+        float bx = (p[t + 1][0] - x0) * SUPERSAMPLE, by = (p[t + 1][1] - y0) * SUPERSAMPLE;
+        float cx = (p[t + 2][0] - x0) * SUPERSAMPLE, cy = (p[t + 2][1] - y0) * SUPERSAMPLE;
+        float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+        if (area == 0.0f) {
+            continue;
+        }
+        float sign = area > 0.0f ? 1.0f : -1.0f;
+        int minX = std::max((int)floorf(std::min(ax, std::min(bx, cx))), 0);
+        int maxX = std::min((int)ceilf(std::max(ax, std::max(bx, cx))), sampleWidth - 1);
+        int minY = std::max((int)floorf(std::min(ay, std::min(by, cy))), 0);
+        int maxY = std::min((int)ceilf(std::max(ay, std::max(by, cy))), sampleHeight - 1);
+        for (int sy = minY; sy <= maxY; sy++) {
+            float y = sy + 0.5f;
+            for (int sx = minX; sx <= maxX; sx++) {
+                float x = sx + 0.5f;
+                float e0 = ((bx - ax) * (y - ay) - (by - ay) * (x - ax)) * sign;
+                float e1 = ((cx - bx) * (y - by) - (cy - by) * (x - bx)) * sign;
+                float e2 = ((ax - cx) * (y - cy) - (ay - cy) * (x - cx)) * sign;
+                if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f) {
+                    samples[sy * sampleWidth + sx] = 1;
+                }
+            }
+        }
+    }
+
+    // Rows go bottom up, as glTexImage2D expects
+    std::vector<unsigned char>& page = pages[glyph.page];
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int covered = 0;
+            for (int sy = 0; sy < SUPERSAMPLE; sy++) {
+                const unsigned char* row =
+                    &samples[(y * SUPERSAMPLE + sy) * sampleWidth + x * SUPERSAMPLE];
+                for (int sx = 0; sx < SUPERSAMPLE; sx++) {
+                    covered += row[sx];
+                }
+            }
+            page[(glyph.y + y) * ATLAS_SIZE + glyph.x + x] =
+                (unsigned char)(covered * 255 / (SUPERSAMPLE * SUPERSAMPLE));
+        }
+    }
+    pageVersions[glyph.page]++;
+}
+
+// Shelf packing with a one pixel gap between glyphs
+bool GlyphCache::allocate(int width, int height, Glyph2D& glyph)
+{
+    if (width + 1 > ATLAS_SIZE || height + 1 > ATLAS_SIZE) {
+        return false;
+    }
+    if (!pages.empty() && shelfX + width + 1 > ATLAS_SIZE) {
+        shelfY += shelfHeight;
+        shelfX = 0;
+        shelfHeight = 0;
+    }
+    if (pages.empty() || shelfY + height + 1 > ATLAS_SIZE) {
+        pages.push_back(std::vector<unsigned char>(ATLAS_SIZE * ATLAS_SIZE, 0));
+        pageVersions.push_back(0);
+        shelfX = shelfY = shelfHeight = 0;
+    }
+    glyph.page = (int)pages.size() - 1;
+    glyph.x = (short)shelfX;
+    glyph.y = (short)shelfY;
+    glyph.width = (short)width;
+    glyph.height = (short)height;
+    shelfX += width + 1;
+    shelfHeight = std::max(shelfHeight, height + 1);
+    return true;
+}
+
+void GlyphCache::bindPage(int page, uint32_t contextId)
+{
+    std::vector<PageTexture>& contextTextures = textures[contextId];
+    while ((int)contextTextures.size() <= page) {
+        PageTexture texture = { 0, 0 };
+        glGenTextures(1, (GLuint*)&texture.id);
+        contextTextures.push_back(texture);
+    }
+    PageTexture& texture = contextTextures[page];
+    glBindTexture(GL_TEXTURE_2D, (GLuint)texture.id);
+    if (texture.version == pageVersions[page] + 1) {
+        return;
+    }
+    // Versions are stored plus one so that 0 means never uploaded
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_SIZE, ATLAS_SIZE, 0, GL_ALPHA,
+                 GL_UNSIGNED_BYTE, &pages[page][0]);
+    texture.version = pageVersions[page] + 1;
+}
+
+GlyphCacheStats GlyphCache::getStats() const
+{
+    GlyphCacheStats result = stats;
+    result.atlasPages = (int)pages.size();
+    result.atlasBytes = pages.size() * ATLAS_SIZE * ATLAS_SIZE;
+    result.meshBytes = meshBytes;
+    return result;
+}
+
+void GlyphCache::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
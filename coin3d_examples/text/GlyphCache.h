@@ -0,0 +1,137 @@
+/*
+ * GlyphCache
+ * Process-wide cache of glyphs by font name, size and character, shared by
+ * every text node that uses it
+ *
+ * 3D glyphs are the triangles SoText3 generates for a single character,
+ * captured once through a callback action, so every further use of the
+ * same character in the same font costs one lookup. 2D glyphs come from
+ * the same outlines: the front face at a size of one unit per pixel is
+ * rasterized with 4x4 supersampling into 8 bit coverage and packed into
+ * 1024x1024 atlas pages, which are uploaded as GL_ALPHA textures once per
+ * GL context and again only when new glyphs were added.
+ *
+ * Glyphs are never evicted; the cache lives until the process ends.
+ * Profiles (SoProfile) are not applied to 3D glyphs.
+ */
+
+#ifndef COIN3D_EXAMPLES_GLYPH_CACHE_H
+#define COIN3D_EXAMPLES_GLYPH_CACHE_H
+
+#include <Inventor/SbBox3f.h>
+#include <Inventor/SbLinear.h>
+#include <Inventor/SbName.h>
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+class SoFont;
+class SoSeparator;
+class SoText3;
+
+struct Glyph2D
+{
+    int page;                  // atlas page, -1 for glyphs without pixels
+    short x, y;                // bitmap position in the page
+    short width, height;       // bitmap size in pixels
+    short bearingX, bearingY;  // bitmap lower left relative to the pen
+    float advance;             // pen movement in pixels
+};
+
+struct Glyph3D
+{
+    std::vector<SbVec3f> points;   // triangle list, pen at the origin
+    std::vector<SbVec3f> normals;
+    SbBox3f box;
+    float advance;
+};
+
+struct GlyphCacheStats
+{
+    unsigned long hits2D, misses2D;
+    unsigned long hits3D, misses3D;
+    int atlasPages;
+    size_t atlasBytes;
+    size_t meshBytes;
+};
+
+class GlyphCache
+{
+public:
+    static GlyphCache& getInstance();
+
+    static const int ATLAS_SIZE = 1024;
+
+    // size is in pixels for 2D glyphs and in units for 3D glyphs; parts
+    // are SoText3::Part bits
+    const Glyph2D& getGlyph2D(const SbName& font, float size, uint32_t code);
+    const Glyph3D& getGlyph3D(const SbName& font, float size, uint32_t code, int parts);
+
+    int getNumPages() const { return (int)pages.size(); }
+    const unsigned char* getPage(int page) const { return &pages[page][0]; }
+    // Bind page as texture in the current GL context, uploading it first
+    // if the context has not seen its latest glyphs
+    void bindPage(int page, uint32_t contextId);
+
+    GlyphCacheStats getStats() const;
+    void resetStats();
+
+    // Code points of UTF-8 text, as SoText2 and SoText3 read strings
+    static void decodeUtf8(const char* text, std::vector<uint32_t>& codes);
+
+private:
+    struct Key
+    {
+        const char* font;  // SbName strings are unique
+        float size;
+        uint32_t code;
+        int parts;         // 0 for 2D glyphs
+
+        bool operator==(const Key& other) const
+        {
+            return font == other.font && size == other.size && code == other.code &&
+                   parts == other.parts;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct PageTexture
+    {
+        unsigned int id;
+        uint32_t version;
+    };
+
+    GlyphCache();
+
+    void tessellate(const SbName& font, float size, uint32_t code, int parts, Glyph3D& glyph);
+    void rasterize(const Glyph3D& outline, Glyph2D& glyph);
+    bool allocate(int width, int height, Glyph2D& glyph);
+
+    std::unordered_map<Key, size_t, KeyHash> index2D;
+    std::unordered_map<Key, size_t, KeyHash> index3D;
+    std::deque<Glyph2D> glyphs2D;  // deques keep references stable
+    std::deque<Glyph3D> glyphs3D;
+
+    std::vector<std::vector<unsigned char> > pages;
+    std::vector<uint32_t> pageVersions;
+    int shelfX, shelfY, shelfHeight;  // packing position in the last page
+    std::map<uint32_t, std::vector<PageTexture> > textures;  // per GL context
+
+    // Graph that tessellates one character
+    SoSeparator* captureRoot;
+    SoFont* captureFont;
+    SoText3* captureText;
+
+    GlyphCacheStats stats;
+    size_t meshBytes;
+};
+
+#endif // COIN3D_EXAMPLES_GLYPH_CACHE_H
@@ -0,0 +1,150 @@
+/*
+ * SoCachedText2
+ * Atlas textured screen-aligned text
+ */
+
+#include "SoCachedText2.h"
+#include "GlyphCache.h"
+
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/bundles/SoMaterialBundle.h>
+#include <Inventor/elements/SoFontNameElement.h>
+#include <Inventor/elements/SoFontSizeElement.h>
+#include <Inventor/elements/SoGLCacheContextElement.h>
+#include <Inventor/elements/SoLazyElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoProjectionMatrixElement.h>
+#include <Inventor/elements/SoViewingMatrixElement.h>
+#include <Inventor/elements/SoViewportRegionElement.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/system/gl.h>
+
+#include <cmath>
+#include <vector>
+
+SO_NODE_SOURCE(SoCachedText2);
+
+void SoCachedText2::initClass()
+{
+    SO_NODE_INIT_CLASS(SoCachedText2, SoShape, "Shape");
+}
+
+SoCachedText2::SoCachedText2()
+{
+    SO_NODE_CONSTRUCTOR(SoCachedText2);
+    SO_NODE_ADD_FIELD(string, (""));
+}
+
+SoCachedText2::~SoCachedText2()
+{
+}
+
+void SoCachedText2::computeBBox(SoAction*, SbBox3f& box, SbVec3f& center)
+{
+    // Like SoText2, the text only occupies its anchor in object space
+    box.setBounds(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    center.setValue(0.0f, 0.0f, 0.0f);
+}
+
+void SoCachedText2::generatePrimitives(SoAction*)
+{
+}
+
+void SoCachedText2::GLRender(SoGLRenderAction* action)
+{
+    if (!shouldGLRender(action)) {
+        return;
+    }
+    SoState* state = action->getState();
+
+    // Anchor in window coordinates; nothing to draw behind the camera
+    SbMatrix toClip = SoModelMatrixElement::get(state) * SoViewingMatrixElement::get(state) *
+                      SoProjectionMatrixElement::get(state);
+    SbVec4f clip;
+    toClip.multVecMatrix(SbVec4f(0.0f, 0.0f, 0.0f, 1.0f), clip);
+    if (clip[3] <= 0.0f || fabsf(clip[2]) > clip[3]) {
+        return;
+    }
+    SbVec2s viewport = SoViewportRegionElement::get(state).getViewportSizePixels();
+    float anchorX = floorf((clip[0] / clip[3] + 1.0f) * 0.5f * viewport[0]);
+    float anchorY = floorf((clip[1] / clip[3] + 1.0f) * 0.5f * viewport[1]);
+    float depth = -clip[2] / clip[3];
+
+    // Look all glyphs up first: new ones change atlas pages, which must
+    // happen before the pages are bound
+    const SbName& font = SoFontNameElement::get(state);
+    float size = SoFontSizeElement::get(state);
+    GlyphCache& cache = GlyphCache::getInstance();
+    std::vector<const Glyph2D*> glyphs;
+    std::vector<SbVec2f> pens;
+    std::vector<uint32_t> codes;
+    for (int line = 0; line < string.getNum(); line++) {
+        GlyphCache::decodeUtf8(string[line].getString(), codes);
+        SbVec2f pen(anchorX, anchorY - line * size);
+        for (size_t i = 0; i < codes.size(); i++) {
+            const Glyph2D& glyph = cache.getGlyph2D(font, size, codes[i]);
+            if (glyph.page >= 0) {
+                glyphs.push_back(&glyph);
+                pens.push_back(pen);
+            }
+            pen[0] += glyph.advance;
+        }
+    }
+    if (glyphs.empty()) {
+        return;
+    }
+
+    // Unlit, in the diffuse color
+    state->push();
+    SoLazyElement::setLightModel(state, SoLazyElement::BASE_COLOR);
+    SoMaterialBundle mb(action);
+    mb.sendFirst();
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, viewport[0], 0.0, viewport[1], -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+    const float scale = 1.0f / GlyphCache::ATLAS_SIZE;
+    uint32_t contextId = SoGLCacheContextElement::get(state);
+    int boundPage = -1;
+    for (size_t i = 0; i < glyphs.size(); i++) {
+        const Glyph2D& glyph = *glyphs[i];
+        if (glyph.page != boundPage) {
+            if (boundPage >= 0) {
+                glEnd();
+            }
+            cache.bindPage(glyph.page, contextId);
+            boundPage = glyph.page;
+            glBegin(GL_QUADS);
+        }
+        float x0 = pens[i][0] + glyph.bearingX, y0 = pens[i][1] + glyph.bearingY;
+        float x1 = x0 + glyph.width, y1 = y0 + glyph.height;
+        float s0 = glyph.x * scale, t0 = glyph.y * scale;
+        float s1 = (glyph.x + glyph.width) * scale, t1 = (glyph.y + glyph.height) * scale;
+        glTexCoord2f(s0, t0);
+        glVertex3f(x0, y0, depth);
+        glTexCoord2f(s1, t0);
+        glVertex3f(x1, y0, depth);
+        glTexCoord2f(s1, t1);
+        glVertex3f(x1, y1, depth);
+        glTexCoord2f(s0, t1);
+        glVertex3f(x0, y1, depth);
+    }
+    glEnd();
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+    state->pop();
+}
@@ -0,0 +1,37 @@
+/*
+ * SoCachedText2
+ * Screen-aligned text like SoText2, drawn as textured quads from the
+ * GlyphCache atlas
+ *
+ * The node stores nothing but its strings; glyphs are looked up by the
+ * current SoFont name and size (in pixels), so labels repeating the same
+ * characters share their bitmaps. Lines are left justified and one font
+ * size apart. The text is not pickable.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_CACHED_TEXT2_H
+#define COIN3D_EXAMPLES_SO_CACHED_TEXT2_H
+
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoMFString.h>
+
+class SoCachedText2 : public SoShape
+{
+    SO_NODE_HEADER(SoCachedText2);
+
+public:
+    static void initClass();
+    SoCachedText2();
+
+    SoMFString string;
+
+    virtual void GLRender(SoGLRenderAction* action);
+
+protected:
+    virtual ~SoCachedText2();
+    virtual void computeBBox(SoAction* action, SbBox3f& box, SbVec3f& center);
+    virtual void generatePrimitives(SoAction* action);
+};
+
+#endif // COIN3D_EXAMPLES_SO_CACHED_TEXT2_H
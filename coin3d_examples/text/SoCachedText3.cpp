@@ -0,0 +1,133 @@
+/*
+ * SoCachedText3
+ * Layout of shared glyph meshes
+ */
+
+#include "SoCachedText3.h"
+#include "GlyphCache.h"
+
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/bundles/SoMaterialBundle.h>
+#include <Inventor/details/SoFaceDetail.h>
+#include <Inventor/elements/SoFontNameElement.h>
+#include <Inventor/elements/SoFontSizeElement.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/system/gl.h>
+
+SO_NODE_SOURCE(SoCachedText3);
+
+void SoCachedText3::initClass()
+{
+    SO_NODE_INIT_CLASS(SoCachedText3, SoShape, "Shape");
+}
+
+SoCachedText3::SoCachedText3()
+{
+    SO_NODE_CONSTRUCTOR(SoCachedText3);
+    SO_NODE_ADD_FIELD(string, (""));
+    SO_NODE_ADD_FIELD(parts, (FRONT));
+
+    SO_NODE_DEFINE_ENUM_VALUE(Part, FRONT);
+    SO_NODE_DEFINE_ENUM_VALUE(Part, SIDES);
+    SO_NODE_DEFINE_ENUM_VALUE(Part, BACK);
+    SO_NODE_DEFINE_ENUM_VALUE(Part, ALL);
+    SO_NODE_SET_SF_ENUM_TYPE(parts, Part);
+}
+
+SoCachedText3::~SoCachedText3()
+{
+}
+
+void SoCachedText3::layout(SoState* state, std::vector<const Glyph3D*>& glyphs,
+                           std::vector<SbVec3f>& pens)
+{
+    const SbName& font = SoFontNameElement::get(state);
+    float size = SoFontSizeElement::get(state);
+    // Same bits as SoText3::Part
+    int partBits = parts.getValue();
+    GlyphCache& cache = GlyphCache::getInstance();
+    std::vector<uint32_t> codes;
+    for (int line = 0; line < string.getNum(); line++) {
+        GlyphCache::decodeUtf8(string[line].getString(), codes);
+        SbVec3f pen(0.0f, -line * size, 0.0f);
+        for (size_t i = 0; i < codes.size(); i++) {
+            const Glyph3D& glyph = cache.getGlyph3D(font, size, codes[i], partBits);
+            if (!glyph.points.empty()) {
+                glyphs.push_back(&glyph);
+                pens.push_back(pen);
+            }
+            pen[0] += glyph.advance;
+        }
+    }
+}
+
+void SoCachedText3::computeBBox(SoAction* action, SbBox3f& box, SbVec3f& center)
+{
+    std::vector<const Glyph3D*> glyphs;
+    std::vector<SbVec3f> pens;
+    layout(action->getState(), glyphs, pens);
+    box.makeEmpty();
+    for (size_t i = 0; i < glyphs.size(); i++) {
+        box.extendBy(glyphs[i]->box.getMin() + pens[i]);
+        box.extendBy(glyphs[i]->box.getMax() + pens[i]);
+    }
+    if (!box.isEmpty()) {
+        center = box.getCenter();
+    }
+}
+
+void SoCachedText3::GLRender(SoGLRenderAction* action)
+{
+    if (!shouldGLRender(action)) {
+        return;
+    }
+    std::vector<const Glyph3D*> glyphs;
+    std::vector<SbVec3f> pens;
+    layout(action->getState(), glyphs, pens);
+    if (glyphs.empty()) {
+        return;
+    }
+
+    SoMaterialBundle mb(action);
+    mb.sendFirst();
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glMatrixMode(GL_MODELVIEW);
+    for (size_t i = 0; i < glyphs.size(); i++) {
+        const Glyph3D& glyph = *glyphs[i];
+        glVertexPointer(3, GL_FLOAT, 0, glyph.points[0].getValue());
+        glNormalPointer(GL_FLOAT, 0, glyph.normals[0].getValue());
+        glPushMatrix();
+        glTranslatef(pens[i][0], pens[i][1], pens[i][2]);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)glyph.points.size());
+        glPopMatrix();
+    }
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void SoCachedText3::generatePrimitives(SoAction* action)
+{
+    std::vector<const Glyph3D*> glyphs;
+    std::vector<SbVec3f> pens;
+    layout(action->getState(), glyphs, pens);
+
+    SoPrimitiveVertex vertex;
+    SoFaceDetail faceDetail;
+    vertex.setDetail(&faceDetail);
+
+    beginShape(action, TRIANGLES, &faceDetail);
+    for (size_t i = 0; i < glyphs.size(); i++) {
+        // Part index is the character, as for SoText3
+        faceDetail.setPartIndex((int)i);
+        const Glyph3D& glyph = *glyphs[i];
+        for (size_t v = 0; v < glyph.points.size(); v++) {
+            vertex.setPoint(glyph.points[v] + pens[i]);
+            vertex.setNormal(glyph.normals[v]);
+            shapeVertex(&vertex);
+        }
+    }
+    endShape();
+}
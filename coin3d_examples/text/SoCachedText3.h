@@ -0,0 +1,55 @@
+/*
+ * SoCachedText3
+ * 3D text like SoText3, drawn from glyph meshes shared through the
+ * GlyphCache
+ *
+ * Each distinct character of a font, size and set of parts is tessellated
+ * once per process; the node itself only lays out its strings. Lines are
+ * left justified and one font size apart, glyphs are placed at their
+ * plain advance without kerning.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_CACHED_TEXT3_H
+#define COIN3D_EXAMPLES_SO_CACHED_TEXT3_H
+
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoMFString.h>
+#include <Inventor/fields/SoSFBitMask.h>
+
+#include <vector>
+
+struct Glyph3D;
+
+class SoCachedText3 : public SoShape
+{
+    SO_NODE_HEADER(SoCachedText3);
+
+public:
+    static void initClass();
+    SoCachedText3();
+
+    enum Part
+    {
+        FRONT = 0x1,
+        SIDES = 0x2,
+        BACK = 0x4,
+        ALL = FRONT | SIDES | BACK
+    };
+
+    SoMFString string;
+    SoSFBitMask parts;  // FRONT by default, as SoText3
+
+    virtual void GLRender(SoGLRenderAction* action);
+
+protected:
+    virtual ~SoCachedText3();
+    virtual void computeBBox(SoAction* action, SbBox3f& box, SbVec3f& center);
+    virtual void generatePrimitives(SoAction* action);
+
+private:
+    // Glyphs of all strings with their pen positions
+    void layout(SoState* state, std::vector<const Glyph3D*>& glyphs, std::vector<SbVec3f>& pens);
+};
+
+#endif // COIN3D_EXAMPLES_SO_CACHED_TEXT3_H
@@ -0,0 +1,312 @@
+/*
+ * SoLabelBatch
+ * Projected, overlap culled label layout drawn from atlas vertex arrays
+ */
+
+#include "SoLabelBatch.h"
+#include "GlyphCache.h"
+
+#include <Inventor/actions/SoGLRenderAction.h>
+#include <Inventor/bundles/SoMaterialBundle.h>
+#include <Inventor/elements/SoFontNameElement.h>
+#include <Inventor/elements/SoFontSizeElement.h>
+#include <Inventor/elements/SoGLCacheContextElement.h>
+#include <Inventor/elements/SoGLLazyElement.h>
+#include <Inventor/elements/SoModelMatrixElement.h>
+#include <Inventor/elements/SoProjectionMatrixElement.h>
+#include <Inventor/elements/SoViewingMatrixElement.h>
+#include <Inventor/elements/SoViewportRegionElement.h>
+#include <Inventor/misc/SoNotification.h>
+#include <Inventor/misc/SoState.h>
+#include <Inventor/system/gl.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Edge length in pixels of the cells of the overlap test
+static const int CELL_SIZE = 64;
+
+SO_NODE_SOURCE(SoLabelBatch);
+
+void SoLabelBatch::initClass()
+{
+    SO_NODE_INIT_CLASS(SoLabelBatch, SoShape, "Shape");
+}
+
+SoLabelBatch::SoLabelBatch()
+    : glyphSize(0.0f), glyphsValid(false), cellsX(0), cellsY(0), numPlaced(0), numOutside(0),
+      numOverlapping(0)
+{
+    SO_NODE_CONSTRUCTOR(SoLabelBatch);
+    SO_NODE_ADD_FIELD(anchor, (0.0f, 0.0f, 0.0f));
+    SO_NODE_ADD_FIELD(string, (""));
+    SO_NODE_ADD_FIELD(color, (0xffffffff));
+    SO_NODE_ADD_FIELD(cullOverlaps, (TRUE));
+    // No labels until they are set
+    anchor.setNum(0);
+    string.setNum(0);
+    color.setNum(0);
+}
+
+SoLabelBatch::~SoLabelBatch()
+{
+}
+
+void SoLabelBatch::notify(SoNotList* list)
+{
+    if (list->getLastField() == &string) {
+        glyphsValid = false;
+    }
+    SoShape::notify(list);
+}
+
+void SoLabelBatch::computeBBox(SoAction*, SbBox3f& box, SbVec3f& center)
+{
+    // Like SoText2, labels only occupy their anchors in object space
+    box.makeEmpty();
+    const SbVec3f* anchors = anchor.getValues(0);
+    for (int i = 0; i < anchor.getNum(); i++) {
+        box.extendBy(anchors[i]);
+    }
+    if (!box.isEmpty()) {
+        center = box.getCenter();
+    }
+}
+
+void SoLabelBatch::generatePrimitives(SoAction*)
+{
+}
+
+void SoLabelBatch::updateGlyphs(const SbName& font, float size)
+{
+    if (glyphsValid && font == glyphFont && size == glyphSize) {
+        return;
+    }
+    glyphs.clear();
+    glyphOffsets.clear();
+    labelStarts.clear();
+    labelRects.clear();
+    GlyphCache& cache = GlyphCache::getInstance();
+    std::vector<uint32_t> codes;
+    for (int i = 0; i < string.getNum(); i++) {
+        labelStarts.push_back((int)glyphs.size());
+        GlyphCache::decodeUtf8(string[i].getString(), codes);
+        SbBox2f rect;
+        float pen = 0.0f;
+        for (size_t c = 0; c < codes.size(); c++) {
+            const Glyph2D& glyph = cache.getGlyph2D(font, size, codes[c]);
+            if (glyph.page >= 0) {
+                glyphs.push_back(&glyph);
+                glyphOffsets.push_back(pen);
+                rect.extendBy(SbVec2f(pen + glyph.bearingX, (float)glyph.bearingY));
+                rect.extendBy(SbVec2f(pen + glyph.bearingX + glyph.width,
+                                      (float)(glyph.bearingY + glyph.height)));
+            }
+            pen += glyph.advance;
+        }
+        labelRects.push_back(rect);
+    }
+    labelStarts.push_back((int)glyphs.size());
+    glyphFont = font;
+    glyphSize = size;
+    glyphsValid = true;
+}
+
+static bool rectsOverlap(const SbBox2f& a, const SbBox2f& b)
+{
+    return a.getMin()[0] < b.getMax()[0] && b.getMin()[0] < a.getMax()[0] &&
+           a.getMin()[1] < b.getMax()[1] && b.getMin()[1] < a.getMax()[1];
+}
+
+bool SoLabelBatch::overlaps(const SbBox2f& rect)
+{
+    int x0 = std::max((int)rect.getMin()[0] / CELL_SIZE, 0);
+    int x1 = std::min((int)rect.getMax()[0] / CELL_SIZE, cellsX - 1);
+    int y0 = std::max((int)rect.getMin()[1] / CELL_SIZE, 0);
+    int y1 = std::min((int)rect.getMax()[1] / CELL_SIZE, cellsY - 1);
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            const std::vector<int>& cell = cells[y * cellsX + x];
+            for (size_t i = 0; i < cell.size(); i++) {
+                if (rectsOverlap(rect, placedRects[cell[i]])) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void SoLabelBatch::insert(const SbBox2f& rect, int index)
+{
+    int x0 = std::max((int)rect.getMin()[0] / CELL_SIZE, 0);
+    int x1 = std::min((int)rect.getMax()[0] / CELL_SIZE, cellsX - 1);
+    int y0 = std::max((int)rect.getMin()[1] / CELL_SIZE, 0);
+    int y1 = std::min((int)rect.getMax()[1] / CELL_SIZE, cellsY - 1);
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            cells[y * cellsX + x].push_back(index);
+        }
+    }
+}
+
+int SoLabelBatch::layout(const SbMatrix& toClip, const SbVec2s& viewport, const SbName& font,
+                         float size)
+{
+    updateGlyphs(font, size);
+    numPlaced = numOutside = numOverlapping = 0;
+    for (size_t p = 0; p < batches.size(); p++) {
+        batches[p].vertices.clear();
+        batches[p].texCoords.clear();
+        batches[p].colors.clear();
+    }
+    cellsX = (viewport[0] + CELL_SIZE - 1) / CELL_SIZE;
+    cellsY = (viewport[1] + CELL_SIZE - 1) / CELL_SIZE;
+    cells.resize(cellsX * cellsY);
+    for (size_t c = 0; c < cells.size(); c++) {
+        cells[c].clear();
+    }
+    placedRects.clear();
+
+    const float scale = 1.0f / GlyphCache::ATLAS_SIZE;
+    const SbVec3f* anchors = anchor.getValues(0);
+    const uint32_t* colors = color.getValues(0);
+    int numColors = color.getNum();
+    int count = std::min(anchor.getNum(), (int)labelRects.size());
+    SbBox2f screen(0.0f, 0.0f, viewport[0], viewport[1]);
+    for (int i = 0; i < count; i++) {
+        if (labelRects[i].isEmpty()) {
+            continue;
+        }
+        SbVec4f clip;
+        const SbVec3f& a = anchors[i];
+        toClip.multVecMatrix(SbVec4f(a[0], a[1], a[2], 1.0f), clip);
+        if (clip[3] <= 0.0f || fabsf(clip[2]) > clip[3]) {
+            numOutside++;
+            continue;
+        }
+        float x = floorf((clip[0] / clip[3] + 1.0f) * 0.5f * viewport[0]);
+        float y = floorf((clip[1] / clip[3] + 1.0f) * 0.5f * viewport[1]);
+        float depth = -clip[2] / clip[3];
+        SbVec2f offset(x, y);
+        SbBox2f rect(labelRects[i].getMin() + offset, labelRects[i].getMax() + offset);
+        if (!rectsOverlap(rect, screen)) {
+            numOutside++;
+            continue;
+        }
+        if (cullOverlaps.getValue()) {
+            if (overlaps(rect)) {
+                numOverlapping++;
+                continue;
+            }
+            insert(rect, (int)placedRects.size());
+            placedRects.push_back(rect);
+        }
+        numPlaced++;
+
+        unsigned char rgba[4] = { 255, 255, 255, 255 };
+        if (numColors > 0) {
+            uint32_t packed = colors[i < numColors ? i : numColors - 1];
+            rgba[0] = (unsigned char)(packed >> 24);
+            rgba[1] = (unsigned char)(packed >> 16);
+            rgba[2] = (unsigned char)(packed >> 8);
+            rgba[3] = (unsigned char)packed;
+        }
+        for (int g = labelStarts[i]; g < labelStarts[i + 1]; g++) {
+            const Glyph2D& glyph = *glyphs[g];
+            if ((int)batches.size() <= glyph.page) {
+                batches.resize(glyph.page + 1);
+            }
+            PageBatch& batch = batches[glyph.page];
+            float x0 = x + glyphOffsets[g] + glyph.bearingX, y0 = y + glyph.bearingY;
+            float x1 = x0 + glyph.width, y1 = y0 + glyph.height;
+            float s0 = glyph.x * scale, t0 = glyph.y * scale;
+            float s1 = (glyph.x + glyph.width) * scale, t1 = (glyph.y + glyph.height) * scale;
+            const float corners[4][4] = {
+                { x0, y0, s0, t0 }, { x1, y0, s1, t0 }, { x1, y1, s1, t1 }, { x0, y1, s0, t1 }
+            };
+            for (int c = 0; c < 4; c++) {
+                batch.vertices.push_back(corners[c][0]);
+                batch.vertices.push_back(corners[c][1]);
+                batch.vertices.push_back(depth);
+                batch.texCoords.push_back(corners[c][2]);
+                batch.texCoords.push_back(corners[c][3]);
+                batch.colors.insert(batch.colors.end(), rgba, rgba + 4);
+            }
+        }
+    }
+    return numPlaced;
+}
+
+void SoLabelBatch::GLRender(SoGLRenderAction* action)
+{
+    if (!shouldGLRender(action)) {
+        return;
+    }
+    SoState* state = action->getState();
+    SbMatrix toClip = SoModelMatrixElement::get(state) * SoViewingMatrixElement::get(state) *
+                      SoProjectionMatrixElement::get(state);
+    SbVec2s viewport = SoViewportRegionElement::get(state).getViewportSizePixels();
+    if (layout(toClip, viewport, SoFontNameElement::get(state), SoFontSizeElement::get(state)) ==
+        0) {
+        return;
+    }
+
+    // Unlit, in the diffuse color unless labels have their own
+    state->push();
+    SoLazyElement::setLightModel(state, SoLazyElement::BASE_COLOR);
+    SoMaterialBundle mb(action);
+    mb.sendFirst();
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, viewport[0], 0.0, viewport[1], -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+    bool perLabelColors = color.getNum() > 0;
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    if (perLabelColors) {
+        glEnableClientState(GL_COLOR_ARRAY);
+    }
+    GlyphCache& cache = GlyphCache::getInstance();
+    uint32_t contextId = SoGLCacheContextElement::get(state);
+    for (size_t p = 0; p < batches.size(); p++) {
+        const PageBatch& batch = batches[p];
+        if (batch.vertices.empty()) {
+            continue;
+        }
+        cache.bindPage((int)p, contextId);
+        glVertexPointer(3, GL_FLOAT, 0, &batch.vertices[0]);
+        glTexCoordPointer(2, GL_FLOAT, 0, &batch.texCoords[0]);
+        if (perLabelColors) {
+            glColorPointer(4, GL_UNSIGNED_BYTE, 0, &batch.colors[0]);
+        }
+        glDrawArrays(GL_QUADS, 0, (GLsizei)(batch.vertices.size() / 3));
+    }
+    if (perLabelColors) {
+        glDisableClientState(GL_COLOR_ARRAY);
+    }
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+    state->pop();
+
+    // The diffuse color in GL no longer matches what Coin thinks it is
+    if (perLabelColors) {
+        SoGLLazyElement::getInstance(state)->reset(state, SoLazyElement::DIFFUSE_MASK);
+    }
+}
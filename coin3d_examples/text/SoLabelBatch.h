@@ -0,0 +1,92 @@
+/*
+ * SoLabelBatch
+ * Many screen-aligned labels in one node, drawn from the GlyphCache atlas
+ * in a single pass
+ *
+ * Replaces a Separator/Transform/Material/Font/SoText2 chain per label
+ * with three packed arrays: anchor positions, one string per label and
+ * optional packed RGBA colors (as SoInstancedShape). Each frame the
+ * anchors are projected, labels outside the viewport are dropped, and
+ * labels whose screen rectangle overlaps one placed earlier are skipped,
+ * so lower indices have priority. The remaining glyph quads are written
+ * into vertex arrays and drawn with one call per atlas page. Font name and
+ * size (in pixels) come from the current SoFont; labels are single lines,
+ * not pickable, and have an empty bounding box beyond their anchors.
+ */
+
+#ifndef COIN3D_EXAMPLES_SO_LABEL_BATCH_H
+#define COIN3D_EXAMPLES_SO_LABEL_BATCH_H
+
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoSubNode.h>
+#include <Inventor/fields/SoMFString.h>
+#include <Inventor/fields/SoMFUInt32.h>
+#include <Inventor/fields/SoMFVec3f.h>
+#include <Inventor/fields/SoSFBool.h>
+#include <Inventor/SbLinear.h>
+#include <Inventor/SbName.h>
+
+#include <vector>
+
+struct Glyph2D;
+
+class SoLabelBatch : public SoShape
+{
+    SO_NODE_HEADER(SoLabelBatch);
+
+public:
+    static void initClass();
+    SoLabelBatch();
+
+    SoMFVec3f anchor;       // lower left of each label's text, object space
+    SoMFString string;      // one line per label
+    SoMFUInt32 color;       // packed RGBA per label; empty = current material
+    SoSFBool cullOverlaps;  // skip labels covering an earlier one, TRUE
+
+    virtual void GLRender(SoGLRenderAction* action);
+
+    // Place the labels for one frame without drawing: toClip is object to
+    // clip space, size is the font size in pixels. Returns the number of
+    // labels placed; rendering calls this each frame.
+    int layout(const SbMatrix& toClip, const SbVec2s& viewport, const SbName& font, float size);
+    int getNumPlaced() const { return numPlaced; }
+    int getNumOutside() const { return numOutside; }
+    int getNumOverlapping() const { return numOverlapping; }
+
+protected:
+    virtual ~SoLabelBatch();
+    virtual void notify(SoNotList* list);
+    virtual void computeBBox(SoAction* action, SbBox3f& box, SbVec3f& center);
+    virtual void generatePrimitives(SoAction* action);
+
+private:
+    struct PageBatch
+    {
+        std::vector<float> vertices;        // x, y, z per quad corner
+        std::vector<float> texCoords;       // s, t per quad corner
+        std::vector<unsigned char> colors;  // r, g, b, a per quad corner
+    };
+
+    void updateGlyphs(const SbName& font, float size);
+    bool overlaps(const SbBox2f& rect);
+    void insert(const SbBox2f& rect, int index);
+
+    // Glyphs of all labels, resolved when strings or font change
+    std::vector<const Glyph2D*> glyphs;
+    std::vector<float> glyphOffsets;  // pen position within the label
+    std::vector<int> labelStarts;     // first glyph of each label, plus end
+    std::vector<SbBox2f> labelRects;  // label extent relative to its anchor
+    SbName glyphFont;
+    float glyphSize;
+    bool glyphsValid;
+
+    // Placed rectangles by coarse screen cell, for the overlap test
+    std::vector<std::vector<int> > cells;
+    std::vector<SbBox2f> placedRects;
+    int cellsX, cellsY;
+
+    std::vector<PageBatch> batches;
+    int numPlaced, numOutside, numOverlapping;
+};
+
+#endif // COIN3D_EXAMPLES_SO_LABEL_BATCH_H
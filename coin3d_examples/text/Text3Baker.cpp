@@ -0,0 +1,154 @@
+/*
+ * Text3Baker
+ * SoText3 tessellation captured into indexed, vertex sharing face sets
+ */
+
+#include "Text3Baker.h"
+
+#include <Inventor/SoPath.h>
+#include <Inventor/SoPrimitiveVertex.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoText3.h>
+#include <Inventor/nodes/SoVertexProperty.h>
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+// Position and normal of a vertex, compared bitwise
+struct VertexKey
+{
+    float values[6];
+
+    bool operator<(const VertexKey& other) const
+    {
+        return memcmp(values, other.values, sizeof(values)) < 0;
+    }
+};
+
+struct BakeTarget
+{
+    const SoNode* text;
+    std::map<VertexKey, int> index;
+    std::vector<SbVec3f> points;
+    std::vector<SbVec3f> normals;
+    std::vector<int32_t> coordIndex;
+    size_t corners;
+};
+
+static void bakeTriangleCB(void* data, SoCallbackAction* action, const SoPrimitiveVertex* v1,
+                           const SoPrimitiveVertex* v2, const SoPrimitiveVertex* v3)
+{
+    BakeTarget* target = (BakeTarget*)data;
+    // Only the text the path leads to, in its own coordinates
+    if (action->getCurrentPath()->getTail() != target->text) {
+        return;
+    }
+    const SoPrimitiveVertex* vertices[3] = { v1, v2, v3 };
+    for (int i = 0; i < 3; i++) {
+        VertexKey key;
+        memset(&key, 0, sizeof(key));
+        const SbVec3f& point = vertices[i]->getPoint();
+        const SbVec3f& normal = vertices[i]->getNormal();
+        for (int c = 0; c < 3; c++) {
+            key.values[c] = point[c];
+            key.values[3 + c] = normal[c];
+        }
+        std::map<VertexKey, int>::iterator it = target->index.find(key);
+        int index;
+        if (it == target->index.end()) {
+            index = (int)target->points.size();
+            target->index[key] = index;
+            target->points.push_back(point);
+            target->normals.push_back(normal);
+        } else {
+            index = it->second;
+        }
+        target->coordIndex.push_back(index);
+    }
+    target->coordIndex.push_back(SO_END_FACE_INDEX);
+    target->corners += 3;
+}
+
+static SoIndexedFaceSet* bakeText(SoPath* path, Text3BakeStats& stats)
+{
+    BakeTarget target;
+    target.text = path->getTail();
+    target.corners = 0;
+    SoCallbackAction action;
+    action.addTriangleCallback(SoText3::getClassTypeId(), bakeTriangleCB, &target);
+    action.apply(path);
+
+    SoVertexProperty* property = new SoVertexProperty;
+    property->vertex.setValues(0, (int)target.points.size(),
+                               target.points.empty() ? NULL : &target.points[0]);
+    property->normal.setValues(0, (int)target.normals.size(),
+                               target.normals.empty() ? NULL : &target.normals[0]);
+    property->normalBinding = SoVertexProperty::PER_VERTEX_INDEXED;
+
+    SoIndexedFaceSet* mesh = new SoIndexedFaceSet;
+    mesh->vertexProperty = property;
+    mesh->coordIndex.setValues(0, (int)target.coordIndex.size(),
+                               target.coordIndex.empty() ? NULL : &target.coordIndex[0]);
+
+    stats.triangles += target.corners / 3;
+    stats.corners += target.corners;
+    stats.vertices += target.points.size();
+    return mesh;
+}
+
+Text3BakeStats bakeText3(SoNode* root)
+{
+    Text3BakeStats stats;
+
+    SoSearchAction search;
+    search.setType(SoText3::getClassTypeId());
+    search.setInterest(SoSearchAction::ALL);
+    search.setSearchingAll(TRUE);
+    search.apply(root);
+    const SoPathList& paths = search.getPaths();
+
+    // A text shared by several parents is baked once, in the state of the
+    // first path leading to it
+    std::map<SoNode*, SoIndexedFaceSet*> baked;
+    for (int i = 0; i < paths.getLength(); i++) {
+        SoPath* path = paths[i];
+        if (path->getLength() < 2) {
+            continue;
+        }
+        SoNode* text = path->getTail();
+        SoNode* parent = path->getNodeFromTail(1);
+        if (!parent->isOfType(SoGroup::getClassTypeId())) {
+            continue;
+        }
+        // Paths through a shared group lead to the same child; once it is
+        // replaced, the later ones no longer end in the text
+        SoGroup* group = (SoGroup*)parent;
+        int index = path->getIndexFromTail(0);
+        if (!text->isOfType(SoText3::getClassTypeId()) || index >= group->getNumChildren() ||
+            group->getChild(index) != text) {
+            continue;
+        }
+        std::map<SoNode*, SoIndexedFaceSet*>::iterator it = baked.find(text);
+        SoIndexedFaceSet* mesh;
+        if (it == baked.end()) {
+            mesh = bakeText(path, stats);
+            mesh->ref();
+            baked[text] = mesh;
+            stats.texts++;
+        } else {
+            mesh = it->second;
+        }
+        group->replaceChild(index, mesh);
+        stats.replaced++;
+    }
+    for (std::map<SoNode*, SoIndexedFaceSet*>::iterator it = baked.begin(); it != baked.end();
+         ++it) {
+        it->second->unref();
+    }
+    return stats;
+}
@@ -0,0 +1,38 @@
+/*
+ * Text3Baker
+ * Offline conversion of SoText3 nodes into static SoIndexedFaceSet meshes
+ *
+ * SoText3 tessellates its glyph outlines, sides and bevels whenever its
+ * caches are invalidated, and needs the font engine to do so. For static
+ * signage the tessellation can be done once: every SoText3 is replaced by
+ * an SoIndexedFaceSet holding the same triangles in an SoVertexProperty,
+ * with vertices of equal position and normal shared. The baked graph can
+ * be written as binary Inventor and loads without any font lookup.
+ *
+ * Each text is tessellated in the state of its path, so fonts, sizes and
+ * profiles above it are honored. Per part material bindings are not: the
+ * mesh takes the current material as a whole.
+ */
+
+#ifndef COIN3D_EXAMPLES_TEXT3_BAKER_H
+#define COIN3D_EXAMPLES_TEXT3_BAKER_H
+
+#include <cstddef>
+
+class SoNode;
+
+struct Text3BakeStats
+{
+    int texts;           // SoText3 nodes found, counting shared ones once
+    int replaced;        // group children redirected to a baked mesh
+    size_t triangles;    // triangles of all baked meshes
+    size_t corners;      // triangle corners before sharing vertices
+    size_t vertices;     // vertices after sharing
+
+    Text3BakeStats() : texts(0), replaced(0), triangles(0), corners(0), vertices(0) {}
+};
+
+// Replace every SoText3 below root by its baked mesh
+Text3BakeStats bakeText3(SoNode* root);
+
+#endif // COIN3D_EXAMPLES_TEXT3_BAKER_H
@@ -0,0 +1,201 @@
+/*
+ * Text3 Bake Benchmark
+ * 5k 3D signage strings (SoText3, parts = ALL) before and after
+ * bakeText3(): tessellation time per traversal that baking avoids, bake
+ * time and vertex sharing, and the binary Inventor files of both graphs
+ * compared on size and on load time up to the first complete traversal,
+ * which for SoText3 includes the font engine and tessellation. The
+ * SoText3 file is loaded before any other text traversal, with cold font
+ * caches. Every tenth sign USEs one shared separator, which must be
+ * baked once and keep producing the same triangles.
+ *
+ * Usage: text_bake_benchmark [strings]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInput.h>
+#include <Inventor/SoOutput.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoWriteAction.h>
+#include <Inventor/nodes/SoFont.h>
+#include <Inventor/nodes/SoIndexedFaceSet.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoText3.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "Text3Baker.h"
+#include "BenchmarkUtils.h"
+
+static void countTriangleCB(void* data, SoCallbackAction*, const SoPrimitiveVertex*,
+                            const SoPrimitiveVertex*, const SoPrimitiveVertex*)
+{
+    (*(long*)data)++;
+}
+
+// Milliseconds of one callback traversal generating all triangles
+static double traverse(SoNode* root, long& triangles)
+{
+    triangles = 0;
+    BenchTimer timer;
+    SoCallbackAction action;
+    action.addTriangleCallback(SoShape::getClassTypeId(), countTriangleCB, &triangles);
+    action.apply(root);
+    return timer.milliseconds();
+}
+
+static bool writeBinary(SoNode* root, const char* filename)
+{
+    SoOutput out;
+    if (!out.openFile(filename)) {
+        return false;
+    }
+    out.setBinary(TRUE);
+    SoWriteAction writeAction(&out);
+    writeAction.apply(root);
+    out.closeFile();
+    return true;
+}
+
+static long fileSize(const char* filename)
+{
+    FILE* fp = fopen(filename, "rb");
+    if (!fp) {
+        return 0;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+// Read time and time of the first traversal after reading
+static bool load(const char* filename, double& readMs, double& firstTraversalMs)
+{
+    BenchTimer timer;
+    SoInput in;
+    if (!in.openFile(filename)) {
+        return false;
+    }
+    SoSeparator* root = SoDB::readAll(&in);
+    if (!root) {
+        return false;
+    }
+    root->ref();
+    readMs = timer.milliseconds();
+    long triangles;
+    firstTraversalMs = traverse(root, triangles);
+    root->unref();
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int strings = argc > 1 ? atoi(argv[1]) : 5000;
+
+    SoSeparator* root = new SoSeparator;
+    root->ref();
+    SoFont* font = new SoFont;
+    font->size = 1.0f;
+    root->addChild(font);
+    // One exit sign, written once and USEd by every tenth placement
+    SoSeparator* exitSign = new SoSeparator;
+    exitSign->ref();
+    SoText3* exitText = new SoText3;
+    exitText->string = "EXIT";
+    exitText->parts = SoText3::ALL;
+    exitSign->addChild(exitText);
+
+    char text[32];
+    int sharedUses = 0;
+    for (int i = 0; i < strings; i++) {
+        SoSeparator* sign = new SoSeparator;
+        SoTranslation* translation = new SoTranslation;
+        translation->translation.setValue((i % 50) * 8.0f, (i / 50) * 2.0f, 0.0f);
+        sign->addChild(translation);
+        if (i % 10 == 9) {
+            sign->addChild(exitSign);
+            sharedUses++;
+        } else {
+            SoText3* text3 = new SoText3;
+            snprintf(text, sizeof(text), "HALL-%04d", i);
+            text3->string = text;
+            text3->parts = SoText3::ALL;
+            sign->addChild(text3);
+        }
+        root->addChild(sign);
+    }
+
+    const char* originalFile = "/tmp/text_bake_original.iv";
+    const char* bakedFile = "/tmp/text_bake_baked.iv";
+    if (!writeBinary(root, originalFile)) {
+        fprintf(stderr, "Failed to write %s\n", originalFile);
+        return 1;
+    }
+    double readMs[2], firstMs[2];
+    if (!load(originalFile, readMs[0], firstMs[0])) {
+        fprintf(stderr, "Failed to load %s\n", originalFile);
+        return 1;
+    }
+
+    long textTriangles, bakedTriangles;
+    double firstTextMs = traverse(root, textTriangles);
+    double textMs = traverse(root, textTriangles);
+
+    BenchTimer timer;
+    Text3BakeStats stats = bakeText3(root);
+    double bakeMs = timer.milliseconds();
+
+    double bakedMs = traverse(root, bakedTriangles);
+    if (!writeBinary(root, bakedFile)) {
+        fprintf(stderr, "Failed to write %s\n", bakedFile);
+        return 1;
+    }
+    if (!load(bakedFile, readMs[1], firstMs[1])) {
+        fprintf(stderr, "Failed to load %s\n", bakedFile);
+        return 1;
+    }
+
+    // Shared texts count once, and every use of the shared sign still
+    // renders the same triangles
+    int expectedTexts = strings - sharedUses + (sharedUses > 0 ? 1 : 0);
+    bool shared = exitSign->getChild(0)->isOfType(SoIndexedFaceSet::getClassTypeId());
+    if (stats.texts != expectedTexts || stats.replaced != expectedTexts ||
+        bakedTriangles != textTriangles || (sharedUses > 0 && !shared)) {
+        fprintf(stderr, "Bake mismatch: %d texts, %d replaced (expected %d), %ld of %ld "
+                "triangles\n", stats.texts, stats.replaced, expectedTexts, bakedTriangles,
+                textTriangles);
+        return 1;
+    }
+
+    printf("%d SoText3 strings, parts = ALL, %d of them USE one shared sign\n", strings,
+           sharedUses);
+    printf("tessellation:  first traversal %.1f ms, every further one %.1f ms (%ld triangles)\n",
+           firstTextMs, textMs, textTriangles);
+    printf("baked mesh:    traversal %.1f ms (%ld triangles), %.1f ms avoided per traversal\n",
+           bakedMs, bakedTriangles, textMs - bakedMs);
+    printf("bake:          %.1f ms, %d texts, %lu corners shared into %lu vertices (%.2fx)\n",
+           bakeMs, stats.texts, (unsigned long)stats.corners, (unsigned long)stats.vertices,
+           stats.vertices ? (double)stats.corners / stats.vertices : 0.0);
+
+    printf("\n%-10s %12s %10s %16s %10s\n", "file", "size", "read ms", "1st traverse ms",
+           "total ms");
+    const char* names[2] = { "SoText3", "baked" };
+    const char* files[2] = { originalFile, bakedFile };
+    for (int i = 0; i < 2; i++) {
+        printf("%-10s %12s %10.1f %16.1f %10.1f\n", names[i],
+               formatBytes((double)fileSize(files[i])).c_str(), readMs[i], firstMs[i],
+               readMs[i] + firstMs[i]);
+        remove(files[i]);
+    }
+    printf("(SoText3 file loaded first, with cold font caches)\n");
+
+    exitSign->unref();
+    root->unref();
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * Glyph Cache Benchmark
+ * 100k part-number labels as SoText2 / SoText3 nodes compared with
+ * SoCachedText2 / SoCachedText3 drawing from the shared GlyphCache: build
+ * time, resident memory growth over build and traversal, bounding box and
+ * callback traversal time, and one offscreen frame, followed by the
+ * cache's hit/miss counts and sizes
+ *
+ * The offscreen frame is the comparison that matters: a callback traversal
+ * does not draw the SoText2 bitmaps at all. With --no-render, or when no
+ * offscreen context is available, only the callback times are compared.
+ *
+ * Usage: text_glyph_benchmark [labels] [--no-render]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoFont.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoText2.h>
+#include <Inventor/nodes/SoText3.h>
+#include <Inventor/nodes/SoTranslation.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "GlyphCache.h"
+#include "SoCachedText2.h"
+#include "SoCachedText3.h"
+#include "BenchmarkUtils.h"
+
+enum Pattern
+{
+    CACHED_TEXT2,
+    TEXT2,
+    CACHED_TEXT3,
+    TEXT3
+};
+
+struct PatternResult
+{
+    double buildMs;
+    size_t memoryBytes;  // growth of the resident size while the labels exist
+    double bboxMs;
+    double callbackMs;
+    long triangles;
+    double renderMs;     // < 0 if not available
+};
+
+static void countTriangleCB(void* data, SoCallbackAction*, const SoPrimitiveVertex*,
+                            const SoPrimitiveVertex*, const SoPrimitiveVertex*)
+{
+    (*(long*)data)++;
+}
+
+// Grid of labels "P-00000" ... under one font
+static SoSeparator* createLabels(Pattern pattern, int labels)
+{
+    SoSeparator* root = new SoSeparator;
+    root->addChild(new SoPerspectiveCamera);
+    root->addChild(new SoDirectionalLight);
+    SoFont* font = new SoFont;
+    bool is3D = pattern == CACHED_TEXT3 || pattern == TEXT3;
+    font->size = is3D ? 1.0f : 14.0f;
+    root->addChild(font);
+
+    int side = (int)ceil(sqrt((double)labels));
+    char text[32];
+    for (int i = 0; i < labels; i++) {
+        snprintf(text, sizeof(text), "P-%05d", i % 100000);
+        SoSeparator* label = new SoSeparator;
+        SoTranslation* translation = new SoTranslation;
+        translation->translation.setValue((i % side) * 6.0f, (i / side) * 2.0f, 0.0f);
+        label->addChild(translation);
+        switch (pattern) {
+        case CACHED_TEXT2: {
+            SoCachedText2* node = new SoCachedText2;
+            node->string = text;
+            label->addChild(node);
+            break;
+        }
+        case TEXT2: {
+            SoText2* node = new SoText2;
+            node->string = text;
+            label->addChild(node);
+            break;
+        }
+        case CACHED_TEXT3: {
+            SoCachedText3* node = new SoCachedText3;
+            node->string = text;
+            node->parts = SoCachedText3::ALL;
+            label->addChild(node);
+            break;
+        }
+        case TEXT3: {
+            SoText3* node = new SoText3;
+            node->string = text;
+            node->parts = SoText3::ALL;
+            label->addChild(node);
+            break;
+        }
+        }
+        root->addChild(label);
+    }
+    return root;
+}
+
+static PatternResult measure(Pattern pattern, int labels, const SbViewportRegion& viewport,
+                             bool render)
+{
+    PatternResult result;
+    size_t residentBefore = currentResidentBytes();
+    BenchTimer timer;
+    SoSeparator* root = createLabels(pattern, labels);
+    root->ref();
+    result.buildMs = timer.milliseconds();
+
+    timer.restart();
+    SoGetBoundingBoxAction bboxAction(viewport);
+    bboxAction.apply(root);
+    result.bboxMs = timer.milliseconds();
+
+    SoPerspectiveCamera* camera = (SoPerspectiveCamera*)root->getChild(0);
+    camera->viewAll(root, viewport);
+
+    result.triangles = 0;
+    timer.restart();
+    SoCallbackAction callbackAction;
+    callbackAction.addTriangleCallback(SoShape::getClassTypeId(), countTriangleCB,
+                                       &result.triangles);
+    callbackAction.apply(root);
+    result.callbackMs = timer.milliseconds();
+
+    result.renderMs = -1.0;
+    if (render) {
+        SoOffscreenRenderer renderer(viewport);
+        timer.restart();
+        if (renderer.render(root)) {
+            result.renderMs = timer.milliseconds();
+        }
+    }
+    size_t residentAfter = currentResidentBytes();
+    result.memoryBytes = residentAfter > residentBefore ? residentAfter - residentBefore : 0;
+    root->unref();
+    return result;
+}
+
+static void printRow(const char* name, const PatternResult& r, int labels)
+{
+    printf("%-14s %10.1f %12s %10.1f %10.1f %12.1f %12ld ", name, r.buildMs,
+           formatBytes((double)r.memoryBytes).c_str(), (double)r.memoryBytes / labels, r.bboxMs,
+           r.callbackMs, r.triangles);
+    if (r.renderMs >= 0.0) {
+        printf("%10.1f\n", r.renderMs);
+    } else {
+        printf("%10s\n", "n/a");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoCachedText2::initClass();
+    SoCachedText3::initClass();
+
+    int labels = 100000;
+    bool render = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-render") == 0) {
+            render = false;
+        } else {
+            labels = atoi(argv[i]);
+        }
+    }
+    SbViewportRegion viewport(1920, 1080);
+
+    const char* names[] = { "SoCachedText2", "SoText2", "SoCachedText3", "SoText3" };
+    PatternResult results[4];
+    bool rendered = render;
+    for (int pattern = 0; pattern < 4; pattern++) {
+        results[pattern] = measure((Pattern)pattern, labels, viewport, render);
+        rendered = rendered && results[pattern].renderMs >= 0.0;
+    }
+
+    printf("%d labels\n", labels);
+    printf("%-14s %10s %12s %10s %10s %12s %12s %10s\n", "pattern", "build ms", "memory",
+           "B/label", "bbox ms", "callback ms", "triangles", "render ms");
+    for (int pattern = 0; pattern < 4; pattern++) {
+        printRow(names[pattern], results[pattern], labels);
+    }
+    if (rendered) {
+        printf("(compare render ms; callback ms leaves out the SoText2 bitmaps)\n");
+    } else {
+        printf("(no offscreen frame: callback ms is the only traversal compared, and it "
+               "leaves out the SoText2 bitmaps)\n");
+    }
+
+    GlyphCacheStats stats = GlyphCache::getInstance().getStats();
+    printf("\nglyph cache: 2D %lu hits / %lu misses, 3D %lu hits / %lu misses\n", stats.hits2D,
+           stats.misses2D, stats.hits3D, stats.misses3D);
+    printf("atlas: %d pages, %s; meshes: %s\n", stats.atlasPages,
+           formatBytes((double)stats.atlasBytes).c_str(),
+           formatBytes((double)stats.meshBytes).c_str());
+    return 0;
+}
@@ -0,0 +1,266 @@
+/*
+ * Label Batch Benchmark
+ * Frame traversal time of 20k part-number labels along a camera orbit,
+ * as one Separator/Transform/Material/Font/SoText2 chain per label and as
+ * one SoLabelBatch. Without GL both sides do the CPU work of a frame: the
+ * per-node graph is traversed with a callback action that projects every
+ * SoText2 and lays out its glyph quads from the GlyphCache, the batch
+ * runs its layout, which does the same for all labels plus overlap
+ * culling. With --render both are also drawn offscreen. Both report how
+ * many labels were placed and how many were outside the view; the batch
+ * also reports the ones skipped for overlapping.
+ *
+ * Usage: text_label_benchmark [labels] [frames] [--render]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoOffscreenRenderer.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/SbViewVolume.h>
+#include <Inventor/actions/SoCallbackAction.h>
+#include <Inventor/nodes/SoDirectionalLight.h>
+#include <Inventor/nodes/SoFont.h>
+#include <Inventor/nodes/SoMaterial.h>
+#include <Inventor/nodes/SoPerspectiveCamera.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoText2.h>
+#include <Inventor/nodes/SoTransform.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "GlyphCache.h"
+#include "SoLabelBatch.h"
+#include "BenchmarkUtils.h"
+
+static const float fontSize = 12.0f;
+
+// Label i sits on a square grid of parts
+static SbVec3f labelPosition(int i, int side)
+{
+    return SbVec3f((i % side) * 4.0f, (i / side) * 4.0f, (float)(i % 7));
+}
+
+static uint32_t labelColor(int i)
+{
+    return i % 3 == 0 ? 0xff4040ff : i % 3 == 1 ? 0x40ff40ff : 0xffffffff;
+}
+
+static SoSeparator* createRoot(SoPerspectiveCamera* camera)
+{
+    SoSeparator* root = new SoSeparator;
+    root->addChild(camera);
+    root->addChild(new SoDirectionalLight);
+    SoFont* font = new SoFont;
+    font->size = fontSize;
+    root->addChild(font);
+    return root;
+}
+
+static SoSeparator* createNodeLabels(SoPerspectiveCamera* camera, int labels, int side)
+{
+    SoSeparator* root = createRoot(camera);
+    char text[32];
+    for (int i = 0; i < labels; i++) {
+        SoSeparator* label = new SoSeparator;
+        SoTransform* transform = new SoTransform;
+        transform->translation = labelPosition(i, side);
+        SoMaterial* material = new SoMaterial;
+        uint32_t rgba = labelColor(i);
+        material->diffuseColor.setValue((rgba >> 24) / 255.0f, ((rgba >> 16) & 0xff) / 255.0f,
+                                        ((rgba >> 8) & 0xff) / 255.0f);
+        SoFont* font = new SoFont;
+        font->size = fontSize;
+        SoText2* text2 = new SoText2;
+        snprintf(text, sizeof(text), "P-%05d", i);
+        text2->string = text;
+        label->addChild(transform);
+        label->addChild(material);
+        label->addChild(font);
+        label->addChild(text2);
+        root->addChild(label);
+    }
+    return root;
+}
+
+static SoLabelBatch* createBatch(int labels, int side)
+{
+    SoLabelBatch* batch = new SoLabelBatch;
+    batch->anchor.setNum(labels);
+    batch->string.setNum(labels);
+    batch->color.setNum(labels);
+    SbVec3f* anchors = batch->anchor.startEditing();
+    SbString* strings = batch->string.startEditing();
+    uint32_t* colors = batch->color.startEditing();
+    char text[32];
+    for (int i = 0; i < labels; i++) {
+        anchors[i] = labelPosition(i, side);
+        snprintf(text, sizeof(text), "P-%05d", i);
+        strings[i] = text;
+        colors[i] = labelColor(i);
+    }
+    batch->anchor.finishEditing();
+    batch->string.finishEditing();
+    batch->color.finishEditing();
+    return batch;
+}
+
+// CPU side of drawing the SoText2 nodes, as SoLabelBatch::layout() does it
+// for its labels
+struct NodeLayout
+{
+    SbVec2s viewport;
+    std::vector<uint32_t> codes;
+    std::vector<float> vertices;  // x, y per quad corner
+    long placed, outside;
+};
+
+// Project the text origin and lay out its glyph quads
+static SoCallbackAction::Response layoutText2CB(void* data, SoCallbackAction* action,
+                                                const SoNode* node)
+{
+    NodeLayout* layout = (NodeLayout*)data;
+    SbMatrix toClip = action->getModelMatrix() * action->getViewingMatrix() *
+                      action->getProjectionMatrix();
+    SbVec4f clip;
+    toClip.multVecMatrix(SbVec4f(0.0f, 0.0f, 0.0f, 1.0f), clip);
+    if (clip[3] <= 0.0f || fabsf(clip[0]) > clip[3] || fabsf(clip[1]) > clip[3] ||
+        fabsf(clip[2]) > clip[3]) {
+        layout->outside++;
+        return SoCallbackAction::CONTINUE;
+    }
+    float x = floorf((clip[0] / clip[3] + 1.0f) * 0.5f * layout->viewport[0]);
+    float y = floorf((clip[1] / clip[3] + 1.0f) * 0.5f * layout->viewport[1]);
+
+    GlyphCache& cache = GlyphCache::getInstance();
+    SbName font = action->getFontName();
+    float size = action->getFontSize();
+    GlyphCache::decodeUtf8(((const SoText2*)node)->string[0].getString(), layout->codes);
+    float pen = 0.0f;
+    for (size_t c = 0; c < layout->codes.size(); c++) {
+        const Glyph2D& glyph = cache.getGlyph2D(font, size, layout->codes[c]);
+        if (glyph.page >= 0) {
+            float x0 = x + pen + glyph.bearingX, y0 = y + glyph.bearingY;
+            float x1 = x0 + glyph.width, y1 = y0 + glyph.height;
+            const float corners[8] = { x0, y0, x1, y0, x1, y1, x0, y1 };
+            layout->vertices.insert(layout->vertices.end(), corners, corners + 8);
+        }
+        pen += glyph.advance;
+    }
+    layout->placed++;
+    return SoCallbackAction::CONTINUE;
+}
+
+static void placeCamera(SoPerspectiveCamera* camera, int frame, int frames, int side)
+{
+    float extent = side * 4.0f;
+    SbVec3f center(0.5f * extent, 0.5f * extent, 0.0f);
+    float angle = 2.0f * (float)M_PI * frame / frames;
+    camera->position = center + SbVec3f(0.4f * extent * cosf(angle),
+                                        0.4f * extent * sinf(angle), 0.5f * extent);
+    camera->pointAt(center, SbVec3f(0.0f, 1.0f, 0.0f));
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+    SoLabelBatch::initClass();
+
+    int labels = argc > 1 ? atoi(argv[1]) : 20000;
+    int frames = argc > 2 ? atoi(argv[2]) : 50;
+    bool render = argc > 3 && strcmp(argv[3], "--render") == 0;
+    int side = (int)ceil(sqrt((double)labels));
+    SbViewportRegion viewport(1920, 1080);
+
+    SoPerspectiveCamera* camera = new SoPerspectiveCamera;
+    camera->nearDistance = 1.0f;
+    camera->farDistance = side * 20.0f;
+
+    BenchTimer timer;
+    SoSeparator* nodeRoot = createNodeLabels(camera, labels, side);
+    nodeRoot->ref();
+    double nodeBuildMs = timer.milliseconds();
+
+    timer.restart();
+    SoSeparator* batchRoot = createRoot(camera);
+    batchRoot->ref();
+    SoLabelBatch* batch = createBatch(labels, side);
+    batchRoot->addChild(batch);
+    double batchBuildMs = timer.milliseconds();
+
+    double nodeMs = 0.0, layoutMs = 0.0;
+    long placed = 0, outside = 0, overlapping = 0;
+    NodeLayout nodeLayout;
+    nodeLayout.viewport = viewport.getViewportSizePixels();
+    nodeLayout.placed = nodeLayout.outside = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        placeCamera(camera, frame, frames, side);
+
+        timer.restart();
+        nodeLayout.vertices.clear();
+        SoCallbackAction callbackAction(viewport);
+        callbackAction.addPreCallback(SoText2::getClassTypeId(), layoutText2CB, &nodeLayout);
+        callbackAction.apply(nodeRoot);
+        nodeMs += timer.milliseconds();
+
+        // What SoLabelBatch does on the CPU every frame
+        SbViewVolume volume = camera->getViewVolume(viewport.getViewportAspectRatio());
+        SbMatrix viewing, projection;
+        volume.getMatrices(viewing, projection);
+        timer.restart();
+        batch->layout(viewing * projection, viewport.getViewportSizePixels(),
+                      SbName("defaultFont"), fontSize);
+        layoutMs += timer.milliseconds();
+        placed += batch->getNumPlaced();
+        outside += batch->getNumOutside();
+        overlapping += batch->getNumOverlapping();
+    }
+
+    printf("%d labels, %d frames\n", labels, frames);
+    printf("%-14s %8s %10s %14s %12s\n", "pattern", "nodes", "build ms", "layout ms/f",
+           "render ms/f");
+
+    double renderMs[2] = { -1.0, -1.0 };
+    if (render) {
+        SoOffscreenRenderer renderer(viewport);
+        for (int pass = 0; pass < 2; pass++) {
+            SoNode* root = pass ? (SoNode*)batchRoot : (SoNode*)nodeRoot;
+            bool ok = true;
+            timer.restart();
+            for (int frame = 0; frame < frames && ok; frame++) {
+                placeCamera(camera, frame, frames, side);
+                ok = renderer.render(root) != FALSE;
+            }
+            if (ok) {
+                renderMs[pass] = timer.milliseconds() / frames;
+            }
+        }
+    }
+
+    const char* names[2] = { "SoText2 nodes", "SoLabelBatch" };
+    // Root, camera, light and font, plus five nodes per label or the batch
+    int nodes[2] = { 4 + 5 * labels, 5 };
+    double buildMs[2] = { nodeBuildMs, batchBuildMs };
+    double traverseMs[2] = { nodeMs / frames, layoutMs / frames };
+    for (int pass = 0; pass < 2; pass++) {
+        printf("%-14s %8d %10.1f %14.3f ", names[pass], nodes[pass], buildMs[pass],
+               traverseMs[pass]);
+        if (renderMs[pass] >= 0.0) {
+            printf("%12.1f\n", renderMs[pass]);
+        } else {
+            printf("%12s\n", "n/a");
+        }
+    }
+    printf("\nSoText2 nodes per frame: %.0f placed, %.0f outside the view\n",
+           (double)nodeLayout.placed / frames, (double)nodeLayout.outside / frames);
+    printf("SoLabelBatch per frame:  %.0f placed, %.0f outside the view, %.0f overlapping\n",
+           (double)placed / frames, (double)outside / frames, (double)overlapping / frames);
+
+    batchRoot->unref();
+    nodeRoot->unref();
+    return 0;
+}
@@ -0,0 +1,375 @@
+/*
+ * World Matrix Cache
+ * Scene graph mirroring, dirty propagation and batched matrix composition
+ */
+
+#include "WorldMatrixCache.h"
+#include "NotificationBatch.h"
+
+#include <Inventor/SoPath.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetMatrixAction.h>
+#include <Inventor/misc/SoChildList.h>
+#include <Inventor/nodes/SoResetTransform.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSwitch.h>
+#include <Inventor/nodes/SoTransformation.h>
+#include <Inventor/nodes/SoTransformSeparator.h>
+#include <Inventor/sensors/SoNodeSensor.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define WORLD_MATRIX_CACHE_SSE
+#endif
+
+// results[i] = left[i] * right[i] for a batch of independent matrices.
+// Coin uses row vectors, so a world matrix is local * parent world.
+static void multMatrices(SbMatrix* const* results, const SbMatrix* const* left,
+                         const SbMatrix* const* right, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        const float* a = left[i]->getValue()[0];
+        const float* b = right[i]->getValue()[0];
+        float* r = (float*)(*results[i]);
+#ifdef WORLD_MATRIX_CACHE_SSE
+        __m128 b0 = _mm_loadu_ps(b);
+        __m128 b1 = _mm_loadu_ps(b + 4);
+        __m128 b2 = _mm_loadu_ps(b + 8);
+        __m128 b3 = _mm_loadu_ps(b + 12);
+        for (int row = 0; row < 4; row++) {
+            const float* ar = a + 4 * row;
+            __m128 sum = _mm_mul_ps(_mm_set1_ps(ar[0]), b0);
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(ar[1]), b1));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(ar[2]), b2));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(ar[3]), b3));
+            _mm_storeu_ps(r + 4 * row, sum);
+        }
+#else
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++) {
+                r[4 * row + col] = a[4 * row] * b[col] + a[4 * row + 1] * b[4 + col] +
+                                   a[4 * row + 2] * b[8 + col] + a[4 * row + 3] * b[12 + col];
+            }
+        }
+#endif
+    }
+}
+
+WorldMatrixCache::WorldMatrixCache(SoNode* root)
+    : root(root), structureDirty(true), switchValue(SO_SWITCH_NONE), numDirty(0),
+      numRecomputed(0), numRebuilds(0)
+{
+    root->ref();
+    matrixAction = new SoGetMatrixAction(SbViewportRegion());
+
+    // Immediate, so the trigger node and field of each change are known
+    sensor = new SoNodeSensor(rootChangedCB, this);
+    sensor->setPriority(0);
+    sensor->attach(root);
+}
+
+WorldMatrixCache::~WorldMatrixCache()
+{
+    sensor->detach();
+    delete sensor;
+    delete matrixAction;
+    for (size_t i = 0; i < tracked.size(); i++) {
+        tracked[i].path->unref();
+    }
+    root->unref();
+}
+
+void WorldMatrixCache::rootChangedCB(void* data, SoSensor* s)
+{
+    WorldMatrixCache* cache = (WorldMatrixCache*)data;
+    SoNodeSensor* sensor = (SoNodeSensor*)s;
+    if (cache->structureDirty) {
+        return;
+    }
+
+    SoNode* node = sensor->getTriggerNode();
+    SoField* field = sensor->getTriggerField();
+    const std::vector<NotificationBatch::Edit>* edits = NotificationBatch::getCommittingEdits();
+    if (node && !field && edits) {
+        // Edits a NotificationBatch merged into one notification from their
+        // common ancestor
+        for (size_t i = 0; i < edits->size() && !cache->structureDirty; i++) {
+            cache->nodeChanged((*edits)[i].node, (*edits)[i].field);
+        }
+        return;
+    }
+    cache->nodeChanged(node, field);
+}
+
+void WorldMatrixCache::nodeChanged(SoNode* node, SoField* field)
+{
+    if (node && field) {
+        // Whether a reset applies to the transform changes the frame tree
+        if (node->isOfType(SoTransformation::getClassTypeId()) &&
+            !node->isOfType(SoResetTransform::getClassTypeId())) {
+            std::unordered_map<SoNode*, std::vector<int> >::iterator it =
+                framesOfNode.find(node);
+            if (it != framesOfNode.end()) {
+                for (size_t i = 0; i < it->second.size(); i++) {
+                    frames[it->second[i]].localDirty = true;
+                    markDirty(it->second[i]);
+                }
+            }
+            return;
+        }
+        // Other field edits cannot move anything, except switching children
+        if (!node->isOfType(SoSwitch::getClassTypeId()) &&
+            !node->isOfType(SoResetTransform::getClassTypeId())) {
+            return;
+        }
+    }
+    // Children added, removed or replaced
+    structureDirty = true;
+}
+
+int WorldMatrixCache::addFrame(SoTransformation* node, int parent)
+{
+    Frame frame;
+    frame.node = node;
+    frame.parent = parent;
+    frame.depth = frames[parent].depth + 1;
+    frame.firstChild = -1;
+    frame.nextSibling = frames[parent].firstChild;
+    frame.localDirty = true;
+    frame.dirty = true;
+
+    int index = (int)frames.size();
+    frames.push_back(frame);
+    frames[parent].firstChild = index;
+    framesOfNode[node].push_back(index);
+    numDirty++;
+    return index;
+}
+
+int WorldMatrixCache::visit(SoNode* node, int occurrence, int frame)
+{
+    if (node->isOfType(SoTransformation::getClassTypeId())) {
+        // A reset starts over from the identity, like the root frame
+        int parent = frame;
+        if (node->isOfType(SoResetTransform::getClassTypeId()) &&
+            (((SoResetTransform*)node)->whatToReset.getValue() & SoResetTransform::TRANSFORM)) {
+            parent = 0;
+        }
+        frame = addFrame((SoTransformation*)node, parent);
+        occurrences[occurrence].frame = frame;
+        return frame;
+    }
+
+    SoChildList* children = node->getChildren();
+    int numChildren = children ? children->getLength() : 0;
+    int current = frame;
+    int outerSwitch = switchValue;
+
+    // Like SoSwitch: an inheriting switch takes the value of the switch
+    // above it, any other sets it for the switches below
+    int which = SO_SWITCH_ALL;
+    if (node->isOfType(SoSwitch::getClassTypeId())) {
+        which = ((SoSwitch*)node)->whichChild.getValue();
+        if (which == SO_SWITCH_INHERIT) {
+            which = switchValue;
+            if (which >= numChildren && numChildren > 0) {
+                which %= numChildren;
+            }
+        } else {
+            switchValue = which;
+        }
+    }
+
+    if (numChildren > 0) {
+        int first = (int)occurrences.size();
+        Occurrence empty = { frame, -1, 0 };
+        occurrences.resize(first + numChildren, empty);
+        occurrences[occurrence].firstChild = first;
+        occurrences[occurrence].numChildren = numChildren;
+
+        for (int i = 0; i < numChildren; i++) {
+            if (which == SO_SWITCH_ALL || which == i) {
+                current = visit((*children)[i], first + i, current);
+            } else {
+                // Not traversed: mirrored for queries, without side effects
+                int traversedSwitch = switchValue;
+                visit((*children)[i], first + i, current);
+                switchValue = traversedSwitch;
+            }
+        }
+    }
+
+    // Separators undo the transforms and switch values of their children
+    if (node->isOfType(SoSeparator::getClassTypeId()) ||
+        node->isOfType(SoTransformSeparator::getClassTypeId())) {
+        current = frame;
+    }
+    if (node->isOfType(SoSeparator::getClassTypeId())) {
+        switchValue = outerSwitch;
+    }
+    occurrences[occurrence].frame = current;
+    return current;
+}
+
+void WorldMatrixCache::rebuild()
+{
+    frames.clear();
+    occurrences.clear();
+    framesOfNode.clear();
+    numDirty = 0;
+
+    Frame rootFrame;
+    rootFrame.node = NULL;
+    rootFrame.parent = -1;
+    rootFrame.depth = 0;
+    rootFrame.firstChild = -1;
+    rootFrame.nextSibling = -1;
+    rootFrame.localDirty = false;
+    rootFrame.dirty = false;
+    rootFrame.local.makeIdentity();
+    rootFrame.world.makeIdentity();
+    frames.push_back(rootFrame);
+
+    Occurrence rootOccurrence = { 0, -1, 0 };
+    occurrences.push_back(rootOccurrence);
+    switchValue = SO_SWITCH_NONE;
+    visit(root, 0, 0);
+
+    structureDirty = false;
+    numRebuilds++;
+    for (size_t i = 0; i < tracked.size(); i++) {
+        tracked[i].frame = resolve(tracked[i].path);
+    }
+    update();
+}
+
+int WorldMatrixCache::resolve(const SoPath* path) const
+{
+    // Paths that do not start at the root resolve to the identity frame
+    if (path->getLength() == 0 || path->getHead() != root) {
+        return 0;
+    }
+    int occurrence = 0;
+    for (int i = 1; i < path->getLength(); i++) {
+        const Occurrence& parent = occurrences[occurrence];
+        int index = path->getIndex(i);
+        if (index >= parent.numChildren) {
+            break;
+        }
+        occurrence = parent.firstChild + index;
+    }
+    return occurrences[occurrence].frame;
+}
+
+void WorldMatrixCache::markDirty(int index)
+{
+    // Descendants of a dirty frame are always dirty, so stop at those
+    std::vector<int> stack(1, index);
+    while (!stack.empty()) {
+        Frame& frame = frames[stack.back()];
+        stack.pop_back();
+        if (frame.dirty) {
+            continue;
+        }
+        frame.dirty = true;
+        numDirty++;
+        for (int child = frame.firstChild; child >= 0; child = frames[child].nextSibling) {
+            stack.push_back(child);
+        }
+    }
+}
+
+void WorldMatrixCache::refreshLocal(Frame& frame)
+{
+    matrixAction->apply(frame.node);
+    frame.local = matrixAction->getMatrix();
+    frame.localDirty = false;
+}
+
+void WorldMatrixCache::computeFrame(int index)
+{
+    Frame& frame = frames[index];
+    if (!frame.dirty) {
+        return;
+    }
+    computeFrame(frame.parent);
+    if (frame.localDirty) {
+        refreshLocal(frame);
+    }
+    frame.world = frame.local;
+    frame.world.multRight(frames[frame.parent].world);
+    frame.dirty = false;
+    numDirty--;
+    numRecomputed++;
+}
+
+void WorldMatrixCache::update()
+{
+    ensureBuilt();
+    if (numDirty == 0) {
+        return;
+    }
+
+    // Frames of one depth only depend on shallower ones, so each level is
+    // one batch of independent multiplications
+    std::vector<std::vector<int> > levels;
+    for (size_t i = 1; i < frames.size(); i++) {
+        Frame& frame = frames[i];
+        if (!frame.dirty) {
+            continue;
+        }
+        if (frame.localDirty) {
+            refreshLocal(frame);
+        }
+        if ((int)levels.size() <= frame.depth) {
+            levels.resize(frame.depth + 1);
+        }
+        levels[frame.depth].push_back((int)i);
+    }
+
+    std::vector<SbMatrix*> results;
+    std::vector<const SbMatrix*> left, right;
+    for (size_t level = 0; level < levels.size(); level++) {
+        const std::vector<int>& batch = levels[level];
+        results.clear();
+        left.clear();
+        right.clear();
+        for (size_t i = 0; i < batch.size(); i++) {
+            Frame& frame = frames[batch[i]];
+            results.push_back(&frame.world);
+            left.push_back(&frame.local);
+            right.push_back(&frames[frame.parent].world);
+        }
+        multMatrices(results.data(), left.data(), right.data(), batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            frames[batch[i]].dirty = false;
+        }
+        numRecomputed += batch.size();
+    }
+    numDirty = 0;
+}
+
+WorldMatrixCache::Handle WorldMatrixCache::track(SoPath* path)
+{
+    ensureBuilt();
+    path->ref();
+    Tracked entry = { path, resolve(path) };
+    tracked.push_back(entry);
+    return (Handle)tracked.size() - 1;
+}
+
+const SbMatrix& WorldMatrixCache::getWorldMatrix(Handle handle)
+{
+    ensureBuilt();
+    int frame = tracked[handle].frame;
+    computeFrame(frame);
+    return frames[frame].world;
+}
+
+SbMatrix WorldMatrixCache::getWorldMatrix(const SoPath* path)
+{
+    ensureBuilt();
+    int frame = resolve(path);
+    computeFrame(frame);
+    return frames[frame].world;
+}
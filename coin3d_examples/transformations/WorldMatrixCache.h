@@ -0,0 +1,122 @@
+/*
+ * World Matrix Cache
+ * O(1) repeated "where is this node in world space" queries
+ *
+ * The cache mirrors the scene graph once: every SoTransformation reached
+ * by traversal becomes a frame holding its local and its world matrix,
+ * and every node occurrence records the frame in effect at it. Queries
+ * for a tracked path return the stored world matrix without traversing.
+ * An immediate sensor on the root marks the frames of an edited transform
+ * and everything below them dirty; dirty frames are recomputed on demand
+ * or all together in update(), which composes them level by level in
+ * batches with SSE. Group, switch and other structural edits rebuild the
+ * mirror on the next query. Edits committed by a NotificationBatch are
+ * handled one by one, even where the batch merged their notifications.
+ *
+ * A path's matrix is the one in effect after its tail node, matching
+ * SoGetMatrixAction applied to the path. SoResetTransform starts a new
+ * frame from the identity and switches set to SO_SWITCH_INHERIT follow
+ * the switch above them, as in a traversal.
+ */
+
+#ifndef COIN3D_EXAMPLES_WORLD_MATRIX_CACHE_H
+#define COIN3D_EXAMPLES_WORLD_MATRIX_CACHE_H
+
+#include <Inventor/SbLinear.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class SoField;
+class SoGetMatrixAction;
+class SoNode;
+class SoPath;
+class SoSensor;
+class SoNodeSensor;
+class SoTransformation;
+
+class WorldMatrixCache
+{
+public:
+    explicit WorldMatrixCache(SoNode* root);
+    ~WorldMatrixCache();
+
+    // Register a path from the root; the handle stays valid across rebuilds
+    typedef int Handle;
+    Handle track(SoPath* path);
+
+    // World matrix of a tracked path, O(1) unless its frame is dirty
+    const SbMatrix& getWorldMatrix(Handle handle);
+    // One-off query; costs O(path length) to resolve the path
+    SbMatrix getWorldMatrix(const SoPath* path);
+
+    // Recompute all dirty frames at once
+    void update();
+
+    size_t getNumFrames() const { return frames.size(); }
+    size_t getNumDirtyFrames() const { return numDirty; }
+    // Frames recomputed / full rebuilds since construction
+    unsigned long getNumRecomputed() const { return numRecomputed; }
+    unsigned long getNumRebuilds() const { return numRebuilds; }
+
+private:
+    WorldMatrixCache(const WorldMatrixCache&);
+    WorldMatrixCache& operator=(const WorldMatrixCache&);
+
+    struct Frame
+    {
+        SoTransformation* node; // NULL for the root frame
+        int parent;
+        int depth;
+        int firstChild;
+        int nextSibling;
+        bool localDirty;
+        bool dirty;
+        SbMatrix local;
+        SbMatrix world;
+    };
+
+    // One node occurrence in the mirrored graph; children are contiguous
+    struct Occurrence
+    {
+        int frame;
+        int firstChild;
+        int numChildren;
+    };
+
+    struct Tracked
+    {
+        SoPath* path;
+        int frame;
+    };
+
+    static void rootChangedCB(void* data, SoSensor* sensor);
+    void nodeChanged(SoNode* node, SoField* field);
+
+    void rebuild();
+    int visit(SoNode* node, int occurrence, int frame);
+    int addFrame(SoTransformation* node, int parent);
+    int resolve(const SoPath* path) const;
+    void markDirty(int frame);
+    void refreshLocal(Frame& frame);
+    void computeFrame(int frame);
+    void ensureBuilt() { if (structureDirty) rebuild(); }
+
+    SoNode* root;
+    SoNodeSensor* sensor;
+    SoGetMatrixAction* matrixAction;
+    bool structureDirty;
+    int switchValue; // inherited SoSwitch value while visiting
+
+    std::vector<Frame> frames;
+    std::vector<Occurrence> occurrences;
+    std::unordered_map<SoNode*, std::vector<int> > framesOfNode;
+    std::vector<Tracked> tracked;
+
+    size_t numDirty;
+    unsigned long numRecomputed;
+    unsigned long numRebuilds;
+};
+
+#endif // COIN3D_EXAMPLES_WORLD_MATRIX_CACHE_H
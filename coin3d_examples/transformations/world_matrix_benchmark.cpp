@@ -0,0 +1,237 @@
+/*
+ * World Matrix Benchmark
+ * World-space queries for every leaf of a deep transform hierarchy, with
+ * one SoGetMatrixAction per query compared to WorldMatrixCache, and the
+ * cost of refreshing the cache after editing a single transform. A small
+ * extra graph checks SoResetTransform and SO_SWITCH_INHERIT against
+ * SoGetMatrixAction as well.
+ *
+ * Usage: transformations_world_matrix_benchmark [depth] [branching]
+ */
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoPath.h>
+#include <Inventor/SbViewportRegion.h>
+#include <Inventor/actions/SoGetMatrixAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/lists/SoPathList.h>
+#include <Inventor/nodes/SoGroup.h>
+#include <Inventor/nodes/SoResetTransform.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoSwitch.h>
+#include <Inventor/nodes/SoCube.h>
+#include <Inventor/nodes/SoTransform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "WorldMatrixCache.h"
+#include "BenchmarkUtils.h"
+
+// Separator { Transform, child... } down to depth levels; every leaf
+// is Separator { Transform, Cube } and shares the same cube
+static SoSeparator* createHierarchy(int depth, int branching, SoCube* cube, int index)
+{
+    SoSeparator* sep = new SoSeparator;
+    SoTransform* transform = new SoTransform;
+    transform->translation.setValue(2.5f * (index % branching), 0.5f, 0.1f * index);
+    transform->rotation.setValue(SbVec3f(0, 0, 1), (float)M_PI / (4 + index));
+    transform->scaleFactor.setValue(0.9f, 0.9f, 0.9f);
+    sep->addChild(transform);
+    if (depth == 0) {
+        sep->addChild(cube);
+    } else {
+        for (int i = 0; i < branching; i++) {
+            sep->addChild(createHierarchy(depth - 1, branching, cube, i));
+        }
+    }
+    return sep;
+}
+
+static float maxDifference(const SbMatrix& a, const SbMatrix& b)
+{
+    float diff = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            diff = std::max(diff, std::fabs(a[i][j] - b[i][j]));
+        }
+    }
+    return diff;
+}
+
+static SoTransform* createTransform(float x, float angle, float scale)
+{
+    SoTransform* transform = new SoTransform;
+    transform->translation.setValue(x, 1.0f, -0.5f);
+    transform->rotation.setValue(SbVec3f(0, 1, 0), angle);
+    transform->scaleFactor.setValue(scale, scale, scale);
+    return transform;
+}
+
+// Largest difference between the cache and SoGetMatrixAction on every
+// cube of root
+static float compareAll(WorldMatrixCache& cache, SoNode* root, SoCube* cube,
+                        const SbViewportRegion& viewport)
+{
+    SoSearchAction search;
+    search.setNode(cube);
+    search.setInterest(SoSearchAction::ALL);
+    search.setSearchingAll(TRUE);
+    search.apply(root);
+    const SoPathList& paths = search.getPaths();
+    float diff = 0.0f;
+    for (int i = 0; i < paths.getLength(); i++) {
+        SoGetMatrixAction action(viewport);
+        action.apply(paths[i]);
+        diff = std::max(diff, maxDifference(action.getMatrix(),
+                                            cache.getWorldMatrix(paths[i])));
+    }
+    return diff;
+}
+
+// Separator {
+//   Transform
+//   Separator { ResetTransform, Transform, Cube }
+//   Switch (1) { Cube, Group { Transform, Switch (INHERIT) { Transform,
+//                Separator { Transform, Cube } } } }
+//   Cube
+// }
+// checked as built, after editing the outer switch and the reset
+static float checkResetAndInherit(const SbViewportRegion& viewport)
+{
+    SoCube* cube = new SoCube;
+    SoSeparator* root = new SoSeparator;
+    root->ref();
+    root->addChild(createTransform(1.0f, 0.3f, 1.5f));
+
+    SoSeparator* resetSep = new SoSeparator;
+    SoResetTransform* reset = new SoResetTransform;
+    resetSep->addChild(reset);
+    resetSep->addChild(createTransform(-2.0f, 0.7f, 2.0f));
+    resetSep->addChild(cube);
+    root->addChild(resetSep);
+
+    SoSwitch* outer = new SoSwitch;
+    outer->addChild(cube);
+    SoGroup* group = new SoGroup;
+    group->addChild(createTransform(3.0f, -0.4f, 0.5f));
+    SoSwitch* inner = new SoSwitch;
+    inner->whichChild = SO_SWITCH_INHERIT;
+    inner->addChild(createTransform(4.0f, 1.1f, 1.0f));
+    SoSeparator* leaf = new SoSeparator;
+    leaf->addChild(createTransform(0.5f, 0.2f, 1.2f));
+    leaf->addChild(cube);
+    inner->addChild(leaf);
+    group->addChild(inner);
+    outer->addChild(group);
+    outer->whichChild = 1;
+    root->addChild(outer);
+    root->addChild(cube);
+
+    float diff;
+    {
+        WorldMatrixCache cache(root);
+        diff = compareAll(cache, root, cube, viewport);
+        outer->whichChild = SO_SWITCH_ALL;
+        diff = std::max(diff, compareAll(cache, root, cube, viewport));
+        reset->whatToReset = SoResetTransform::BBOX;
+        diff = std::max(diff, compareAll(cache, root, cube, viewport));
+    }
+    root->unref();
+    return diff;
+}
+
+int main(int argc, char** argv)
+{
+    // Initialize Coin without any window system
+    SoDB::init();
+
+    int depth = argc > 1 ? atoi(argv[1]) : 7;
+    int branching = argc > 2 ? atoi(argv[2]) : 5;
+
+    SoCube* cube = new SoCube;
+    SoSeparator* root = createHierarchy(depth, branching, cube, 0);
+    root->ref();
+
+    // One path per leaf occurrence of the shared cube
+    SoSearchAction search;
+    search.setNode(cube);
+    search.setInterest(SoSearchAction::ALL);
+    search.apply(root);
+    SoPathList paths = search.getPaths();
+    int numPaths = paths.getLength();
+
+    SbViewportRegion viewport;
+    std::vector<SbMatrix> reference(numPaths);
+    BenchTimer timer;
+    for (int i = 0; i < numPaths; i++) {
+        SoGetMatrixAction action(viewport);
+        action.apply(paths[i]);
+        reference[i] = action.getMatrix();
+    }
+    double actionMs = timer.milliseconds();
+
+    timer.restart();
+    WorldMatrixCache cache(root);
+    cache.update();
+    double buildMs = timer.milliseconds();
+
+    timer.restart();
+    std::vector<WorldMatrixCache::Handle> handles(numPaths);
+    for (int i = 0; i < numPaths; i++) {
+        handles[i] = cache.track(paths[i]);
+    }
+    double trackMs = timer.milliseconds();
+
+    timer.restart();
+    float checksum = 0.0f;
+    for (int i = 0; i < numPaths; i++) {
+        checksum += cache.getWorldMatrix(handles[i])[3][0];
+    }
+    double queryMs = timer.milliseconds();
+
+    float error = 0.0f;
+    for (int i = 0; i < numPaths; i++) {
+        error = std::max(error, maxDifference(reference[i], cache.getWorldMatrix(handles[i])));
+    }
+
+    // Edit one transform right below the root: only its subtree goes dirty
+    SoTransform* edited = (SoTransform*)((SoSeparator*)root->getChild(1))->getChild(0);
+    unsigned long recomputedBefore = cache.getNumRecomputed();
+    timer.restart();
+    edited->translation.setValue(1.0f, 2.0f, 3.0f);
+    size_t dirty = cache.getNumDirtyFrames();
+    cache.update();
+    double updateMs = timer.milliseconds();
+    unsigned long recomputed = cache.getNumRecomputed() - recomputedBefore;
+
+    float editError = 0.0f;
+    for (int i = 0; i < numPaths; i += 97) {
+        SoGetMatrixAction action(viewport);
+        action.apply(paths[i]);
+        editError = std::max(editError, maxDifference(action.getMatrix(),
+                                                      cache.getWorldMatrix(handles[i])));
+    }
+
+    printf("depth %d, branching %d: %d leaf paths, %lu frames\n", depth, branching, numPaths,
+           (unsigned long)cache.getNumFrames());
+    printf("%-28s %10.2f ms %10.3f us/query\n", "SoGetMatrixAction per path", actionMs,
+           actionMs * 1000.0 / numPaths);
+    printf("%-28s %10.2f ms\n", "cache build", buildMs);
+    printf("%-28s %10.2f ms\n", "track all paths", trackMs);
+    printf("%-28s %10.2f ms %10.3f us/query\n", "cached queries", queryMs,
+           queryMs * 1000.0 / numPaths);
+    printf("%-28s %10.2f ms (%lu of %lu frames dirty, %lu recomputed)\n",
+           "edit + batched update", updateMs, (unsigned long)dirty,
+           (unsigned long)cache.getNumFrames(), recomputed);
+    printf("max difference to SoGetMatrixAction: %g, after edit: %g (checksum %g)\n", error,
+           editError, checksum);
+    float specialError = checkResetAndInherit(viewport);
+    printf("max difference with SoResetTransform and SO_SWITCH_INHERIT: %g\n", specialError);
+
+    root->unref();
+    return 0;
+}